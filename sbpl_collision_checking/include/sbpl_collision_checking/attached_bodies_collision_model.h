@@ -41,6 +41,7 @@
 #include <geometric_shapes/shapes.h>
 
 // project includes
+#include <sbpl_collision_checking/attached_body_model_cache.h>
 #include <sbpl_collision_checking/base_collision_models.h>
 #include <sbpl_collision_checking/robot_collision_model.h>
 #include <sbpl_collision_checking/types.h>
@@ -106,6 +107,14 @@ public:
     auto groupLinkIndices(int gidx) const -> const std::vector<int>&;
     ///@}
 
+    /// \name Attached Bodies Model Cache
+    ///@{
+    bool loadModelCache(const std::string& path);
+    bool saveModelCache(const std::string& path) const;
+    void clearModelCache();
+    void setModelCacheCapacity(size_t capacity);
+    ///@}
+
 private:
 
     struct AttachedBodyModel
@@ -138,6 +147,9 @@ private:
 
     int m_version;
 
+    // sphere and voxel models generated for previously attached bodies
+    AttachedBodyModelCache m_cache;
+
     int generateAttachedBodyIndex();
 
     CollisionSpheresModel* createSpheresModel(
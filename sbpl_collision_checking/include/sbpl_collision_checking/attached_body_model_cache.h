@@ -0,0 +1,135 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef sbpl_collision_attached_body_model_cache_h
+#define sbpl_collision_attached_body_model_cache_h
+
+// standard includes
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// system includes
+#include <Eigen/Dense>
+#include <geometric_shapes/shapes.h>
+
+// project includes
+#include <sbpl_collision_checking/base_collision_models.h>
+#include <sbpl_collision_checking/types.h>
+
+namespace sbpl {
+namespace collision {
+
+/// \brief Cache of sphere and voxel models generated for attached bodies
+///
+/// Models are keyed on the content of the attached body's shapes, rather than
+/// the attached body's id or pose, so that a body that is attached and detached
+/// repeatedly, under different ids, or at different poses, only has its models
+/// generated once. Models are stored in the frame of the body's first shape and
+/// moved to the pose of the body when attached. Sphere names are stored
+/// relative to the id of the attached body, i.e. the leaf sphere "<id>/<i>" is
+/// stored as "/<i>".
+///
+/// The cache holds at most capacity() models, counting sphere and voxel models
+/// separately. When full, the least recently used model is evicted to make room
+/// for a new one.
+///
+/// The cache may be saved to and loaded from a file to avoid regenerating
+/// models for a known set of objects. Files are stored in the host's native
+/// byte order.
+class AttachedBodyModelCache
+{
+public:
+
+    static const size_t DefaultCapacity = 256;
+
+    AttachedBodyModelCache(size_t capacity = DefaultCapacity);
+
+    static bool ComputeKey(
+        const std::vector<shapes::ShapeConstPtr>& shapes,
+        const Affine3dVector& transforms,
+        std::string& key);
+
+    static void ModelTransforms(
+        const Affine3dVector& transforms,
+        Eigen::Affine3d& origin,
+        Affine3dVector& model_transforms);
+
+    auto findSpheres(const std::string& key, double sphere_radius) const
+            -> const CollisionSphereModelTree*;
+    auto insertSpheres(
+        const std::string& key,
+        double sphere_radius,
+        CollisionSphereModelTree&& spheres)
+            -> const CollisionSphereModelTree*;
+
+    auto findVoxels(const std::string& key, double voxel_res) const
+            -> const std::vector<Eigen::Vector3d>*;
+    auto insertVoxels(
+        const std::string& key,
+        double voxel_res,
+        std::vector<Eigen::Vector3d>&& voxels)
+            -> const std::vector<Eigen::Vector3d>*;
+
+    size_t size() const;
+    size_t capacity() const { return m_capacity; }
+    void setCapacity(size_t capacity);
+    void clear();
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+private:
+
+    template <typename T>
+    struct Entry
+    {
+        T model;
+        mutable std::uint64_t last_use;
+    };
+
+    // keys are the shapes key followed by the bytes of the sphere radius or
+    // voxel resolution
+    hash_map<std::string, Entry<CollisionSphereModelTree>>      m_spheres;
+    hash_map<std::string, Entry<std::vector<Eigen::Vector3d>>>  m_voxels;
+
+    size_t m_capacity;
+
+    // incremented on every access, to order entries by recency of use
+    mutable std::uint64_t m_use_count;
+
+    void makeRoom(size_t count);
+};
+
+} // namespace collision
+} // namespace sbpl
+
+#endif
@@ -92,20 +92,24 @@ public:
     typedef container_type::const_iterator          const_iterator;
     typedef container_type::const_reverse_iterator  const_reverse_iterator;
 
-    // disallow copy/assign for now since the underyling tree structure is kept in a
-    // compact array with internal references
+    // disallow implicit copy/assign since the underyling tree structure is kept
+    // in a compact array with internal references; see copyFrom()
     CollisionSphereModelTree() : m_tree() { }
     CollisionSphereModelTree(const CollisionSphereModelTree& o) = delete;
     CollisionSphereModelTree(CollisionSphereModelTree&& o);
 
     CollisionSphereModelTree& operator=(const CollisionSphereModelTree&) = delete;
-    CollisionSphereModelTree& operator=(CollisionSphereModelTree&&) = delete;
+    CollisionSphereModelTree& operator=(CollisionSphereModelTree&& o);
 
-    void buildFrom(const std::vector<CollisionSphereConfig>& spheres);
+    void buildFrom(
+        const std::vector<CollisionSphereConfig>& spheres,
+        bool balanced = false);
     void buildFrom(const std::vector<CollisionSphereModel>& spheres);
 
     void buildFrom(const std::vector<const CollisionSphereModel*>& spheres);
 
+    void copyFrom(const CollisionSphereModelTree& o);
+
     const CollisionSphereModel* root() const { return &m_tree.back(); }
 
     /// \name Vector-like Element Access
@@ -142,7 +146,8 @@ private:
     template <typename Sphere>
     size_t buildRecursive(
         typename std::vector<const Sphere*>::iterator msfirst,
-        typename std::vector<const Sphere*>::iterator mslast);
+        typename std::vector<const Sphere*>::iterator mslast,
+        bool balanced = false);
 
     size_t buildMetaRecursive(
         std::vector<const CollisionSphereModel*>::iterator msfirst,
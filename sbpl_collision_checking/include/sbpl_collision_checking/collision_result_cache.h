@@ -0,0 +1,150 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef sbpl_collision_collision_result_cache_h
+#define sbpl_collision_collision_result_cache_h
+
+// standard includes
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// project includes
+#include <sbpl_collision_checking/types.h>
+
+namespace sbpl {
+namespace collision {
+
+/// \brief Bounded cache of collision check results
+///
+/// Results are keyed by a configuration discretized at a fixed per-variable
+/// resolution, so that all configurations falling in the same cell share a
+/// result, and by the version of the scene they were computed against. Results
+/// computed against a different scene version than the one queried are
+/// discarded. When full, entries are evicted by the CLOCK algorithm.
+///
+/// The cache is divided into independently locked shards and is safe for use
+/// by multiple threads concurrently.
+class CollisionResultCache
+{
+public:
+
+    CollisionResultCache(
+        size_t capacity,
+        const std::vector<double>& resolutions,
+        const std::vector<bool>& continuous);
+
+    bool findValidity(
+        const std::vector<double>& state,
+        uint64_t version,
+        bool& valid,
+        double& dist);
+    void insertValidity(
+        const std::vector<double>& state,
+        uint64_t version,
+        bool valid,
+        double dist);
+
+    bool findDistance(
+        const std::vector<double>& state,
+        uint64_t version,
+        double& dist);
+    void insertDistance(
+        const std::vector<double>& state,
+        uint64_t version,
+        double dist);
+
+    void clear();
+
+    size_t capacity() const;
+    auto resolutions() const -> const std::vector<double>& { return m_resolutions; }
+    size_t hits() const { return m_hits; }
+    size_t misses() const { return m_misses; }
+    double hitRate() const;
+    void resetStats();
+
+private:
+
+    struct Entry
+    {
+        std::vector<int> coord;
+        bool has_validity;
+        bool valid;
+        double valid_dist;
+        bool has_distance;
+        double distance;
+        bool referenced;
+    };
+
+    struct CoordHash
+    {
+        typedef std::vector<int> argument_type;
+        typedef std::size_t result_type;
+
+        result_type operator()(const argument_type& s) const;
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+        uint64_t version;
+        std::vector<Entry> entries;
+        hash_map<std::vector<int>, size_t, CoordHash> index;
+        size_t hand;
+    };
+
+    std::vector<double> m_resolutions;
+    std::vector<bool> m_continuous;
+    size_t m_shard_capacity;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+
+    std::atomic<size_t> m_hits;
+    std::atomic<size_t> m_misses;
+
+    void discretize(
+        const std::vector<double>& state,
+        std::vector<int>& coord) const;
+
+    Shard& shard(const std::vector<int>& coord);
+
+    Entry* find(Shard& shard, const std::vector<int>& coord, uint64_t version);
+    Entry* insert(Shard& shard, std::vector<int>&& coord, uint64_t version);
+};
+
+typedef std::shared_ptr<CollisionResultCache> CollisionResultCachePtr;
+typedef std::shared_ptr<const CollisionResultCache> CollisionResultCacheConstPtr;
+
+} // namespace collision
+} // namespace sbpl
+
+#endif
@@ -34,6 +34,7 @@
 #define sbpl_collision_collision_space_h
 
 // standard includes
+#include <cstdint>
 #include <string>
 #include <memory>
 #include <vector>
@@ -53,6 +54,7 @@
 // project includes
 #include <sbpl_collision_checking/allowed_collisions_interface.h>
 #include <sbpl_collision_checking/collision_model_config.h>
+#include <sbpl_collision_checking/collision_result_cache.h>
 #include <sbpl_collision_checking/robot_collision_model.h>
 #include <sbpl_collision_checking/robot_motion_collision_model.h>
 #include <sbpl_collision_checking/robot_collision_state.h>
@@ -65,12 +67,17 @@ namespace collision {
 
 class CollisionSpaceBuilder;
 
-class CollisionSpace : public motion::CollisionChecker
+class CollisionSpace :
+    public motion::CollisionChecker,
+    public motion::CollisionVersionExtension
 {
 public:
 
     ~CollisionSpace();
 
+    std::shared_ptr<CollisionSpace> clone();
+    bool copyConfiguration(const CollisionSpace& other);
+
     bool setPlanningScene(const moveit_msgs::PlanningScene& scene);
 
     /// \name Robot State
@@ -119,6 +126,10 @@ public:
 
     bool processAttachedCollisionObject(
         const moveit_msgs::AttachedCollisionObject& obj);
+
+    bool loadAttachedObjectCache(const std::string& path);
+    bool saveAttachedObjectCache(const std::string& path) const;
+    void setAttachedObjectCacheCapacity(size_t capacity);
     ///@}
 
     const std::string& getReferenceFrame() const;
@@ -164,11 +175,25 @@ public:
         const std::vector<double>& state,
         CollisionDetails& details);
 
+    /// \name Collision Result Cache
+    ///@{
+    bool enableResultCache(
+        size_t capacity,
+        const std::vector<double>& resolutions);
+    void disableResultCache();
+    auto resultCache() const -> CollisionResultCacheConstPtr;
+    ///@}
+
     /// \name Required Functions from Extension
     ///@{
     motion::Extension* getExtension(size_t class_code) override;
     ///@}
 
+    /// \name Required Functions from CollisionVersionExtension
+    ///@{
+    uint64_t collisionVersion() override;
+    ///@}
+
     /// \name Required Functions from CollisionChecker
     ///@{
     bool isStateValid(
@@ -223,6 +248,18 @@ private:
     std::vector<int>                m_planning_joint_to_collision_model_indices;
     std::vector<double>             m_increments;
 
+    // results of isStateValid and collisionDistance
+    CollisionResultCachePtr         m_result_cache;
+
+    // incremented on changes to the padding, allowed collisions, and robot
+    // state that are not reflected in the grid or attached bodies versions
+    uint32_t                        m_config_version;
+
+    // scratch storage and failure memory for checking motions
+    MotionFailureMemory             m_motion_failures;
+    std::vector<int>                m_waypoint_order;
+    std::vector<std::uint8_t>       m_waypoint_clear;
+
     CollisionSpace();
 
     bool init(
@@ -261,6 +298,9 @@ private:
 
     bool withinJointPositionLimits(const std::vector<double>& positions) const;
 
+    uint64_t sceneVersion() const;
+    void updateConfigVersion();
+
     friend class CollisionSpaceBuilder;
 };
 
@@ -303,6 +343,12 @@ SelfCollisionModelConstPtr CollisionSpace::selfCollisionModel() const
     return m_scm;
 }
 
+inline
+auto CollisionSpace::resultCache() const -> CollisionResultCacheConstPtr
+{
+    return m_result_cache;
+}
+
 inline
 size_t CollisionSpace::planningVariableCount() const
 {
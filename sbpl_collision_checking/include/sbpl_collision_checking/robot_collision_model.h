@@ -84,6 +84,12 @@ public:
         const urdf::ModelInterface& urdf,
         const CollisionModelConfig& config);
 
+    static
+    RobotCollisionModelPtr Load(
+        const urdf::ModelInterface& urdf,
+        const CollisionModelConfig& config,
+        const std::string& cache_dir);
+
     ~RobotCollisionModel();
 
     /// \name Robot Model - General Information
@@ -241,7 +247,8 @@ private:
 
     bool init(
         const urdf::ModelInterface& urdf,
-        const CollisionModelConfig& config);
+        const CollisionModelConfig& config,
+        const std::string& cache_dir);
 
     // this function will take care of appending joint information independent
     // of the type of joint including, name, origin, axis, and offsets into
@@ -262,9 +269,24 @@ private:
         const urdf::ModelInterface& urdf,
         const WorldJointConfig& config);
     bool initCollisionModel(
+        const urdf::ModelInterface& urdf,
+        const CollisionModelConfig& config,
+        const std::string& cache_dir);
+
+    void generateCollisionModels(
         const urdf::ModelInterface& urdf,
         const CollisionModelConfig& config);
 
+    // compiled spheres and voxels models may be cached on disk, keyed by the
+    // parts of the urdf and config they are generated from
+    std::string collisionModelsKey(
+        const urdf::ModelInterface& urdf,
+        const CollisionModelConfig& config) const;
+    bool loadCollisionModels(const std::string& path, const std::string& key);
+    bool saveCollisionModels(
+        const std::string& path,
+        const std::string& key) const;
+
     bool expandGroups(
         const std::vector<CollisionGroupConfig>& groups,
         std::vector<CollisionGroupConfig>& expanded_groups) const;
@@ -33,6 +33,7 @@
 #define sbpl_collision_robot_collision_state_h
 
 // standard includes
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -140,11 +141,17 @@ private:
     /// \name Robot State
     ///@{
     std::vector<double>                     m_jvar_positions;
-    std::vector<bool>                       m_dirty_joint_transforms;
+    std::vector<std::uint8_t>               m_dirty_joint_transforms;
     Affine3dVector                          m_joint_transforms;
-    std::vector<bool>                       m_dirty_link_transforms;
+    std::vector<std::uint8_t>               m_dirty_link_transforms;
     Affine3dVector                          m_link_transforms;
     std::vector<int>                        m_link_transform_versions;
+
+    // links in depth-first preorder from the root link; the subtree rooted at
+    // the link at position p occupies positions [p, m_subtree_ends[p])
+    std::vector<int>                        m_link_order;
+    std::vector<int>                        m_link_order_positions;
+    std::vector<int>                        m_subtree_ends;
     ///@}
 
     /// \name Collision State
@@ -163,13 +170,17 @@ private:
     std::vector<CollisionVoxelsState*>      m_link_voxels_states;
     std::vector<CollisionSpheresState*>     m_link_spheres_states;
 
-    std::vector<int> m_q;
-    std::vector<int> m_ancestors;
+    // preorder positions of the roots of link subtrees to be dirtied
+    std::vector<int> m_dirty_subtrees;
     ///@}
 
     void initRobotState();
+    void initLinkOrder();
     void initCollisionState();
 
+    void dirtyLinkSubtree(int pos);
+    void computeLinkTransform(int lidx);
+
     bool checkCollisionStateReferences() const;
 };
 
@@ -181,9 +192,14 @@ RobotCollisionState::RobotCollisionState(
 :
     m_model(model),
     m_jvar_positions(),
+    m_dirty_joint_transforms(),
+    m_joint_transforms(),
     m_dirty_link_transforms(),
     m_link_transforms(),
     m_link_transform_versions(),
+    m_link_order(),
+    m_link_order_positions(),
+    m_subtree_ends(),
     m_spheres_states(),
     m_dirty_voxels_states(),
     m_voxels_states(),
@@ -371,13 +387,19 @@ bool RobotCollisionState::linkTransformDirty(int lidx) const
     return m_dirty_link_transforms[lidx];
 }
 
+/// Update all dirty link transforms in a single pass over the links in
+/// preorder, so that every parent transform is up to date before any of its
+/// children are computed
 inline
 bool RobotCollisionState::updateLinkTransforms()
 {
     ROS_DEBUG_NAMED(RCS_LOGGER, "Updating all link transforms");
     bool updated = false;
-    for (size_t lidx = 0; lidx < m_model->linkCount(); ++lidx) {
-        updated |= updateLinkTransform(lidx);
+    for (int lidx : m_link_order) {
+        if (m_dirty_link_transforms[lidx]) {
+            computeLinkTransform(lidx);
+            updated = true;
+        }
     }
     return updated;
 }
@@ -406,6 +428,18 @@ bool RobotCollisionState::updateLinkTransform(int lidx)
         updateLinkTransform(plidx);
     }
 
+    computeLinkTransform(lidx);
+    return true;
+}
+
+/// Compute the transform of a link from its parent joint, assuming the
+/// transform of its parent link is up to date
+inline
+void RobotCollisionState::computeLinkTransform(int lidx)
+{
+    const int pjidx = m_model->linkParentJointIndex(lidx);
+    const int plidx = m_model->jointParentLinkIndex(pjidx);
+
     if (m_dirty_joint_transforms[pjidx]) {
         JointTransformFunction fn = m_model->jointTransformFn(pjidx);
         const Eigen::Affine3d& joint_origin = m_model->jointOrigin(pjidx);
@@ -427,7 +461,6 @@ bool RobotCollisionState::updateLinkTransform(int lidx)
 
     m_dirty_link_transforms[lidx] = false;
     ++m_link_transform_versions[lidx];
-    return true;
 }
 
 inline
@@ -546,13 +579,28 @@ bool RobotCollisionState::updateSphereStates()
     return updated;
 }
 
+/// Update all spheres in a spheres state with a single link transform update
 inline
 bool RobotCollisionState::updateSphereStates(int ssidx)
 {
+    ASSERT_VECTOR_RANGE(m_spheres_states, ssidx);
+    CollisionSpheresState& spheres_state = m_spheres_states[ssidx];
+    const int lidx = spheres_state.model->link_index;
+    updateLinkTransform(lidx);
+
+    const Eigen::Affine3d& T_model_link = m_link_transforms[lidx];
+    const Eigen::Matrix3d R = T_model_link.linear();
+    const Eigen::Vector3d t = T_model_link.translation();
+    const int link_version = m_link_transform_versions[lidx];
+
     bool updated = false;
-    const CollisionSpheresState& spheres_state = m_spheres_states[ssidx];
-    for (size_t sidx = 0; sidx < spheres_state.spheres.size(); ++sidx) {
-        updated |= updateSphereState(SphereIndex(ssidx, sidx));
+    for (CollisionSphereState& sphere_state : spheres_state.spheres) {
+        if (sphere_state.version == link_version) {
+            continue;
+        }
+        sphere_state.pos = R * sphere_state.model->center + t;
+        sphere_state.version = link_version;
+        updated = true;
     }
     return updated;
 }
@@ -33,6 +33,7 @@
 #define SBPL_COLLISION_ROBOT_COLLISION_MOTION_MODEL_H
 
 // standard includes
+#include <cmath>
 #include <vector>
 
 // system includes
@@ -94,6 +95,29 @@ private:
     double m_waypoint_count_inv;
 };
 
+/// Remembers the waypoint, as a fraction of the motion, at which a collision
+/// was last found along a motion from a given start state, so that the other
+/// motions from the same start state (the edges to the successors of a single
+/// state) may check there first.
+class MotionFailureMemory
+{
+public:
+
+    MotionFailureMemory() : m_start(), m_alpha(-1.0) { }
+
+    int waypoint(const std::vector<double>& start, int waypoint_count) const;
+
+    void record(
+        const std::vector<double>& start,
+        int waypoint,
+        int waypoint_count);
+
+private:
+
+    std::vector<double> m_start;
+    double m_alpha;
+};
+
 /// This class is responsible for determining the maximum distance any sphere on
 /// the robot might travel for a given motion between two states. It's primary
 /// focus is preparing an interpolation of the path such that no sphere moves
@@ -365,6 +389,31 @@ void RobotMotionCollisionModel::fillMotionInterpolation(
     }
 }
 
+/// Return the waypoint of a motion from \p start, discretized into
+/// \p waypoint_count waypoints, nearest to where the last collision from the
+/// same start state was found, or -1 if there is no such collision.
+inline
+int MotionFailureMemory::waypoint(
+    const std::vector<double>& start,
+    int waypoint_count) const
+{
+    if (m_alpha < 0.0 || waypoint_count <= 0 || start != m_start) {
+        return -1;
+    }
+    return (int)std::round(m_alpha * (waypoint_count - 1));
+}
+
+/// Record that a collision was found at a waypoint of a motion from \p start
+inline
+void MotionFailureMemory::record(
+    const std::vector<double>& start,
+    int waypoint,
+    int waypoint_count)
+{
+    m_start = start;
+    m_alpha = waypoint_count > 1 ? (double)waypoint / (waypoint_count - 1) : 0.0;
+}
+
 } // namespace collision
 } // namespace sbpl
 
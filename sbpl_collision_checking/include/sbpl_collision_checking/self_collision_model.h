@@ -59,19 +59,27 @@ class SelfCollisionModel
 {
 public:
 
+    static const size_t DefaultVoxelsFieldCapacity = 4;
+
     SelfCollisionModel(
         OccupancyGrid* grid,
         const RobotCollisionModel* rcm,
         const AttachedBodiesCollisionModel* ab_model);
 
+    SelfCollisionModel(SelfCollisionModel& base, int gidx);
+
     ~SelfCollisionModel();
 
     const AllowedCollisionMatrix& allowedCollisionMatrix() const;
     void updateAllowedCollisionMatrix(const AllowedCollisionMatrix& acm);
     void setAllowedCollisionMatrix(const AllowedCollisionMatrix& acm);
 
+    double padding() const;
     void setPadding(double padding);
 
+    size_t voxelsFieldCapacity() const;
+    void setVoxelsFieldCapacity(size_t capacity);
+
     void setWorldToModelTransform(const Eigen::Affine3d& transform);
 
     bool checkCollision(
@@ -96,6 +104,16 @@ public:
         const int gidx,
         double& dist);
 
+    bool checkMotionCollision(
+        RobotCollisionState& state,
+        AttachedBodiesCollisionState& ab_state,
+        const RobotMotionCollisionModel& rmcm,
+        const std::vector<double>& start,
+        const std::vector<double>& finish,
+        const int gidx,
+        int& num_checks,
+        double& dist);
+
     bool checkMotionCollision(
         RobotCollisionState& state,
         AttachedBodiesCollisionState& ab_state,
@@ -106,6 +124,11 @@ public:
         const int gidx,
         double& dist);
 
+    double motionClearance(
+        RobotCollisionState& state,
+        AttachedBodiesCollisionState& ab_state,
+        const int gidx);
+
     double collisionDistance(
         RobotCollisionState& state,
         AttachedBodiesCollisionState& ab_state,
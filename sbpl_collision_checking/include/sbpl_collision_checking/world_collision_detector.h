@@ -92,6 +92,12 @@ private:
 
     mutable std::vector<const CollisionSphereState*> m_vq;
 
+    // scratch storage for motion checks, and the waypoint at which the last
+    // motion check found a collision
+    mutable std::vector<int> m_order;
+    mutable std::vector<int> m_narrow;
+    mutable MotionFailureMemory m_motion_failures;
+
     bool checkRobotSpheresStateCollisions(
         RobotCollisionState& state,
         int gidx,
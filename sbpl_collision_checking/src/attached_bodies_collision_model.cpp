@@ -51,7 +51,8 @@ AttachedBodiesCollisionModel::AttachedBodiesCollisionModel(
     m_voxels_models(),
     m_group_models(),
     m_group_name_to_index(),
-    m_version(0)
+    m_version(0),
+    m_cache()
 {
     m_link_attached_bodies.resize(m_model->linkCount());
 
@@ -211,11 +212,42 @@ CollisionSpheresModel* AttachedBodiesCollisionModel::createSpheresModel(
     const Affine3dVector& transforms,
     double sphere_radius)
 {
-    ROS_DEBUG_NAMED(ABM_LOGGER, "  Generate spheres model");
+    // look for a spheres model generated for an identical body, generating
+    // and caching one, in the frame of the body's first shape and with sphere
+    // names relative to the body id, if none exists
+    std::string key;
+    const bool cacheable = m_cache.capacity() > 0 &&
+            AttachedBodyModelCache::ComputeKey(shapes, transforms, key);
+
+    Eigen::Affine3d origin;
+    Affine3dVector model_transforms;
+    const CollisionSphereModelTree* cached = nullptr;
+    if (cacheable) {
+        AttachedBodyModelCache::ModelTransforms(
+                transforms, origin, model_transforms);
+        cached = m_cache.findSpheres(key, sphere_radius);
+    }
 
-    // create configuration spheres and a spheres model for this body
-    CollisionSpheresModelConfig config;
-    generateSpheresModel(id, shapes, transforms, config, sphere_radius);
+    CollisionSphereModelTree spheres;
+    if (!cached) {
+        ROS_DEBUG_NAMED(ABM_LOGGER, "  Generate spheres model");
+
+        // create configuration spheres and a spheres model for this body
+        CollisionSpheresModelConfig config;
+        if (cacheable) {
+            generateSpheresModel(
+                    "", shapes, model_transforms, config, sphere_radius);
+        } else {
+            generateSpheresModel(
+                    id, shapes, transforms, config, sphere_radius);
+        }
+        spheres.buildFrom(config.spheres, true);
+        if (cacheable) {
+            cached = m_cache.insertSpheres(key, sphere_radius, std::move(spheres));
+        }
+    } else {
+        ROS_DEBUG_NAMED(ABM_LOGGER, "  Reuse cached spheres model");
+    }
 
     // initialize a new spheres model
     m_spheres_models.emplace_back(new CollisionSpheresModel);
@@ -224,7 +256,17 @@ CollisionSpheresModel* AttachedBodiesCollisionModel::createSpheresModel(
     CollisionSpheresModel* spheres_model = m_spheres_models.back().get();
 
     spheres_model->link_index = abidx;
-    spheres_model->spheres.buildFrom(config.spheres);
+    if (cached) {
+        spheres_model->spheres.copyFrom(*cached);
+        for (auto& sphere : spheres_model->spheres.m_tree) {
+            if (!sphere.name.empty()) {
+                sphere.name = id + sphere.name;
+            }
+            sphere.center = origin * sphere.center;
+        }
+    } else {
+        spheres_model->spheres = std::move(spheres);
+    }
     ROS_DEBUG_NAMED(ABM_LOGGER, "  Spheres Model: %p", spheres_model);
 
     // TODO: possible make this more automatic?
@@ -259,9 +301,39 @@ CollisionVoxelsModel* AttachedBodiesCollisionModel::createVoxelsModel(
     const double AB_VOXEL_RES = 0.01;
     voxels_model->voxel_res = AB_VOXEL_RES;
 
-    if (!voxelizeAttachedBody(shapes, transforms, *voxels_model)) {
+    std::string key;
+    const bool cacheable =
+            AttachedBodyModelCache::ComputeKey(shapes, transforms, key);
+    if (!cacheable) {
+        if (!voxelizeAttachedBody(shapes, transforms, *voxels_model)) {
+            ROS_ERROR_NAMED(ABM_LOGGER, "Failed to voxelize attached body '%s'", id.c_str());
+            // TODO: anything to do in this case
+        }
+        return voxels_model;
+    }
+
+    // voxels are cached in the frame of the body's first shape
+    Eigen::Affine3d origin;
+    Affine3dVector model_transforms;
+    AttachedBodyModelCache::ModelTransforms(
+            transforms, origin, model_transforms);
+
+    const std::vector<Eigen::Vector3d>* cached =
+            m_cache.findVoxels(key, voxels_model->voxel_res);
+    if (cached) {
+        ROS_DEBUG_NAMED(ABM_LOGGER, "  Reuse cached voxels model");
+        voxels_model->voxels = *cached;
+    } else if (!voxelizeAttachedBody(shapes, model_transforms, *voxels_model)) {
         ROS_ERROR_NAMED(ABM_LOGGER, "Failed to voxelize attached body '%s'", id.c_str());
         // TODO: anything to do in this case
+        return voxels_model;
+    } else {
+        std::vector<Eigen::Vector3d> voxels(voxels_model->voxels);
+        m_cache.insertVoxels(key, voxels_model->voxel_res, std::move(voxels));
+    }
+
+    for (auto& voxel : voxels_model->voxels) {
+        voxel = origin * voxel;
     }
 
     return voxels_model;
@@ -348,6 +420,31 @@ bool AttachedBodiesCollisionModel::voxelizeAttachedBody(
     return true;
 }
 
+/// Load previously generated attached body models from a file, so that
+/// attaching a known object does not require generating its models.
+bool AttachedBodiesCollisionModel::loadModelCache(const std::string& path)
+{
+    return m_cache.load(path);
+}
+
+/// Save the cached attached body models to a file
+bool AttachedBodiesCollisionModel::saveModelCache(const std::string& path) const
+{
+    return m_cache.save(path);
+}
+
+void AttachedBodiesCollisionModel::clearModelCache()
+{
+    m_cache.clear();
+}
+
+/// Set the maximum number of cached attached body models, evicting the least
+/// recently used models beyond it
+void AttachedBodiesCollisionModel::setModelCacheCapacity(size_t capacity)
+{
+    m_cache.setCapacity(capacity);
+}
+
 inline
 int AttachedBodiesCollisionModel::generateAttachedBodyIndex()
 {
@@ -0,0 +1,383 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#include <sbpl_collision_checking/attached_body_model_cache.h>
+
+// standard includes
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <sstream>
+
+// system includes
+#include <ros/console.h>
+
+// project includes
+#include "model_serialization.h"
+
+namespace sbpl {
+namespace collision {
+
+static const char* ABMC_LOGGER = "attached_bodies_model";
+
+static const uint32_t ABMC_MAGIC = 0x434d4241; // "ABMC"
+static const uint32_t ABMC_VERSION = 2;
+
+static std::string ParameterizedKey(const std::string& key, double param)
+{
+    std::string pkey(key);
+    AppendBytes(pkey, param);
+    return pkey;
+}
+
+const size_t AttachedBodyModelCache::DefaultCapacity;
+
+AttachedBodyModelCache::AttachedBodyModelCache(size_t capacity) :
+    m_spheres(),
+    m_voxels(),
+    m_capacity(capacity),
+    m_use_count(0)
+{
+}
+
+/// Append the transform of a shape, relative to the first shape of the body,
+/// rounded so that the key does not depend on the rounding error of composing
+/// the transforms with the pose of the body
+static void AppendRelativeTransform(std::string& key, const Eigen::Affine3d& t)
+{
+    const double scale = 1e6;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            AppendBytes(key, (int64_t)std::llround(t(i, j) * scale));
+        }
+    }
+}
+
+/// Compute the cache key for an attached body with the given shapes. The key
+/// depends only on the content of the shapes and, for bodies with more than one
+/// shape, on the transforms of the shapes relative to the first shape, so that
+/// the same body attached at any pose has the same key. Models are cached in
+/// the frame of the first shape; see ModelTransforms(). Returns false if the
+/// attached body contains shapes whose models should not be cached (planes and
+/// octrees).
+bool AttachedBodyModelCache::ComputeKey(
+    const std::vector<shapes::ShapeConstPtr>& shapes,
+    const Affine3dVector& transforms,
+    std::string& key)
+{
+    if (shapes.empty() || shapes.size() != transforms.size()) {
+        return false;
+    }
+
+    const Eigen::Affine3d origin_inv = transforms[0].inverse();
+
+    key.clear();
+    AppendBytes(key, (uint64_t)shapes.size());
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        const shapes::Shape* shape = shapes[i].get();
+        if (!shape) {
+            return false;
+        }
+
+        AppendBytes(key, (int32_t)shape->type);
+        switch (shape->type) {
+        case shapes::SPHERE: {
+            const shapes::Sphere* sphere =
+                    static_cast<const shapes::Sphere*>(shape);
+            AppendBytes(key, sphere->radius);
+        }   break;
+        case shapes::CYLINDER: {
+            const shapes::Cylinder* cylinder =
+                    static_cast<const shapes::Cylinder*>(shape);
+            AppendBytes(key, cylinder->radius);
+            AppendBytes(key, cylinder->length);
+        }   break;
+        case shapes::CONE: {
+            const shapes::Cone* cone = static_cast<const shapes::Cone*>(shape);
+            AppendBytes(key, cone->radius);
+            AppendBytes(key, cone->length);
+        }   break;
+        case shapes::BOX: {
+            const shapes::Box* box = static_cast<const shapes::Box*>(shape);
+            AppendBytes(key, box->size, 3);
+        }   break;
+        case shapes::MESH: {
+            const shapes::Mesh* mesh = static_cast<const shapes::Mesh*>(shape);
+            AppendBytes(key, (uint64_t)mesh->vertex_count);
+            AppendBytes(key, mesh->vertices, 3 * mesh->vertex_count);
+            AppendBytes(key, (uint64_t)mesh->triangle_count);
+            key.append(
+                    reinterpret_cast<const char*>(mesh->triangles),
+                    3 * mesh->triangle_count * sizeof(mesh->triangles[0]));
+        }   break;
+        default:
+            return false;
+        }
+
+        if (i > 0) {
+            AppendRelativeTransform(key, origin_inv * transforms[i]);
+        }
+    }
+
+    return true;
+}
+
+/// Split the transforms of the shapes of an attached body into the transform
+/// of the frame in which its models are cached, the frame of its first shape,
+/// and the transforms of the shapes in that frame
+void AttachedBodyModelCache::ModelTransforms(
+    const Affine3dVector& transforms,
+    Eigen::Affine3d& origin,
+    Affine3dVector& model_transforms)
+{
+    origin = transforms.empty() ? Eigen::Affine3d::Identity() : transforms[0];
+    const Eigen::Affine3d origin_inv = origin.inverse();
+    model_transforms.resize(transforms.size());
+    for (size_t i = 0; i < transforms.size(); ++i) {
+        model_transforms[i] = origin_inv * transforms[i];
+    }
+}
+
+auto AttachedBodyModelCache::findSpheres(
+    const std::string& key,
+    double sphere_radius) const
+    -> const CollisionSphereModelTree*
+{
+    auto it = m_spheres.find(ParameterizedKey(key, sphere_radius));
+    if (it == m_spheres.end()) {
+        return nullptr;
+    }
+    it->second.last_use = ++m_use_count;
+    return &it->second.model;
+}
+
+auto AttachedBodyModelCache::insertSpheres(
+    const std::string& key,
+    double sphere_radius,
+    CollisionSphereModelTree&& spheres)
+    -> const CollisionSphereModelTree*
+{
+    if (m_capacity == 0) {
+        return nullptr;
+    }
+
+    std::string pkey = ParameterizedKey(key, sphere_radius);
+    if (m_spheres.find(pkey) == m_spheres.end()) {
+        makeRoom(1);
+    }
+
+    // the nodes of the moved tree retain their addresses, and the nodes of
+    // hash map entries are never relocated
+    auto& entry = m_spheres[std::move(pkey)];
+    entry.model = std::move(spheres);
+    entry.last_use = ++m_use_count;
+    return &entry.model;
+}
+
+auto AttachedBodyModelCache::findVoxels(
+    const std::string& key,
+    double voxel_res) const
+    -> const std::vector<Eigen::Vector3d>*
+{
+    auto it = m_voxels.find(ParameterizedKey(key, voxel_res));
+    if (it == m_voxels.end()) {
+        return nullptr;
+    }
+    it->second.last_use = ++m_use_count;
+    return &it->second.model;
+}
+
+auto AttachedBodyModelCache::insertVoxels(
+    const std::string& key,
+    double voxel_res,
+    std::vector<Eigen::Vector3d>&& voxels)
+    -> const std::vector<Eigen::Vector3d>*
+{
+    if (m_capacity == 0) {
+        return nullptr;
+    }
+
+    std::string pkey = ParameterizedKey(key, voxel_res);
+    if (m_voxels.find(pkey) == m_voxels.end()) {
+        makeRoom(1);
+    }
+
+    auto& entry = m_voxels[std::move(pkey)];
+    entry.model = std::move(voxels);
+    entry.last_use = ++m_use_count;
+    return &entry.model;
+}
+
+size_t AttachedBodyModelCache::size() const
+{
+    return m_spheres.size() + m_voxels.size();
+}
+
+/// Set the maximum number of cached models, evicting the least recently used
+/// models if the cache holds more. A capacity of 0 disables caching.
+void AttachedBodyModelCache::setCapacity(size_t capacity)
+{
+    m_capacity = capacity;
+    makeRoom(0);
+}
+
+void AttachedBodyModelCache::clear()
+{
+    m_spheres.clear();
+    m_voxels.clear();
+}
+
+bool AttachedBodyModelCache::save(const std::string& path) const
+{
+    // replace the file as a whole; see RobotCollisionModel
+    std::ostringstream ofs;
+    WriteBinary(ofs, ABMC_MAGIC);
+    WriteBinary(ofs, ABMC_VERSION);
+
+    WriteBinary(ofs, (uint64_t)m_spheres.size());
+    for (const auto& entry : m_spheres) {
+        WriteBinary(ofs, entry.first);
+        WriteSphereTree(ofs, entry.second.model);
+    }
+
+    WriteBinary(ofs, (uint64_t)m_voxels.size());
+    for (const auto& entry : m_voxels) {
+        WriteBinary(ofs, entry.first);
+        WriteVoxels(ofs, entry.second.model);
+    }
+
+    if (!ofs || !ReplaceFile(path, ofs.str())) {
+        ROS_ERROR_NAMED(ABMC_LOGGER, "Failed to write attached body model cache to '%s'", path.c_str());
+        return false;
+    }
+
+    ROS_INFO_NAMED(ABMC_LOGGER, "Saved %zu attached body models to '%s'", size(), path.c_str());
+    return true;
+}
+
+/// Load the contents of a cache file, merging them into this cache. Entries in
+/// the file replace existing entries with the same key and count as the most
+/// recently used; if the merged cache exceeds its capacity, the least recently
+/// used entries are evicted. On failure, this cache is left unmodified.
+bool AttachedBodyModelCache::load(const std::string& path)
+{
+    std::string contents;
+    if (!ReadFile(path, contents)) {
+        ROS_ERROR_NAMED(ABMC_LOGGER, "Failed to open '%s' for reading", path.c_str());
+        return false;
+    }
+    std::istringstream ifs(contents);
+
+    uint32_t magic, version;
+    if (!ReadBinary(ifs, magic) || !ReadBinary(ifs, version) ||
+        magic != ABMC_MAGIC || version != ABMC_VERSION)
+    {
+        ROS_ERROR_NAMED(ABMC_LOGGER, "'%s' is not a compatible attached body model cache", path.c_str());
+        return false;
+    }
+
+    hash_map<std::string, CollisionSphereModelTree> spheres;
+    hash_map<std::string, std::vector<Eigen::Vector3d>> voxels;
+
+    uint64_t entry_count;
+    if (!ReadBinary(ifs, entry_count)) {
+        ROS_ERROR_NAMED(ABMC_LOGGER, "Failed to read attached body model cache from '%s'", path.c_str());
+        return false;
+    }
+    for (uint64_t i = 0; i < entry_count; ++i) {
+        std::string key;
+        if (!ReadBinary(ifs, key) || !ReadSphereTree(ifs, spheres[key])) {
+            ROS_ERROR_NAMED(ABMC_LOGGER, "Failed to read attached body model cache from '%s'", path.c_str());
+            return false;
+        }
+    }
+
+    if (!ReadBinary(ifs, entry_count)) {
+        ROS_ERROR_NAMED(ABMC_LOGGER, "Failed to read attached body model cache from '%s'", path.c_str());
+        return false;
+    }
+    for (uint64_t i = 0; i < entry_count; ++i) {
+        std::string key;
+        if (!ReadBinary(ifs, key) || !ReadVoxels(ifs, voxels[key])) {
+            ROS_ERROR_NAMED(ABMC_LOGGER, "Failed to read attached body model cache from '%s'", path.c_str());
+            return false;
+        }
+    }
+
+    for (auto& entry : spheres) {
+        auto& e = m_spheres[entry.first];
+        e.model = std::move(entry.second);
+        e.last_use = ++m_use_count;
+    }
+    for (auto& entry : voxels) {
+        auto& e = m_voxels[entry.first];
+        e.model = std::move(entry.second);
+        e.last_use = ++m_use_count;
+    }
+    makeRoom(0);
+
+    ROS_INFO_NAMED(ABMC_LOGGER, "Loaded %zu attached body models from '%s'", spheres.size() + voxels.size(), path.c_str());
+    return true;
+}
+
+// Evict the least recently used models until count more models may be
+// inserted without exceeding the capacity
+void AttachedBodyModelCache::makeRoom(size_t count)
+{
+    while (!(m_spheres.empty() && m_voxels.empty()) &&
+        size() + count > m_capacity)
+    {
+        std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+        auto sit = m_spheres.end();
+        auto vit = m_voxels.end();
+        for (auto it = m_spheres.begin(); it != m_spheres.end(); ++it) {
+            if (it->second.last_use < oldest) {
+                oldest = it->second.last_use;
+                sit = it;
+            }
+        }
+        for (auto it = m_voxels.begin(); it != m_voxels.end(); ++it) {
+            if (it->second.last_use < oldest) {
+                oldest = it->second.last_use;
+                vit = it;
+            }
+        }
+
+        if (vit != m_voxels.end()) {
+            m_voxels.erase(vit);
+        } else {
+            m_spheres.erase(sit);
+        }
+    }
+}
+
+} // namespace collision
+} // namespace sbpl
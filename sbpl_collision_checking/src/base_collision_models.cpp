@@ -30,6 +30,7 @@
 /// \author Andrew Dornbush
 
 // standard includes
+#include <algorithm>
 #include <sstream>
 
 // system includes
@@ -181,8 +182,25 @@ CollisionSphereModelTree::CollisionSphereModelTree(CollisionSphereModelTree&& o)
 {
 }
 
+/// Moving the underlying array preserves the addresses of its elements, and
+/// with them the internal references between spheres
+CollisionSphereModelTree&
+CollisionSphereModelTree::operator=(CollisionSphereModelTree&& o)
+{
+    m_tree = std::move(o.m_tree);
+    return *this;
+}
+
+/// \brief Build a bounding sphere hierarchy over a set of spheres
+///
+/// Each level of the hierarchy splits its spheres along the largest axis of
+/// their bounding box. By default, spheres are split about their centroid,
+/// which may produce a deep hierarchy for unevenly distributed spheres. If
+/// \p balanced is true, spheres are split about their median instead, so that
+/// the depth of the hierarchy is logarithmic in the number of spheres.
 void CollisionSphereModelTree::buildFrom(
-    const std::vector<CollisionSphereConfig>& spheres)
+    const std::vector<CollisionSphereConfig>& spheres,
+    bool balanced)
 {
     m_tree.clear();
 
@@ -193,7 +211,7 @@ void CollisionSphereModelTree::buildFrom(
         sptrs[i] = &spheres[i];
     }
 
-    buildRecursive<CollisionSphereConfig>(sptrs.begin(), sptrs.end());
+    buildRecursive<CollisionSphereConfig>(sptrs.begin(), sptrs.end(), balanced);
 
     // rewire the child pointers
     size_t leaf_count = 0;
@@ -285,6 +303,32 @@ void CollisionSphereModelTree::buildFrom(
     ROS_DEBUG("%zu leaves", leaf_count);
 }
 
+/// \brief Make this tree a copy of another tree
+///
+/// Internal references between spheres are rewired to refer to spheres in this
+/// tree. The parent spheres model of each sphere is copied unchanged and should
+/// be updated by the caller.
+void CollisionSphereModelTree::copyFrom(const CollisionSphereModelTree& o)
+{
+    m_tree = o.m_tree;
+
+    const CollisionSphereModel* ofirst = o.m_tree.data();
+    const CollisionSphereModel* olast = ofirst + o.m_tree.size();
+    auto rebase = [&](const CollisionSphereModel* s)
+            -> const CollisionSphereModel*
+    {
+        if (s >= ofirst && s < olast) {
+            return m_tree.data() + (s - ofirst);
+        }
+        return s;
+    };
+
+    for (CollisionSphereModel& sphere : m_tree) {
+        sphere.left = rebase(sphere.left);
+        sphere.right = rebase(sphere.right);
+    }
+}
+
 double CollisionSphereModelTree::maxRadius() const
 {
     auto radius_comp = [](
@@ -337,7 +381,8 @@ double CollisionSphereModelTree::maxLeafRadius() const
 template <typename Sphere>
 size_t CollisionSphereModelTree::buildRecursive(
     typename std::vector<const Sphere*>::iterator msfirst,
-    typename std::vector<const Sphere*>::iterator mslast)
+    typename std::vector<const Sphere*>::iterator mslast,
+    bool balanced)
 {
     if (mslast == msfirst) {
         ROS_DEBUG("Zero spheres base case");
@@ -400,15 +445,35 @@ size_t CollisionSphereModelTree::buildRecursive(
             return std::partition(first, last, SpherePartitionerZ<Sphere>(compact_bounding_sphere_center.z()));
         }
     };
-    // split the tree along the largest axis by the centroid
-    auto msmid = part(split_axis, msfirst, mslast);
-    if (msfirst == msmid || msmid == mslast) {
-        msmid = msfirst + (std::distance(msfirst, mslast) >> 1);
+    typename std::vector<const Sphere*>::iterator msmid;
+    if (balanced) {
+        // split the tree along the largest axis by the median
+        auto coord = [split_axis](const Sphere* s) {
+            if (split_axis == 0) {
+                return get_x(*s);
+            } else if (split_axis == 1) {
+                return get_y(*s);
+            } else {
+                return get_z(*s);
+            }
+        };
+        msmid = msfirst + (count >> 1);
+        std::nth_element(msfirst, msmid, mslast,
+                [&](const Sphere* a, const Sphere* b)
+                {
+                    return coord(a) < coord(b);
+                });
+    } else {
+        // split the tree along the largest axis by the centroid
+        msmid = part(split_axis, msfirst, mslast);
+        if (msfirst == msmid || msmid == mslast) {
+            msmid = msfirst + (std::distance(msfirst, mslast) >> 1);
+        }
     }
 
     // recurse on both subtrees
-    const size_t left_idx = buildRecursive<Sphere>(msfirst, msmid);
-    const size_t right_idx = buildRecursive<Sphere>(msmid, mslast);
+    const size_t left_idx = buildRecursive<Sphere>(msfirst, msmid, balanced);
+    const size_t right_idx = buildRecursive<Sphere>(msmid, mslast, balanced);
 
     const CollisionSphereModel& sl = m_tree[left_idx];
     const CollisionSphereModel& sr = m_tree[right_idx];
@@ -70,5 +70,59 @@ std::vector<SphereIndex> GatherSphereIndices(
     return sphere_indices;
 }
 
+/// \brief Compute the order in which to check the waypoints of a motion
+///
+/// The final and initial waypoints are checked first, followed by the interior
+/// waypoints in bisection (van der Corput) order, so that every part of the
+/// motion is sampled coarsely before any part of it is sampled finely.
+///
+/// \param waypoint_count The number of waypoints along the motion
+/// \param first The index of a waypoint to check before all others, or -1
+/// \param order The sequence of waypoint indices to check
+void MakeWaypointCheckOrder(
+    int waypoint_count,
+    int first,
+    std::vector<int>& order)
+{
+    order.clear();
+    if (waypoint_count <= 0) {
+        return;
+    }
+
+    order.reserve(waypoint_count);
+    if (first >= 0 && first < waypoint_count) {
+        order.push_back(first);
+    }
+
+    const int last = waypoint_count - 1;
+    if (last != first) {
+        order.push_back(last);
+    }
+    if (last == 0) {
+        return;
+    }
+    if (first != 0) {
+        order.push_back(0);
+    }
+
+    // breadth-first bisection of the open intervals between checked waypoints
+    std::vector<std::pair<int, int>> intervals;
+    intervals.reserve(waypoint_count);
+    intervals.emplace_back(0, last);
+    for (size_t head = 0; head < intervals.size(); ++head) {
+        const int lo = intervals[head].first;
+        const int hi = intervals[head].second;
+        if (hi - lo < 2) {
+            continue;
+        }
+        const int mid = lo + (hi - lo) / 2;
+        if (mid != first) {
+            order.push_back(mid);
+        }
+        intervals.emplace_back(lo, mid);
+        intervals.emplace_back(mid, hi);
+    }
+}
+
 } // namespace collision
 } // namespace sbpl
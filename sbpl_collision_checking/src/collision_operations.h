@@ -32,12 +32,19 @@
 #ifndef sbpl_collision_collision_operations_h
 #define sbpl_collision_collision_operations_h
 
+// standard includes
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
 // system includes
 #include <ros/console.h>
 #include <smpl/occupancy_grid.h>
 
 // project includes
 #include <sbpl_collision_checking/robot_collision_state.h>
+#include <sbpl_collision_checking/robot_motion_collision_model.h>
 
 namespace sbpl {
 namespace collision {
@@ -63,6 +70,24 @@ bool CheckVoxelsCollisions(
 
 static const char* COP_LOGGER = "collision_operations";
 
+void MakeWaypointCheckOrder(
+    int waypoint_count,
+    int first,
+    std::vector<int>& order);
+
+template <typename CheckFn, typename ClearanceFn>
+bool CheckMotionConservative(
+    int waypoint_count,
+    double step_motion,
+    const std::vector<double>& start,
+    MotionFailureMemory& failures,
+    std::vector<int>& order,
+    std::vector<std::uint8_t>& clear,
+    const CheckFn& check,
+    const ClearanceFn& clearance,
+    int& num_checks,
+    double& dist);
+
 /// Check a single sphere against an occupancy grid
 inline
 bool CheckSphereCollision(
@@ -164,6 +189,83 @@ bool CheckVoxelsCollisions(
     return true;
 }
 
+/// Check the waypoints of a motion by conservative advancement
+///
+/// Waypoints are checked in the order given by MakeWaypointCheckOrder(),
+/// beginning with the waypoint at which a collision was last found along a
+/// motion from the same start state. After a waypoint is found to be
+/// collision-free, its clearance, divided by the bound on the distance any
+/// sphere moves between two waypoints, gives the number of surrounding
+/// waypoints, and the motion in between, that are also collision-free. These
+/// waypoints are skipped.
+///
+/// \param waypoint_count The number of waypoints along the motion
+/// \param step_motion Upper bound on the distance any sphere moves between two
+///     consecutive waypoints
+/// \param start The start state of the motion
+/// \param failures Memory of the waypoint at which the last collision was found
+/// \param order Storage for the order in which to check waypoints
+/// \param clear Storage for the waypoints known to be collision-free
+/// \param check Checks a waypoint for collisions, called as
+///     check(int waypoint, double& dist)
+/// \param clearance Returns the clearance at the waypoint checked last, or 0 if
+///     the check covers only the waypoint itself
+/// \param num_checks Incremented for each waypoint checked
+/// \param dist The distance that caused the check to fail, if any; otherwise,
+///     the minimum distance over the checked waypoints
+template <typename CheckFn, typename ClearanceFn>
+bool CheckMotionConservative(
+    int waypoint_count,
+    double step_motion,
+    const std::vector<double>& start,
+    MotionFailureMemory& failures,
+    std::vector<int>& order,
+    std::vector<std::uint8_t>& clear,
+    const CheckFn& check,
+    const ClearanceFn& clearance,
+    int& num_checks,
+    double& dist)
+{
+    const int last = waypoint_count - 1;
+
+    MakeWaypointCheckOrder(
+            waypoint_count, failures.waypoint(start, waypoint_count), order);
+    clear.assign(waypoint_count, 0);
+
+    double dmin = std::numeric_limits<double>::infinity();
+    for (const int i : order) {
+        if (clear[i]) {
+            continue;
+        }
+
+        ++num_checks;
+        double wdist = std::numeric_limits<double>::infinity();
+        if (!check(i, wdist)) {
+            failures.record(start, i, waypoint_count);
+            dist = wdist;
+            return false;
+        }
+        dmin = std::min(dmin, wdist);
+
+        clear[i] = 1;
+        if (last == 0) {
+            continue;
+        }
+        const double safe_steps = clearance() / step_motion;
+        const int steps = safe_steps >= (double)last ?
+                last : std::max(0, (int)safe_steps);
+        if (steps > 0) {
+            const int lo = std::max(0, i - steps);
+            const int hi = std::min(last, i + steps);
+            ROS_DEBUG_NAMED(COP_LOGGER, "Motion is clear from waypoint %d to %d", lo, hi);
+            std::fill(clear.begin() + lo, clear.begin() + hi + 1, 1);
+        }
+    }
+
+    dist = dmin;
+    return true;
+}
+
 } // namespace collision
 } // namespace sbpl
 
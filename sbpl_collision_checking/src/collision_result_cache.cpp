@@ -0,0 +1,280 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#include <sbpl_collision_checking/collision_result_cache.h>
+
+// standard includes
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+
+// system includes
+#include <boost/functional/hash.hpp>
+#include <smpl/angles.h>
+
+namespace sbpl {
+namespace collision {
+
+static const size_t RESULT_CACHE_SHARD_COUNT = 16;
+
+/// \param capacity The maximum number of cached configurations
+/// \param resolutions The discretization of each variable
+/// \param continuous Whether each variable is an unbounded angle, to be
+///     normalized before discretization
+CollisionResultCache::CollisionResultCache(
+    size_t capacity,
+    const std::vector<double>& resolutions,
+    const std::vector<bool>& continuous)
+:
+    m_resolutions(resolutions),
+    m_continuous(continuous),
+    m_shard_capacity(),
+    m_shards(),
+    m_hits(0),
+    m_misses(0)
+{
+    assert(resolutions.size() == continuous.size());
+    m_shard_capacity = std::max(
+            (size_t)1,
+            (capacity + RESULT_CACHE_SHARD_COUNT - 1) / RESULT_CACHE_SHARD_COUNT);
+    m_shards.resize(RESULT_CACHE_SHARD_COUNT);
+    for (auto& shard : m_shards) {
+        shard.reset(new Shard);
+        shard->version = 0;
+        shard->entries.reserve(m_shard_capacity);
+        shard->index.reserve(m_shard_capacity);
+        shard->hand = 0;
+    }
+}
+
+/// Look up the result of a validity check. On a hit, \p valid and \p dist are
+/// set to the results of the check of the first configuration inserted in the
+/// same cell.
+bool CollisionResultCache::findValidity(
+    const std::vector<double>& state,
+    uint64_t version,
+    bool& valid,
+    double& dist)
+{
+    std::vector<int> coord;
+    discretize(state, coord);
+    Shard& s = shard(coord);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    Entry* entry = find(s, coord, version);
+    if (!entry || !entry->has_validity) {
+        ++m_misses;
+        return false;
+    }
+    ++m_hits;
+    valid = entry->valid;
+    dist = entry->valid_dist;
+    return true;
+}
+
+void CollisionResultCache::insertValidity(
+    const std::vector<double>& state,
+    uint64_t version,
+    bool valid,
+    double dist)
+{
+    std::vector<int> coord;
+    discretize(state, coord);
+    Shard& s = shard(coord);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    Entry* entry = insert(s, std::move(coord), version);
+    entry->has_validity = true;
+    entry->valid = valid;
+    entry->valid_dist = dist;
+}
+
+bool CollisionResultCache::findDistance(
+    const std::vector<double>& state,
+    uint64_t version,
+    double& dist)
+{
+    std::vector<int> coord;
+    discretize(state, coord);
+    Shard& s = shard(coord);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    Entry* entry = find(s, coord, version);
+    if (!entry || !entry->has_distance) {
+        ++m_misses;
+        return false;
+    }
+    ++m_hits;
+    dist = entry->distance;
+    return true;
+}
+
+void CollisionResultCache::insertDistance(
+    const std::vector<double>& state,
+    uint64_t version,
+    double dist)
+{
+    std::vector<int> coord;
+    discretize(state, coord);
+    Shard& s = shard(coord);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    Entry* entry = insert(s, std::move(coord), version);
+    entry->has_distance = true;
+    entry->distance = dist;
+}
+
+void CollisionResultCache::clear()
+{
+    for (auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->entries.clear();
+        shard->index.clear();
+        shard->hand = 0;
+    }
+}
+
+size_t CollisionResultCache::capacity() const
+{
+    return m_shard_capacity * m_shards.size();
+}
+
+double CollisionResultCache::hitRate() const
+{
+    const size_t hits = m_hits;
+    const size_t lookups = hits + m_misses;
+    return lookups ? (double)hits / (double)lookups : 0.0;
+}
+
+void CollisionResultCache::resetStats()
+{
+    m_hits = 0;
+    m_misses = 0;
+}
+
+auto CollisionResultCache::CoordHash::operator()(const argument_type& s) const ->
+    result_type
+{
+    std::size_t seed = 0;
+    boost::hash_combine(seed, boost::hash_range(s.begin(), s.end()));
+    return seed;
+}
+
+void CollisionResultCache::discretize(
+    const std::vector<double>& state,
+    std::vector<int>& coord) const
+{
+    assert(state.size() == m_resolutions.size());
+    coord.resize(state.size());
+    for (size_t i = 0; i < state.size(); ++i) {
+        double v = state[i];
+        if (m_continuous[i]) {
+            v = angles::normalize_angle_positive(v);
+        }
+        coord[i] = (int)std::floor(v / m_resolutions[i] + 0.5);
+    }
+}
+
+auto CollisionResultCache::shard(const std::vector<int>& coord) -> Shard&
+{
+    // use the high bits so that shards and per-shard buckets are not chosen by
+    // the same bits of the hash
+    const size_t h = CoordHash()(coord);
+    return *m_shards[(h >> 16) % m_shards.size()];
+}
+
+auto CollisionResultCache::find(
+    Shard& shard,
+    const std::vector<int>& coord,
+    uint64_t version)
+    -> Entry*
+{
+    if (shard.version != version) {
+        return nullptr;
+    }
+
+    auto it = shard.index.find(coord);
+    if (it == shard.index.end()) {
+        return nullptr;
+    }
+
+    Entry& entry = shard.entries[it->second];
+    entry.referenced = true;
+    return &entry;
+}
+
+auto CollisionResultCache::insert(
+    Shard& shard,
+    std::vector<int>&& coord,
+    uint64_t version)
+    -> Entry*
+{
+    // drop results computed against a different scene
+    if (shard.version != version) {
+        shard.entries.clear();
+        shard.index.clear();
+        shard.hand = 0;
+        shard.version = version;
+    }
+
+    auto it = shard.index.find(coord);
+    if (it != shard.index.end()) {
+        Entry& entry = shard.entries[it->second];
+        entry.referenced = true;
+        return &entry;
+    }
+
+    size_t eidx;
+    if (shard.entries.size() < m_shard_capacity) {
+        eidx = shard.entries.size();
+        shard.entries.emplace_back();
+    } else {
+        // advance the clock hand to the first entry not referenced since the
+        // hand last passed it
+        while (shard.entries[shard.hand].referenced) {
+            shard.entries[shard.hand].referenced = false;
+            shard.hand = (shard.hand + 1) % shard.entries.size();
+        }
+        eidx = shard.hand;
+        shard.hand = (shard.hand + 1) % shard.entries.size();
+        shard.index.erase(shard.entries[eidx].coord);
+    }
+
+    Entry& entry = shard.entries[eidx];
+    entry.coord = std::move(coord);
+    entry.has_validity = false;
+    entry.valid = false;
+    entry.valid_dist = 0.0;
+    entry.has_distance = false;
+    entry.distance = 0.0;
+    entry.referenced = true;
+    shard.index[entry.coord] = eidx;
+    return &entry;
+}
+
+} // namespace collision
+} // namespace sbpl
@@ -47,6 +47,8 @@
 #include <moveit_msgs/RobotState.h>
 #include <smpl/angles.h>
 
+#include "collision_operations.h"
+
 namespace sbpl {
 namespace collision {
 
@@ -56,6 +58,80 @@ CollisionSpace::~CollisionSpace()
 {
 }
 
+/// \brief Create a collision space that may check states on another thread
+///
+/// The clone shares the occupancy grid, robot collision model, attached bodies
+/// model, and world collision model with this collision space, but keeps its
+/// own robot state, self collision voxels fields, and scratch storage, so that
+/// clones may check states concurrently with each other.
+///
+/// Changes to the world objects, attached objects, and world padding are made
+/// to the shared models and are seen by all clones. The robot state, world to
+/// model transform, self collision padding, and allowed collision matrix are
+/// copied when the clone is created; the clone is a snapshot of them and later
+/// changes to this collision space must be propagated to each clone with
+/// copyConfiguration(). No changes may be made while any clone is checking
+/// states. Clones only ever check the group of this collision space.
+std::shared_ptr<CollisionSpace> CollisionSpace::clone()
+{
+    CollisionSpacePtr cspace(new CollisionSpace);
+    cspace->m_grid = m_grid;
+    cspace->m_rcm = m_rcm;
+    cspace->m_abcm = m_abcm;
+    cspace->m_rmcm = m_rmcm;
+    cspace->m_rcs = std::make_shared<RobotCollisionState>(m_rcm.get());
+    cspace->m_abcs = std::make_shared<AttachedBodiesCollisionState>(
+            m_abcm.get(), cspace->m_rcs.get());
+    cspace->m_joint_vars = m_joint_vars;
+    cspace->m_wcm = m_wcm;
+    cspace->m_scm = std::make_shared<SelfCollisionModel>(*m_scm, m_gidx);
+    cspace->m_group_name = m_group_name;
+    cspace->m_gidx = m_gidx;
+    cspace->m_planning_joint_to_collision_model_indices =
+            m_planning_joint_to_collision_model_indices;
+    cspace->m_increments = m_increments;
+    cspace->m_config_version = m_config_version;
+    if (m_result_cache) {
+        cspace->enableResultCache(
+                m_result_cache->capacity(), m_result_cache->resolutions());
+    }
+
+    cspace->m_rcs->setWorldToModelTransform(m_rcs->worldToModelTransform());
+    cspace->copyState();
+    return cspace;
+}
+
+/// \brief Copy the robot state and collision configuration of another collision
+///     space
+///
+/// Copies the joint variables, world to model transform, self collision
+/// padding, and allowed collision matrix, as captured by clone(), so that a
+/// clone can be brought up to date with the collision space it was cloned from.
+///
+/// \param other A collision space over the same robot collision model
+/// \return true if the configuration was copied; false otherwise
+bool CollisionSpace::copyConfiguration(const CollisionSpace& other)
+{
+    if (other.m_rcm != m_rcm) {
+        ROS_ERROR_NAMED(CC_LOGGER, "Cannot copy configuration from a collision space over a different robot collision model");
+        return false;
+    }
+
+    if (&other == this) {
+        return true;
+    }
+
+    m_joint_vars = other.m_joint_vars;
+    const Eigen::Affine3d& transform = other.m_rcs->worldToModelTransform();
+    m_rcs->setWorldToModelTransform(transform);
+    m_scm->setWorldToModelTransform(transform);
+    m_scm->setPadding(other.m_scm->padding());
+    m_scm->setAllowedCollisionMatrix(other.m_scm->allowedCollisionMatrix());
+    copyState();
+    updateConfigVersion();
+    return true;
+}
+
 /// \brief Set the planning scene
 /// \param scene The scene
 /// \return true if the scene was updated correctly; false otherwise
@@ -130,9 +206,9 @@ bool CollisionSpace::setPlanningScene(const moveit_msgs::PlanningScene& scene)
 
     AllowedCollisionMatrix acm(scene.allowed_collision_matrix);
     if (scene.is_diff) {
-        m_scm->updateAllowedCollisionMatrix(acm);
+        updateAllowedCollisionMatrix(acm);
     } else {
-        m_scm->setAllowedCollisionMatrix(acm);
+        setAllowedCollisionMatrix(acm);
     }
 
     //////////////////////////
@@ -169,7 +245,10 @@ bool CollisionSpace::setJointPosition(
 {
     if (m_rcm->hasJointVar(name)) {
         int jidx = m_rcm->jointVarIndex(name);
-        m_joint_vars[jidx] = position;
+        if (m_joint_vars[jidx] != position) {
+            m_joint_vars[jidx] = position;
+            updateConfigVersion();
+        }
         return true;
     } else {
         return false;
@@ -189,6 +268,7 @@ void CollisionSpace::setWorldToModelTransform(
             m_rcs->getJointVarPositions() + vlidx,
             m_joint_vars.data() + vfidx);
     m_scm->setWorldToModelTransform(transform);
+    updateConfigVersion();
 }
 
 /// \brief Set the padding applied to the collision model
@@ -196,6 +276,7 @@ void CollisionSpace::setPadding(double padding)
 {
     m_wcm->setPadding(padding);
     m_scm->setPadding(padding);
+    updateConfigVersion();
 }
 
 /// \brief Return the allowed collision matrix
@@ -210,7 +291,8 @@ const AllowedCollisionMatrix& CollisionSpace::allowedCollisionMatrix() const
 void CollisionSpace::updateAllowedCollisionMatrix(
     const AllowedCollisionMatrix& acm)
 {
-    return m_scm->updateAllowedCollisionMatrix(acm);
+    m_scm->updateAllowedCollisionMatrix(acm);
+    updateConfigVersion();
 }
 
 /// \brief Set the allowed collision matrix
@@ -219,6 +301,7 @@ void CollisionSpace::setAllowedCollisionMatrix(
     const AllowedCollisionMatrix& acm)
 {
     m_scm->setAllowedCollisionMatrix(acm);
+    updateConfigVersion();
 }
 
 /// \brief Insert an object into the world
@@ -327,6 +410,30 @@ bool CollisionSpace::detachObject(const std::string& id)
     return m_abcm->detachBody(id);
 }
 
+/// \brief Load sphere and voxel models of attached objects from a file
+///
+/// Objects attached later whose shapes match those of a loaded model reuse the
+/// loaded model rather than generating a new one.
+bool CollisionSpace::loadAttachedObjectCache(const std::string& path)
+{
+    return m_abcm->loadModelCache(path);
+}
+
+/// \brief Save the cached sphere and voxel models of attached objects
+bool CollisionSpace::saveAttachedObjectCache(const std::string& path) const
+{
+    return m_abcm->saveModelCache(path);
+}
+
+/// \brief Set the maximum number of cached attached object models
+///
+/// The least recently used models are evicted when the cache is full. A
+/// capacity of 0 disables caching.
+void CollisionSpace::setAttachedObjectCacheCapacity(size_t capacity)
+{
+    m_abcm->setModelCacheCapacity(capacity);
+}
+
 /// \brief Process an attached collision object
 /// \param ao The attached collision object
 /// \return true if the attached collision object was processed successfully;
@@ -509,8 +616,19 @@ bool CollisionSpace::checkCollision(
 
 double CollisionSpace::collisionDistance(const std::vector<double>& state)
 {
+    double dist;
+    const uint64_t version = m_result_cache ? sceneVersion() : 0;
+    if (m_result_cache && m_result_cache->findDistance(state, version, dist)) {
+        return dist;
+    }
+
     updateState(state);
-    return m_scm->collisionDistance(*m_rcs, *m_abcs, m_gidx);
+    dist = m_scm->collisionDistance(*m_rcs, *m_abcs, m_gidx);
+
+    if (m_result_cache) {
+        m_result_cache->insertDistance(state, version, dist);
+    }
+    return dist;
 }
 
 bool CollisionSpace::collisionDetails(
@@ -521,30 +639,111 @@ bool CollisionSpace::collisionDetails(
     return m_scm->collisionDetails(*m_rcs, *m_abcs, m_gidx, details);
 }
 
+/// \brief Cache the results of isStateValid and collisionDistance
+///
+/// Results are shared by all states that discretize to the same cell at the
+/// given per-planning-variable resolutions, typically the resolutions of the
+/// planner's state lattice, so a cached distance may differ slightly from the
+/// distance of the queried state. Cached results are dropped when the
+/// occupancy grid or attached objects change, or when the scene is modified
+/// through this collision space. Clones of this collision space receive their
+/// own cache, with the same capacity and resolutions, since the versions of
+/// this collision space and its clones advance independently.
+///
+/// \param capacity The maximum number of cached states
+/// \param resolutions The discretization of each planning variable
+/// \return true if the cache was enabled; false otherwise
+bool CollisionSpace::enableResultCache(
+    size_t capacity,
+    const std::vector<double>& resolutions)
+{
+    if (resolutions.size() != planningVariableCount()) {
+        ROS_ERROR_NAMED(CC_LOGGER, "Result cache requires one resolution for each planning variable (expected: %zu, actual: %zu)", planningVariableCount(), resolutions.size());
+        return false;
+    }
+
+    std::vector<bool> continuous(planningVariableCount());
+    for (size_t vidx = 0; vidx < planningVariableCount(); ++vidx) {
+        continuous[vidx] = isContinuous(vidx);
+    }
+
+    m_result_cache = std::make_shared<CollisionResultCache>(
+            capacity, resolutions, continuous);
+    return true;
+}
+
+void CollisionSpace::disableResultCache()
+{
+    m_result_cache.reset();
+}
+
 motion::Extension* CollisionSpace::getExtension(size_t class_code)
 {
-    if (class_code == motion::GetClassCode<motion::CollisionChecker>()) {
+    if (class_code == motion::GetClassCode<motion::CollisionChecker>() ||
+        class_code == motion::GetClassCode<motion::CollisionVersionExtension>())
+    {
         return this;
     }
     return nullptr;
 }
 
+/// \brief Return a version identifying the scene and configuration against
+///     which collisions are checked
+///
+/// The version changes when the occupancy grid or attached objects change, or
+/// when the robot state, padding, or allowed collisions are modified through
+/// this collision space.
+uint64_t CollisionSpace::collisionVersion()
+{
+    return sceneVersion();
+}
+
 bool CollisionSpace::isStateValid(
     const motion::RobotState& state,
     bool verbose,
     bool visualize,
     double& dist)
 {
+    bool valid;
+    const uint64_t version = m_result_cache ? sceneVersion() : 0;
+    if (m_result_cache &&
+        m_result_cache->findValidity(state, version, valid, dist))
+    {
+        return valid;
+    }
+
     dist = std::numeric_limits<double>::max();
-    return checkCollision(state, dist);
+    valid = checkCollision(state, dist);
+
+    if (m_result_cache) {
+        m_result_cache->insertValidity(state, version, valid, dist);
+    }
+    return valid;
 }
 
+/// \brief Check a linearly interpolated motion between two states
+///
+/// The motion is discretized so that no sphere moves further than a fixed
+/// resolution between consecutive waypoints, and waypoints are checked with
+/// the same full collision check as isStateValid(), but never through its
+/// result cache. Waypoints are checked in bisection order, beginning with the
+/// waypoint at which a collision was last found along a motion from the same
+/// start state.
+///
+/// The motion is checked by conservative advancement: after a waypoint is
+/// checked and found collision-free, the clearance of the robot at that
+/// waypoint, together with the bound on sphere motion from the motion collision
+/// model, determines how many of the surrounding waypoints, and the motion in
+/// between, are also collision-free. These waypoints are skipped. See
+/// SelfCollisionModel::motionClearance and CheckMotionConservative.
+///
+/// The reported distance is the minimum distance over the checked waypoints.
 bool CollisionSpace::isStateToStateValid(
     const motion::RobotState& start,
     const motion::RobotState& finish,
     int& path_length,
     int& num_checks,
-    double &dist)
+    double& dist)
 {
     const double res = 0.05;
 
@@ -555,52 +754,44 @@ bool CollisionSpace::isStateToStateValid(
             m_planning_joint_to_collision_model_indices, res,
             interp);
 
-    const bool verbose = false;
-
-    const int inc_cc = 5;
-    double dist_temp = std::numeric_limits<double>::infinity();
-
     // for debugging & statistical purposes
     path_length = interp.waypointCount();
 
-    motion::RobotState interm;
+    if (interp.waypointCount() == 0) {
+        return true;
+    }
 
-    // TODO: Looks like the idea here is to collision check the path starting at
-    // the most coarse resolution (just the endpoints) and increasing the
-    // granularity until all points are checked. This could probably be made
-    // irrespective of the number of waypoints by bisecting the path and
-    // checking the endpoints recursively.
-    if (interp.waypointCount() > inc_cc) {
-        // try to find collisions that might come later in the path earlier
-        for (int i = 0; i < inc_cc; i++) {
-            for (size_t j = i; j < interp.waypointCount(); j = j + inc_cc) {
-                num_checks++;
-                interp.interpolate(j, interm, m_planning_joint_to_collision_model_indices);
-                if (!isStateValid(interm, verbose, false, dist_temp)) {
-                    dist = dist_temp;
-                    return false;
-                }
-
-                if (dist_temp < dist) {
-                    dist = dist_temp;
-                }
-            }
-        }
-    } else {
-        for (size_t i = 0; i < interp.waypointCount(); i++) {
-            num_checks++;
-            interp.interpolate(i, interm, m_planning_joint_to_collision_model_indices);
-            if (!isStateValid(interm, verbose, false, dist_temp)) {
-                dist = dist_temp;
-                return false;
-            }
-
-            if (dist_temp < dist) {
-                dist = dist_temp;
-            }
-        }
+    // upper bound on the distance any sphere moves between two waypoints
+    const double step_motion = m_rmcm->getMaxSphereMotion(
+            start, finish, m_planning_joint_to_collision_model_indices) /
+            (interp.waypointCount() - 1);
+
+    // waypoints bypass the result cache; a cached result is shared by all
+    // states in the same cell and says nothing of the motion around this one
+    double dmin;
+    motion::RobotState interm;
+    const bool valid = CheckMotionConservative(
+            interp.waypointCount(), step_motion, start,
+            m_motion_failures, m_waypoint_order, m_waypoint_clear,
+            [&](int i, double& d) {
+                interp.interpolate(
+                        i, interm, m_planning_joint_to_collision_model_indices);
+                return checkCollision(interm, d);
+            },
+            [&]() {
+                // the collision models were updated to this waypoint by the
+                // check
+                return m_scm->motionClearance(*m_rcs, *m_abcs, m_gidx);
+            },
+            num_checks, dmin);
+    if (!valid) {
+        dist = dmin;
+        return false;
     }
 
+    if (dmin < dist) {
+        dist = dmin;
+    }
     return true;
 }
 
@@ -693,7 +884,13 @@ CollisionSpace::CollisionSpace() :
     m_scm(),
     m_group_name(),
     m_gidx(-1),
-    m_planning_joint_to_collision_model_indices()
+    m_planning_joint_to_collision_model_indices(),
+    m_increments(),
+    m_result_cache(),
+    m_config_version(0),
+    m_motion_failures(),
+    m_waypoint_order(),
+    m_waypoint_clear()
 {
 }
 
@@ -848,6 +1045,25 @@ bool CollisionSpace::withinJointPositionLimits(
     return inside;
 }
 
+/// Return a version identifying the state of the occupancy grid, the set of
+/// attached bodies, and the configuration of this collision space, against
+/// which cached collision results are valid.
+uint64_t CollisionSpace::sceneVersion() const
+{
+    // both counters only increase, so their sum changes whenever either does
+    const uint32_t local_version =
+            (uint32_t)m_abcm->version() + m_config_version;
+    return ((uint64_t)m_grid->version() << 32) | (uint64_t)local_version;
+}
+
+/// Record a change to the configuration of this collision space that may
+/// change the result of a collision check. Cached results computed against the
+/// previous configuration are ignored from then on.
+void CollisionSpace::updateConfigVersion()
+{
+    ++m_config_version;
+}
+
 CollisionSpacePtr CollisionSpaceBuilder::build(
     OccupancyGrid* grid,
     const std::string& urdf_string,
@@ -0,0 +1,225 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#include "model_serialization.h"
+
+// standard includes
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+// system includes
+#include <unistd.h>
+
+namespace sbpl {
+namespace collision {
+
+/// Return whether the unread part of a stream is large enough to hold \p count
+/// items of at least \p item_size bytes each, so that a corrupt count is
+/// rejected before storage is allocated for it. The stream must be seekable;
+/// streams over files read into memory are cheapest to seek.
+bool CountFits(std::istream& i, uint64_t count, size_t item_size)
+{
+    const std::streampos pos = i.tellg();
+    if (pos == std::streampos(-1)) {
+        return false;
+    }
+    i.seekg(0, std::ios::end);
+    const std::streampos end = i.tellg();
+    i.seekg(pos);
+    if (!i || end == std::streampos(-1) || end < pos) {
+        return false;
+    }
+    return count <= (uint64_t)(end - pos) / item_size;
+}
+
+void WriteBinary(std::ostream& o, const std::string& s)
+{
+    WriteBinary(o, (uint64_t)s.size());
+    o.write(s.data(), s.size());
+}
+
+bool ReadBinary(std::istream& i, std::string& s)
+{
+    uint64_t size;
+    if (!ReadBinary(i, size) || !CountFits(i, size, 1)) {
+        return false;
+    }
+    s.resize(size);
+    return (bool)i.read(&s[0], size);
+}
+
+void WriteVoxels(std::ostream& o, const std::vector<Eigen::Vector3d>& voxels)
+{
+    WriteBinary(o, (uint64_t)voxels.size());
+    for (const Eigen::Vector3d& v : voxels) {
+        WriteBinary(o, v.x());
+        WriteBinary(o, v.y());
+        WriteBinary(o, v.z());
+    }
+}
+
+bool ReadVoxels(std::istream& i, std::vector<Eigen::Vector3d>& voxels)
+{
+    uint64_t voxel_count;
+    if (!ReadBinary(i, voxel_count) ||
+        !CountFits(i, voxel_count, 3 * sizeof(double)))
+    {
+        return false;
+    }
+
+    voxels.resize(voxel_count);
+    for (Eigen::Vector3d& v : voxels) {
+        if (!ReadBinary(i, v.x()) || !ReadBinary(i, v.y()) ||
+            !ReadBinary(i, v.z()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void WriteSphereTree(std::ostream& o, const CollisionSphereModelTree& tree)
+{
+    const std::vector<CollisionSphereModel>& nodes = tree.m_tree;
+    const CollisionSphereModel* first = nodes.data();
+    auto index = [first](const CollisionSphereModel* s) {
+        return s ? (int64_t)(s - first) : (int64_t)-1;
+    };
+
+    WriteBinary(o, (uint64_t)nodes.size());
+    for (const CollisionSphereModel& s : nodes) {
+        WriteBinary(o, s.name);
+        WriteBinary(o, s.center.x());
+        WriteBinary(o, s.center.y());
+        WriteBinary(o, s.center.z());
+        WriteBinary(o, s.radius);
+        WriteBinary(o, (int32_t)s.priority);
+        WriteBinary(o, index(s.left));
+        WriteBinary(o, index(s.right));
+    }
+}
+
+bool ReadSphereTree(std::istream& i, CollisionSphereModelTree& tree)
+{
+    // name length, center, radius, priority, and child indices
+    const size_t min_node_size =
+            sizeof(uint64_t) + 4 * sizeof(double) + sizeof(int32_t) +
+            2 * sizeof(int64_t);
+
+    uint64_t node_count;
+    if (!ReadBinary(i, node_count) ||
+        !CountFits(i, node_count, min_node_size))
+    {
+        return false;
+    }
+
+    std::vector<CollisionSphereModel>& nodes = tree.m_tree;
+    nodes.clear();
+    nodes.resize(node_count);
+    for (CollisionSphereModel& s : nodes) {
+        double x, y, z;
+        int32_t priority;
+        int64_t left, right;
+        if (!ReadBinary(i, s.name) ||
+            !ReadBinary(i, x) || !ReadBinary(i, y) || !ReadBinary(i, z) ||
+            !ReadBinary(i, s.radius) ||
+            !ReadBinary(i, priority) ||
+            !ReadBinary(i, left) || !ReadBinary(i, right) ||
+            left >= (int64_t)node_count || right >= (int64_t)node_count)
+        {
+            return false;
+        }
+        s.center = Eigen::Vector3d(x, y, z);
+        s.priority = priority;
+        s.parent = nullptr;
+        s.left = left < 0 ? nullptr : &nodes[left];
+        s.right = right < 0 ? nullptr : &nodes[right];
+    }
+    return true;
+}
+
+/// 64-bit FNV-1a hash
+uint64_t HashBytes(const std::string& s)
+{
+    uint64_t h = 14695981039346656037ull;
+    for (char c : s) {
+        h ^= (uint8_t)c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+/// Read the contents of a file into memory
+bool ReadFile(const std::string& path, std::string& contents)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs.is_open()) {
+        return false;
+    }
+    std::ostringstream oss;
+    oss << ifs.rdbuf();
+    if (!ifs) {
+        return false;
+    }
+    contents = oss.str();
+    return true;
+}
+
+/// Replace the contents of a file. The contents are written to a temporary
+/// file in the same directory, which is then renamed over the file, so that
+/// concurrent readers see either the previous or the new contents, never a
+/// partially written file.
+bool ReplaceFile(const std::string& path, const std::string& contents)
+{
+    const std::string tmp_path = path + ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!ofs.is_open()) {
+            return false;
+        }
+        ofs.write(contents.data(), contents.size());
+        ofs.close();
+        if (!ofs) {
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace collision
+} // namespace sbpl
@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef sbpl_collision_model_serialization_h
+#define sbpl_collision_model_serialization_h
+
+// standard includes
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// system includes
+#include <Eigen/Dense>
+
+// project includes
+#include <sbpl_collision_checking/base_collision_models.h>
+
+namespace sbpl {
+namespace collision {
+
+/// \name Binary Serialization
+/// Values are written in the host's native byte order and are only intended to
+/// be read back on the same platform.
+///@{
+
+template <typename T>
+void WriteBinary(std::ostream& o, const T& t)
+{
+    o.write(reinterpret_cast<const char*>(&t), sizeof(T));
+}
+
+template <typename T>
+bool ReadBinary(std::istream& i, T& t)
+{
+    return (bool)i.read(reinterpret_cast<char*>(&t), sizeof(T));
+}
+
+bool CountFits(std::istream& i, uint64_t count, size_t item_size);
+
+void WriteBinary(std::ostream& o, const std::string& s);
+bool ReadBinary(std::istream& i, std::string& s);
+
+void WriteVoxels(std::ostream& o, const std::vector<Eigen::Vector3d>& voxels);
+bool ReadVoxels(std::istream& i, std::vector<Eigen::Vector3d>& voxels);
+
+// The parent spheres model of each sphere is not stored, and is set to null
+// when read.
+void WriteSphereTree(std::ostream& o, const CollisionSphereModelTree& tree);
+bool ReadSphereTree(std::istream& i, CollisionSphereModelTree& tree);
+
+template <typename T>
+void AppendBytes(std::string& s, const T& t)
+{
+    s.append(reinterpret_cast<const char*>(&t), sizeof(T));
+}
+
+inline
+void AppendBytes(std::string& s, const double* d, size_t count)
+{
+    s.append(reinterpret_cast<const char*>(d), count * sizeof(double));
+}
+
+inline
+void AppendBytes(std::string& s, const std::string& t)
+{
+    AppendBytes(s, (uint64_t)t.size());
+    s.append(t);
+}
+
+uint64_t HashBytes(const std::string& s);
+
+///@}
+
+bool ReadFile(const std::string& path, std::string& contents);
+bool ReplaceFile(const std::string& path, const std::string& contents);
+
+} // namespace collision
+} // namespace sbpl
+
+#endif
@@ -35,7 +35,10 @@
 // standard includes
 #include <assert.h>
 #include <stdlib.h>
+#include <cstdint>
 #include <functional>
+#include <iomanip>
+#include <sstream>
 #include <stack>
 #include <utility>
 
@@ -50,6 +53,7 @@
 
 // project includes
 #include <sbpl_collision_checking/robot_collision_state.h>
+#include "model_serialization.h"
 #include "transform_functions.h"
 #include "voxel_operations.h"
 
@@ -58,13 +62,33 @@ namespace collision {
 
 static const char* RCM_LOGGER = "robot_model";
 
+static const uint32_t RCM_CACHE_MAGIC = 0x434d4352; // "RCMC"
+static const uint32_t RCM_CACHE_VERSION = 1;
+
 RobotCollisionModelPtr RobotCollisionModel::Load(
     const urdf::ModelInterface& urdf,
     const CollisionModelConfig& config)
+{
+    return Load(urdf, config, std::string());
+}
+
+/// \brief Load a collision model, reusing compiled spheres and voxels models
+///
+/// Generating spheres and voxels models for detailed link meshes may be
+/// expensive. The models compiled for a given urdf and config are stored in
+/// a file in \p cache_dir, named by a hash of the inputs they were compiled
+/// from, and are loaded from that file by later calls with the same urdf and
+/// config. Changes to the contents of mesh files are not detected; the cache
+/// directory should be cleared when meshes are modified in place. An empty
+/// \p cache_dir disables caching.
+RobotCollisionModelPtr RobotCollisionModel::Load(
+    const urdf::ModelInterface& urdf,
+    const CollisionModelConfig& config,
+    const std::string& cache_dir)
 {
     //std::make_shared<RobotCollisionModel>();
     auto rcm = RobotCollisionModelPtr(new RobotCollisionModel);
-    if (!rcm->init(urdf, config)) {
+    if (!rcm->init(urdf, config, cache_dir)) {
         return RobotCollisionModelPtr();
     }
     else {
@@ -101,11 +125,12 @@ RobotCollisionModel::~RobotCollisionModel()
 
 bool RobotCollisionModel::init(
     const urdf::ModelInterface& urdf,
-    const CollisionModelConfig& config)
+    const CollisionModelConfig& config,
+    const std::string& cache_dir)
 {
     bool success = true;
     success = success && initRobotModel(urdf, config.world_joint);
-    success = success && initCollisionModel(urdf, config);
+    success = success && initCollisionModel(urdf, config, cache_dir);
 
     if (success) {
         m_config = config;
@@ -516,7 +541,8 @@ void RobotCollisionModel::addFloatingJoint(const urdf::Joint& joint)
 
 bool RobotCollisionModel::initCollisionModel(
     const urdf::ModelInterface& urdf,
-    const CollisionModelConfig& config)
+    const CollisionModelConfig& config,
+    const std::string& cache_dir)
 {
     if (!checkCollisionModelConfig(config)) {
         return false;
@@ -528,6 +554,83 @@ bool RobotCollisionModel::initCollisionModel(
         return false;
     }
 
+    // initialize spheres and voxels models, from previously compiled models if
+    // available
+    std::string key;
+    std::string cache_path;
+    if (!cache_dir.empty()) {
+        key = collisionModelsKey(urdf, config);
+        std::stringstream ss;
+        ss << cache_dir << '/' << m_name << '_' <<
+                std::hex << std::setw(16) << std::setfill('0') <<
+                HashBytes(key) << ".rcm";
+        cache_path = ss.str();
+    }
+
+    if (cache_path.empty() || !loadCollisionModels(cache_path, key)) {
+        generateCollisionModels(urdf, config);
+        if (!cache_path.empty()) {
+            saveCollisionModels(cache_path, key);
+        }
+    }
+
+    for (auto& spheres_model : m_spheres_models) {
+        for (auto& sphere : spheres_model.spheres.m_tree) {
+            sphere.parent = &spheres_model;
+        }
+    }
+
+    // initialize groups
+    m_group_models.resize(expanded_groups.size());
+    for (size_t i = 0; i < m_group_models.size(); ++i) {
+        CollisionGroupModel& group_model = m_group_models[i];
+        const CollisionGroupConfig& group_config = expanded_groups[i];
+        const std::string& group_name = group_config.name;
+        group_model.name = group_name;
+
+        for (size_t j = 0; j < group_config.links.size(); ++j) {
+            const std::string& link_name = group_config.links[j];
+            group_model.link_indices.push_back(linkIndex(link_name));
+        }
+
+        m_group_name_to_index[group_name] = i;
+    }
+
+    // initialize link spheres models
+    m_link_spheres_models.assign(m_link_names.size(), nullptr);
+    for (const CollisionSpheresModel& spheres_model : m_spheres_models) {
+        m_link_spheres_models[spheres_model.link_index] = &spheres_model;
+    }
+
+    // initialize link voxels models
+    m_link_voxels_models.assign(m_link_names.size(), nullptr);
+    for (const CollisionVoxelsModel& voxels_model : m_voxels_models) {
+        m_link_voxels_models[voxels_model.link_index] = &voxels_model;
+    }
+
+    assert(checkCollisionModelReferences());
+
+    ROS_DEBUG_NAMED(RCM_LOGGER, "Collision Model:");
+    ROS_DEBUG_NAMED(RCM_LOGGER, "  Spheres Models: [%p, %p]", m_spheres_models.data(), m_spheres_models.data() + m_spheres_models.size());
+    for (const auto& spheres_model : m_spheres_models) {
+        ROS_DEBUG_STREAM_NAMED(RCM_LOGGER, "    link_index: " << spheres_model.link_index << ", spheres: " << spheres_model.spheres.size());
+    }
+    ROS_DEBUG_NAMED(RCM_LOGGER, "  Voxels Models: [%p, %p]", m_voxels_models.data(), m_voxels_models.data() + m_voxels_models.size());
+    for (const auto& voxels_model : m_voxels_models) {
+        ROS_DEBUG_NAMED(RCM_LOGGER, "    link_index: %d, voxel_res: %0.3f, voxel count: %zu", voxels_model.link_index, voxels_model.voxel_res, voxels_model.voxels.size());
+    }
+    ROS_DEBUG_NAMED(RCM_LOGGER, "  Group Models:");
+    for (const auto& group_model : m_group_models) {
+        ROS_DEBUG_NAMED(RCM_LOGGER, "    name: %s, link_indices: %s", group_model.name.c_str(), to_string(group_model.link_indices).c_str());
+    }
+
+    return true;
+}
+
+void RobotCollisionModel::generateCollisionModels(
+    const urdf::ModelInterface& urdf,
+    const CollisionModelConfig& config)
+{
     // initialize spheres models
     m_spheres_models.reserve(config.spheres_models.size());
     for (size_t i = 0; i < config.spheres_models.size(); ++i) {
@@ -557,10 +660,6 @@ bool RobotCollisionModel::initCollisionModel(
 
         CollisionSpheresModel& spheres_model = m_spheres_models.back();
         spheres_model.link_index = linkIndex(spheres_config.link_name);
-
-        for (auto& sphere : spheres_model.spheres.m_tree) {
-            sphere.parent = &spheres_model;
-        }
     }
 
     // initialize voxels models
@@ -574,51 +673,220 @@ bool RobotCollisionModel::initCollisionModel(
             ROS_ERROR_NAMED(RCM_LOGGER, "Failed to voxelize link '%s'", link_name.c_str());
         }
     }
+}
 
-    // initialize groups
-    m_group_models.resize(expanded_groups.size());
-    for (size_t i = 0; i < m_group_models.size(); ++i) {
-        CollisionGroupModel& group_model = m_group_models[i];
-        const CollisionGroupConfig& group_config = expanded_groups[i];
-        const std::string& group_name = group_config.name;
-        group_model.name = group_name;
+static void AppendCollisionGeometry(
+    std::string& key,
+    const urdf::Collision& collision)
+{
+    AppendBytes(key, collision.origin.position.x);
+    AppendBytes(key, collision.origin.position.y);
+    AppendBytes(key, collision.origin.position.z);
+    AppendBytes(key, collision.origin.rotation.x);
+    AppendBytes(key, collision.origin.rotation.y);
+    AppendBytes(key, collision.origin.rotation.z);
+    AppendBytes(key, collision.origin.rotation.w);
 
-        for (size_t j = 0; j < group_config.links.size(); ++j) {
-            const std::string& link_name = group_config.links[j];
-            group_model.link_indices.push_back(linkIndex(link_name));
+    auto geom = collision.geometry;
+    if (!geom) {
+        AppendBytes(key, (int32_t)-1);
+        return;
+    }
+
+    AppendBytes(key, (int32_t)geom->type);
+    if (geom->type == urdf::Geometry::MESH) {
+        const urdf::Mesh* mesh = (const urdf::Mesh*)geom.get();
+        AppendBytes(key, mesh->filename);
+        AppendBytes(key, mesh->scale.x);
+        AppendBytes(key, mesh->scale.y);
+        AppendBytes(key, mesh->scale.z);
+    }
+    else if (geom->type == urdf::Geometry::BOX) {
+        const urdf::Box* box = (const urdf::Box*)geom.get();
+        AppendBytes(key, box->dim.x);
+        AppendBytes(key, box->dim.y);
+        AppendBytes(key, box->dim.z);
+    }
+    else if (geom->type == urdf::Geometry::CYLINDER) {
+        const urdf::Cylinder* cyl = (const urdf::Cylinder*)geom.get();
+        AppendBytes(key, cyl->radius);
+        AppendBytes(key, cyl->length);
+    }
+    else if (geom->type == urdf::Geometry::SPHERE) {
+        const urdf::Sphere* sph = (const urdf::Sphere*)geom.get();
+        AppendBytes(key, sph->radius);
+    }
+}
+
+static void AppendLinkGeometry(
+    std::string& key,
+    const urdf::ModelInterface& urdf,
+    const std::string& link_name)
+{
+    auto link = urdf.getLink(link_name);
+    if (!link) {
+        AppendBytes(key, (uint8_t)0);
+        return;
+    }
+
+    AppendBytes(key, (uint8_t)1);
+    AppendBytes(key, (uint8_t)(bool)link->collision);
+    if (link->collision) {
+        AppendCollisionGeometry(key, *link->collision);
+    }
+    AppendBytes(key, (uint64_t)link->collision_array.size());
+    for (auto collision : link->collision_array) {
+        AppendCollisionGeometry(key, *collision);
+    }
+}
+
+/// Return a string that uniquely identifies the inputs from which the spheres
+/// and voxels models are generated.
+std::string RobotCollisionModel::collisionModelsKey(
+    const urdf::ModelInterface& urdf,
+    const CollisionModelConfig& config) const
+{
+    std::string key;
+
+    AppendBytes(key, (uint64_t)config.spheres_models.size());
+    for (const CollisionSpheresModelConfig& spheres_config : config.spheres_models) {
+        AppendBytes(key, spheres_config.link_name);
+        AppendBytes(key, (uint8_t)spheres_config.autogenerate);
+        if (spheres_config.autogenerate) {
+            AppendBytes(key, spheres_config.radius);
+            AppendLinkGeometry(key, urdf, spheres_config.link_name);
+        } else {
+            AppendBytes(key, (uint64_t)spheres_config.spheres.size());
+            for (const CollisionSphereConfig& sphere : spheres_config.spheres) {
+                AppendBytes(key, sphere.name);
+                AppendBytes(key, sphere.x);
+                AppendBytes(key, sphere.y);
+                AppendBytes(key, sphere.z);
+                AppendBytes(key, sphere.radius);
+                AppendBytes(key, (int32_t)sphere.priority);
+            }
         }
+    }
 
-        m_group_name_to_index[group_name] = i;
+    AppendBytes(key, (uint64_t)config.voxel_models.size());
+    for (const CollisionVoxelModelConfig& voxels_config : config.voxel_models) {
+        AppendBytes(key, voxels_config.link_name);
+        AppendBytes(key, voxels_config.res);
+        AppendLinkGeometry(key, urdf, voxels_config.link_name);
     }
 
-    // initialize link spheres models
-    m_link_spheres_models.assign(m_link_names.size(), nullptr);
-    for (const CollisionSpheresModel& spheres_model : m_spheres_models) {
-        m_link_spheres_models[spheres_model.link_index] = &spheres_model;
+    return key;
+}
+
+bool RobotCollisionModel::loadCollisionModels(
+    const std::string& path,
+    const std::string& key)
+{
+    std::string contents;
+    if (!ReadFile(path, contents)) {
+        ROS_INFO_NAMED(RCM_LOGGER, "No compiled collision model found at '%s'", path.c_str());
+        return false;
     }
+    std::istringstream ifs(contents);
 
-    // initialize link voxels models
-    m_link_voxels_models.assign(m_link_names.size(), nullptr);
-    for (const CollisionVoxelsModel& voxels_model : m_voxels_models) {
-        m_link_voxels_models[voxels_model.link_index] = &voxels_model;
+    uint32_t magic, version;
+    std::string file_key;
+    if (!ReadBinary(ifs, magic) || !ReadBinary(ifs, version) ||
+        magic != RCM_CACHE_MAGIC || version != RCM_CACHE_VERSION ||
+        !ReadBinary(ifs, file_key) || file_key != key)
+    {
+        ROS_WARN_NAMED(RCM_LOGGER, "Ignoring incompatible compiled collision model '%s'", path.c_str());
+        return false;
     }
 
-    assert(checkCollisionModelReferences());
+    auto read_link_index = [&](int& lidx) {
+        std::string link_name;
+        if (!ReadBinary(ifs, link_name) || !hasLink(link_name)) {
+            return false;
+        }
+        lidx = linkIndex(link_name);
+        return true;
+    };
 
-    ROS_DEBUG_NAMED(RCM_LOGGER, "Collision Model:");
-    ROS_DEBUG_NAMED(RCM_LOGGER, "  Spheres Models: [%p, %p]", m_spheres_models.data(), m_spheres_models.data() + m_spheres_models.size());
-    for (const auto& spheres_model : m_spheres_models) {
-        ROS_DEBUG_STREAM_NAMED(RCM_LOGGER, "    link_index: " << spheres_model.link_index << ", spheres: " << spheres_model.spheres.size());
+    std::vector<CollisionSpheresModel> spheres_models;
+    std::vector<CollisionVoxelsModel> voxels_models;
+
+    // every spheres model stores at least a link name and a node count, and
+    // every voxels model a link name, a resolution, and a voxel count
+    const size_t min_spheres_model_size = 2 * sizeof(uint64_t);
+    const size_t min_voxels_model_size = 2 * sizeof(uint64_t) + sizeof(double);
+
+    uint64_t count;
+    bool ok = ReadBinary(ifs, count) &&
+            CountFits(ifs, count, min_spheres_model_size);
+    if (ok) {
+        spheres_models.resize(count);
+        for (CollisionSpheresModel& spheres_model : spheres_models) {
+            if (!read_link_index(spheres_model.link_index) ||
+                !ReadSphereTree(ifs, spheres_model.spheres))
+            {
+                ok = false;
+                break;
+            }
+        }
     }
-    ROS_DEBUG_NAMED(RCM_LOGGER, "  Voxels Models: [%p, %p]", m_voxels_models.data(), m_voxels_models.data() + m_voxels_models.size());
-    for (const auto& voxels_model : m_voxels_models) {
-        ROS_DEBUG_NAMED(RCM_LOGGER, "    link_index: %d, voxel_res: %0.3f, voxel count: %zu", voxels_model.link_index, voxels_model.voxel_res, voxels_model.voxels.size());
+
+    ok = ok && ReadBinary(ifs, count) &&
+            CountFits(ifs, count, min_voxels_model_size);
+    if (ok) {
+        voxels_models.resize(count);
+        for (CollisionVoxelsModel& voxels_model : voxels_models) {
+            if (!read_link_index(voxels_model.link_index) ||
+                !ReadBinary(ifs, voxels_model.voxel_res) ||
+                !ReadVoxels(ifs, voxels_model.voxels))
+            {
+                ok = false;
+                break;
+            }
+        }
     }
-    ROS_DEBUG_NAMED(RCM_LOGGER, "  Group Models:");
-    for (const auto& group_model : m_group_models) {
-        ROS_DEBUG_NAMED(RCM_LOGGER, "    name: %s, link_indices: %s", group_model.name.c_str(), to_string(group_model.link_indices).c_str());
+
+    if (!ok) {
+        ROS_ERROR_NAMED(RCM_LOGGER, "Failed to read compiled collision model '%s'", path.c_str());
+        return false;
+    }
+
+    m_spheres_models = std::move(spheres_models);
+    m_voxels_models = std::move(voxels_models);
+    ROS_INFO_NAMED(RCM_LOGGER, "Loaded compiled collision model from '%s'", path.c_str());
+    return true;
+}
+
+bool RobotCollisionModel::saveCollisionModels(
+    const std::string& path,
+    const std::string& key) const
+{
+    // serialize to memory and replace the file as a whole, so that planners
+    // loading the same file concurrently never read a partial file
+    std::ostringstream ofs;
+    WriteBinary(ofs, RCM_CACHE_MAGIC);
+    WriteBinary(ofs, RCM_CACHE_VERSION);
+    WriteBinary(ofs, key);
+
+    WriteBinary(ofs, (uint64_t)m_spheres_models.size());
+    for (const CollisionSpheresModel& spheres_model : m_spheres_models) {
+        WriteBinary(ofs, m_link_names[spheres_model.link_index]);
+        WriteSphereTree(ofs, spheres_model.spheres);
+    }
+
+    WriteBinary(ofs, (uint64_t)m_voxels_models.size());
+    for (const CollisionVoxelsModel& voxels_model : m_voxels_models) {
+        WriteBinary(ofs, m_link_names[voxels_model.link_index]);
+        WriteBinary(ofs, voxels_model.voxel_res);
+        WriteVoxels(ofs, voxels_model.voxels);
+    }
+
+    if (!ofs || !ReplaceFile(path, ofs.str())) {
+        ROS_WARN_NAMED(RCM_LOGGER, "Failed to write compiled collision model to '%s'", path.c_str());
+        return false;
     }
 
+    ROS_INFO_NAMED(RCM_LOGGER, "Saved compiled collision model to '%s'", path.c_str());
     return true;
 }
 
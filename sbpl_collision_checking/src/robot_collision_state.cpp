@@ -68,32 +68,8 @@ bool RobotCollisionState::setJointVarPosition(int vidx, double position)
 
         m_dirty_joint_transforms[jidx] = true;
 
-        // TODO: cache affected link transforms in a per-joint array?
-
-        std::vector<int>& q = m_q;
-        q.clear();
-        q.push_back(m_model->jointChildLinkIndex(jidx));
-        while (!q.empty()) {
-            int lidx = q.back();
-            q.pop_back();
-
-            ROS_DEBUG_NAMED(RCS_LOGGER, "Dirtying transform to link '%s'", m_model->linkName(lidx).c_str());
-
-            // dirty the transform of the affected link
-            m_dirty_link_transforms[lidx] = true;
-
-            // dirty the voxels states of any attached voxels model
-            CollisionVoxelsState* voxels_state = m_link_voxels_states[lidx];
-            if (voxels_state) {
-                int dvsidx = std::distance(m_voxels_states.data(), voxels_state);
-                m_dirty_voxels_states[dvsidx] = true;
-            }
-
-            // add child links to the queue
-            for (int cjidx : m_model->linkChildJointIndices(lidx)) {
-                q.push_back(m_model->jointChildLinkIndex(cjidx));
-            }
-        }
+        dirtyLinkSubtree(
+                m_link_order_positions[m_model->jointChildLinkIndex(jidx)]);
 
         return true;
     }
@@ -104,45 +80,42 @@ bool RobotCollisionState::setJointVarPosition(int vidx, double position)
 
 bool RobotCollisionState::setJointVarPositions(const double* positions)
 {
-    std::vector<int>& ancestors = m_ancestors;
-    ancestors.clear();
+    std::vector<int>& roots = m_dirty_subtrees;
+    roots.clear();
     for (size_t vidx = 0; vidx < m_jvar_positions.size(); ++vidx) {
         if (m_jvar_positions[vidx] != positions[vidx]) {
             m_jvar_positions[vidx] = positions[vidx];
             const int jidx = m_model->jointVarJointIndex(vidx);
             m_dirty_joint_transforms[jidx] = true;
-            bool add = true;
-            for (int& ancestor : ancestors) {
-                if (m_model->isDescendantJoint(jidx, ancestor)) {
-                    // only keep most ancestral joints
-                    add = false;
-                    break;
-                }
-                else if (m_model->isDescendantJoint(ancestor, jidx)) {
-                    // replace the ancestor joint with this joint
-                    add = false;
-                    ancestor = jidx;
-                    break;
-                }
-            }
-            if (add) {
-                ancestors.push_back(jidx);
-            }
+            const int clidx = m_model->jointChildLinkIndex(jidx);
+            roots.push_back(m_link_order_positions[clidx]);
         }
     }
 
-    if (ancestors.empty()) {
+    if (roots.empty()) {
         return false;
     }
 
-    std::vector<int>& q = m_q;
-    q.clear();
-    for (int ancestor : ancestors) {
-        q.push_back(m_model->jointChildLinkIndex(ancestor));
+    // subtrees are either nested or disjoint; in preorder, a nested subtree
+    // begins before the end of the subtree containing it
+    std::sort(roots.begin(), roots.end());
+    int end = 0;
+    for (int pos : roots) {
+        if (pos >= end) {
+            dirtyLinkSubtree(pos);
+            end = m_subtree_ends[pos];
+        }
     }
-    while (!q.empty()) {
-        int lidx = q.back();
-        q.pop_back();
+
+    return true;
+}
+
+/// Dirty the transforms, and any voxels states, of all links in the subtree
+/// rooted at the link at a preorder position
+void RobotCollisionState::dirtyLinkSubtree(int pos)
+{
+    for (int p = pos; p < m_subtree_ends[pos]; ++p) {
+        const int lidx = m_link_order[p];
 
         ROS_DEBUG_NAMED(RCS_LOGGER, "Dirtying transform to link '%s'", m_model->linkName(lidx).c_str());
 
@@ -155,14 +128,7 @@ bool RobotCollisionState::setJointVarPositions(const double* positions)
             int dvsidx = std::distance(m_voxels_states.data(), voxels_state);
             m_dirty_voxels_states[dvsidx] = true;
         }
-
-        // add child links to the queue
-        for (int cjidx : m_model->linkChildJointIndices(lidx)) {
-            q.push_back(m_model->jointChildLinkIndex(cjidx));
-        }
     }
-
-    return true;
 }
 
 visualization_msgs::MarkerArray
@@ -232,12 +198,54 @@ void RobotCollisionState::initRobotState()
     m_dirty_link_transforms[0] = false;
     m_link_transform_versions[0] = 0;
 
+    initLinkOrder();
+
     ROS_DEBUG_NAMED(RCS_LOGGER, "Robot State:");
     ROS_DEBUG_NAMED(RCS_LOGGER, "  %zu Joint Positions", m_jvar_positions.size());
     ROS_DEBUG_NAMED(RCS_LOGGER, "  %zu Dirty Link Transforms", m_dirty_link_transforms.size());
     ROS_DEBUG_NAMED(RCS_LOGGER, "  %zu Link Transforms", m_link_transforms.size());
 }
 
+/// Order the links in depth-first preorder from the root link so that the
+/// links of any subtree are contiguous and follow their subtree root
+void RobotCollisionState::initLinkOrder()
+{
+    const int link_count = (int)m_model->linkCount();
+    m_link_order.clear();
+    m_link_order.reserve(link_count);
+    m_link_order_positions.assign(link_count, -1);
+    m_subtree_ends.assign(link_count, 0);
+
+    // (link, whether its subtree has been expanded)
+    std::vector<std::pair<int, bool>> stack;
+    for (int root = 0; root < link_count; ++root) {
+        if (m_link_order_positions[root] >= 0 ||
+            m_model->jointParentLinkIndex(
+                    m_model->linkParentJointIndex(root)) >= 0)
+        {
+            continue;
+        }
+        stack.push_back(std::make_pair(root, false));
+        while (!stack.empty()) {
+            const int lidx = stack.back().first;
+            if (stack.back().second) {
+                stack.pop_back();
+                m_subtree_ends[m_link_order_positions[lidx]] = (int)m_link_order.size();
+                continue;
+            }
+            stack.back().second = true;
+            m_link_order_positions[lidx] = (int)m_link_order.size();
+            m_link_order.push_back(lidx);
+            const auto& child_joints = m_model->linkChildJointIndices(lidx);
+            for (auto it = child_joints.rbegin(); it != child_joints.rend(); ++it) {
+                stack.push_back(std::make_pair(m_model->jointChildLinkIndex(*it), false));
+            }
+        }
+    }
+
+    assert((int)m_link_order.size() == link_count);
+}
+
 void RobotCollisionState::initCollisionState()
 {
     // initialize sphere and spheres states
@@ -282,7 +282,7 @@ double RobotMotionCollisionModel::getMaxSphereMotion(
     assert(finish.size() == m_rcm->jointVarCount());
 
     double motion = 0.0;
-    for (size_t jidx; jidx < m_rcm->jointCount(); ++jidx) {
+    for (size_t jidx = 0; jidx < m_rcm->jointCount(); ++jidx) {
         size_t fvidx = m_rcm->jointVarIndexFirst(jidx);
 
         double dist = 0.0;
@@ -31,6 +31,12 @@
 
 #include <sbpl_collision_checking/self_collision_model.h>
 
+// standard includes
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+
 // system includes
 #include <leatherman/print.h>
 
@@ -44,6 +50,83 @@ namespace collision {
 
 static const char* SCM_LOGGER = "self";
 
+/// Dense, symmetric matrix of flags between pairs of integer-indexed entities,
+/// packed 64 entries to a word
+class PairBitMatrix
+{
+public:
+
+    PairBitMatrix() : m_size(0), m_stride(0), m_words() { }
+
+    int size() const { return m_size; }
+
+    /// Resize the matrix and clear all flags
+    void assign(int size)
+    {
+        m_size = size;
+        m_stride = (size + 63) >> 6;
+        m_words.assign((size_t)m_stride * (size_t)size, 0);
+    }
+
+    /// Set the flags for row i from a mask over all columns
+    void setRow(int i, const std::uint8_t* mask)
+    {
+        std::uint64_t* row = &m_words[(size_t)i * m_stride];
+        for (int w = 0; w < m_stride; ++w) {
+            const int jfirst = w << 6;
+            const int jlast = std::min(jfirst + 64, m_size);
+            std::uint64_t word = 0;
+            for (int j = jfirst; j < jlast; ++j) {
+                word |= std::uint64_t(mask[j] != 0) << (j - jfirst);
+            }
+            row[w] = word;
+        }
+    }
+
+    bool test(int i, int j) const
+    {
+        return (m_words[(size_t)i * m_stride + (j >> 6)] >> (j & 63)) & 1;
+    }
+
+    void set(int i, int j)
+    {
+        m_words[(size_t)i * m_stride + (j >> 6)] |= std::uint64_t(1) << (j & 63);
+        m_words[(size_t)j * m_stride + (i >> 6)] |= std::uint64_t(1) << (i & 63);
+    }
+
+private:
+
+    int m_size;
+    int m_stride;
+    std::vector<std::uint64_t> m_words;
+};
+
+/// Distance field over the voxels of the links and attached bodies outside of
+/// a group, kept apart from the world occupancy grid, along with the voxels
+/// states it currently contains, their models, their voxels, and the version of
+/// the voxels state they were taken from
+struct SelfCollisionField
+{
+    std::unique_ptr<OccupancyGrid>              grid;
+
+    // the group whose outside voxels the field holds, the version of the
+    // attached bodies model its attached body voxels states are numbered by,
+    // and the time the field was last active
+    int                                         gidx = -1;
+    int                                         ab_version = -1;
+    std::uint64_t                               last_use = 0;
+
+    std::vector<int>                            voxels_indices;
+    std::vector<const CollisionVoxelsModel*>    voxels_models;
+    std::vector<std::uint32_t>                  voxels_versions;
+    std::vector<std::vector<Eigen::Vector3d>>   voxels;
+
+    std::vector<int>                            ab_voxels_indices;
+    std::vector<const CollisionVoxelsModel*>    ab_voxels_models;
+    std::vector<std::uint32_t>                  ab_voxels_versions;
+    std::vector<std::vector<Eigen::Vector3d>>   ab_voxels;
+};
+
 class SelfCollisionModelImpl
 {
 public:
@@ -53,14 +136,20 @@ public:
         const RobotCollisionModel* rcm,
         const AttachedBodiesCollisionModel* ab_model);
 
+    SelfCollisionModelImpl(SelfCollisionModelImpl& base, int gidx);
+
     ~SelfCollisionModelImpl();
 
     const AllowedCollisionMatrix& allowedCollisionMatrix() const;
     void updateAllowedCollisionMatrix(const AllowedCollisionMatrix& acm);
     void setAllowedCollisionMatrix(const AllowedCollisionMatrix& acm);
 
+    double padding() const { return m_padding; }
     void setPadding(double padding);
 
+    size_t voxelsFieldCapacity() const { return m_field_capacity; }
+    void setVoxelsFieldCapacity(size_t capacity);
+
     void setWorldToModelTransform(const Eigen::Affine3d& transform);
 
     bool checkCollision(
@@ -85,6 +174,16 @@ public:
         const int gidx,
         double& dist);
 
+    bool checkMotionCollision(
+        RobotCollisionState& state,
+        AttachedBodiesCollisionState& ab_state,
+        const RobotMotionCollisionModel& rmcm,
+        const std::vector<double>& start,
+        const std::vector<double>& finish,
+        const int gidx,
+        int& num_checks,
+        double& dist);
+
     bool checkMotionCollision(
         RobotCollisionState& state,
         AttachedBodiesCollisionState& ab_state,
@@ -95,6 +194,11 @@ public:
         const int gidx,
         double& dist);
 
+    double motionClearance(
+        RobotCollisionState& state,
+        AttachedBodiesCollisionState& ab_state,
+        const int gidx);
+
     double collisionDistance(
         RobotCollisionState& state,
         AttachedBodiesCollisionState& ab_state,
@@ -131,8 +235,23 @@ private:
     // cached group information updated when a collision check for a different
     // group is made
     int                                     m_gidx;
-    std::vector<int>                        m_voxels_indices;
-    std::vector<int>                        m_ab_voxels_indices;
+
+    // distance fields over the voxels outside of recently checked groups, at
+    // most m_field_capacity of them, and the field of the active group, or
+    // nullptr if it has no outside voxels. Switching to a group that has a
+    // field only selects it; otherwise, a new field is created or, when at
+    // capacity, the least recently used field is taken over by moving only
+    // the voxels states that differ between the outside sets of the groups
+    std::vector<std::unique_ptr<SelfCollisionField>>    m_fields;
+    SelfCollisionField*                     m_field;
+    size_t                                  m_field_capacity;
+    std::uint64_t                           m_field_use_count;
+
+    // number of times each voxels state has been updated, compared against the
+    // versions recorded in each field to find the voxels that have moved since
+    // the field was last active
+    std::vector<std::uint32_t>              m_voxels_versions;
+    std::vector<std::uint32_t>              m_ab_voxels_versions;
 
     // cached set of spheres state pairs that should be checked for self
     // collisions when using the internal allowed collision matrix
@@ -143,6 +262,42 @@ private:
     AllowedCollisionMatrix                  m_acm;
     double                                  m_padding;
 
+    // allowed collision matrix compiled over integer entity indices; robot
+    // links occupy [0, linkCount()) and attached bodies follow in the order
+    // given by m_ab_entity_indices
+    PairBitMatrix                           m_allowed_entities;
+    std::vector<int>                        m_ab_entity_indices;
+    int                                     m_ab_version;
+
+    // allowed collision matrix compiled over the names of leaf spheres that
+    // appear in the acm, and the mapping from [spheres state][sphere] to a
+    // row of the compiled matrix, or -1 if the sphere has no acm entry
+    PairBitMatrix                           m_allowed_spheres;
+    std::vector<std::vector<int>>           m_robot_sphere_entries;
+    std::vector<std::vector<int>>           m_ab_sphere_entries;
+
+    // scratch matrix compiled from the AllowedCollisionsInterface of the
+    // current request, over the same entity indices as m_allowed_entities
+    PairBitMatrix                           m_aci_allowed_entities;
+
+    // broad phase over the root spheres of the spheres states in the active
+    // group; robot spheres states occupy the first m_bp_robot_count slots and
+    // attached body spheres states follow. Root spheres are stored as
+    // structure-of-arrays so that all pairs may be tested in vectorized loops
+    int                                     m_bp_robot_count;
+    std::vector<int>                        m_bp_spheres_states;
+    std::vector<int>                        m_bp_robot_slots;   // ssidx -> slot
+    std::vector<int>                        m_bp_ab_slots;      // ssidx -> slot
+    std::vector<double>                     m_bp_x;
+    std::vector<double>                     m_bp_y;
+    std::vector<double>                     m_bp_z;
+    std::vector<double>                     m_bp_r;
+    std::vector<std::uint8_t>               m_bp_mask;
+    PairBitMatrix                           m_bp_overlap;
+    // cleared on any change to the robot state, the world to model transform,
+    // the padding, or the set of checked spheres states
+    bool                                    m_bp_valid;
+
     // queue storage for sphere hierarchy traversal
     typedef std::pair<const CollisionSphereState*, const CollisionSphereState*> SpherePair;
     std::vector<SpherePair> m_q;
@@ -151,6 +306,12 @@ private:
     std::vector<Eigen::Vector3d> m_v_rem;
     std::vector<Eigen::Vector3d> m_v_ins;
 
+    // scratch storage for motion checks, and the waypoint at which the last
+    // motion check found a collision
+    std::vector<int>                            m_waypoint_order;
+    std::vector<std::uint8_t>                   m_waypoint_clear;
+    MotionFailureMemory                         m_motion_failures;
+
 #if USE_META_TREE
     // cached group information for building meta trees
     typedef hash_map<const CollisionSphereModel*, const CollisionSphereState*> ModelStateMap;
@@ -162,6 +323,15 @@ private:
 #endif
 
     void initAllowedCollisionMatrix();
+    void compileAllowedCollisionMatrix();
+    void compileAllowedCollisions(const AllowedCollisionsInterface& aci);
+
+    int attachedBodyEntityIndex(int abidx) const;
+
+    auto sphereEntries(const RobotCollisionState& state, int ssidx) const
+            -> const std::vector<int>*;
+    auto sphereEntries(const AttachedBodiesCollisionState& state, int ssidx) const
+            -> const std::vector<int>*;
 
     bool checkCommonInputs(
         const RobotCollisionState& state,
@@ -169,27 +339,37 @@ private:
         const int gidx) const;
 
     void prepareState(int gidx, const double* state);
+    bool checkPreparedState(const PairBitMatrix& allowed, double& dist);
     void updateGroup(int gidx);
     void copyState(const double* state);
+
+    SelfCollisionField* activateField();
+    const OccupancyGrid* voxelsGrid() const;
     void updateVoxelsStates();
 
-    // update the state of outside-group voxels and check for collisions between
-    // spheres and occupied voxels
+    // check for collisions between spheres and occupied voxels of the world
+    // and the outside-group voxels
     bool checkRobotVoxelsStateCollisions(double& dist);
+    bool checkRobotVoxelsStateCollisions(
+        const OccupancyGrid& grid,
+        double& dist);
     bool checkAttachedBodyVoxelsStateCollisions(double& dist);
+    bool checkAttachedBodyVoxelsStateCollisions(
+        const OccupancyGrid& grid,
+        double& dist);
 
     // check for collisions between inside-group spheres
     bool checkRobotSpheresStateCollisions(double& dist);
     bool checkRobotSpheresStateCollisions(
-        const AllowedCollisionsInterface& aci,
+        const PairBitMatrix& allowed,
         double& dist);
     bool checkAttachedBodySpheresStateCollisions(double& dist);
     bool checkAttachedBodySpheresStateCollisions(
-        const AllowedCollisionsInterface& aci,
+        const PairBitMatrix& allowed,
         double& dist);
     bool checkRobotAttachedBodySpheresStateCollisions(double& dist);
     bool checkRobotAttachedBodySpheresStateCollisions(
-        const AllowedCollisionsInterface& aci,
+        const PairBitMatrix& allowed,
         double& dist);
 
     template <typename StateTypeA, typename StateTypeB>
@@ -201,6 +381,12 @@ private:
         const CollisionSpheresState& ss2,
         double& dist);
 
+    void updateBroadPhaseSlots();
+    void updateBroadPhase();
+    bool rootsOverlap(int rss1i, int rss2i) const;
+    bool attachedBodyRootsOverlap(int ass1i, int ass2i) const;
+    bool attachedBodyRobotRootsOverlap(int ass1i, int rss2i) const;
+
     void updateCheckedSpheresIndices();
     void updateRobotCheckedSphereIndices();
     void updateRobotAttachedBodyCheckedSphereIndices();
@@ -208,6 +394,8 @@ private:
 
     void updateMetaSphereTrees();
 
+    double motionClearance();
+
     double robotVoxelsCollisionDistance();
     double robotSpheresCollisionDistance();
     double robotSpheresCollisionDistance(const AllowedCollisionsInterface& aci);
@@ -221,6 +409,8 @@ private:
         const CollisionSpheresState& ss1,
         const CollisionSpheresState& ss2);
 
+    double voxelsDistance(const CollisionSphereState& s) const;
+
     double sphereDistance(
         const CollisionSphereState& s1,
         const CollisionSphereState& s2) const;
@@ -230,18 +420,18 @@ private:
 
     bool getRobotSpheresStateCollisionDetails(CollisionDetails& details);
     bool getRobotSpheresStateCollisionDetails(
-        const AllowedCollisionsInterface& aci,
+        const PairBitMatrix& allowed,
         CollisionDetails& details);
 
     bool getAttachedBodySpheresStateCollisionDetails(CollisionDetails& details);
     bool getAttachedBodySpheresStateCollisionDetails(
-        const AllowedCollisionsInterface& aci,
+        const PairBitMatrix& allowed,
         CollisionDetails& details);
 
     bool getRobotAttachedBodySpheresStateCollisionDetails(
         CollisionDetails& details);
     bool getRobotAttachedBodySpheresStateCollisionDetails(
-        const AllowedCollisionsInterface& aci,
+        const PairBitMatrix& allowed,
         CollisionDetails& details);
 };
 
@@ -256,13 +446,35 @@ SelfCollisionModelImpl::SelfCollisionModelImpl(
     m_rcs(rcm),
     m_abcs(ab_model, &m_rcs),
     m_gidx(-1),
-    m_voxels_indices(),
-    m_ab_voxels_indices(),
+    m_fields(),
+    m_field(nullptr),
+    m_field_capacity(SelfCollisionModel::DefaultVoxelsFieldCapacity),
+    m_field_use_count(0),
+    m_voxels_versions(),
+    m_ab_voxels_versions(),
     m_checked_spheres_states(),
     m_checked_attached_body_spheres_states(),
     m_checked_attached_body_robot_spheres_states(),
     m_acm(),
     m_padding(0.0),
+    m_allowed_entities(),
+    m_ab_entity_indices(),
+    m_ab_version(-1),
+    m_allowed_spheres(),
+    m_robot_sphere_entries(),
+    m_ab_sphere_entries(),
+    m_aci_allowed_entities(),
+    m_bp_robot_count(0),
+    m_bp_spheres_states(),
+    m_bp_robot_slots(),
+    m_bp_ab_slots(),
+    m_bp_x(),
+    m_bp_y(),
+    m_bp_z(),
+    m_bp_r(),
+    m_bp_mask(),
+    m_bp_overlap(),
+    m_bp_valid(false),
 #if USE_META_TREE
     m_model_state_map(),
     m_root_models(),
@@ -274,6 +486,68 @@ SelfCollisionModelImpl::SelfCollisionModelImpl(
     m_vq()
 {
     initAllowedCollisionMatrix();
+    compileAllowedCollisionMatrix();
+}
+
+/// Construct a self collision model that shares the collision models and
+/// occupancy grid of another, and copies its allowed collision matrix, padding,
+/// and robot state, but keeps its own collision state, voxels fields, and
+/// scratch storage, so that the two may be used from different threads.
+SelfCollisionModelImpl::SelfCollisionModelImpl(
+    SelfCollisionModelImpl& base,
+    int gidx)
+:
+    m_grid(base.m_grid),
+    m_rcm(base.m_rcm),
+    m_abcm(base.m_abcm),
+    m_rcs(base.m_rcm),
+    m_abcs(base.m_abcm, &m_rcs),
+    m_gidx(-1),
+    m_fields(),
+    m_field(nullptr),
+    m_field_capacity(base.m_field_capacity),
+    m_field_use_count(0),
+    m_voxels_versions(),
+    m_ab_voxels_versions(),
+    m_checked_spheres_states(),
+    m_checked_attached_body_spheres_states(),
+    m_checked_attached_body_robot_spheres_states(),
+    m_acm(base.m_acm),
+    m_padding(base.m_padding),
+    m_allowed_entities(),
+    m_ab_entity_indices(),
+    m_ab_version(-1),
+    m_allowed_spheres(),
+    m_robot_sphere_entries(),
+    m_ab_sphere_entries(),
+    m_aci_allowed_entities(),
+    m_bp_robot_count(0),
+    m_bp_spheres_states(),
+    m_bp_robot_slots(),
+    m_bp_ab_slots(),
+    m_bp_x(),
+    m_bp_y(),
+    m_bp_z(),
+    m_bp_r(),
+    m_bp_mask(),
+    m_bp_overlap(),
+    m_bp_valid(false),
+#if USE_META_TREE
+    m_model_state_map(),
+    m_root_models(),
+    m_root_model_pointers(),
+    m_meta_model(),
+    m_meta_state(),
+#endif
+    m_q(),
+    m_vq()
+{
+    m_rcs.setWorldToModelTransform(base.m_rcs.worldToModelTransform());
+    m_rcs.setJointVarPositions(base.m_rcs.getJointVarPositions());
+    compileAllowedCollisionMatrix();
+    if (gidx >= 0 && gidx < m_rcm->groupCount()) {
+        prepareState(gidx, m_rcs.getJointVarPositions());
+    }
 }
 
 /// Seed the allowed collision matrix with pairs of adjacent links.
@@ -311,6 +585,165 @@ void SelfCollisionModelImpl::initAllowedCollisionMatrix()
     // when the first request with a valid group index is received
 }
 
+/// Compile the allowed collision matrix into bit matrices indexed by link,
+/// attached body, and leaf sphere so that no string lookups are required
+/// during collision checking. Must be called whenever the allowed collision
+/// matrix changes or attached bodies are added or removed.
+void SelfCollisionModelImpl::compileAllowedCollisionMatrix()
+{
+    ROS_DEBUG_NAMED(SCM_LOGGER, "Compile allowed collision matrix");
+
+    // gather entity names; links first, then attached bodies
+    std::vector<const std::string*> entity_names;
+    entity_names.reserve(m_rcm->linkCount());
+    for (size_t lidx = 0; lidx < m_rcm->linkCount(); ++lidx) {
+        entity_names.push_back(&m_rcm->linkName(lidx));
+    }
+
+    m_ab_entity_indices.clear();
+    for (size_t lidx = 0; lidx < m_rcm->linkCount(); ++lidx) {
+        for (int abidx : m_abcm->attachedBodyIndices(lidx)) {
+            if (abidx >= m_ab_entity_indices.size()) {
+                m_ab_entity_indices.resize(abidx + 1, -1);
+            }
+            m_ab_entity_indices[abidx] = (int)entity_names.size();
+            entity_names.push_back(&m_abcm->attachedBodyName(abidx));
+        }
+    }
+
+    // only entities that appear in the acm may have allowed collisions
+    std::vector<int> acm_entities;
+    for (size_t i = 0; i < entity_names.size(); ++i) {
+        if (m_acm.hasEntry(*entity_names[i])) {
+            acm_entities.push_back((int)i);
+        }
+    }
+
+    collision_detection::AllowedCollision::Type type;
+    m_allowed_entities.assign((int)entity_names.size());
+    for (size_t i = 0; i < acm_entities.size(); ++i) {
+        const std::string& name1 = *entity_names[acm_entities[i]];
+        for (size_t j = i + 1; j < acm_entities.size(); ++j) {
+            const std::string& name2 = *entity_names[acm_entities[j]];
+            if (m_acm.getEntry(name1, name2, type) &&
+                type == collision_detection::AllowedCollision::ALWAYS)
+            {
+                m_allowed_entities.set(acm_entities[i], acm_entities[j]);
+            }
+        }
+    }
+
+    // map leaf spheres, by name, to rows of the compiled sphere matrix
+    hash_map<std::string, int> sphere_name_to_entry;
+    std::vector<const std::string*> sphere_names;
+    auto map_leaf_spheres = [&](
+        const CollisionSpheresModel& spheres_model,
+        std::vector<int>& entries)
+    {
+        entries.assign(spheres_model.spheres.size(), -1);
+        for (size_t sidx = 0; sidx < spheres_model.spheres.size(); ++sidx) {
+            const CollisionSphereModel& sphere = spheres_model.spheres[sidx];
+            if (!sphere.isLeaf() || !m_acm.hasEntry(sphere.name)) {
+                continue;
+            }
+            auto it = sphere_name_to_entry.insert(std::make_pair(
+                    sphere.name, (int)sphere_names.size()));
+            if (it.second) {
+                sphere_names.push_back(&sphere.name);
+            }
+            entries[sidx] = it.first->second;
+        }
+    };
+
+    m_robot_sphere_entries.resize(m_rcm->spheresModelCount());
+    for (size_t ssidx = 0; ssidx < m_rcm->spheresModelCount(); ++ssidx) {
+        map_leaf_spheres(
+                m_rcm->spheresModel(ssidx), m_robot_sphere_entries[ssidx]);
+    }
+    m_ab_sphere_entries.resize(m_abcm->spheresModelCount());
+    for (size_t ssidx = 0; ssidx < m_abcm->spheresModelCount(); ++ssidx) {
+        map_leaf_spheres(
+                m_abcm->spheresModel(ssidx), m_ab_sphere_entries[ssidx]);
+    }
+
+    m_allowed_spheres.assign((int)sphere_names.size());
+    for (size_t i = 0; i < sphere_names.size(); ++i) {
+        // leaves may share a name, so include the diagonal
+        for (size_t j = i; j < sphere_names.size(); ++j) {
+            if (m_acm.getEntry(*sphere_names[i], *sphere_names[j], type) &&
+                type == collision_detection::AllowedCollision::ALWAYS)
+            {
+                m_allowed_spheres.set(i, j);
+            }
+        }
+    }
+
+    ROS_DEBUG_NAMED(SCM_LOGGER, "  %zu entities (%zu in acm), %zu leaf spheres in acm", entity_names.size(), acm_entities.size(), sphere_names.size());
+
+    m_ab_version = m_abcm->version();
+}
+
+/// Compile the allowed collisions interface of a request into the scratch bit
+/// matrix for the links and attached bodies in the active group
+void SelfCollisionModelImpl::compileAllowedCollisions(
+    const AllowedCollisionsInterface& aci)
+{
+    std::vector<int> entities;
+    std::vector<const std::string*> names;
+
+    for (int lidx : m_rcm->groupLinkIndices(m_gidx)) {
+        if (m_rcm->hasSpheresModel(lidx)) {
+            entities.push_back(lidx);
+            names.push_back(&m_rcm->linkName(lidx));
+        }
+    }
+    for (int abidx : m_abcm->groupLinkIndices(m_gidx)) {
+        if (m_abcm->hasSpheresModel(abidx)) {
+            entities.push_back(attachedBodyEntityIndex(abidx));
+            names.push_back(&m_abcm->attachedBodyName(abidx));
+        }
+    }
+
+    AllowedCollision::Type type;
+    m_aci_allowed_entities.assign(m_allowed_entities.size());
+    for (size_t i = 0; i < entities.size(); ++i) {
+        for (size_t j = i + 1; j < entities.size(); ++j) {
+            if (aci.getEntry(*names[i], *names[j], type) &&
+                type == AllowedCollision::Type::ALWAYS)
+            {
+                m_aci_allowed_entities.set(entities[i], entities[j]);
+            }
+        }
+    }
+}
+
+int SelfCollisionModelImpl::attachedBodyEntityIndex(int abidx) const
+{
+    return m_ab_entity_indices[abidx];
+}
+
+/// Return the compiled acm rows for the spheres in a robot spheres state
+auto SelfCollisionModelImpl::sphereEntries(
+    const RobotCollisionState& state,
+    int ssidx) const
+    -> const std::vector<int>*
+{
+    return &m_robot_sphere_entries[ssidx];
+}
+
+/// Return the compiled acm rows for the spheres in an attached body spheres
+/// state
+auto SelfCollisionModelImpl::sphereEntries(
+    const AttachedBodiesCollisionState& state,
+    int ssidx) const
+    -> const std::vector<int>*
+{
+    if (ssidx >= m_ab_sphere_entries.size()) {
+        return nullptr;
+    }
+    return &m_ab_sphere_entries[ssidx];
+}
+
 /// Check that the input states are related to the collision models passed to
 /// the constructor.
 bool SelfCollisionModelImpl::checkCommonInputs(
@@ -340,6 +773,13 @@ void SelfCollisionModelImpl::prepareState(
     int gidx,
     const double* state)
 {
+    if (m_ab_version != m_abcm->version()) {
+        // attached body voxels states are renumbered; each field matches its
+        // attached body voxels to the new voxels states when next active
+        m_ab_voxels_versions.clear();
+        compileAllowedCollisionMatrix();
+        updateCheckedSpheresIndices();
+    }
     updateGroup(gidx);
     copyState(state);
     updateVoxelsStates();
@@ -380,6 +820,7 @@ void SelfCollisionModelImpl::updateAllowedCollisionMatrix(
             }
         }
     }
+    compileAllowedCollisionMatrix();
     updateCheckedSpheresIndices();
 }
 
@@ -388,6 +829,7 @@ void SelfCollisionModelImpl::setAllowedCollisionMatrix(
 {
     ROS_DEBUG_NAMED(SCM_LOGGER, "Overwrite allowed collision matrix");
     m_acm = acm;
+    compileAllowedCollisionMatrix();
     updateCheckedSpheresIndices();
 }
 
@@ -396,12 +838,43 @@ void SelfCollisionModelImpl::setAllowedCollisionMatrix(
 void SelfCollisionModelImpl::setPadding(double padding)
 {
     m_padding = padding;
+    m_bp_valid = false;
+}
+
+/// Set the maximum number of fields of outside voxels kept for recently checked
+/// groups. Each field is a distance map with the bounds of the world grid. At
+/// least one field is always kept.
+void SelfCollisionModelImpl::setVoxelsFieldCapacity(size_t capacity)
+{
+    m_field_capacity = std::max(capacity, (size_t)1);
+    if (m_fields.size() <= m_field_capacity) {
+        return;
+    }
+
+    // keep the most recently used fields
+    std::sort(m_fields.begin(), m_fields.end(),
+            [](
+                const std::unique_ptr<SelfCollisionField>& a,
+                const std::unique_ptr<SelfCollisionField>& b)
+            {
+                return a->last_use > b->last_use;
+            });
+    m_fields.resize(m_field_capacity);
+    if (m_field && std::none_of(m_fields.begin(), m_fields.end(),
+            [&](const std::unique_ptr<SelfCollisionField>& f)
+            {
+                return f.get() == m_field;
+            }))
+    {
+        m_field = nullptr;
+    }
 }
 
 void SelfCollisionModelImpl::setWorldToModelTransform(
     const Eigen::Affine3d& transform)
 {
     (void)m_rcs.setWorldToModelTransform(transform);
+    m_bp_valid = false;
 }
 
 bool SelfCollisionModelImpl::checkCollision(
@@ -439,11 +912,21 @@ bool SelfCollisionModelImpl::checkCollision(
     }
 
     prepareState(gidx, state.getJointVarPositions());
+    compileAllowedCollisions(aci);
+
+    return checkPreparedState(m_aci_allowed_entities, dist);
+}
 
+/// Check the prepared state for collisions, allowing collisions between the
+/// pairs of links and attached bodies in a compiled set of allowed collisions
+bool SelfCollisionModelImpl::checkPreparedState(
+    const PairBitMatrix& allowed,
+    double& dist)
+{
     if (!checkRobotVoxelsStateCollisions(dist) ||
         !checkAttachedBodyVoxelsStateCollisions(dist) ||
-        !checkRobotSpheresStateCollisions(aci, dist) ||
-        !checkAttachedBodySpheresStateCollisions(aci, dist))
+        !checkRobotSpheresStateCollisions(allowed, dist) ||
+        !checkAttachedBodySpheresStateCollisions(allowed, dist))
     {
         return false;
     }
@@ -460,19 +943,70 @@ bool SelfCollisionModelImpl::checkMotionCollision(
     const int gidx,
     double& dist)
 {
+    int num_checks = 0;
+    return checkMotionCollision(
+            state, ab_state, rmcm, start, finish, gidx, num_checks, dist);
+}
+
+/// Check a linearly interpolated motion for collisions by conservative
+/// advancement.
+///
+/// The motion is discretized into waypoints such that no sphere moves further
+/// than a fixed resolution between consecutive waypoints. Waypoints are checked
+/// in bisection order, beginning with the waypoint at which a collision was
+/// last found along a motion from the same start state. After a waypoint is
+/// found to be collision-free, the clearance of the robot at that waypoint,
+/// together with the bound on sphere motion from the motion collision model,
+/// determines how many of the surrounding waypoints, and the motion in between,
+/// are also guaranteed to be collision-free. These waypoints are skipped. When
+/// the clearance is less than the motion between two waypoints, only the
+/// checked waypoint is covered, as with a plain discrete check.
+///
+/// Attached bodies are not covered by the bounds on sphere motion; motions for
+/// groups with attached bodies check every waypoint. The reported distance is
+/// the minimum over the checked waypoints.
+bool SelfCollisionModelImpl::checkMotionCollision(
+    RobotCollisionState& state,
+    AttachedBodiesCollisionState& ab_state,
+    const RobotMotionCollisionModel& rmcm,
+    const std::vector<double>& start,
+    const std::vector<double>& finish,
+    const int gidx,
+    int& num_checks,
+    double& dist)
+{
+    if (!checkCommonInputs(state, ab_state, gidx)) {
+        return false;
+    }
+
     const double res = 0.05;
     MotionInterpolation interp(m_rcm);
     rmcm.fillMotionInterpolation(start, finish, res, interp);
 
-    motion::RobotState interm;
-    for (int i = 0; i < interp.waypointCount(); ++i) {
-        interp.interpolate(i, interm);
-        state.setJointVarPositions(interm.data());
-        if (!checkCollision(state, ab_state, gidx, dist)) {
-            return false;
-        }
+    if (interp.waypointCount() == 0) {
+        return true;
     }
-    return true;
+
+    // upper bound on the distance any sphere moves between two waypoints
+    const double step_motion = rmcm.getMaxSphereMotion(start, finish) /
+            (interp.waypointCount() - 1);
+
+    prepareState(gidx, state.getJointVarPositions());
+    const bool advance = m_abcs.groupSpheresStateIndices(gidx).empty();
+
+    motion::RobotState interm;
+    return CheckMotionConservative(
+            interp.waypointCount(), step_motion, start,
+            m_motion_failures, m_waypoint_order, m_waypoint_clear,
+            [&](int i, double& d) {
+                interp.interpolate(i, interm);
+                state.setJointVarPositions(interm.data());
+                return checkCollision(state, ab_state, gidx, d);
+            },
+            [&]() {
+                return advance ? motionClearance() : 0.0;
+            },
+            num_checks, dist);
 }
 
 bool SelfCollisionModelImpl::checkMotionCollision(
@@ -485,21 +1019,73 @@ bool SelfCollisionModelImpl::checkMotionCollision(
     const int gidx,
     double& dist)
 {
+    if (!checkCommonInputs(state, ab_state, gidx)) {
+        return false;
+    }
+
+    // compile the allowed collisions once for all waypoints
+    prepareState(gidx, state.getJointVarPositions());
+    compileAllowedCollisions(aci);
+
     const double res = 0.05;
     MotionInterpolation interp(m_rcm);
     rmcm.fillMotionInterpolation(start, finish, res, interp);
 
+    MakeWaypointCheckOrder(
+            interp.waypointCount(),
+            m_motion_failures.waypoint(start, interp.waypointCount()),
+            m_waypoint_order);
+
     motion::RobotState interm;
-    for (int i = 0; i < interp.waypointCount(); ++i) {
+    for (const int i : m_waypoint_order) {
         interp.interpolate(i, interm);
         state.setJointVarPositions(interm.data());
-        if (!checkCollision(state, ab_state, aci, gidx, dist)) {
+        prepareState(gidx, state.getJointVarPositions());
+        if (!checkPreparedState(m_aci_allowed_entities, dist)) {
+            m_motion_failures.record(start, i, interp.waypointCount());
             return false;
         }
     }
     return true;
 }
 
+/// Return a lower bound on the distance any sphere in a group may move from
+/// the state before it may collide with an occupied voxel or another sphere,
+/// or 0 if the group includes attached bodies, whose motion is not bounded
+double SelfCollisionModelImpl::motionClearance(
+    RobotCollisionState& state,
+    AttachedBodiesCollisionState& ab_state,
+    const int gidx)
+{
+    if (!checkCommonInputs(state, ab_state, gidx)) {
+        return 0.0;
+    }
+
+    prepareState(gidx, state.getJointVarPositions());
+    if (!m_abcs.groupSpheresStateIndices(gidx).empty()) {
+        return 0.0;
+    }
+    return motionClearance();
+}
+
+/// Return a lower bound on the distance any sphere in the active group may move
+/// from the prepared state before it may collide with an occupied voxel or
+/// another sphere
+double SelfCollisionModelImpl::motionClearance()
+{
+    // distances to voxels are measured from the center of the cell containing
+    // the sphere, so they may differ by up to a cell diagonal from the true
+    // distance
+    const double voxels_clearance =
+            robotVoxelsCollisionDistance() -
+            std::sqrt(3.0) * m_grid->resolution();
+
+    // both spheres of a pair may move towards one another
+    const double spheres_clearance = 0.5 * robotSpheresCollisionDistance();
+
+    return std::min(voxels_clearance, spheres_clearance);
+}
+
 double SelfCollisionModelImpl::collisionDistance(
     RobotCollisionState& state,
     AttachedBodiesCollisionState& ab_state,
@@ -595,6 +1181,7 @@ bool SelfCollisionModelImpl::collisionDetails(
     }
 
     prepareState(gidx, state.getJointVarPositions());
+    compileAllowedCollisions(aci);
 
     double dist;
     details.voxels_collision_count = 0;
@@ -602,17 +1189,16 @@ bool SelfCollisionModelImpl::collisionDetails(
     bool res = true;
     res &= getRobotVoxelsStateCollisionDetails(details);
     res &= getAttachedBodyVoxelsStateCollisionDetails(details);
-    res &= getRobotSpheresStateCollisionDetails(aci, details);
-    res &= getAttachedBodySpheresStateCollisionDetails(aci, details);
+    res &= getRobotSpheresStateCollisionDetails(m_aci_allowed_entities, details);
+    res &= getAttachedBodySpheresStateCollisionDetails(m_aci_allowed_entities, details);
     return res;
 }
 
 /// Switch to checking for a new collision group
 ///
-/// Removes voxels from groups that are inside the new collision group and add
-/// voxels that are outside the new collision group. Also updates the cached
-/// set of checked sphere indices for checking against the default collision
-/// matrix
+/// Updates the cached set of checked sphere indices for checking against the
+/// default collision matrix. The field of voxels outside the new group is
+/// loaded separately, in updateVoxelsStates().
 void SelfCollisionModelImpl::updateGroup(int gidx)
 {
     if (gidx == m_gidx) {
@@ -621,110 +1207,6 @@ void SelfCollisionModelImpl::updateGroup(int gidx)
 
     ROS_DEBUG_NAMED(SCM_LOGGER, "Update Self Collision Model from group %d to group %d", m_gidx, gidx);
 
-    // switch to new voxels state context
-
-    std::vector<int> old_ov_indices = m_voxels_indices;
-
-    std::sort(old_ov_indices.begin(), old_ov_indices.end());
-    ROS_DEBUG_NAMED(SCM_LOGGER, "Old outside voxels indices: %s", to_string(old_ov_indices).c_str());
-
-    std::vector<int> new_ov_indices = m_rcs.groupOutsideVoxelsStateIndices(gidx);
-    std::sort(new_ov_indices.begin(), new_ov_indices.end());
-    ROS_DEBUG_NAMED(SCM_LOGGER, "New outside voxels indices: %s", to_string(new_ov_indices).c_str());
-
-    // get the indices of the voxels states that were outside the group but are
-    // now inside and must be removed
-    std::vector<int> ovidx_rem;
-    std::set_difference(
-            old_ov_indices.begin(), old_ov_indices.end(),
-            new_ov_indices.begin(), new_ov_indices.end(),
-            std::back_inserter(ovidx_rem));
-    ROS_DEBUG_NAMED(SCM_LOGGER, "ovidx_rem: %s", to_string(ovidx_rem).c_str());
-
-    // get the indices of the voxels states that were inside the group but are
-    // now outside and must be inserted
-    std::vector<int> ovidx_ins;
-    std::set_difference(
-            new_ov_indices.begin(), new_ov_indices.end(),
-            old_ov_indices.begin(), old_ov_indices.end(),
-            std::back_inserter(ovidx_ins));
-    ROS_DEBUG_NAMED(SCM_LOGGER, "ovidx_ins: %s", to_string(ovidx_ins).c_str());
-
-    // gather the voxels to be removed
-    std::vector<Eigen::Vector3d> v_rem;
-    for (int vsidx : ovidx_rem) {
-        const CollisionVoxelsState& vs = m_rcs.voxelsState(vsidx);
-        v_rem.insert(v_rem.end(), vs.voxels.begin(), vs.voxels.end());
-    }
-
-    // gather the voxels to be inserted
-    std::vector<Eigen::Vector3d> v_ins;
-    for (int vsidx : ovidx_ins) {
-        const CollisionVoxelsState& vs = m_rcs.voxelsState(vsidx);
-        v_ins.insert(v_ins.end(), vs.voxels.begin(), vs.voxels.end());
-    }
-
-    // insert/remove the voxels
-    if (!v_rem.empty()) {
-        ROS_DEBUG_NAMED(SCM_LOGGER, "  Remove %zu voxels from old voxels models", v_rem.size());
-        m_grid->removePointsFromField(v_rem);
-    }
-    if (!v_ins.empty()) {
-        ROS_DEBUG_NAMED(SCM_LOGGER, "  Insert %zu voxels from new voxels models", v_ins.size());
-        m_grid->addPointsToField(v_ins);
-    }
-
-    // prepare voxels indices
-
-    m_voxels_indices = std::move(new_ov_indices);
-
-    std::vector<int> old_ab_ov_indices = m_ab_voxels_indices;
-    std::sort(old_ab_ov_indices.begin(), old_ab_ov_indices.end());
-    ROS_DEBUG_NAMED(SCM_LOGGER, "Old attached body outside voxels indices: %s", to_string(old_ab_ov_indices).c_str());
-
-    std::vector<int> new_ab_ov_indices = m_abcs.groupOutsideVoxelsStateIndices(gidx);
-    std::sort(new_ab_ov_indices.begin(), new_ab_ov_indices.end());
-    ROS_DEBUG_NAMED(SCM_LOGGER, "New attached body outside voxels indices: %s", to_string(new_ab_ov_indices).c_str());
-
-    std::vector<int> abovidx_rem;
-    std::set_difference(
-            old_ab_ov_indices.begin(), old_ab_ov_indices.end(),
-            new_ab_ov_indices.begin(), new_ab_ov_indices.end(),
-            std::back_inserter(abovidx_rem));
-    ROS_DEBUG_NAMED(SCM_LOGGER, "abovidx_rem: %s", to_string(abovidx_rem).c_str());
-
-    std::vector<int> abovidx_ins;
-    std::set_difference(
-            new_ab_ov_indices.begin(), new_ab_ov_indices.end(),
-            old_ab_ov_indices.begin(), old_ab_ov_indices.end(),
-            std::back_inserter(abovidx_ins));
-    ROS_DEBUG_NAMED(SCM_LOGGER, "ovidx_ins: %s", to_string(abovidx_ins).c_str());
-
-    v_rem.clear();
-    for (int vsidx : abovidx_rem) {
-        const CollisionVoxelsState& vs = m_abcs.voxelsState(vsidx);
-        v_rem.insert(v_rem.end(), vs.voxels.begin(), vs.voxels.end());
-    }
-
-    // gather the voxels to be inserted
-    v_ins.clear();
-    for (int vsidx : abovidx_ins) {
-        const CollisionVoxelsState& vs = m_abcs.voxelsState(vsidx);
-        v_ins.insert(v_ins.end(), vs.voxels.begin(), vs.voxels.end());
-    }
-
-    // insert/remove the voxels
-    if (!v_rem.empty()) {
-        ROS_DEBUG_NAMED(SCM_LOGGER, "  Remove %zu voxels from old voxels models", v_rem.size());
-        m_grid->removePointsFromField(v_rem);
-    }
-    if (!v_ins.empty()) {
-        ROS_DEBUG_NAMED(SCM_LOGGER, "  Insert %zu voxels from new voxels models", v_ins.size());
-        m_grid->addPointsToField(v_ins);
-    }
-
-    m_ab_voxels_indices = std::move(new_ab_ov_indices);
-
 #if USE_META_TREE
     // map from meta sphere leaf model to its corresponding collision sphere root state
     m_model_state_map.clear();
@@ -762,77 +1244,240 @@ void SelfCollisionModelImpl::updateGroup(int gidx)
 void SelfCollisionModelImpl::copyState(const double* state)
 {
     (void)m_rcs.setJointVarPositions(state);
+    m_bp_valid = false;
 }
 
-/// Lazily update the state of the occupancy grid, representing areas filled by
-/// voxels models, when voxels state changes are detected in the robot collision
-/// state (and attached bodies collision state)
-void SelfCollisionModelImpl::updateVoxelsStates()
+/// Return the distance field of voxels outside the active group, or nullptr if
+/// there are none
+const OccupancyGrid* SelfCollisionModelImpl::voxelsGrid() const
 {
-    ROS_DEBUG_NAMED(SCM_LOGGER, "Update voxels states");
-    // gather all changed voxels before updating so as to impose only a single
-    // distance field update
-    auto& v_rem = m_v_rem; v_rem.clear();
-    auto& v_ins = m_v_ins; v_ins.clear();
+    return m_field ? m_field->grid.get() : nullptr;
+}
 
-    for (int vsidx : m_voxels_indices) {
-        if (m_rcs.voxelsStateDirty(vsidx)) {
-            const CollisionVoxelsState& voxels_state = m_rcs.voxelsState(vsidx);
+/// Gather the voxels to be displaced in a field by changes to the voxels states
+/// since the field was last updated.
+template <typename StateType>
+static void GatherChangedVoxels(
+    StateType& state,
+    const std::vector<int>& voxels_indices,
+    std::vector<std::uint32_t>& state_versions,
+    std::vector<std::uint32_t>& field_versions,
+    std::vector<std::vector<Eigen::Vector3d>>& field_voxels,
+    std::vector<Eigen::Vector3d>& v_rem,
+    std::vector<Eigen::Vector3d>& v_ins)
+{
+    for (size_t i = 0; i < voxels_indices.size(); ++i) {
+        const int vsidx = voxels_indices[i];
+        if (vsidx >= (int)state_versions.size()) {
+            state_versions.resize(vsidx + 1, 0);
+        }
 
-            // copy over voxels to be removed before updating
-            const size_t prev_size = v_rem.size();
-            v_rem.insert(
-                    v_rem.end(),
-                    voxels_state.voxels.begin(),
-                    voxels_state.voxels.end());
-            const size_t curr_size = v_rem.size();
+        if (state.voxelsStateDirty(vsidx)) {
+            state.updateVoxelsState(vsidx);
+            ++state_versions[vsidx];
+        }
 
-            m_rcs.updateVoxelsState(vsidx);
+        if (field_versions[i] == state_versions[vsidx]) {
+            continue;
+        }
 
-            // copy over voxels to be inserted
-            v_ins.insert(
-                    v_ins.end(),
-                    voxels_state.voxels.begin(),
-                    voxels_state.voxels.end());
+        field_versions[i] = state_versions[vsidx];
 
-            ROS_DEBUG_NAMED(SCM_LOGGER, "  Update Occupancy Grid with change to Collision Voxels State (%zu displaced)", curr_size - prev_size);
+        // voxels states that were updated in place, or matched to a
+        // renumbered voxels state, may not have moved
+        const auto& voxels = state.voxelsState(vsidx).voxels;
+        if (voxels == field_voxels[i]) {
+            continue;
         }
-    }
 
-    // same method as above against attached bodies collision state
-    for (int vsidx : m_ab_voxels_indices) {
-        if (m_abcs.voxelsStateDirty(vsidx)) {
-            const CollisionVoxelsState& voxels_state =
-                    m_abcs.voxelsState(vsidx);
+        // copy over voxels to be removed before updating
+        v_rem.insert(v_rem.end(), field_voxels[i].begin(), field_voxels[i].end());
 
-            // copy over voxels to be removed before updating
-            const size_t prev_size = v_rem.size();
-            v_rem.insert(
-                    v_rem.end(),
-                    voxels_state.voxels.begin(),
-                    voxels_state.voxels.end());
-            const size_t curr_size = v_rem.size();
+        field_voxels[i] = voxels;
 
-            m_abcs.updateVoxelsState(vsidx);
+        // copy over voxels to be inserted
+        v_ins.insert(v_ins.end(), field_voxels[i].begin(), field_voxels[i].end());
 
-            // copy over voxels to be inserted
-            v_ins.insert(
-                    v_ins.end(),
-                    voxels_state.voxels.begin(),
-                    voxels_state.voxels.end());
+        ROS_DEBUG_NAMED(SCM_LOGGER, "  Update voxels field with change to Collision Voxels State (%zu voxels)", field_voxels[i].size());
+    }
+}
 
-            ROS_DEBUG_NAMED(SCM_LOGGER, "  Update Occupancy Grid with change to Collision Voxels State (%zu displaced)", curr_size - prev_size);
+/// Replace the voxels states held by a field with those of another group.
+/// Voxels of states no longer included are gathered for removal; states that
+/// remain keep their voxels and versions, and newly included states are marked
+/// as never updated so that their voxels are gathered for insertion.
+template <typename StateType>
+static void ReloadFieldVoxels(
+    const StateType& state,
+    const std::vector<int>& voxels_indices,
+    std::vector<int>& field_indices,
+    std::vector<const CollisionVoxelsModel*>& field_models,
+    std::vector<std::uint32_t>& field_versions,
+    std::vector<std::vector<Eigen::Vector3d>>& field_voxels,
+    std::vector<Eigen::Vector3d>& v_rem)
+{
+    std::vector<const CollisionVoxelsModel*> models(voxels_indices.size());
+    std::vector<std::uint32_t> versions(
+            voxels_indices.size(), ~std::uint32_t(0));
+    std::vector<std::vector<Eigen::Vector3d>> voxels(voxels_indices.size());
+    for (size_t j = 0; j < voxels_indices.size(); ++j) {
+        models[j] = state.voxelsState(voxels_indices[j]).model;
+    }
+    for (size_t i = 0; i < field_indices.size(); ++i) {
+        auto it = std::find(
+                voxels_indices.begin(), voxels_indices.end(), field_indices[i]);
+        if (it == voxels_indices.end()) {
+            v_rem.insert(v_rem.end(), field_voxels[i].begin(), field_voxels[i].end());
+        } else {
+            const size_t j = std::distance(voxels_indices.begin(), it);
+            versions[j] = field_versions[i];
+            voxels[j] = std::move(field_voxels[i]);
+        }
+    }
+    field_indices = voxels_indices;
+    field_models = std::move(models);
+    field_versions = std::move(versions);
+    field_voxels = std::move(voxels);
+}
+
+/// Match the voxels states held by a field to the voxels states, among
+/// \p voxels_indices, created from the same voxels model, after the voxels
+/// states have been renumbered. Unmatched states are given an invalid index, so
+/// that ReloadFieldVoxels removes their voxels. Matched states are marked as
+/// never updated, so that their voxels are compared against the renumbered
+/// state rather than reinserted.
+template <typename StateType>
+static void RenumberFieldVoxels(
+    const StateType& state,
+    const std::vector<int>& voxels_indices,
+    std::vector<int>& field_indices,
+    const std::vector<const CollisionVoxelsModel*>& field_models,
+    std::vector<std::uint32_t>& field_versions)
+{
+    for (size_t i = 0; i < field_indices.size(); ++i) {
+        field_indices[i] = -1;
+        field_versions[i] = ~std::uint32_t(0);
+        for (int vsidx : voxels_indices) {
+            if (state.voxelsState(vsidx).model == field_models[i]) {
+                field_indices[i] = vsidx;
+                break;
+            }
+        }
+    }
+}
+
+/// Return the field of voxels outside the active group, taking over the least
+/// recently used field if the group has none and no more fields may be created
+SelfCollisionField* SelfCollisionModelImpl::activateField()
+{
+    SelfCollisionField* lru = nullptr;
+    for (auto& field : m_fields) {
+        if (field->gidx == m_gidx) {
+            return field.get();
+        }
+        if (!lru || field->last_use < lru->last_use) {
+            lru = field.get();
         }
     }
 
-    // update occupancy grid with new voxel data
+    if (m_fields.size() < m_field_capacity) {
+        ROS_DEBUG_NAMED(SCM_LOGGER, "Create voxels field for group %d", m_gidx);
+        std::unique_ptr<SelfCollisionField> field(new SelfCollisionField);
+        DistanceMapInterfacePtr df(m_grid->getDistanceField()->clone());
+        df->reset();
+        field->grid.reset(new OccupancyGrid(df, true));
+        field->grid->setReferenceFrame(m_grid->getReferenceFrame());
+        m_fields.push_back(std::move(field));
+        return m_fields.back().get();
+    }
+
+    ROS_DEBUG_NAMED(SCM_LOGGER, "Move voxels field from group %d to group %d", lru->gidx, m_gidx);
+    return lru;
+}
+
+/// Select the field of voxels outside the active group and lazily update it
+/// when changes are detected in the voxels states of the robot collision state
+/// (and attached bodies collision state). The world occupancy grid is never
+/// modified; each field is a separate distance map with the same type and
+/// bounds as the world grid. Groups without any outside voxels use no field.
+void SelfCollisionModelImpl::updateVoxelsStates()
+{
+    const std::vector<int>& voxels_indices =
+            m_rcs.groupOutsideVoxelsStateIndices(m_gidx);
+    const std::vector<int>& ab_voxels_indices =
+            m_abcs.groupOutsideVoxelsStateIndices(m_gidx);
+
+    if (voxels_indices.empty() && ab_voxels_indices.empty()) {
+        m_field = nullptr;
+        return;
+    }
+
+    m_field = activateField();
+    m_field->last_use = ++m_field_use_count;
+
+    ROS_DEBUG_NAMED(SCM_LOGGER, "Update voxels states");
+    // gather all changed voxels before updating so as to impose only a single
+    // distance field update
+    auto& v_rem = m_v_rem; v_rem.clear();
+    auto& v_ins = m_v_ins; v_ins.clear();
+
+    if (m_field->ab_version != m_abcm->version()) {
+        ROS_DEBUG_NAMED(SCM_LOGGER, "  Renumber attached body voxels");
+        RenumberFieldVoxels(
+                m_abcs,
+                ab_voxels_indices,
+                m_field->ab_voxels_indices,
+                m_field->ab_voxels_models,
+                m_field->ab_voxels_versions);
+        m_field->ab_version = m_abcm->version();
+        m_field->gidx = -1; // reload attached body voxels states
+    }
+
+    if (m_field->gidx != m_gidx) {
+        ROS_DEBUG_NAMED(SCM_LOGGER, "  Load voxels outside group %d", m_gidx);
+        ReloadFieldVoxels(
+                m_rcs,
+                voxels_indices,
+                m_field->voxels_indices,
+                m_field->voxels_models,
+                m_field->voxels_versions,
+                m_field->voxels,
+                v_rem);
+        ReloadFieldVoxels(
+                m_abcs,
+                ab_voxels_indices,
+                m_field->ab_voxels_indices,
+                m_field->ab_voxels_models,
+                m_field->ab_voxels_versions,
+                m_field->ab_voxels,
+                v_rem);
+        m_field->gidx = m_gidx;
+    }
+
+    GatherChangedVoxels(
+            m_rcs,
+            m_field->voxels_indices,
+            m_voxels_versions,
+            m_field->voxels_versions,
+            m_field->voxels,
+            v_rem, v_ins);
+
+    GatherChangedVoxels(
+            m_abcs,
+            m_field->ab_voxels_indices,
+            m_ab_voxels_versions,
+            m_field->ab_voxels_versions,
+            m_field->ab_voxels,
+            v_rem, v_ins);
+
+    // update the field with new voxel data
     if (!v_rem.empty()) {
         ROS_DEBUG_NAMED(SCM_LOGGER, "  Remove %zu voxels", v_rem.size());
-        m_grid->removePointsFromField(v_rem);
+        m_field->grid->removePointsFromField(v_rem);
     }
     if (!v_ins.empty()) {
         ROS_DEBUG_NAMED(SCM_LOGGER, "  Insert %zu voxels", v_ins.size());
-        m_grid->addPointsToField(v_ins);
+        m_field->grid->addPointsToField(v_ins);
     }
 }
 
@@ -844,6 +1489,18 @@ bool SelfCollisionModelImpl::checkRobotVoxelsStateCollisions(double& dist)
     updateMetaSphereTrees();
 #endif
 
+    if (!checkRobotVoxelsStateCollisions(*m_grid, dist)) {
+        return false;
+    }
+
+    const OccupancyGrid* voxels_grid = voxelsGrid();
+    return !voxels_grid || checkRobotVoxelsStateCollisions(*voxels_grid, dist);
+}
+
+bool SelfCollisionModelImpl::checkRobotVoxelsStateCollisions(
+    const OccupancyGrid& grid,
+    double& dist)
+{
     auto& q = m_vq;
     q.clear();
 
@@ -857,7 +1514,7 @@ bool SelfCollisionModelImpl::checkRobotVoxelsStateCollisions(double& dist)
     }
 #endif
 
-    return CheckVoxelsCollisions(m_rcs, q, *m_grid, m_padding, dist);
+    return CheckVoxelsCollisions(m_rcs, q, grid, m_padding, dist);
 }
 
 bool SelfCollisionModelImpl::checkAttachedBodyVoxelsStateCollisions(
@@ -865,6 +1522,19 @@ bool SelfCollisionModelImpl::checkAttachedBodyVoxelsStateCollisions(
 {
     ROS_DEBUG_NAMED(SCM_LOGGER, "Check attached bodies against voxels states");
 
+    if (!checkAttachedBodyVoxelsStateCollisions(*m_grid, dist)) {
+        return false;
+    }
+
+    const OccupancyGrid* voxels_grid = voxelsGrid();
+    return !voxels_grid ||
+            checkAttachedBodyVoxelsStateCollisions(*voxels_grid, dist);
+}
+
+bool SelfCollisionModelImpl::checkAttachedBodyVoxelsStateCollisions(
+    const OccupancyGrid& grid,
+    double& dist)
+{
     auto& q = m_vq;
     q.clear();
 
@@ -874,16 +1544,21 @@ bool SelfCollisionModelImpl::checkAttachedBodyVoxelsStateCollisions(
         q.push_back(s);
     }
 
-    return CheckVoxelsCollisions(m_abcs, q, *m_grid, m_padding, dist);
+    return CheckVoxelsCollisions(m_abcs, q, grid, m_padding, dist);
 }
 
 bool SelfCollisionModelImpl::checkRobotSpheresStateCollisions(double& dist)
 {
     ROS_DEBUG_NAMED(SCM_LOGGER, "Check robot links vs robot links");
 
+    updateBroadPhase();
+
     for (const auto& ss_pair : m_checked_spheres_states) {
         int ss1i = ss_pair.first;
         int ss2i = ss_pair.second;
+        if (!rootsOverlap(ss1i, ss2i)) {
+            continue;
+        }
         const CollisionSpheresState& ss1 = m_rcs.spheresState(ss1i);
         const CollisionSpheresState& ss2 = m_rcs.spheresState(ss2i);
 
@@ -899,11 +1574,13 @@ bool SelfCollisionModelImpl::checkRobotSpheresStateCollisions(double& dist)
 }
 
 bool SelfCollisionModelImpl::checkRobotSpheresStateCollisions(
-    const AllowedCollisionsInterface& aci,
+    const PairBitMatrix& allowed,
     double& dist)
 {
     ROS_DEBUG_NAMED(SCM_LOGGER, "Check robot links vs robot links");
 
+    updateBroadPhase();
+
     const auto& group_link_indices = m_rcm->groupLinkIndices(m_gidx);
     for (int l1 = 0; l1 < group_link_indices.size(); ++l1) {
         const int lidx1 = group_link_indices[l1];
@@ -911,24 +1588,22 @@ bool SelfCollisionModelImpl::checkRobotSpheresStateCollisions(
             continue;
         }
 
-        const std::string& l1_name = m_rcm->linkName(lidx1);
         for (int l2 = l1 + 1; l2 < group_link_indices.size(); ++l2) {
             const int lidx2 = group_link_indices[l2];
             if (!m_rcm->hasSpheresModel(lidx2)) {
                 continue;
             }
-            const std::string& l2_name = m_rcm->linkName(lidx2);
 
-            AllowedCollision::Type type;
-            if (aci.getEntry(l2_name, l1_name, type) &&
-                type == AllowedCollision::Type::ALWAYS)
-            {
+            if (allowed.test(lidx1, lidx2)) {
                 // collisions allowed between this pair of links
                 continue;
             }
 
             const int ss1i = m_rcs.linkSpheresStateIndex(lidx1);
             const int ss2i = m_rcs.linkSpheresStateIndex(lidx2);
+            if (!rootsOverlap(ss1i, ss2i)) {
+                continue;
+            }
             const CollisionSpheresState& ss1 = m_rcs.spheresState(ss1i);
             const CollisionSpheresState& ss2 = m_rcs.spheresState(ss2i);
             if (!checkSpheresStateCollision(
@@ -946,11 +1621,16 @@ bool SelfCollisionModelImpl::checkRobotSpheresStateCollisions(
 bool SelfCollisionModelImpl::checkAttachedBodySpheresStateCollisions(
     double& dist)
 {
-    ROS_DEBUG(SCM_LOGGER, "Check attached bodies vs attached bodies");
+    ROS_DEBUG_NAMED(SCM_LOGGER, "Check attached bodies vs attached bodies");
+
+    updateBroadPhase();
 
     for (const auto& ss_pair : m_checked_attached_body_spheres_states) {
         int ss1i = ss_pair.first;
         int ss2i = ss_pair.second;
+        if (!attachedBodyRootsOverlap(ss1i, ss2i)) {
+            continue;
+        }
         const CollisionSpheresState& ss1 = m_abcs.spheresState(ss1i);
         const CollisionSpheresState& ss2 = m_abcs.spheresState(ss2i);
 
@@ -969,10 +1649,11 @@ bool SelfCollisionModelImpl::checkAttachedBodySpheresStateCollisions(
 }
 
 bool SelfCollisionModelImpl::checkAttachedBodySpheresStateCollisions(
-    const AllowedCollisionsInterface& aci,
+    const PairBitMatrix& allowed,
     double& dist)
 {
     ROS_DEBUG_NAMED(SCM_LOGGER, "Check attached bodies vs attached bodies");
+    updateBroadPhase();
     const auto& group_body_indices = m_abcm->groupLinkIndices(m_gidx);
     for (int b1 = 0; b1 < group_body_indices.size(); ++b1) {
         const int bidx1 = group_body_indices[b1];
@@ -980,25 +1661,23 @@ bool SelfCollisionModelImpl::checkAttachedBodySpheresStateCollisions(
             continue;
         }
 
-        const std::string& b1_name = m_abcm->attachedBodyName(bidx1);
+        const int e1 = attachedBodyEntityIndex(bidx1);
         for (int b2 = b1 + 1; b2 < group_body_indices.size(); ++b2) {
             const int bidx2 = group_body_indices[b2];
             if (!m_abcm->hasSpheresModel(bidx2)) {
                 continue;
             }
 
-            const std::string& b2_name = m_abcm->attachedBodyName(bidx2);
-
-            AllowedCollision::Type type;
-            if (aci.getEntry(b1_name, b2_name, type) &&
-                type == AllowedCollision::Type::ALWAYS)
-            {
+            if (allowed.test(e1, attachedBodyEntityIndex(bidx2))) {
                 // collisions between this pair of links
                 continue;
             }
 
             const int ss1i = m_abcs.attachedBodySpheresStateIndex(bidx1);
             const int ss2i = m_abcs.attachedBodySpheresStateIndex(bidx2);
+            if (!attachedBodyRootsOverlap(ss1i, ss2i)) {
+                continue;
+            }
             const CollisionSpheresState& ss1 = m_abcs.spheresState(ss1i);
             const CollisionSpheresState& ss2 = m_abcs.spheresState(ss2i);
             if (!checkSpheresStateCollision(
@@ -1009,7 +1688,7 @@ bool SelfCollisionModelImpl::checkAttachedBodySpheresStateCollisions(
         }
     }
 
-    if (!checkRobotAttachedBodySpheresStateCollisions(aci, dist)) {
+    if (!checkRobotAttachedBodySpheresStateCollisions(allowed, dist)) {
         return false;
     }
 
@@ -1021,9 +1700,14 @@ bool SelfCollisionModelImpl::checkRobotAttachedBodySpheresStateCollisions(
 {
     ROS_DEBUG_NAMED(SCM_LOGGER, "Check attached bodies vs robot links");
 
+    updateBroadPhase();
+
     for (const auto& ss_pair : m_checked_attached_body_robot_spheres_states) {
         int ss1i = ss_pair.first;
         int ss2i = ss_pair.second;
+        if (!attachedBodyRobotRootsOverlap(ss1i, ss2i)) {
+            continue;
+        }
         const CollisionSpheresState& ss1 = m_abcs.spheresState(ss1i);
         const CollisionSpheresState& ss2 = m_rcs.spheresState(ss2i);
 
@@ -1038,10 +1722,11 @@ bool SelfCollisionModelImpl::checkRobotAttachedBodySpheresStateCollisions(
 }
 
 bool SelfCollisionModelImpl::checkRobotAttachedBodySpheresStateCollisions(
-    const AllowedCollisionsInterface& aci,
+    const PairBitMatrix& allowed,
     double& dist)
 {
     ROS_DEBUG_NAMED(SCM_LOGGER, "Check attached bodies vs robot links");
+    updateBroadPhase();
     const auto& group_link_indices = m_rcm->groupLinkIndices(m_gidx);
     const auto& group_body_indices = m_abcm->groupLinkIndices(m_gidx);
     for (int b1 = 0; b1 < group_body_indices.size(); ++b1) {
@@ -1050,25 +1735,23 @@ bool SelfCollisionModelImpl::checkRobotAttachedBodySpheresStateCollisions(
             continue;
         }
 
-        const std::string& body_name = m_abcm->attachedBodyName(bidx);
+        const int body_entity = attachedBodyEntityIndex(bidx);
         for (int l1 = 0; l1 < group_link_indices.size(); ++l1) {
             const int lidx = group_link_indices[l1];
             if (!m_rcm->hasSpheresModel(lidx)) {
                 continue;
             }
 
-            const std::string& link_name = m_rcm->linkName(lidx);
-
-            AllowedCollision::Type type;
-            if (aci.getEntry(body_name, link_name, type) &&
-                type == AllowedCollision::Type::ALWAYS)
-            {
+            if (allowed.test(body_entity, lidx)) {
                 // collisions between this pair of links
                 continue;
             }
 
             const int ss1i = m_abcs.attachedBodySpheresStateIndex(bidx);
             const int ss2i = m_rcs.linkSpheresStateIndex(lidx);
+            if (!attachedBodyRobotRootsOverlap(ss1i, ss2i)) {
+                continue;
+            }
             const CollisionSpheresState& ss1 = m_abcs.spheresState(ss1i);
             const CollisionSpheresState& ss2 = m_rcs.spheresState(ss2i);
             if (!checkSpheresStateCollision(
@@ -1107,6 +1790,10 @@ bool SelfCollisionModelImpl::checkSpheresStateCollision(
     stateA.updateSphereState(SphereIndex(ss1i, ss1.spheres.root()->index()));
     stateB.updateSphereState(SphereIndex(ss2i, ss2.spheres.root()->index()));
 
+    // compiled acm rows for the leaf spheres of each spheres state
+    const std::vector<int>* entries1 = sphereEntries(stateA, ss1i);
+    const std::vector<int>* entries2 = sphereEntries(stateB, ss2i);
+
     auto& q = m_q;
     q.clear();
     q.push_back(std::make_pair(ss1.spheres.root(), ss2.spheres.root()));
@@ -1132,14 +1819,9 @@ bool SelfCollisionModelImpl::checkSpheresStateCollision(
 
         if (s1s->isLeaf() && s2s->isLeaf()) {
             // collision found! check acm
-            collision_detection::AllowedCollision::Type type;
-            if (m_acm.getEntry(s1m->name, s2m->name, type)) {
-                if (type != collision_detection::AllowedCollision::ALWAYS) {
-                    ROS_DEBUG_NAMED(SCM_LOGGER, "  *collision* '%s' x '%s'", s1m->name.c_str(), s2m->name.c_str());
-                    dist = cd2;
-                    return false;
-                }
-            } else {
+            const int e1 = entries1 ? (*entries1)[s1s->index()] : -1;
+            const int e2 = entries2 ? (*entries2)[s2s->index()] : -1;
+            if (e1 < 0 || e2 < 0 || !m_allowed_spheres.test(e1, e2)) {
                 ROS_DEBUG_NAMED(SCM_LOGGER, "  *collision* '%s' x '%s'", s1m->name.c_str(), s2m->name.c_str());
                 dist = cd2;
                 return false;
@@ -1228,6 +1910,114 @@ void SelfCollisionModelImpl::updateCheckedSpheresIndices()
     updateRobotCheckedSphereIndices();
     updateAttachedBodyCheckedSphereIndices();
     updateRobotAttachedBodyCheckedSphereIndices();
+    updateBroadPhaseSlots();
+}
+
+/// Assign a broad phase slot to each spheres state in the active group
+void SelfCollisionModelImpl::updateBroadPhaseSlots()
+{
+    const auto& robot_ss_indices = m_rcs.groupSpheresStateIndices(m_gidx);
+    const auto& ab_ss_indices = m_abcs.groupSpheresStateIndices(m_gidx);
+
+    m_bp_spheres_states.clear();
+    m_bp_robot_slots.assign(m_rcm->spheresModelCount(), -1);
+    for (int ssidx : robot_ss_indices) {
+        m_bp_robot_slots[ssidx] = (int)m_bp_spheres_states.size();
+        m_bp_spheres_states.push_back(ssidx);
+    }
+    m_bp_robot_count = (int)m_bp_spheres_states.size();
+
+    m_bp_ab_slots.clear();
+    for (int ssidx : ab_ss_indices) {
+        if (ssidx >= m_bp_ab_slots.size()) {
+            m_bp_ab_slots.resize(ssidx + 1, -1);
+        }
+        m_bp_ab_slots[ssidx] = (int)m_bp_spheres_states.size();
+        m_bp_spheres_states.push_back(ssidx);
+    }
+
+    const size_t n = m_bp_spheres_states.size();
+    m_bp_x.resize(n);
+    m_bp_y.resize(n);
+    m_bp_z.resize(n);
+    m_bp_r.resize(n);
+    m_bp_mask.resize(n);
+    m_bp_overlap.assign((int)n);
+    m_bp_valid = false;
+}
+
+/// Update the root spheres of all spheres states in the active group and test
+/// all pairs of them for overlap. Pairs of spheres states whose root spheres
+/// do not overlap cannot be in collision and are skipped by the narrow phase.
+void SelfCollisionModelImpl::updateBroadPhase()
+{
+    if (m_bp_valid) {
+        return;
+    }
+
+    const int n = (int)m_bp_spheres_states.size();
+    for (int i = 0; i < n; ++i) {
+        const int ssidx = m_bp_spheres_states[i];
+        const CollisionSphereState* s;
+        if (i < m_bp_robot_count) {
+            s = m_rcs.spheresState(ssidx).spheres.root();
+            m_rcs.updateSphereState(SphereIndex(ssidx, s->index()));
+        } else {
+            s = m_abcs.spheresState(ssidx).spheres.root();
+            m_abcs.updateSphereState(SphereIndex(ssidx, s->index()));
+        }
+        m_bp_x[i] = s->pos.x();
+        m_bp_y[i] = s->pos.y();
+        m_bp_z[i] = s->pos.z();
+        m_bp_r[i] = s->model->radius;
+    }
+
+    const double* x = m_bp_x.data();
+    const double* y = m_bp_y.data();
+    const double* z = m_bp_z.data();
+    const double* r = m_bp_r.data();
+    std::uint8_t* mask = m_bp_mask.data();
+    for (int i = 0; i < n; ++i) {
+        const double xi = x[i];
+        const double yi = y[i];
+        const double zi = z[i];
+        const double ri = r[i];
+        // branch-free so the compiler can vectorize the inner loop; the lower
+        // triangle and diagonal are computed but never queried
+        for (int j = 0; j < n; ++j) {
+            const double dx = x[j] - xi;
+            const double dy = y[j] - yi;
+            const double dz = z[j] - zi;
+            const double cr = r[j] + ri;
+            mask[j] = dx * dx + dy * dy + dz * dz <= cr * cr;
+        }
+        m_bp_overlap.setRow(i, mask);
+    }
+
+    m_bp_valid = true;
+}
+
+/// Return whether the root spheres of two robot spheres states overlap
+bool SelfCollisionModelImpl::rootsOverlap(int rss1i, int rss2i) const
+{
+    return m_bp_overlap.test(m_bp_robot_slots[rss1i], m_bp_robot_slots[rss2i]);
+}
+
+/// Return whether the root spheres of two attached body spheres states overlap
+bool SelfCollisionModelImpl::attachedBodyRootsOverlap(
+    int ass1i,
+    int ass2i) const
+{
+    return m_bp_overlap.test(m_bp_ab_slots[ass1i], m_bp_ab_slots[ass2i]);
+}
+
+/// Return whether the root spheres of an attached body spheres state and a
+/// robot spheres state overlap
+bool SelfCollisionModelImpl::attachedBodyRobotRootsOverlap(
+    int ass1i,
+    int rss2i) const
+{
+    return m_bp_overlap.test(m_bp_ab_slots[ass1i], m_bp_robot_slots[rss2i]);
 }
 
 void SelfCollisionModelImpl::updateRobotCheckedSphereIndices()
@@ -1241,24 +2031,14 @@ void SelfCollisionModelImpl::updateRobotCheckedSphereIndices()
         if (!l1_has_spheres) {
             continue;
         }
-        const std::string& l1_name = m_rcm->linkName(lidx1);
         for (int l2 = l1 + 1; l2 < group_link_indices.size(); ++l2) {
             const int lidx2 = group_link_indices[l2];
             const bool l2_has_spheres = m_rcm->hasSpheresModel(lidx2);
             if (!l2_has_spheres) {
                 continue;
             }
-            const std::string& l2_name = m_rcm->linkName(lidx2);
-
-            collision_detection::AllowedCollision::Type type;
-            if (m_acm.getEntry(l1_name, l2_name, type)) {
-                if (type != collision_detection::AllowedCollision::ALWAYS) {
-                    m_checked_spheres_states.emplace_back(
-                            m_rcs.linkSpheresStateIndex(lidx1),
-                            m_rcs.linkSpheresStateIndex(lidx2));
-                }
-            }
-            else {
+
+            if (!m_allowed_entities.test(lidx1, lidx2)) {
                 m_checked_spheres_states.emplace_back(
                         m_rcs.linkSpheresStateIndex(lidx1),
                         m_rcs.linkSpheresStateIndex(lidx2));
@@ -1269,7 +2049,6 @@ void SelfCollisionModelImpl::updateRobotCheckedSphereIndices()
 
 void SelfCollisionModelImpl::updateRobotAttachedBodyCheckedSphereIndices()
 {
-    // TODO: see note in updateAttachedBodyCheckedSphereIndices()
     m_checked_attached_body_robot_spheres_states.clear();
 
     const auto& group_body_indices = m_abcm->groupLinkIndices(m_gidx);
@@ -1280,24 +2059,15 @@ void SelfCollisionModelImpl::updateRobotAttachedBodyCheckedSphereIndices()
         if (!b1_has_spheres) {
             continue;
         }
-        const std::string& b1_name = m_abcm->attachedBodyName(bidx1);
+        const int b1_entity = attachedBodyEntityIndex(bidx1);
         for (int l1 = 0; l1 < group_link_indices.size(); ++l1) {
             const int lidx = group_link_indices[l1];
             const bool l1_has_spheres = m_rcm->hasSpheresModel(lidx);
             if (!l1_has_spheres) {
                 continue;
             }
-            const std::string& l1_name = m_rcm->linkName(lidx);
-
-            collision_detection::AllowedCollision::Type type;
-            if (m_acm.getEntry(b1_name, l1_name, type)) {
-                if (type != collision_detection::AllowedCollision::ALWAYS) {
-                    m_checked_attached_body_robot_spheres_states.emplace_back(
-                            m_abcs.attachedBodySpheresStateIndex(bidx1),
-                            m_rcs.linkSpheresStateIndex(lidx));
-                }
-            }
-            else {
+
+            if (!m_allowed_entities.test(b1_entity, lidx)) {
                 m_checked_attached_body_robot_spheres_states.emplace_back(
                         m_abcs.attachedBodySpheresStateIndex(bidx1),
                         m_rcs.linkSpheresStateIndex(lidx));
@@ -1308,8 +2078,6 @@ void SelfCollisionModelImpl::updateRobotAttachedBodyCheckedSphereIndices()
 
 void SelfCollisionModelImpl::updateAttachedBodyCheckedSphereIndices()
 {
-    // TODO: need to call this function whenever the attached bodies model has
-    // a body added or removed from it
     m_checked_attached_body_spheres_states.clear();
     const auto& group_body_indices = m_abcm->groupLinkIndices(m_gidx);
     for (int b1 = 0; b1 < group_body_indices.size(); ++b1) {
@@ -1318,24 +2086,17 @@ void SelfCollisionModelImpl::updateAttachedBodyCheckedSphereIndices()
         if (!b1_has_spheres) {
             continue;
         }
-        const std::string& b1_name = m_abcm->attachedBodyName(bidx1);
+        const int b1_entity = attachedBodyEntityIndex(bidx1);
         for (int b2 = b1 + 1; b2 < group_body_indices.size(); ++b2) {
             const int bidx2 = group_body_indices[b2];
             const bool b2_has_spheres = m_abcm->hasSpheresModel(bidx2);
             if (!b2_has_spheres) {
                 continue;
             }
-            const std::string& b2_name = m_abcm->attachedBodyName(bidx2);
-
-            collision_detection::AllowedCollision::Type type;
-            if (m_acm.getEntry(b1_name, b2_name, type)) {
-                if (type != collision_detection::AllowedCollision::ALWAYS) {
-                    m_checked_attached_body_spheres_states.emplace_back(
-                            m_abcs.attachedBodySpheresStateIndex(bidx1),
-                            m_abcs.attachedBodySpheresStateIndex(bidx2));
-                }
-            }
-            else {
+
+            if (!m_allowed_entities.test(
+                    b1_entity, attachedBodyEntityIndex(bidx2)))
+            {
                 m_checked_attached_body_spheres_states.emplace_back(
                         m_abcs.attachedBodySpheresStateIndex(bidx1),
                         m_abcs.attachedBodySpheresStateIndex(bidx2));
@@ -1407,7 +2168,7 @@ double SelfCollisionModelImpl::robotVoxelsCollisionDistance()
 
         ROS_DEBUG_NAMED(SCM_LOGGER, "Checking sphere with radius %0.3f at (%0.3f, %0.3f, %0.3f)", s->model->radius, s->pos.x(), s->pos.y(), s->pos.z());
 
-        double obs_dist = SphereCollisionDistance(*m_grid, *s, m_padding);
+        double obs_dist = voxelsDistance(*s);
         if (obs_dist >= d) {
             continue; // further -> ok!
         }
@@ -1637,8 +2398,21 @@ double SelfCollisionModelImpl::spheresStateCollisionDistance(
     }
     ROS_DEBUG_NAMED(SCM_LOGGER, "queue exhaused");
 
-    // queue exhaused = no collision found
-    return true;
+    // queue exhaused = no pair of spheres closer than dp
+    return dp;
+}
+
+/// Return the distance between a sphere and the nearest voxel of either the
+/// world or the voxels outside the active group
+double SelfCollisionModelImpl::voxelsDistance(
+    const CollisionSphereState& s) const
+{
+    double d = SphereCollisionDistance(*m_grid, s, m_padding);
+    const OccupancyGrid* voxels_grid = voxelsGrid();
+    if (voxels_grid) {
+        d = std::min(d, SphereCollisionDistance(*voxels_grid, s, m_padding));
+    }
+    return d;
 }
 
 double SelfCollisionModelImpl::sphereDistance(
@@ -1653,16 +2427,26 @@ bool SelfCollisionModelImpl::getRobotVoxelsStateCollisionDetails(
 {
     const size_t old_size = details.details.size();
 
+    const OccupancyGrid* voxels_grid = voxelsGrid();
+
     for (const int ssidx : m_rcs.groupSpheresStateIndices(m_gidx)) {
         auto& q = m_vq;
-        q.clear();
 
         const auto& ss = m_rcs.spheresState(ssidx);
         const CollisionSphereState* s = ss.spheres.root();
-        q.push_back(s);
 
         double dist;
-        if (!CheckVoxelsCollisions(m_rcs, q, *m_grid, m_padding, dist)) {
+        bool valid = true;
+        for (const OccupancyGrid* grid : { (const OccupancyGrid*)m_grid, voxels_grid }) {
+            if (!grid || !valid) {
+                continue;
+            }
+            q.clear();
+            q.push_back(s);
+            valid = CheckVoxelsCollisions(m_rcs, q, *grid, m_padding, dist);
+        }
+
+        if (!valid) {
             CollisionDetail detail;
             detail.first_link = m_rcs.model()->linkName(ss.model->link_index);
             detail.second_link = "_voxels_";
@@ -1715,11 +2499,11 @@ bool SelfCollisionModelImpl::getRobotSpheresStateCollisionDetails(
 }
 
 bool SelfCollisionModelImpl::getRobotSpheresStateCollisionDetails(
-    const AllowedCollisionsInterface& aci,
+    const PairBitMatrix& allowed,
     CollisionDetails& details)
 {
     double dist;
-    if (!checkRobotSpheresStateCollisions(aci, dist)) {
+    if (!checkRobotSpheresStateCollisions(allowed, dist)) {
         ++details.sphere_collision_count;
         return false;
     }
@@ -1738,11 +2522,11 @@ bool SelfCollisionModelImpl::getAttachedBodySpheresStateCollisionDetails(
 }
 
 bool SelfCollisionModelImpl::getAttachedBodySpheresStateCollisionDetails(
-    const AllowedCollisionsInterface& aci,
+    const PairBitMatrix& allowed,
     CollisionDetails& details)
 {
     double dist;
-    if (!checkAttachedBodySpheresStateCollisions(aci, dist)) {
+    if (!checkAttachedBodySpheresStateCollisions(allowed, dist)) {
         ++details.sphere_collision_count;
         return false;
     }
@@ -1756,7 +2540,7 @@ bool SelfCollisionModelImpl::getRobotAttachedBodySpheresStateCollisionDetails(
 }
 
 bool SelfCollisionModelImpl::getRobotAttachedBodySpheresStateCollisionDetails(
-    const AllowedCollisionsInterface& aci,
+    const PairBitMatrix& allowed,
     CollisionDetails& details)
 {
     return false;
@@ -1775,6 +2559,15 @@ SelfCollisionModel::SelfCollisionModel(
 {
 }
 
+/// Construct a self collision model, for use by another thread, sharing the
+/// collision models and occupancy grid of another model and copying its
+/// allowed collision matrix and padding. The new model is prepared to check
+/// collisions for group gidx.
+SelfCollisionModel::SelfCollisionModel(SelfCollisionModel& base, int gidx) :
+    m_impl(new SelfCollisionModelImpl(*base.m_impl, gidx))
+{
+}
+
 SelfCollisionModel::~SelfCollisionModel()
 {
 }
@@ -1796,11 +2589,31 @@ void SelfCollisionModel::setAllowedCollisionMatrix(
     return m_impl->setAllowedCollisionMatrix(acm);
 }
 
+double SelfCollisionModel::padding() const
+{
+    return m_impl->padding();
+}
+
 void SelfCollisionModel::setPadding(double padding)
 {
     return m_impl->setPadding(padding);
 }
 
+/// Return the maximum number of fields of outside voxels kept for recently
+/// checked groups
+size_t SelfCollisionModel::voxelsFieldCapacity() const
+{
+    return m_impl->voxelsFieldCapacity();
+}
+
+/// Set the maximum number of fields of outside voxels kept for recently checked
+/// groups. Switching to a group with a field is cheap; each field is a distance
+/// map with the bounds of the world occupancy grid.
+void SelfCollisionModel::setVoxelsFieldCapacity(size_t capacity)
+{
+    return m_impl->setVoxelsFieldCapacity(capacity);
+}
+
 void SelfCollisionModel::setWorldToModelTransform(const Eigen::Affine3d& transform)
 {
     return m_impl->setWorldToModelTransform(transform);
@@ -1837,6 +2650,22 @@ bool SelfCollisionModel::checkMotionCollision(
     return m_impl->checkMotionCollision(state, ab_state, rmcm, start, finish, gidx, dist);
 }
 
+/// Check a motion for collisions, returning the number of waypoints along the
+/// motion that were checked in num_checks
+bool SelfCollisionModel::checkMotionCollision(
+    RobotCollisionState& state,
+    AttachedBodiesCollisionState& ab_state,
+    const RobotMotionCollisionModel& rmcm,
+    const std::vector<double>& start,
+    const std::vector<double>& finish,
+    const int gidx,
+    int& num_checks,
+    double& dist)
+{
+    return m_impl->checkMotionCollision(
+            state, ab_state, rmcm, start, finish, gidx, num_checks, dist);
+}
+
 bool SelfCollisionModel::checkMotionCollision(
     RobotCollisionState& state,
     AttachedBodiesCollisionState& ab_state,
@@ -1850,6 +2679,14 @@ bool SelfCollisionModel::checkMotionCollision(
     return m_impl->checkMotionCollision(state, ab_state, aci, rmcm, start, finish, gidx, dist);
 }
 
+double SelfCollisionModel::motionClearance(
+    RobotCollisionState& state,
+    AttachedBodiesCollisionState& ab_state,
+    const int gidx)
+{
+    return m_impl->motionClearance(state, ab_state, gidx);
+}
+
 double SelfCollisionModel::collisionDistance(
     RobotCollisionState& state,
     AttachedBodiesCollisionState& ab_state,
@@ -47,7 +47,10 @@ WorldCollisionDetector::WorldCollisionDetector(
 :
     m_rcm(rcm),
     m_wcm(wcm),
-    m_vq()
+    m_vq(),
+    m_order(),
+    m_narrow(),
+    m_motion_failures()
 {
 }
 
@@ -81,6 +84,70 @@ bool WorldCollisionDetector::checkCollision(
             checkAttachedBodySpheresStateCollisions(ab_state, gidx, dist);
 }
 
+/// Return whether the root spheres of a group are clear of obstacles. Spheres
+/// deeper in the hierarchy need not be checked if this holds.
+template <typename StateType>
+static bool RootSpheresClear(
+    StateType& state,
+    int gidx,
+    const OccupancyGrid& grid,
+    double padding)
+{
+    for (const int ssidx : state.groupSpheresStateIndices(gidx)) {
+        const auto& ss = state.spheresState(ssidx);
+        const CollisionSphereState* s = ss.spheres.root();
+        state.updateSphereState(SphereIndex(ssidx, s->index()));
+        double dist;
+        if (!CheckSphereCollision(grid, *s, padding, dist)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Check the waypoints of a motion in two passes. The first pass tests only
+/// the root spheres at every waypoint, and the second pass runs the full check
+/// at the waypoints whose root spheres touch an obstacle. Both passes visit the
+/// waypoints in the order given by MakeWaypointCheckOrder().
+template <typename RootsClearFn, typename CheckFn>
+static bool CheckMotionWaypoints(
+    RobotCollisionState& state,
+    const MotionInterpolation& interp,
+    const std::vector<double>& start,
+    MotionFailureMemory& failures,
+    std::vector<int>& order,
+    std::vector<int>& narrow,
+    const RootsClearFn& roots_clear,
+    const CheckFn& check,
+    double& dist)
+{
+    const int waypoint_count = interp.waypointCount();
+    MakeWaypointCheckOrder(
+            waypoint_count, failures.waypoint(start, waypoint_count), order);
+
+    motion::RobotState interm;
+
+    narrow.clear();
+    for (const int i : order) {
+        interp.interpolate(i, interm);
+        state.setJointVarPositions(interm.data());
+        if (!roots_clear()) {
+            narrow.push_back(i);
+        }
+    }
+
+    for (const int i : narrow) {
+        interp.interpolate(i, interm);
+        state.setJointVarPositions(interm.data());
+        if (!check(dist)) {
+            failures.record(start, i, waypoint_count);
+            return false;
+        }
+    }
+
+    return true;
+}
+
 bool WorldCollisionDetector::checkMotionCollision(
     RobotCollisionState& state,
     const RobotMotionCollisionModel& rmcm,
@@ -89,19 +156,26 @@ bool WorldCollisionDetector::checkMotionCollision(
     const int gidx,
     double& dist) const
 {
+    if (gidx < 0 || gidx >= state.model()->groupCount()) {
+        ROS_ERROR_NAMED(WCM_LOGGER, "World Collision Check is for non-existent group");
+        return false;
+    }
+
     const double res = 0.05;
     MotionInterpolation interp(m_rcm);
     rmcm.fillMotionInterpolation(start, finish, res, interp);
 
-    motion::RobotState interm;
-    for (int i = 0; i < interp.waypointCount(); ++i) {
-        interp.interpolate(i, interm);
-        state.setJointVarPositions(interm.data());
-        if (!checkCollision(state, gidx, dist)) {
-            return false;
-        }
-    }
-    return true;
+    const OccupancyGrid& grid = *m_wcm->grid();
+    const double padding = m_wcm->padding();
+    return CheckMotionWaypoints(
+            state, interp, start, m_motion_failures, m_order, m_narrow,
+            [&]() {
+                return RootSpheresClear(state, gidx, grid, padding);
+            },
+            [&](double& d) {
+                return checkRobotSpheresStateCollisions(state, gidx, d);
+            },
+            dist);
 }
 
 bool WorldCollisionDetector::checkMotionCollision(
@@ -113,19 +187,30 @@ bool WorldCollisionDetector::checkMotionCollision(
     const int gidx,
     double& dist) const
 {
+    if (gidx < 0 || gidx >= state.model()->groupCount() ||
+        gidx >= ab_state.model()->groupCount())
+    {
+        ROS_ERROR_NAMED(WCM_LOGGER, "World Collision Check is for non-existent group");
+        return false;
+    }
+
     const double res = 0.05;
     MotionInterpolation interp(m_rcm);
     rmcm.fillMotionInterpolation(start, finish, res, interp);
 
-    motion::RobotState interm;
-    for (int i = 0; i < interp.waypointCount(); ++i) {
-        interp.interpolate(i, interm);
-        state.setJointVarPositions(interm.data());
-        if (!checkCollision(state, ab_state, gidx, dist)) {
-            return false;
-        }
-    }
-    return true;
+    const OccupancyGrid& grid = *m_wcm->grid();
+    const double padding = m_wcm->padding();
+    return CheckMotionWaypoints(
+            state, interp, start, m_motion_failures, m_order, m_narrow,
+            [&]() {
+                return RootSpheresClear(state, gidx, grid, padding) &&
+                        RootSpheresClear(ab_state, gidx, grid, padding);
+            },
+            [&](double& d) {
+                return checkRobotSpheresStateCollisions(state, gidx, d) &&
+                        checkAttachedBodySpheresStateCollisions(ab_state, gidx, d);
+            },
+            dist);
 }
 
 /// logical const, but not thread-safe, since it makes use of an internal
@@ -34,6 +34,7 @@
 #define SMPL_COLLISION_CHECKER_H
 
 // standard includes
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -123,6 +124,17 @@ public:
         const RobotState& finish) = 0;
 };
 
+class CollisionVersionExtension : public virtual Extension
+{
+public:
+
+    /// Return a value that changes whenever a change to the collision
+    /// checker's scene or configuration may change the result of a check,
+    /// including changes that are not made through an occupancy grid, such as
+    /// attaching objects or modifying the allowed collisions.
+    virtual std::uint64_t collisionVersion() = 0;
+};
+
 } // namespace motion
 } // namespace sbpl
 
@@ -0,0 +1,177 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_HASH_INDEX_HPP
+#define SMPL_HASH_INDEX_HPP
+
+#include "../hash_index.h"
+
+namespace sbpl {
+
+template <class Key, class Hash, class KeyEqual>
+HashIndex<Key, Hash, KeyEqual>::HashIndex(
+    const hasher& hash,
+    const key_equal& equal)
+:
+    m_entries(),
+    m_size(0),
+    m_hash(hash),
+    m_equal(equal)
+{
+}
+
+template <class Key, class Hash, class KeyEqual>
+int HashIndex<Key, Hash, KeyEqual>::find(const Key& key) const
+{
+    if (m_entries.empty()) {
+        return -1;
+    }
+    return m_entries[probe(key, mix(m_hash(key)))].id;
+}
+
+template <class Key, class Hash, class KeyEqual>
+int HashIndex<Key, Hash, KeyEqual>::insert(const Key* key, int id)
+{
+    const std::size_t hash = mix(m_hash(*key));
+    if (!m_entries.empty()) {
+        const Entry& e = m_entries[probe(*key, hash)];
+        if (e.id >= 0) {
+            return e.id;
+        }
+    }
+
+    // only grow the table for new keys
+    if (2 * (m_size + 1) > m_entries.size()) {
+        rehash(m_entries.empty() ? 64 : 2 * m_entries.size());
+    }
+
+    Entry& e = m_entries[probe(*key, hash)];
+    e.hash = hash;
+    e.key = key;
+    e.id = id;
+    ++m_size;
+    return id;
+}
+
+template <class Key, class Hash, class KeyEqual>
+bool HashIndex<Key, Hash, KeyEqual>::empty() const
+{
+    return m_size == 0;
+}
+
+template <class Key, class Hash, class KeyEqual>
+auto HashIndex<Key, Hash, KeyEqual>::size() const -> size_type
+{
+    return m_size;
+}
+
+template <class Key, class Hash, class KeyEqual>
+auto HashIndex<Key, Hash, KeyEqual>::bucket_count() const -> size_type
+{
+    return m_entries.size();
+}
+
+template <class Key, class Hash, class KeyEqual>
+void HashIndex<Key, Hash, KeyEqual>::reserve(size_type count)
+{
+    size_type buckets = m_entries.empty() ? 64 : m_entries.size();
+    while (buckets < 2 * count) {
+        buckets *= 2;
+    }
+    if (buckets != m_entries.size()) {
+        rehash(buckets);
+    }
+}
+
+template <class Key, class Hash, class KeyEqual>
+void HashIndex<Key, Hash, KeyEqual>::clear()
+{
+    for (Entry& e : m_entries) {
+        e.id = -1;
+    }
+    m_size = 0;
+}
+
+/// Scramble the bits of a user-provided hash value. Hash functions for integer
+/// coordinates tend to leave entropy in the high bits, which would otherwise
+/// be discarded when masking to the table size.
+template <class Key, class Hash, class KeyEqual>
+std::size_t HashIndex<Key, Hash, KeyEqual>::mix(std::size_t h)
+{
+    std::uint64_t k = h;
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return (std::size_t)k;
+}
+
+/// Return the index of the entry containing a key equal to \p key, or the
+/// index of the empty entry where it would be inserted.
+template <class Key, class Hash, class KeyEqual>
+auto HashIndex<Key, Hash, KeyEqual>::probe(
+    const Key& key,
+    std::size_t hash) const -> size_type
+{
+    const size_type mask = m_entries.size() - 1;
+    size_type i = hash & mask;
+    while (true) {
+        const Entry& e = m_entries[i];
+        if (e.id < 0 || (e.hash == hash && m_equal(*e.key, key))) {
+            return i;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+template <class Key, class Hash, class KeyEqual>
+void HashIndex<Key, Hash, KeyEqual>::rehash(size_type bucket_count)
+{
+    std::vector<Entry> entries(bucket_count, Entry{ 0, nullptr, -1 });
+    entries.swap(m_entries);
+
+    const size_type mask = m_entries.size() - 1;
+    for (const Entry& e : entries) {
+        if (e.id < 0) {
+            continue;
+        }
+        size_type i = e.hash & mask;
+        while (m_entries[i].id >= 0) {
+            i = (i + 1) & mask;
+        }
+        m_entries[i] = e;
+    }
+}
+
+} // namespace sbpl
+
+#endif
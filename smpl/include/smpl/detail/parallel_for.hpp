@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_PARALLEL_FOR_HPP
+#define SMPL_PARALLEL_FOR_HPP
+
+#include "../parallel_for.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace sbpl {
+
+template <class Function>
+void ParallelFor(
+    std::size_t first,
+    std::size_t last,
+    int thread_count,
+    Function f)
+{
+    if (last <= first) {
+        return;
+    }
+
+    const std::size_t count = last - first;
+    const std::size_t chunk_count =
+            std::min(count, (std::size_t)std::max(thread_count, 1));
+
+    auto run_chunk = [&](std::size_t c) {
+        const std::size_t begin = first + count * c / chunk_count;
+        const std::size_t end = first + count * (c + 1) / chunk_count;
+        for (std::size_t i = begin; i != end; ++i) {
+            f(i);
+        }
+    };
+
+    if (chunk_count == 1) {
+        run_chunk(0);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(chunk_count - 1);
+    for (std::size_t c = 1; c < chunk_count; ++c) {
+        threads.emplace_back(run_chunk, c);
+    }
+    run_chunk(0);
+    for (std::thread& t : threads) {
+        t.join();
+    }
+}
+
+} // namespace sbpl
+
+#endif
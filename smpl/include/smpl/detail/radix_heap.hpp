@@ -0,0 +1,123 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_RADIX_HEAP_HPP
+#define SMPL_RADIX_HEAP_HPP
+
+#include "../radix_heap.h"
+
+#include <assert.h>
+#include <limits>
+
+namespace sbpl {
+
+template <class T>
+RadixHeap<T>::RadixHeap() :
+    m_buckets(),
+    m_last(0),
+    m_size(0)
+{
+}
+
+template <class T>
+bool RadixHeap<T>::empty() const
+{
+    return m_size == 0;
+}
+
+template <class T>
+auto RadixHeap<T>::size() const -> size_type
+{
+    return m_size;
+}
+
+template <class T>
+void RadixHeap<T>::push(key_type key, const T& value)
+{
+    assert(key >= m_last);
+    m_buckets[bucketIndex(key, m_last)].emplace_back(key, value);
+    ++m_size;
+}
+
+template <class T>
+void RadixHeap<T>::pop(key_type& key, T& value)
+{
+    assert(!empty());
+
+    if (m_buckets[0].empty()) {
+        // find the first non-empty bucket and redistribute its elements
+        // relative to its minimum key, which places at least that element in
+        // the first bucket
+        int b = 1;
+        while (m_buckets[b].empty()) {
+            ++b;
+        }
+
+        key_type min_key = std::numeric_limits<key_type>::max();
+        for (const auto& e : m_buckets[b]) {
+            if (e.first < min_key) {
+                min_key = e.first;
+            }
+        }
+
+        m_last = min_key;
+        for (auto& e : m_buckets[b]) {
+            m_buckets[bucketIndex(e.first, m_last)].push_back(std::move(e));
+        }
+        m_buckets[b].clear();
+    }
+
+    key = m_buckets[0].back().first;
+    value = std::move(m_buckets[0].back().second);
+    m_buckets[0].pop_back();
+    --m_size;
+}
+
+template <class T>
+void RadixHeap<T>::clear()
+{
+    for (auto& bucket : m_buckets) {
+        bucket.clear();
+    }
+    m_last = 0;
+    m_size = 0;
+}
+
+template <class T>
+int RadixHeap<T>::bucketIndex(key_type key, key_type last)
+{
+    const key_type diff = key ^ last;
+    return diff == 0 ? 0 : 32 - __builtin_clz(diff);
+}
+
+} // namespace sbpl
+
+#endif
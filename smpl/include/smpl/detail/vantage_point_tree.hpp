@@ -0,0 +1,239 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_VANTAGE_POINT_TREE_HPP
+#define SMPL_VANTAGE_POINT_TREE_HPP
+
+#include "../vantage_point_tree.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace sbpl {
+
+template <class T, class Distance>
+VantagePointTree<T, Distance>::VantagePointTree(
+    const distance_function& dist,
+    double tolerance,
+    size_type leaf_size)
+:
+    m_dist(dist),
+    m_tolerance(tolerance),
+    m_leaf_size(std::max(leaf_size, (size_type)1)),
+    m_nodes(),
+    m_size(0)
+{
+}
+
+template <class T, class Distance>
+template <class InputIt>
+void VantagePointTree<T, Distance>::build(InputIt first, InputIt last)
+{
+    clear();
+    std::vector<T> values(first, last);
+    m_size = values.size();
+    makeNode(createNode(), std::move(values));
+}
+
+template <class T, class Distance>
+void VantagePointTree<T, Distance>::insert(const T& value)
+{
+    if (m_nodes.empty()) {
+        makeNode(createNode(), std::vector<T>());
+    }
+
+    int nidx = 0;
+    while (!m_nodes[nidx].leaf()) {
+        const Node& n = m_nodes[nidx];
+        nidx = m_dist(n.vantage, value) < n.mu ? n.inside : n.outside;
+    }
+
+    m_nodes[nidx].bucket.push_back(value);
+    ++m_size;
+
+    if (m_nodes[nidx].bucket.size() > m_nodes[nidx].split_size) {
+        std::vector<T> values;
+        values.swap(m_nodes[nidx].bucket);
+        makeNode(nidx, std::move(values));
+    }
+}
+
+template <class T, class Distance>
+template <class OutputIt>
+OutputIt VantagePointTree<T, Distance>::within(
+    const T& query,
+    double radius,
+    OutputIt out) const
+{
+    if (m_nodes.empty()) {
+        return out;
+    }
+
+    std::vector<int> open;
+    open.push_back(0);
+    while (!open.empty()) {
+        const Node& n = m_nodes[open.back()];
+        open.pop_back();
+
+        if (n.leaf()) {
+            for (const T& value : n.bucket) {
+                if (m_dist(query, value) <= radius) {
+                    *out++ = value;
+                }
+            }
+            continue;
+        }
+
+        const double d = m_dist(query, n.vantage);
+        if (d <= radius) {
+            *out++ = n.vantage;
+        }
+
+        // by the triangle inequality, elements within the radius lie in
+        // [d - radius, d + radius] of the vantage element
+        if (d - radius - m_tolerance < n.mu) {
+            open.push_back(n.inside);
+        }
+        if (d + radius + m_tolerance >= n.mu) {
+            open.push_back(n.outside);
+        }
+    }
+
+    return out;
+}
+
+template <class T, class Distance>
+bool VantagePointTree<T, Distance>::empty() const
+{
+    return m_size == 0;
+}
+
+template <class T, class Distance>
+auto VantagePointTree<T, Distance>::size() const -> size_type
+{
+    return m_size;
+}
+
+template <class T, class Distance>
+void VantagePointTree<T, Distance>::clear()
+{
+    m_nodes.clear();
+    m_size = 0;
+}
+
+template <class T, class Distance>
+int VantagePointTree<T, Distance>::createNode()
+{
+    m_nodes.emplace_back();
+    Node& n = m_nodes.back();
+    n.mu = 0.0;
+    n.inside = -1;
+    n.outside = -1;
+    n.split_size = m_leaf_size;
+    return (int)m_nodes.size() - 1;
+}
+
+template <class T, class Distance>
+void VantagePointTree<T, Distance>::makeNode(int nidx, std::vector<T>&& values)
+{
+    if (values.size() > m_leaf_size) {
+        const T vantage = values.back();
+
+        std::vector<std::pair<double, T>> dists;
+        dists.reserve(values.size() - 1);
+        for (size_type i = 0; i < values.size() - 1; ++i) {
+            dists.emplace_back(m_dist(vantage, values[i]), values[i]);
+        }
+
+        auto by_dist = [](
+            const std::pair<double, T>& a,
+            const std::pair<double, T>& b)
+        {
+            return a.first < b.first;
+        };
+
+        auto mid = dists.begin() + dists.size() / 2;
+        std::nth_element(dists.begin(), mid, dists.end(), by_dist);
+        double mu = mid->first;
+
+        // if the lower half of the elements are all at the median distance,
+        // split at the next greater distance instead
+        if (std::none_of(dists.begin(), dists.end(),
+                [mu](const std::pair<double, T>& p) { return p.first < mu; }))
+        {
+            double next = std::numeric_limits<double>::infinity();
+            for (const auto& p : dists) {
+                if (p.first > mu && p.first < next) {
+                    next = p.first;
+                }
+            }
+            mu = next;
+        }
+
+        std::vector<T> inside;
+        std::vector<T> outside;
+        for (const auto& p : dists) {
+            if (p.first < mu) {
+                inside.push_back(p.second);
+            } else {
+                outside.push_back(p.second);
+            }
+        }
+
+        if (!inside.empty() && !outside.empty()) {
+            const int iidx = createNode();
+            const int oidx = createNode();
+            Node& n = m_nodes[nidx];
+            n.vantage = vantage;
+            n.mu = mu;
+            n.inside = iidx;
+            n.outside = oidx;
+            n.bucket = std::vector<T>();
+            makeNode(iidx, std::move(inside));
+            makeNode(oidx, std::move(outside));
+            return;
+        }
+
+        // all elements are equidistant from the vantage element; defer
+        // splitting this leaf until it has grown substantially
+        m_nodes[nidx].split_size = 2 * values.size();
+    }
+
+    Node& n = m_nodes[nidx];
+    n.inside = -1;
+    n.outside = -1;
+    n.bucket = std::move(values);
+}
+
+} // namespace sbpl
+
+#endif
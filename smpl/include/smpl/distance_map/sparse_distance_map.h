@@ -42,7 +42,7 @@
 #include <Eigen/StdVector>
 
 // project includes
-#include <smpl/grid/sparse_grid.h>
+#include <smpl/grid/block_sparse_grid.h>
 #include <smpl/distance_map/distance_map_interface.h>
 #include "detail/distance_map_common.h"
 
@@ -119,7 +119,7 @@ public:
 
         int pos;
 
-        // NOTE: vacuous true here for interoperability with SparseGrid::prune.
+        // NOTE: vacuous true here for interoperability with BlockSparseGrid::prune.
         // This shouldn't be used to do unconditional pruning, but should be
         // used in conjunction with conditional pruning to remove cells with
         // unknown nearest obstacles, and which must not be referred to by any
@@ -127,7 +127,7 @@ public:
         bool operator==(const Cell& rhs) const { return true; }
     };
 
-    SparseGrid<Cell> m_cells;
+    BlockSparseGrid<Cell> m_cells;
 
     int m_cell_count_x;
     int m_cell_count_y;
@@ -0,0 +1,224 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_FIXED_VECTOR_H
+#define SMPL_FIXED_VECTOR_H
+
+// standard includes
+#include <assert.h>
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+namespace sbpl {
+
+/// A sequence container with a compile-time capacity whose elements are stored
+/// inline with the container. The interface mirrors the subset of std::vector
+/// required to use it as a drop-in replacement for short, bounded-length
+/// sequences (such as discrete state coordinates), without incurring a heap
+/// allocation per instance.
+///
+/// Elements beyond size() are value-initialized storage; resizing never
+/// reallocates and growing beyond the capacity is a logic error.
+template <class T, std::size_t N>
+class FixedVector
+{
+public:
+
+    typedef T                   value_type;
+    typedef std::size_t         size_type;
+    typedef T&                  reference;
+    typedef const T&            const_reference;
+    typedef T*                  pointer;
+    typedef const T*            const_pointer;
+    typedef T*                  iterator;
+    typedef const T*            const_iterator;
+
+    FixedVector() : m_size(0), m_data() { }
+
+    explicit FixedVector(size_type count, const T& value = T()) :
+        m_size(0), m_data()
+    {
+        assign(count, value);
+    }
+
+    template <
+        class InputIt,
+        class = typename std::enable_if<std::is_convertible<
+                typename std::iterator_traits<InputIt>::iterator_category,
+                std::input_iterator_tag>::value>::type>
+    FixedVector(InputIt first, InputIt last) : m_size(0), m_data()
+    {
+        assign(first, last);
+    }
+
+    FixedVector(std::initializer_list<T> init) : m_size(0), m_data()
+    {
+        assign(init.begin(), init.end());
+    }
+
+    void assign(size_type count, const T& value)
+    {
+        assert(count <= N);
+        std::fill(m_data, m_data + count, value);
+        m_size = count;
+    }
+
+    template <
+        class InputIt,
+        class = typename std::enable_if<std::is_convertible<
+                typename std::iterator_traits<InputIt>::iterator_category,
+                std::input_iterator_tag>::value>::type>
+    void assign(InputIt first, InputIt last)
+    {
+        m_size = 0;
+        for (; first != last; ++first) {
+            push_back(*first);
+        }
+    }
+
+    reference operator[](size_type pos) { return m_data[pos]; }
+    const_reference operator[](size_type pos) const { return m_data[pos]; }
+
+    reference front() { return m_data[0]; }
+    const_reference front() const { return m_data[0]; }
+    reference back() { return m_data[m_size - 1]; }
+    const_reference back() const { return m_data[m_size - 1]; }
+
+    pointer data() { return m_data; }
+    const_pointer data() const { return m_data; }
+
+    iterator begin() { return m_data; }
+    const_iterator begin() const { return m_data; }
+    iterator end() { return m_data + m_size; }
+    const_iterator end() const { return m_data + m_size; }
+
+    bool empty() const { return m_size == 0; }
+    size_type size() const { return m_size; }
+    static constexpr size_type capacity() { return N; }
+    static constexpr size_type max_size() { return N; }
+
+    void clear() { m_size = 0; }
+
+    void push_back(const T& value)
+    {
+        assert(m_size < N);
+        m_data[m_size++] = value;
+    }
+
+    void pop_back() { --m_size; }
+
+    void resize(size_type count, const T& value = T())
+    {
+        assert(count <= N);
+        if (count > m_size) {
+            std::fill(m_data + m_size, m_data + count, value);
+        }
+        m_size = count;
+    }
+
+private:
+
+    size_type m_size;
+    T m_data[N];
+};
+
+template <class T, std::size_t N>
+bool operator==(const FixedVector<T, N>& lhs, const FixedVector<T, N>& rhs)
+{
+    return lhs.size() == rhs.size() &&
+            std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class T, std::size_t N>
+bool operator!=(const FixedVector<T, N>& lhs, const FixedVector<T, N>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+template <class T, std::size_t N>
+bool operator<(const FixedVector<T, N>& lhs, const FixedVector<T, N>& rhs)
+{
+    return std::lexicographical_compare(
+            lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <class T, std::size_t N>
+std::ostream& operator<<(std::ostream& o, const FixedVector<T, N>& v)
+{
+    o << '[';
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        o << v[i];
+        if (i != v.size() - 1) {
+            o << ", ";
+        }
+    }
+    o << ']';
+    return o;
+}
+
+template <class T, std::size_t N>
+std::string to_string(const FixedVector<T, N>& v)
+{
+    std::stringstream ss;
+    ss << v;
+    return ss.str();
+}
+
+} // namespace sbpl
+
+namespace std {
+
+template <class T, std::size_t N>
+struct hash<sbpl::FixedVector<T, N>>
+{
+    typedef sbpl::FixedVector<T, N> argument_type;
+    typedef std::size_t result_type;
+
+    result_type operator()(const argument_type& v) const
+    {
+        std::size_t seed = 0;
+        for (const T& e : v) {
+            seed ^= std::hash<T>()(e) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        }
+        return seed;
+    }
+};
+
+} // namespace std
+
+#endif
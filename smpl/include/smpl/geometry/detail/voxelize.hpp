@@ -30,24 +30,24 @@
 #ifndef SMPL_VOXELIZE_HPP
 #define SMPL_VOXELIZE_HPP
 
+// standard includes
+#include <algorithm>
+#include <cmath>
+
+// project includes
 #include <smpl/geometry/utils.h>
 
 namespace sbpl {
 namespace geometry {
 
-/// \brief Voxelize a triangle
-///
-/// Based on the algorithm described in:
-///
-/// 'Huang, Yagel, Filippov, and Kurzion, "An Accurate Method for Voxelizing
-/// Polygon Meshes," IEEE Volume Visualization '98, October, 1998, Chapel Hill,
-/// North Carolina, USA, pp. 119-126'
-template <typename Discretizer>
-void VoxelizeTriangle(
+namespace detail {
+
+inline
+bool ThickTriangle::init(
     const Eigen::Vector3d& a,
     const Eigen::Vector3d& b,
     const Eigen::Vector3d& c,
-    VoxelGrid<Discretizer>& vg)
+    double res)
 {
     Eigen::Vector3d p1 = a;
     Eigen::Vector3d p2 = b;
@@ -56,7 +56,7 @@ void VoxelizeTriangle(
     // check for colinearity and counterclockwiseness
     double det = ((p2 - p1).cross(p3 - p1).norm());
     if (det == 0) {
-        return;
+        return false;
     }
 
     // ensure p1, p2, p3 ccw
@@ -66,15 +66,14 @@ void VoxelizeTriangle(
 
     // thickness parameters
 
-    double rc = sqrt(3.0) * 0.5 * vg.res().x();
-//    double rc = sqrt(3.0) * 0.5 * vg.res().x();
-    double rc2 = rc * rc;
+    double rc = sqrt(3.0) * 0.5 * res;
+    rc2 = rc * rc;
 
     // get the normal vector for the triangle
     Eigen::Vector3d u = p2 - p1;
     Eigen::Vector3d v = p3 - p2;
     Eigen::Vector3d w = p1 - p3;
-    Eigen::Vector3d n = u.cross(v);
+    n = u.cross(v);
     n.normalize();
 
     double ca = 1.0;
@@ -90,27 +89,86 @@ void VoxelizeTriangle(
     };
     ca = *std::max_element(corners, corners + sizeof(corners) / sizeof(double));
 
-    double t = rc * ca;
+    t = rc * ca;
 
     // get the distance from the origin for the triangle plane
-    double d = -n.dot(p1);
+    d = -n.dot(p1);
 
     // normal to the edge p2 - p1 pointing inwards
-    Eigen::Vector3d e1 = -u.cross(n);
-    e1.normalize();
+    e[0] = -u.cross(n);
+    e[0].normalize();
 
     // normal to the edge p3 - p2 pointing inwards
-    Eigen::Vector3d e2 = -v.cross(n);
-    e2.normalize();
+    e[1] = -v.cross(n);
+    e[1].normalize();
 
     // normal to the edge p1 - p3 pointing inwards
-    Eigen::Vector3d e3 = -w.cross(n);
-    e3.normalize();
+    e[2] = -w.cross(n);
+    e[2].normalize();
 
     // distances of the edge-guard planes from the origin
-    double d1 = -e1.dot(p1);
-    double d2 = -e2.dot(p2);
-    double d3 = -e3.dot(p3);
+    ed[0] = -e[0].dot(p1);
+    ed[1] = -e[1].dot(p2);
+    ed[2] = -e[2].dot(p3);
+
+    p[0] = p1;
+    p[1] = p2;
+    p[2] = p3;
+    return true;
+}
+
+inline
+bool ThickTriangle::inVertexRegion(int i, const Eigen::Vector3d& x) const
+{
+    return (x - p[i]).squaredNorm() <= rc2;
+}
+
+inline
+bool ThickTriangle::inEdgeRegion(int i, const Eigen::Vector3d& x) const
+{
+    return Distance(edgeStart(i), edgeEnd(i), rc2, x) != -1.0;
+}
+
+inline
+bool ThickTriangle::inFaceRegion(const Eigen::Vector3d& x) const
+{
+    return
+            // inside triangle thickness
+            utils::sign(n.dot(x) + (d + t)) != utils::sign(n.dot(x) + (d - t)) &&
+            // inside the edge bounding planes
+            (e[0].dot(x) + ed[0] > 0.0) &&
+            (e[1].dot(x) + ed[1] > 0.0) &&
+            (e[2].dot(x) + ed[2] > 0.0);
+}
+
+inline
+bool ThickTriangle::contains(const Eigen::Vector3d& x) const
+{
+    return inVertexRegion(0, x) || inVertexRegion(1, x) || inVertexRegion(2, x) ||
+            inEdgeRegion(0, x) || inEdgeRegion(1, x) || inEdgeRegion(2, x) ||
+            inFaceRegion(x);
+}
+
+} // namespace detail
+
+/// \brief Voxelize a triangle
+///
+/// Based on the algorithm described in:
+///
+/// 'Huang, Yagel, Filippov, and Kurzion, "An Accurate Method for Voxelizing
+/// Polygon Meshes," IEEE Volume Visualization '98, October, 1998, Chapel Hill,
+/// North Carolina, USA, pp. 119-126'
+template <typename Discretizer>
+void VoxelizeTriangle(
+    const Eigen::Vector3d& a,
+    const Eigen::Vector3d& b,
+    const Eigen::Vector3d& c,
+    VoxelGrid<Discretizer>& vg)
+{
+    detail::ThickTriangle tri;
+    if (!tri.init(a, b, c, vg.res().x())) {
+        return;
+    }
 
     Eigen::Vector3d mintri;
     Eigen::Vector3d maxtri;
@@ -134,46 +192,12 @@ void VoxelizeTriangle(
 
                 // TODO: shortcut based off of distance to triangle plane?
 
-                // check if the voxel point is in the plane of the triangle and
-                // within the edges
+                // check if the voxel point is near a vertex or edge, or in the
+                // plane of the triangle and within the edges
                 const Eigen::Vector3d voxel_p(wc.x, wc.y, wc.z);
-
-                Eigen::Vector3d dx1 = voxel_p - p1;
-                Eigen::Vector3d dx2 = voxel_p - p2;
-                Eigen::Vector3d dx3 = voxel_p - p3;
-
-                if (dx1.squaredNorm() <= rc2 ||
-                    dx2.squaredNorm() <= rc2 ||
-                    dx3.squaredNorm() <= rc2)
-                {
-                    // vertex fills this voxel
+                if (tri.contains(voxel_p)) {
                     vg[gc] = 1;
                 }
-                else if (Distance(p1, p3, rc2, voxel_p) != -1.0 ||
-                         Distance(p2, p3, rc2, voxel_p) != -1.0 ||
-                         Distance(p3, p1, rc2, voxel_p) != -1.0)
-                {
-                    // edge fills this voxel
-                    vg[gc] = 1;
-                }
-                else {
-                    // then check for inside the triangle
-                    if ((
-                            // inside triangle thickness
-                            utils::sign(n.dot(voxel_p) + (d + t)) != utils::sign(n.dot(voxel_p) + (d - t))
-                        ) &&
-                        (
-                            // inside the edge bounding planes
-                            (
-                                (e1.dot(voxel_p) + d1 > 0.0) &&
-                                (e2.dot(voxel_p) + d2 > 0.0) &&
-                                (e3.dot(voxel_p) + d3 > 0.0)
-                            )
-                        ))
-                    {
-                        vg[gc] = 1;
-                    }
-                }
             }
         }
     }
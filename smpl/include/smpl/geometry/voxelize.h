@@ -246,6 +246,42 @@ double Distance(
     double radius_sqrd,
     const Eigen::Vector3d& x);
 
+namespace detail {
+
+/// \brief The thickened triangle used by VoxelizeTriangle to decide which
+///     voxels a triangle fills
+///
+/// A voxel is filled if its center lies in any of the vertex, edge, or face
+/// regions. The regions are exposed individually since each one is convex.
+struct ThickTriangle
+{
+    Eigen::Vector3d p[3];   ///< vertices, counterclockwise
+    Eigen::Vector3d n;      ///< unit normal of the triangle plane
+    Eigen::Vector3d e[3];   ///< inward normals of the edge-guard planes
+    double d;               ///< offset of the triangle plane
+    double ed[3];           ///< offsets of the edge-guard planes
+    double rc2;             ///< squared radius of the vertex and edge regions
+    double t;               ///< half-thickness of the face region
+
+    bool init(
+        const Eigen::Vector3d& a,
+        const Eigen::Vector3d& b,
+        const Eigen::Vector3d& c,
+        double res);
+
+    // The edge regions are those tested by the original voxelizer: (p1, p3),
+    // (p2, p3), and (p3, p1)
+    const Eigen::Vector3d& edgeStart(int i) const { return p[i]; }
+    const Eigen::Vector3d& edgeEnd(int i) const { return p[i == 2 ? 0 : 2]; }
+
+    bool inVertexRegion(int i, const Eigen::Vector3d& x) const;
+    bool inEdgeRegion(int i, const Eigen::Vector3d& x) const;
+    bool inFaceRegion(const Eigen::Vector3d& x) const;
+    bool contains(const Eigen::Vector3d& x) const;
+};
+
+} // namespace detail
+
 template <typename Discretizer>
 void VoxelizeTriangle(
     const Eigen::Vector3d& a,
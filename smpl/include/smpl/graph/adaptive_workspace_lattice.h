@@ -39,13 +39,16 @@
 #include <vector>
 
 // project includes
-#include <smpl/grid.h>
+#include <smpl/hash_index.h>
+#include <smpl/object_pool.h>
 #include <smpl/occupancy_grid.h>
 #include <smpl/time.h>
 #include <smpl/types.h>
 #include <smpl/graph/adaptive_graph_extension.h>
 #include <smpl/graph/motion_primitive.h>
 #include <smpl/graph/workspace_lattice_base.h>
+#include <smpl/grid/sparse_binary_grid.h>
+#include <smpl/grid/sparse_grid.h>
 
 namespace sbpl {
 namespace motion {
@@ -197,16 +200,15 @@ private:
     AdaptiveState* m_start_state;
     int m_start_state_id;
 
-    typedef AdaptiveWorkspaceState HiStateKey;
-    typedef PointerValueHash<HiStateKey> HiStateHash;
-    typedef PointerValueEqual<HiStateKey> HiStateEqual;
-    typedef AdaptiveGridState LoStateKey;
-    typedef PointerValueHash<LoStateKey> LoStateHash;
-    typedef PointerValueEqual<LoStateKey> LoStateEqual;
+    // state records, allocated in blocks
+    ObjectPool<AdaptiveWorkspaceState> m_hi_pool;
+    ObjectPool<AdaptiveGridState> m_lo_pool;
 
-    hash_map<HiStateKey*, int, HiStateHash, HiStateEqual> m_hi_to_id;
-    hash_map<LoStateKey*, int, LoStateHash, LoStateEqual> m_lo_to_id;
+    // maps state -> id
+    HashIndex<AdaptiveWorkspaceState> m_hi_to_id;
+    HashIndex<AdaptiveGridState> m_lo_to_id;
 
+    // maps id -> state
     std::vector<AdaptiveState*> m_states;
 
     clock::time_point m_t_start;
@@ -223,15 +225,14 @@ private:
 
     bool m_plan_mode;
 
-    struct AdaptiveGridCell
-    {
-        int grow_count;
-        bool plan_hd; //planning_hd;
-        bool trak_hd;
+    // number of times the high-dimensional region around a cell was grown
+    SparseGrid<int> m_grow_grid;
 
-        AdaptiveGridCell() : grow_count(0), plan_hd(false), trak_hd(false) { }
-    };
-    Grid3<AdaptiveGridCell> m_dim_grid;
+    // cells within the high-dimensional region during planning
+    SparseBinaryGrid<> m_plan_grid;
+
+    // cells within the high-dimensional tunnel during tracking
+    SparseBinaryGrid<> m_trak_grid;
 
     bool initMotionPrimitives();
 
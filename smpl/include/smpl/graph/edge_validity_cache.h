@@ -0,0 +1,122 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_EDGE_VALIDITY_CACHE_H
+#define SMPL_EDGE_VALIDITY_CACHE_H
+
+// standard includes
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace sbpl {
+namespace motion {
+
+/// Bounded cache of edge validity results.
+///
+/// Entries are keyed by the id of the parent state and the index of the action
+/// applied to it, and store whether the edge was found to be valid along with
+/// the clearance reported by the collision checker. Since the set of actions
+/// available from a state may change between queries, each entry also records
+/// a fingerprint of the action it was computed for; lookups with a different
+/// fingerprint are reported as misses. Each entry is tagged with the version
+/// of the world it was computed against; entries from other world versions are
+/// reported as misses and overwritten lazily, so no explicit invalidation is
+/// required when the world changes.
+///
+/// The cache is lock-free. Each slot is guarded by a sequence counter that
+/// writers claim before updating the slot's key and value; readers report a
+/// miss if the slot was modified while it was being read. An insertion into a
+/// slot that is concurrently being written is dropped.
+class EdgeValidityCache
+{
+public:
+
+    static const int ProbeCount = 4;
+
+    EdgeValidityCache(std::size_t capacity = 0);
+
+    std::size_t capacity() const { return m_size; }
+    void resize(std::size_t capacity);
+
+    void clear();
+
+    bool find(
+        int parent_id,
+        int action_index,
+        std::uint64_t action_id,
+        std::uint32_t version,
+        bool& valid,
+        double& dist) const;
+
+    void insert(
+        int parent_id,
+        int action_index,
+        std::uint64_t action_id,
+        std::uint32_t version,
+        bool valid,
+        double dist);
+
+    std::size_t hits() const { return m_hits.load(std::memory_order_relaxed); }
+    std::size_t misses() const { return m_misses.load(std::memory_order_relaxed); }
+
+private:
+
+    static const std::uint64_t EmptyKey = 0;
+    static const std::uint32_t VersionMask = 0x7FFFFFFF;
+    static const std::uint64_t ValidBit = 0x80000000;
+
+    struct Slot
+    {
+        std::atomic<std::uint32_t> seq;
+        std::atomic<std::uint64_t> key;
+        std::atomic<std::uint64_t> action;
+        std::atomic<std::uint64_t> value;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    std::size_t m_size;
+    std::size_t m_mask;
+
+    mutable std::atomic<std::size_t> m_hits;
+    mutable std::atomic<std::size_t> m_misses;
+
+    static std::uint64_t MakeKey(int parent_id, int action_index);
+    static std::uint64_t MakeValue(std::uint32_t version, bool valid, double dist);
+    static std::uint32_t ValueVersion(std::uint64_t value);
+
+    std::size_t homeSlot(std::uint64_t key) const;
+};
+
+} // namespace motion
+} // namespace sbpl
+
+#endif
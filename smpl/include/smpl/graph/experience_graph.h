@@ -33,6 +33,7 @@
 #define SMPL_EXPERIENCE_GRAPH_H
 
 // standard includes
+#include <cstdint>
 #include <cstdlib>
 #include <vector>
 
@@ -181,6 +182,12 @@ public:
 
     bool edge(node_id uid, node_id vid) const;
 
+    /// Return a version that changes whenever nodes or edges are inserted or
+    /// erased or a node state is accessed for modification. Versions are
+    /// unique across all experience graphs, so that a replaced experience graph
+    /// never matches the version of the graph it replaced.
+    std::uint64_t version() const { return m_version; }
+
     node_id insert_node(const RobotState& state);
     void erase_node(node_id id);
 
@@ -194,7 +201,7 @@ public:
     void erase_edge(edge_id id);
 
     const RobotState& state(node_id id) const { return m_nodes[id].state; }
-    RobotState& state(node_id id) { return m_nodes[id].state; }
+    RobotState& state(node_id id) { touch(); return m_nodes[id].state; }
 
     const std::vector<RobotState>& waypoints(edge_id id) const {
         return m_edges[id].waypoints;
@@ -212,9 +219,29 @@ private:
     // removal
     std::vector<std::ptrdiff_t> m_shift;
 
+    std::uint64_t m_version;
+
+    void touch();
     void insert_incident_edge(edge_id eid, node_id uid, node_id vid);
 };
 
+/// Label the connected components of an experience graph. Returns the number
+/// of components; component ids are in [0, count).
+int ComputeComponents(
+    const ExperienceGraph& eg,
+    std::vector<int>& component_ids);
+
+/// Update component labels, computed by ComputeComponents(), after nodes with
+/// ids at or after \p first_node and the edges \p edges have been inserted into
+/// the experience graph. Components joined by new edges are merged, which may
+/// leave unused component ids below the returned count.
+int UpdateComponents(
+    const ExperienceGraph& eg,
+    ExperienceGraph::node_id first_node,
+    const std::vector<ExperienceGraph::edge_id>& edges,
+    std::vector<int>& component_ids,
+    int component_count);
+
 inline
 ExperienceGraph::incident_edge_iterator::incident_edge_iterator(
     adjacent_edge_iterator it)
@@ -47,6 +47,11 @@ public:
 
     virtual bool loadExperienceGraph(const std::string& path) = 0;
 
+    /// Insert a path, e.g. the solution to a planning request, into the
+    /// experience graph
+    virtual bool insertExperienceGraphPath(
+        const std::vector<RobotState>& path) = 0;
+
     virtual void getExperienceGraphNodes(
         int state_id,
         std::vector<ExperienceGraph::node_id>& nodes) = 0;
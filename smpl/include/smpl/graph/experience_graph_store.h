@@ -0,0 +1,156 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_EXPERIENCE_GRAPH_STORE_H
+#define SMPL_EXPERIENCE_GRAPH_STORE_H
+
+// standard includes
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// system includes
+#include <Eigen/Dense>
+
+// project includes
+#include <smpl/graph/experience_graph.h>
+
+namespace sbpl {
+namespace motion {
+
+/// Read-only, memory-mapped view of a binary experience graph file.
+///
+/// The file consists of a short header followed by a sequence of segments.
+/// Each segment holds a batch of experience graph nodes (states, optional 3D
+/// projections, and connected component labels) and the edges (with their
+/// waypoints) between them. New segments may be appended to an existing file
+/// with AppendExperienceGraphStore() without rewriting earlier segments. Node
+/// and component ids are global across segments, in order of appearance.
+///
+/// All data is accessed in place through the mapping; nothing is copied until
+/// load() is called to build an ExperienceGraph.
+class ExperienceGraphStore
+{
+public:
+
+    ExperienceGraphStore();
+    ~ExperienceGraphStore();
+
+    ExperienceGraphStore(const ExperienceGraphStore&) = delete;
+    ExperienceGraphStore& operator=(const ExperienceGraphStore&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    size_t variableCount() const { return m_var_count; }
+
+    size_t numNodes() const { return m_node_count; }
+    size_t numEdges() const { return m_edge_count; }
+    size_t numComponents() const { return m_component_count; }
+
+    /// Return the joint variables of a node
+    const double* state(size_t n) const;
+
+    /// Return the 3D projection of a node, or nullptr if the segment
+    /// containing the node was stored without projections
+    const double* projection(size_t n) const;
+
+    size_t component(size_t n) const;
+
+    size_t source(size_t e) const;
+    size_t target(size_t e) const;
+    size_t waypointCount(size_t e) const;
+
+    /// Return the joint variables of the i'th waypoint of an edge
+    const double* waypoint(size_t e, size_t i) const;
+
+    /// Append all nodes and edges in the store to an experience graph. If the
+    /// graph is initially empty, node and edge ids will match those in the
+    /// store.
+    bool load(ExperienceGraph& graph) const;
+
+private:
+
+    struct EdgeRecord;
+
+    struct Segment
+    {
+        const double* states;
+        const double* projections;
+        const std::uint32_t* components;
+        const EdgeRecord* edges;
+        const double* waypoints;
+        size_t node_begin;
+        size_t edge_begin;
+        size_t component_begin;
+    };
+
+    void* m_data;
+    size_t m_size;
+
+    size_t m_var_count;
+    size_t m_node_count;
+    size_t m_edge_count;
+    size_t m_component_count;
+
+    std::vector<Segment> m_segments;
+
+    const Segment& nodeSegment(size_t n) const;
+    const Segment& edgeSegment(size_t e) const;
+    const EdgeRecord& edgeRecord(size_t e) const;
+};
+
+/// Write an experience graph to a new binary store at \p path, replacing any
+/// existing file. If \p projections is non-null, it must contain one 3D point
+/// per node.
+bool WriteExperienceGraphStore(
+    const std::string& path,
+    const ExperienceGraph& graph,
+    const std::vector<Eigen::Vector3d>* projections = nullptr);
+
+/// Append the nodes of \p graph with ids at or after \p first_node, and the
+/// edges between them, to the binary store at \p path as a new segment. The
+/// store is created if it does not exist, holding only the appended nodes, so
+/// that node ids in a created store are offset by \p first_node from those in
+/// \p graph. Edges incident to nodes before \p first_node are not stored. If
+/// \p projections is non-null, it must contain one 3D point for each appended
+/// node.
+bool AppendExperienceGraphStore(
+    const std::string& path,
+    const ExperienceGraph& graph,
+    ExperienceGraph::node_id first_node = 0,
+    const std::vector<Eigen::Vector3d>* projections = nullptr);
+
+} // namespace motion
+} // namespace sbpl
+
+#endif
@@ -35,6 +35,7 @@
 
 // standard includes
 #include <time.h>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -51,6 +52,7 @@
 #include <smpl/planning_params.h>
 #include <smpl/robot_model.h>
 #include <smpl/types.h>
+#include <smpl/graph/edge_validity_cache.h>
 #include <smpl/graph/robot_planning_space.h>
 
 namespace sbpl {
@@ -118,6 +120,15 @@ public:
     void setVisualizationFrameId(const std::string& frame_id);
     const std::string& visualizationFrameId() const;
 
+    /// \name Edge Validity Cache
+    ///@{
+    void enableEdgeCache(const OccupancyGrid* grid, size_t capacity);
+    void disableEdgeCache();
+    bool edgeCacheEnabled() const { return m_edge_cache.capacity() != 0; }
+    void clearEdgeCache();
+    const EdgeValidityCache& edgeCache() const { return m_edge_cache; }
+    ///@}
+
     /// \name Reimplemented Public Functions from RobotPlanningSpace
     ///@{
     void GetLazySuccs(
@@ -196,6 +207,15 @@ protected:
         const Action& action,
         double& dist);
 
+    bool checkAction(
+        int state_id,
+        int action_index,
+        const RobotState& state,
+        const Action& action,
+        double& dist);
+
+    std::uint32_t edgeCacheVersion();
+
     bool isGoal(const RobotState& state, const std::vector<double>& pose);
 
     visualization_msgs::MarkerArray getStateVisualization(
@@ -234,6 +254,16 @@ private:
 
     std::string m_viz_frame_id;
 
+    EdgeValidityCache m_edge_cache;
+    const OccupancyGrid* m_edge_cache_grid;
+    CollisionVersionExtension* m_edge_cache_checker;
+
+    // versions of the grid and the collision checker last seen by the edge
+    // cache, and the cache version they map to
+    std::uint32_t m_edge_cache_grid_version;
+    std::uint64_t m_edge_cache_checker_version;
+    std::uint32_t m_edge_cache_version;
+
     bool setGoalPose(const GoalConstraint& goal);
     bool setGoalConfiguration(const GoalConstraint& goal);
 
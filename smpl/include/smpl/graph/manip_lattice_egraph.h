@@ -55,10 +55,18 @@ public:
         std::vector<RobotState>& path) override;
     ///@}
 
+    bool saveExperienceGraph(const std::string& path) const;
+
+    bool appendExperienceGraph(
+        const std::string& path,
+        const std::vector<RobotState>& egraph_states);
+
     /// \name Required Public Functions from ExperienceGraphExtension
     ///@{
     bool loadExperienceGraph(const std::string& path);
 
+    bool insertExperienceGraphPath(const std::vector<RobotState>& path);
+
     void getExperienceGraphNodes(
         int state_id,
         std::vector<ExperienceGraph::node_id>& nodes);
@@ -108,11 +116,39 @@ private:
     // map from experience graph node ids to state ids
     std::vector<int> m_egraph_state_ids;
 
+    // number of times each experience graph edge has been traversed by an
+    // inserted or extracted path, for eviction of rarely used edges
+    std::vector<int> m_edge_usage;
+    int m_max_egraph_edges;
+
     bool findShortestExperienceGraphPath(
         ExperienceGraph::node_id u,
         ExperienceGraph::node_id s,
         std::vector<ExperienceGraph::node_id>& path);
 
+    bool loadExperienceGraphStore(const std::string& path);
+
+    void addExperienceGraphStates(
+        const std::vector<RobotState>& egraph_states,
+        bool merge,
+        std::vector<ExperienceGraph::edge_id>* new_edges);
+
+    bool findExperienceGraphEdge(
+        ExperienceGraph::node_id u,
+        ExperienceGraph::node_id v,
+        ExperienceGraph::edge_id& e);
+
+    bool pruneExperienceGraph();
+
+    void notifyExperienceGraphHeuristics(
+        ExperienceGraph::node_id first_node,
+        const std::vector<ExperienceGraph::edge_id>& edges,
+        bool rebuild);
+
+    void mapExperienceGraphNode(
+        ExperienceGraph::node_id n,
+        const RobotCoord& coord);
+
     bool parseExperienceGraphFile(
         const std::string& filepath,
         std::vector<RobotState>& egraph_states) const;
@@ -43,6 +43,8 @@
 
 // project includes
 #include <smpl/collision_checker.h>
+#include <smpl/hash_index.h>
+#include <smpl/object_pool.h>
 #include <smpl/planning_params.h>
 #include <smpl/robot_model.h>
 #include <smpl/time.h>
@@ -181,11 +183,11 @@ private:
     WorkspaceLatticeState* m_start_entry;
     int m_start_state_id;
 
+    // state records, allocated in blocks
+    ObjectPool<WorkspaceLatticeState> m_state_pool;
+
     // maps state -> id
-    typedef WorkspaceLatticeState StateKey;
-    typedef PointerValueHash<StateKey> StateHash;
-    typedef PointerValueEqual<StateKey> StateEqual;
-    hash_map<StateKey*, int, StateHash, StateEqual> m_state_to_id;
+    HashIndex<WorkspaceLatticeState> m_state_to_id;
 
     // maps id -> state
     std::vector<WorkspaceLatticeState*> m_states;
@@ -32,7 +32,11 @@
 #ifndef SMPL_WORKSPACE_LATTICE_BASE_H
 #define SMPL_WORKSPACE_LATTICE_BASE_H
 
+// standard includes
+#include <deque>
+
 // project includes
+#include <smpl/fixed_vector.h>
 #include <smpl/graph/robot_planning_space.h>
 
 namespace sbpl {
@@ -41,8 +45,13 @@ namespace motion {
 /// continuous state ( x, y, z, R, P, Y, j1, ..., jn )
 typedef std::vector<double> WorkspaceState;
 
-/// discrete coordinate ( x, y, z, R, P, Y, j1, ..., jn )
-typedef std::vector<int> WorkspaceCoord;
+/// maximum number of variables ( 6 + number of redundant variables ) that may
+/// be represented by a workspace coordinate
+constexpr std::size_t MaxWorkspaceDofCount = 10;
+
+/// discrete coordinate ( x, y, z, R, P, Y, j1, ..., jn ), stored inline so that
+/// state records do not require a separate allocation
+typedef FixedVector<int, MaxWorkspaceDofCount> WorkspaceCoord;
 
 /// 6-dof pose ( x, y, z, R, P, Y )
 typedef std::vector<double> SixPose;
@@ -70,6 +79,23 @@ public:
         int Y_count;
 
         std::vector<double> free_angle_res;
+
+        // maximum number of recent ik solutions, keyed by workspace
+        // coordinate, kept to warm-start inverse kinematics; 0 disables the
+        // cache
+        int ik_seed_cache_size = 0;
+
+        // maximum difference, in any non-redundant variable, between a cached
+        // solution and the caller's seed for the cached solution to be used
+        // as the seed, so that seeds are not taken from another ik branch
+        double ik_seed_cache_max_dist = 0.5;
+
+        // attempt a damped least-squares solve from the seed state before
+        // falling back to the robot model's inverse kinematics
+        bool approx_ik = false;
+        int approx_ik_max_iterations = 10;
+        double approx_ik_pos_tolerance = 1e-4;
+        double approx_ik_rot_tolerance = 1e-3;
     };
 
     WorkspaceLatticeBase(
@@ -94,6 +120,17 @@ protected:
     int m_dof_count;
     std::vector<std::size_t> m_fangle_indices;
 
+    // ik acceleration
+    std::vector<int> m_approx_ik_vars; // non-redundant variable indices
+    bool m_approx_ik;
+    int m_approx_ik_max_iterations;
+    double m_approx_ik_pos_tolerance;
+    double m_approx_ik_rot_tolerance;
+    std::size_t m_ik_seed_cache_size;
+    double m_ik_seed_cache_max_dist;
+    mutable hash_map<WorkspaceCoord, RobotState> m_ik_seed_cache;
+    mutable std::deque<WorkspaceCoord> m_ik_seed_cache_order;
+
     size_t freeAngleCount() const { return m_fangle_indices.size(); }
 
     // conversions between robot states, workspace states, and workspace coords
@@ -107,6 +144,15 @@ protected:
     bool stateWorkspaceToRobot(
         const WorkspaceState& state, const RobotState& seed, RobotState& ostate) const;
 
+    bool computeApproxIK(
+        const SixPose& pose, const RobotState& seed, RobotState& ostate) const;
+    void clearIKSeedCache();
+    bool ikAccelerationEnabled() const;
+    const RobotState& waypointSeed(
+        const RobotState& state,
+        const std::vector<RobotState>& wptraj) const;
+    double seedDistance(const RobotState& a, const RobotState& b) const;
+
     // TODO: variants of workspace -> robot that don't restrict redundant angles
     // TODO: variants of workspace -> robot that take in a full seed state
 
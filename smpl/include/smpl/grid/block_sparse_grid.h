@@ -0,0 +1,259 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_BLOCK_SPARSE_GRID_H
+#define SMPL_BLOCK_SPARSE_GRID_H
+
+// standard includes
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+// project includes
+#include <smpl/octree/pool_allocator.h>
+
+namespace sbpl {
+
+/// This class represents a resizeable three-dimensional array of sparse data,
+/// with the same interface as SparseGrid. Instead of an octree, cells are
+/// grouped into fixed-size blocks of 8 x 8 x 8 cells stored in a hash table
+/// keyed by block coordinates. Each block is either uniform, storing a single
+/// value for all of its cells, or dense, storing the value of each cell.
+/// Blocks that are not present take the background value of the grid.
+///
+/// Accessing a cell requires a single hash lookup rather than a descent from
+/// the root of an octree. Accessor and ConstAccessor objects additionally
+/// cache the most recently accessed block, so that sequences of accesses to
+/// nearby cells avoid the lookup altogether.
+///
+/// The non-const operator() expands the block containing the cell to dense
+/// storage, after which references to its cells remain valid until the block
+/// is collapsed. set() collapses a dense block back to a uniform block when it
+/// restores the value the block was expanded from and all of its cells become
+/// equal; set_lazy() never collapses blocks. prune() collapses all uniform
+/// dense blocks and removes uniform blocks holding the background value.
+///
+/// Accessors remain valid across get(), set(), set_lazy(), and operator(), and
+/// are invalidated by prune(), reset(), assign(), and resize().
+///
+/// Cell coordinates must be non-negative and less than 2^24.
+template <class T, class Allocator = PoolAllocator<T>>
+class BlockSparseGrid
+{
+    struct block_type
+    {
+        T* cells;   // null if the block is uniform
+        T value;    // value of a uniform block, or the value a dense block
+                    // was expanded from
+    };
+
+public:
+
+    using value_type        = T;
+    using size_type         = std::size_t;
+    using reference         = value_type&;
+    using const_reference   = const value_type&;
+    using index_type        = int;
+
+    static const int BLOCK_BITS = 3;
+    static const int BLOCK_SIZE = 1 << BLOCK_BITS;
+    static const int BLOCK_CELL_COUNT = BLOCK_SIZE * BLOCK_SIZE * BLOCK_SIZE;
+
+    class ConstAccessor
+    {
+    public:
+
+        explicit ConstAccessor(const BlockSparseGrid& grid);
+
+        const_reference get(index_type x, index_type y, index_type z);
+
+    private:
+
+        const BlockSparseGrid* m_grid;
+        std::uint64_t m_key;
+        const block_type* m_block;
+    };
+
+    class Accessor
+    {
+    public:
+
+        explicit Accessor(BlockSparseGrid& grid);
+
+        const_reference get(index_type x, index_type y, index_type z);
+
+        reference operator()(index_type x, index_type y, index_type z);
+
+        void set(index_type x, index_type y, index_type z, const T& data);
+        void set_lazy(index_type x, index_type y, index_type z, const T& data);
+
+    private:
+
+        BlockSparseGrid* m_grid;
+        std::uint64_t m_key;
+        block_type* m_block;
+
+        block_type* find_or_insert_block(
+            index_type x, index_type y, index_type z);
+    };
+
+    BlockSparseGrid();
+    BlockSparseGrid(const T& value);
+    BlockSparseGrid(size_type size_x, size_type size_y, size_type size_z);
+    BlockSparseGrid(
+        size_type size_x, size_type size_y, size_type size_z,
+        const T& value);
+
+    explicit BlockSparseGrid(const Allocator& alloc);
+    explicit BlockSparseGrid(const T& value, const Allocator& alloc);
+    explicit BlockSparseGrid(
+        size_type size_x, size_type size_y, size_type size_z,
+        const Allocator& alloc);
+    explicit BlockSparseGrid(
+        size_type size_x, size_type size_y, size_type size_z,
+        const T& value, const Allocator& alloc);
+
+    BlockSparseGrid(const BlockSparseGrid& o);
+    BlockSparseGrid(BlockSparseGrid&& o);
+
+    ~BlockSparseGrid();
+
+    BlockSparseGrid& operator=(const BlockSparseGrid& rhs);
+    BlockSparseGrid& operator=(BlockSparseGrid&& rhs);
+
+    /// \name Size Properties
+    ///@{
+    size_type size() const;
+    size_type max_size() const;
+    size_type size_x() const;
+    size_type size_y() const;
+    size_type size_z() const;
+
+    int max_depth() const;
+
+    size_type mem_usage() const;
+
+    size_type num_blocks() const;
+    size_type num_dense_blocks() const;
+    ///@}
+
+    /// \name Element Access
+    ///@{
+    const_reference operator()(index_type x, index_type y, index_type z) const;
+
+    reference operator()(index_type x, index_type y, index_type z);
+
+    const_reference get(index_type x, index_type y, index_type z) const;
+
+    Accessor accessor();
+    ConstAccessor accessor() const;
+    ///@}
+
+    /// \name Modifiers
+    ///@{
+    void reset(const T& value);
+    void assign(const T& value);
+
+    void set(index_type x, index_type y, index_type z, const T& data);
+    void set_lazy(index_type x, index_type y, index_type z, const T& data);
+
+    void prune();
+
+    template <class UnaryPredicate>
+    void prune(UnaryPredicate p);
+
+    void resize(size_type size_x, size_type size_y, size_type size_z);
+    void resize(size_type size_x, size_type size_y, size_type size_z, const T& value);
+    ///@}
+
+    template <class Pred>
+    size_type mem_usage_full(const Pred& pred);
+
+    template <typename Callable>
+    void accept(Callable c);
+
+    template <typename Callable>
+    void accept_coords(Callable c);
+
+private:
+
+    struct key_hash
+    {
+        std::size_t operator()(std::uint64_t key) const;
+    };
+
+    using block_allocator = typename std::allocator_traits<Allocator>::template
+            rebind_alloc<std::pair<const std::uint64_t, block_type>>;
+
+    using block_map = std::unordered_map<
+            std::uint64_t,
+            block_type,
+            key_hash,
+            std::equal_to<std::uint64_t>,
+            block_allocator>;
+
+    Allocator m_alloc;
+    block_map m_blocks;
+    T m_value;
+
+    int m_max_depth;
+    size_type m_size[3];
+
+    static std::uint64_t block_key(index_type x, index_type y, index_type z);
+    static int cell_index(index_type x, index_type y, index_type z);
+
+    int compute_max_depth(
+        size_type size_x,
+        size_type size_y,
+        size_type size_z) const;
+
+    const block_type* find_block(std::uint64_t key) const;
+    block_type* find_block(std::uint64_t key);
+    block_type* insert_block(std::uint64_t key);
+
+    void expand_block(block_type& b);
+    void collapse_block(block_type& b);
+    bool uniform(const block_type& b) const;
+
+    static const_reference get_cell(const block_type& b, int index);
+    reference get_cell_unique(block_type& b, int index);
+    void set_cell(block_type& b, int index, const T& value);
+    void set_cell_lazy(block_type& b, int index, const T& value);
+
+    void clear_blocks();
+    void copy_blocks(const BlockSparseGrid& o);
+};
+
+} // namespace sbpl
+
+#include "detail/block_sparse_grid.hpp"
+
+#endif
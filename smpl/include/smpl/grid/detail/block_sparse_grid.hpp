@@ -0,0 +1,855 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_BLOCK_SPARSE_GRID_HPP
+#define SMPL_BLOCK_SPARSE_GRID_HPP
+
+#include "../block_sparse_grid.h"
+
+// standard includes
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <utility>
+
+namespace sbpl {
+
+template <class T, class Allocator>
+const int BlockSparseGrid<T, Allocator>::BLOCK_BITS;
+
+template <class T, class Allocator>
+const int BlockSparseGrid<T, Allocator>::BLOCK_SIZE;
+
+template <class T, class Allocator>
+const int BlockSparseGrid<T, Allocator>::BLOCK_CELL_COUNT;
+
+template <class T, class Allocator>
+BlockSparseGrid<T, Allocator>::ConstAccessor::ConstAccessor(
+    const BlockSparseGrid& grid)
+:
+    m_grid(&grid),
+    m_key(0),
+    m_block(nullptr)
+{
+}
+
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::ConstAccessor::get(
+    index_type x, index_type y, index_type z)
+    -> const_reference
+{
+    const std::uint64_t key = block_key(x, y, z);
+    if (!m_block || key != m_key) {
+        const block_type* b = m_grid->find_block(key);
+        if (!b) {
+            return m_grid->m_value;
+        }
+        m_block = b;
+        m_key = key;
+    }
+    return get_cell(*m_block, cell_index(x, y, z));
+}
+
+template <class T, class Allocator>
+BlockSparseGrid<T, Allocator>::Accessor::Accessor(BlockSparseGrid& grid) :
+    m_grid(&grid),
+    m_key(0),
+    m_block(nullptr)
+{
+}
+
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::Accessor::get(
+    index_type x, index_type y, index_type z)
+    -> const_reference
+{
+    const std::uint64_t key = block_key(x, y, z);
+    if (!m_block || key != m_key) {
+        block_type* b = m_grid->find_block(key);
+        if (!b) {
+            return m_grid->m_value;
+        }
+        m_block = b;
+        m_key = key;
+    }
+    return get_cell(*m_block, cell_index(x, y, z));
+}
+
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::Accessor::operator()(
+    index_type x, index_type y, index_type z)
+    -> reference
+{
+    block_type* b = find_or_insert_block(x, y, z);
+    return m_grid->get_cell_unique(*b, cell_index(x, y, z));
+}
+
+template <class T, class Allocator>
+void BlockSparseGrid<T, Allocator>::Accessor::set(
+    index_type x, index_type y, index_type z, const T& data)
+{
+    const std::uint64_t key = block_key(x, y, z);
+    if (!m_block || key != m_key) {
+        block_type* b = m_grid->find_block(key);
+        if (!b) {
+            if (std::equal_to<T>()(data, m_grid->m_value)) {
+                return;
+            }
+            b = m_grid->insert_block(key);
+        }
+        m_block = b;
+        m_key = key;
+    }
+    m_grid->set_cell(*m_block, cell_index(x, y, z), data);
+}
+
+template <class T, class Allocator>
+void BlockSparseGrid<T, Allocator>::Accessor::set_lazy(
+    index_type x, index_type y, index_type z, const T& data)
+{
+    const std::uint64_t key = block_key(x, y, z);
+    if (!m_block || key != m_key) {
+        block_type* b = m_grid->find_block(key);
+        if (!b) {
+            if (std::equal_to<T>()(data, m_grid->m_value)) {
+                return;
+            }
+            b = m_grid->insert_block(key);
+        }
+        m_block = b;
+        m_key = key;
+    }
+    m_grid->set_cell_lazy(*m_block, cell_index(x, y, z), data);
+}
+
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::Accessor::find_or_insert_block(
+    index_type x, index_type y, index_type z)
+    -> block_type*
+{
+    const std::uint64_t key = block_key(x, y, z);
+    if (!m_block || key != m_key) {
+        block_type* b = m_grid->find_block(key);
+        if (!b) {
+            b = m_grid->insert_block(key);
+        }
+        m_block = b;
+        m_key = key;
+    }
+    return m_block;
+}
+
+template <class T, class Allocator>
+BlockSparseGrid<T, Allocator>::BlockSparseGrid() :
+    m_alloc(),
+    m_blocks(),
+    m_value(),
+    m_max_depth(16)
+{
+    m_size[0] = m_size[1] = m_size[2] = 1u << 16;
+}
+
+template <class T, class Allocator>
+BlockSparseGrid<T, Allocator>::BlockSparseGrid(const T& value) :
+    m_alloc(),
+    m_blocks(),
+    m_value(value),
+    m_max_depth(16)
+{
+    m_size[0] = m_size[1] = m_size[2] = 1u << 16;
+}
+
+template <class T, class Allocator>
+BlockSparseGrid<T, Allocator>::BlockSparseGrid(
+    size_type size_x,
+    size_type size_y,
+    size_type size_z)
+:
+    m_alloc(),
+    m_blocks(),
+    m_value(),
+    m_max_depth(compute_max_depth(size_x, size_y, size_z))
+{
+    m_size[0] = size_x;
+    m_size[1] = size_y;
+    m_size[2] = size_z;
+}
+
+template <class T, class Allocator>
+BlockSparseGrid<T, Allocator>::BlockSparseGrid(
+    size_type size_x,
+    size_type size_y,
+    size_type size_z,
+    const T& value)
+:
+    m_alloc(),
+    m_blocks(),
+    m_value(value),
+    m_max_depth(compute_max_depth(size_x, size_y, size_z))
+{
+    m_size[0] = size_x;
+    m_size[1] = size_y;
+    m_size[2] = size_z;
+}
+
+template <class T, class Allocator>
+BlockSparseGrid<T, Allocator>::BlockSparseGrid(const Allocator& alloc) :
+    m_alloc(alloc),
+    m_blocks(0, key_hash(), std::equal_to<std::uint64_t>(), block_allocator(alloc)),
+    m_value(),
+    m_max_depth(16)
+{
+    m_size[0] = m_size[1] = m_size[2] = 1u << 16;
+}
+
+template <class T, class Allocator>
+BlockSparseGrid<T, Allocator>::BlockSparseGrid(
+    const T& value,
+    const Allocator& alloc)
+:
+    m_alloc(alloc),
+    m_blocks(0, key_hash(), std::equal_to<std::uint64_t>(), block_allocator(alloc)),
+    m_value(value),
+    m_max_depth(16)
+{
+    m_size[0] = m_size[1] = m_size[2] = 1u << 16;
+}
+
+template <class T, class Allocator>
+BlockSparseGrid<T, Allocator>::BlockSparseGrid(
+    size_type size_x, size_type size_y, size_type size_z,
+    const Allocator& alloc)
+:
+    m_alloc(alloc),
+    m_blocks(0, key_hash(), std::equal_to<std::uint64_t>(), block_allocator(alloc)),
+    m_value(),
+    m_max_depth(compute_max_depth(size_x, size_y, size_z))
+{
+    m_size[0] = size_x;
+    m_size[1] = size_y;
+    m_size[2] = size_z;
+}
+
+template <class T, class Allocator>
+BlockSparseGrid<T, Allocator>::BlockSparseGrid(
+    size_type size_x, size_type size_y, size_type size_z,
+    const T& value, const Allocator& alloc)
+:
+    m_alloc(alloc),
+    m_blocks(0, key_hash(), std::equal_to<std::uint64_t>(), block_allocator(alloc)),
+    m_value(value),
+    m_max_depth(compute_max_depth(size_x, size_y, size_z))
+{
+    m_size[0] = size_x;
+    m_size[1] = size_y;
+    m_size[2] = size_z;
+}
+
+template <class T, class Allocator>
+BlockSparseGrid<T, Allocator>::BlockSparseGrid(const BlockSparseGrid& o) :
+    m_alloc(std::allocator_traits<Allocator>::
+            select_on_container_copy_construction(o.m_alloc)),
+    m_blocks(0, key_hash(), std::equal_to<std::uint64_t>(), block_allocator(m_alloc)),
+    m_value(o.m_value),
+    m_max_depth(o.m_max_depth)
+{
+    m_size[0] = o.m_size[0];
+    m_size[1] = o.m_size[1];
+    m_size[2] = o.m_size[2];
+    copy_blocks(o);
+}
+
+template <class T, class Allocator>
+BlockSparseGrid<T, Allocator>::BlockSparseGrid(BlockSparseGrid&& o) :
+    m_alloc(std::move(o.m_alloc)),
+    m_blocks(std::move(o.m_blocks)),
+    m_value(std::move(o.m_value)),
+    m_max_depth(o.m_max_depth)
+{
+    m_size[0] = o.m_size[0];
+    m_size[1] = o.m_size[1];
+    m_size[2] = o.m_size[2];
+
+    // the cells are now owned by this grid
+    o.m_blocks.clear();
+}
+
+template <class T, class Allocator>
+BlockSparseGrid<T, Allocator>::~BlockSparseGrid()
+{
+    clear_blocks();
+}
+
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::operator=(const BlockSparseGrid& rhs)
+    -> BlockSparseGrid&
+{
+    if (this != &rhs) {
+        clear_blocks();
+        m_value = rhs.m_value;
+        m_max_depth = rhs.m_max_depth;
+        m_size[0] = rhs.m_size[0];
+        m_size[1] = rhs.m_size[1];
+        m_size[2] = rhs.m_size[2];
+        copy_blocks(rhs);
+    }
+    return *this;
+}
+
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::operator=(BlockSparseGrid&& rhs)
+    -> BlockSparseGrid&
+{
+    if (this != &rhs) {
+        clear_blocks();
+        // cells must be released by the allocator that created them
+        m_alloc = rhs.m_alloc;
+        m_blocks = std::move(rhs.m_blocks);
+        rhs.m_blocks.clear();
+        m_value = std::move(rhs.m_value);
+        m_max_depth = rhs.m_max_depth;
+        m_size[0] = rhs.m_size[0];
+        m_size[1] = rhs.m_size[1];
+        m_size[2] = rhs.m_size[2];
+    }
+    return *this;
+}
+
+/// Return the size of the three-dimensional grid.
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::size() const -> size_type
+{
+    return size_x() * size_y() * size_z();
+}
+
+/// Return the maximum possible size of the three-dimensional grid that can be
+/// supported by this BlockSparseGrid implementation.
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::max_size() const -> size_type
+{
+    return std::numeric_limits<size_type>::max();
+}
+
+/// Return the size of the three-dimensional grid in the x dimension.
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::size_x() const -> size_type
+{
+    return m_size[0];
+}
+
+/// Return the size of the three-dimensional grid in the y dimension.
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::size_y() const -> size_type
+{
+    return m_size[1];
+}
+
+/// Return the size of the three-dimensional grid in the z dimension.
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::size_z() const -> size_type
+{
+    return m_size[2];
+}
+
+/// Return the depth of an octree covering the grid, for compatibility with
+/// SparseGrid.
+template <class T, class Allocator>
+int BlockSparseGrid<T, Allocator>::max_depth() const
+{
+    return m_max_depth;
+}
+
+/// Return the approximate number of bytes used by the grid. Note the size is
+/// obtained from sizeof which will not account for dynamic memory allocated by
+/// an element
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::mem_usage() const -> size_type
+{
+    const size_type node_size =
+            sizeof(typename block_map::value_type) + 2 * sizeof(void*);
+    return sizeof(*this) +
+            m_blocks.bucket_count() * sizeof(void*) +
+            m_blocks.size() * node_size +
+            num_dense_blocks() * BLOCK_CELL_COUNT * sizeof(T);
+}
+
+/// Return the number of blocks whose values differ from the background value,
+/// before pruning.
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::num_blocks() const -> size_type
+{
+    return m_blocks.size();
+}
+
+/// Return the number of blocks that store the value of each of their cells.
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::num_dense_blocks() const -> size_type
+{
+    size_type count = 0;
+    for (const auto& entry : m_blocks) {
+        if (entry.second.cells) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::operator()(
+    index_type x, index_type y, index_type z) const
+    -> const_reference
+{
+    return get(x, y, z);
+}
+
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::operator()(
+    index_type x, index_type y, index_type z)
+    -> reference
+{
+    const std::uint64_t key = block_key(x, y, z);
+    block_type* b = find_block(key);
+    if (!b) {
+        b = insert_block(key);
+    }
+    return get_cell_unique(*b, cell_index(x, y, z));
+}
+
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::get(
+    index_type x, index_type y, index_type z) const
+    -> const_reference
+{
+    const block_type* b = find_block(block_key(x, y, z));
+    if (!b) {
+        return m_value;
+    }
+    return get_cell(*b, cell_index(x, y, z));
+}
+
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::accessor() -> Accessor
+{
+    return Accessor(*this);
+}
+
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::accessor() const -> ConstAccessor
+{
+    return ConstAccessor(*this);
+}
+
+/// Reset so that all cells have identical values. Removes all blocks.
+template <class T, class Allocator>
+void BlockSparseGrid<T, Allocator>::reset(const T& value)
+{
+    clear_blocks();
+    m_value = value;
+}
+
+template <class T, class Allocator>
+void BlockSparseGrid<T, Allocator>::assign(const T& value)
+{
+    return reset(value);
+}
+
+template <class T, class Allocator>
+void BlockSparseGrid<T, Allocator>::set(
+    index_type x, index_type y, index_type z, const T& data)
+{
+    const std::uint64_t key = block_key(x, y, z);
+    block_type* b = find_block(key);
+    if (!b) {
+        if (std::equal_to<T>()(data, m_value)) {
+            return;
+        }
+        b = insert_block(key);
+    }
+    set_cell(*b, cell_index(x, y, z), data);
+}
+
+template <class T, class Allocator>
+void BlockSparseGrid<T, Allocator>::set_lazy(
+    index_type x, index_type y, index_type z, const T& data)
+{
+    const std::uint64_t key = block_key(x, y, z);
+    block_type* b = find_block(key);
+    if (!b) {
+        if (std::equal_to<T>()(data, m_value)) {
+            return;
+        }
+        b = insert_block(key);
+    }
+    set_cell_lazy(*b, cell_index(x, y, z), data);
+}
+
+/// Collapse dense blocks whose cells are all equal and remove uniform blocks
+/// holding the background value.
+template <class T, class Allocator>
+void BlockSparseGrid<T, Allocator>::prune()
+{
+    prune([](const T&) { return true; });
+}
+
+/// Collapse dense blocks whose cells are all equal and all satisfy \p p, and
+/// remove uniform blocks holding the background value that satisfies \p p.
+template <class T, class Allocator>
+template <class UnaryPredicate>
+void BlockSparseGrid<T, Allocator>::prune(UnaryPredicate p)
+{
+    for (auto it = m_blocks.begin(); it != m_blocks.end(); ) {
+        block_type& b = it->second;
+        if (b.cells) {
+            if (uniform(b) && std::all_of(b.cells, b.cells + BLOCK_CELL_COUNT, p)) {
+                collapse_block(b);
+            }
+        }
+
+        if (!b.cells && std::equal_to<T>()(b.value, m_value) && p(b.value)) {
+            it = m_blocks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+template <class T, class Allocator>
+void BlockSparseGrid<T, Allocator>::resize(
+    size_type size_x,
+    size_type size_y,
+    size_type size_z)
+{
+    clear_blocks(); // TODO: non-destructive resize
+    m_size[0] = size_x;
+    m_size[1] = size_y;
+    m_size[2] = size_z;
+    m_max_depth = compute_max_depth(size_x, size_y, size_z);
+}
+
+template <class T, class Allocator>
+void BlockSparseGrid<T, Allocator>::resize(
+    size_type size_x,
+    size_type size_y,
+    size_type size_z,
+    const T& value)
+{
+    resize(size_x, size_y, size_z);
+    m_value = value;
+}
+
+/// Return the approximate number of bytes used by an equivalent dense grid.
+template <class T, class Allocator>
+template <class Pred>
+auto BlockSparseGrid<T, Allocator>::mem_usage_full(const Pred& pred)
+    -> size_type
+{
+    index_type min_coord = 0;
+    index_type max_coord = 1 << m_max_depth;
+    index_type xmin = max_coord, ymin = max_coord, zmin = max_coord;
+    index_type xmax = min_coord, ymax = min_coord, zmax = min_coord;
+
+    auto record_bbx = [&](
+        const T& val,
+        index_type xfirst, index_type yfirst, index_type zfirst,
+        index_type xlast, index_type ylast, index_type zlast)
+    {
+        if (pred(val)) {
+            xmin = std::min(xmin, xfirst);
+            ymin = std::min(ymin, yfirst);
+            zmin = std::min(zmin, zfirst);
+            xmax = std::max(xmax, xlast);
+            ymax = std::max(ymax, ylast);
+            zmax = std::max(zmax, zlast);
+        }
+    };
+
+    accept_coords(record_bbx);
+
+    return (xmax - xmin) * (ymax - ymin) * (zmax - zmin) * sizeof(T);
+}
+
+/// Call \p c with the background value, the value of each uniform block, and
+/// the value of each cell of each dense block.
+template <class T, class Allocator>
+template <typename Callable>
+void BlockSparseGrid<T, Allocator>::accept(Callable c)
+{
+    c(m_value);
+    for (auto& entry : m_blocks) {
+        block_type& b = entry.second;
+        c(b.value);
+        if (b.cells) {
+            for (T* v = b.cells; v != b.cells + BLOCK_CELL_COUNT; ++v) {
+                c(*v);
+            }
+        }
+    }
+}
+
+/// Call \p c with each value and the half-open range of cells that it covers.
+/// The background value is reported first, covering the entire grid, followed
+/// by the values of the blocks that override it, in no particular order.
+template <class T, class Allocator>
+template <typename Callable>
+void BlockSparseGrid<T, Allocator>::accept_coords(Callable c)
+{
+    size_type max_coord = (size_type)1 << m_max_depth;
+    c(m_value, 0, 0, 0, max_coord, max_coord, max_coord);
+
+    const std::uint64_t mask = (1u << 21) - 1;
+    for (auto& entry : m_blocks) {
+        const size_type bx = (size_type)((entry.first >> 42) & mask) << BLOCK_BITS;
+        const size_type by = (size_type)((entry.first >> 21) & mask) << BLOCK_BITS;
+        const size_type bz = (size_type)(entry.first & mask) << BLOCK_BITS;
+        block_type& b = entry.second;
+        if (!b.cells) {
+            c(b.value, bx, by, bz, bx + BLOCK_SIZE, by + BLOCK_SIZE, bz + BLOCK_SIZE);
+            continue;
+        }
+
+        for (size_type x = bx; x != bx + BLOCK_SIZE; ++x) {
+        for (size_type y = by; y != by + BLOCK_SIZE; ++y) {
+        for (size_type z = bz; z != bz + BLOCK_SIZE; ++z) {
+            c(b.cells[cell_index(x, y, z)], x, y, z, x + 1, y + 1, z + 1);
+        }
+        }
+        }
+    }
+}
+
+template <class T, class Allocator>
+std::size_t BlockSparseGrid<T, Allocator>::key_hash::operator()(
+    std::uint64_t key) const
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (std::size_t)key;
+}
+
+template <class T, class Allocator>
+std::uint64_t BlockSparseGrid<T, Allocator>::block_key(
+    index_type x, index_type y, index_type z)
+{
+    return  (std::uint64_t)(x >> BLOCK_BITS) << 42 |
+            (std::uint64_t)(y >> BLOCK_BITS) << 21 |
+            (std::uint64_t)(z >> BLOCK_BITS);
+}
+
+template <class T, class Allocator>
+int BlockSparseGrid<T, Allocator>::cell_index(
+    index_type x, index_type y, index_type z)
+{
+    const int mask = BLOCK_SIZE - 1;
+    return (x & mask) << (2 * BLOCK_BITS) | (y & mask) << BLOCK_BITS | (z & mask);
+}
+
+template <class T, class Allocator>
+int BlockSparseGrid<T, Allocator>::compute_max_depth(
+    size_type size_x,
+    size_type size_y,
+    size_type size_z) const
+{
+    int max_depth = 0;
+
+    int depth_x = (int)std::log2(size_x);
+    if (size_x != (size_type)1 << depth_x) {
+        ++depth_x;
+    }
+    int depth_y = (int)std::log2(size_y);
+    if (size_y != (size_type)1 << depth_y) {
+        ++depth_y;
+    }
+    int depth_z = (int)std::log2(size_z);
+    if (size_z != (size_type)1 << depth_z) {
+        ++depth_z;
+    }
+
+    max_depth = std::max(max_depth, depth_x);
+    max_depth = std::max(max_depth, depth_y);
+    max_depth = std::max(max_depth, depth_z);
+    return max_depth;
+}
+
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::find_block(std::uint64_t key) const
+    -> const block_type*
+{
+    auto it = m_blocks.find(key);
+    return it == m_blocks.end() ? nullptr : &it->second;
+}
+
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::find_block(std::uint64_t key)
+    -> block_type*
+{
+    auto it = m_blocks.find(key);
+    return it == m_blocks.end() ? nullptr : &it->second;
+}
+
+/// Insert a uniform block holding the background value.
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::insert_block(std::uint64_t key)
+    -> block_type*
+{
+    block_type b;
+    b.cells = nullptr;
+    b.value = m_value;
+    return &m_blocks.emplace(key, std::move(b)).first->second;
+}
+
+template <class T, class Allocator>
+void BlockSparseGrid<T, Allocator>::expand_block(block_type& b)
+{
+    using traits = std::allocator_traits<Allocator>;
+    T* cells = traits::allocate(m_alloc, BLOCK_CELL_COUNT);
+    for (T* c = cells; c != cells + BLOCK_CELL_COUNT; ++c) {
+        traits::construct(m_alloc, c, b.value);
+    }
+    b.cells = cells;
+}
+
+template <class T, class Allocator>
+void BlockSparseGrid<T, Allocator>::collapse_block(block_type& b)
+{
+    using traits = std::allocator_traits<Allocator>;
+    b.value = b.cells[0];
+    for (T* c = b.cells; c != b.cells + BLOCK_CELL_COUNT; ++c) {
+        traits::destroy(m_alloc, c);
+    }
+    traits::deallocate(m_alloc, b.cells, BLOCK_CELL_COUNT);
+    b.cells = nullptr;
+}
+
+template <class T, class Allocator>
+bool BlockSparseGrid<T, Allocator>::uniform(const block_type& b) const
+{
+    for (const T* c = b.cells + 1; c != b.cells + BLOCK_CELL_COUNT; ++c) {
+        if (!std::equal_to<T>()(*c, b.cells[0])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::get_cell(const block_type& b, int index)
+    -> const_reference
+{
+    return b.cells ? b.cells[index] : b.value;
+}
+
+template <class T, class Allocator>
+auto BlockSparseGrid<T, Allocator>::get_cell_unique(block_type& b, int index)
+    -> reference
+{
+    if (!b.cells) {
+        expand_block(b);
+    }
+    return b.cells[index];
+}
+
+template <class T, class Allocator>
+void BlockSparseGrid<T, Allocator>::set_cell(
+    block_type& b, int index, const T& value)
+{
+    if (!b.cells) {
+        if (std::equal_to<T>()(value, b.value)) {
+            return;
+        }
+        expand_block(b);
+    }
+
+    T& c = b.cells[index];
+    if (std::equal_to<T>()(c, value)) {
+        return;
+    }
+    c = value;
+
+    // only check for collapse when restoring the value the block was expanded
+    // from, to avoid scanning the block on every modification
+    if (std::equal_to<T>()(value, b.value) && uniform(b)) {
+        collapse_block(b);
+    }
+}
+
+template <class T, class Allocator>
+void BlockSparseGrid<T, Allocator>::set_cell_lazy(
+    block_type& b, int index, const T& value)
+{
+    if (!b.cells) {
+        if (std::equal_to<T>()(value, b.value)) {
+            return;
+        }
+        expand_block(b);
+    }
+    b.cells[index] = value;
+}
+
+template <class T, class Allocator>
+void BlockSparseGrid<T, Allocator>::clear_blocks()
+{
+    using traits = std::allocator_traits<Allocator>;
+    for (auto& entry : m_blocks) {
+        block_type& b = entry.second;
+        if (b.cells) {
+            for (T* c = b.cells; c != b.cells + BLOCK_CELL_COUNT; ++c) {
+                traits::destroy(m_alloc, c);
+            }
+            traits::deallocate(m_alloc, b.cells, BLOCK_CELL_COUNT);
+        }
+    }
+    m_blocks.clear();
+}
+
+template <class T, class Allocator>
+void BlockSparseGrid<T, Allocator>::copy_blocks(const BlockSparseGrid& o)
+{
+    using traits = std::allocator_traits<Allocator>;
+    m_blocks.reserve(o.m_blocks.size());
+    for (const auto& entry : o.m_blocks) {
+        block_type b;
+        b.cells = nullptr;
+        b.value = entry.second.value;
+        if (entry.second.cells) {
+            b.cells = traits::allocate(m_alloc, BLOCK_CELL_COUNT);
+            for (int i = 0; i < BLOCK_CELL_COUNT; ++i) {
+                traits::construct(m_alloc, b.cells + i, entry.second.cells[i]);
+            }
+        }
+        m_blocks.emplace(entry.first, std::move(b));
+    }
+}
+
+} // namespace sbpl
+
+#endif
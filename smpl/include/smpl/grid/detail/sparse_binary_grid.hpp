@@ -4,6 +4,8 @@
 #include "../sparse_binary_grid.h"
 
 #include <stdio.h>
+#include <algorithm>
+#include <limits>
 
 namespace sbpl {
 
@@ -244,6 +246,9 @@ void SparseBinaryGrid<Allocator>::resize(
     size_type size_y,
     size_type size_z)
 {
+    m_osize[0] = size_x;
+    m_osize[1] = size_y;
+    m_osize[2] = size_z;
     m_grid.resize(reduced(size_x), reduced(size_y), reduced(size_z));
 }
 
@@ -254,9 +259,69 @@ void SparseBinaryGrid<Allocator>::resize(
     size_type size_z,
     bool value)
 {
+    m_osize[0] = size_x;
+    m_osize[1] = size_y;
+    m_osize[2] = size_z;
     m_grid.resize(reduced(size_x), reduced(size_y), reduced(size_z), initval(value));
 }
 
+/// Set all cells in the box [first_x, last_x) x [first_y, last_y) x
+/// [first_z, last_z) to \p value. Packed cells entirely within the box are
+/// filled through SparseGrid::fill_region; only the packed cells along the
+/// boundary of the box are updated individually.
+template <class Allocator>
+void SparseBinaryGrid<Allocator>::fill_region(
+    index_type first_x, index_type first_y, index_type first_z,
+    index_type last_x, index_type last_y, index_type last_z,
+    bool value)
+{
+    region_type region;
+    if (!make_region(
+            first_x, first_y, first_z, last_x, last_y, last_z, region))
+    {
+        return;
+    }
+
+    // packed cells covering the box, and packed cells entirely within it
+    index_type cover_first[3], cover_last[3];
+    index_type inner_first[3], inner_last[3];
+    bool inner = true;
+    for (int i = 0; i < 3; ++i) {
+        cover_first[i] = (index_type)(region.first[i] >> 1);
+        cover_last[i] = (index_type)((region.last[i] + 1) >> 1);
+        inner_first[i] = (index_type)((region.first[i] + 1) >> 1);
+        inner_last[i] = (index_type)(region.last[i] >> 1);
+        inner &= inner_first[i] < inner_last[i];
+    }
+
+    if (inner) {
+        m_grid.fill_region(
+                inner_first[0], inner_first[1], inner_first[2],
+                inner_last[0], inner_last[1], inner_last[2],
+                initval(value));
+    }
+
+    for (index_type x = cover_first[0]; x != cover_last[0]; ++x) {
+        const bool inner_x = x >= inner_first[0] && x < inner_last[0];
+        for (index_type y = cover_first[1]; y != cover_last[1]; ++y) {
+            const bool inner_y = y >= inner_first[1] && y < inner_last[1];
+            if (inner && inner_x && inner_y) {
+                // only the ends of this column lie on the boundary
+                for (index_type z = cover_first[2]; z != inner_first[2]; ++z) {
+                    fill_packed(x, y, z, region, value);
+                }
+                for (index_type z = inner_last[2]; z != cover_last[2]; ++z) {
+                    fill_packed(x, y, z, region, value);
+                }
+            } else {
+                for (index_type z = cover_first[2]; z != cover_last[2]; ++z) {
+                    fill_packed(x, y, z, region, value);
+                }
+            }
+        }
+    }
+}
+
 template <class Allocator>
 template <class Pred>
 auto SparseBinaryGrid<Allocator>::mem_usage_full(const Pred& pred) -> size_type
@@ -264,11 +329,90 @@ auto SparseBinaryGrid<Allocator>::mem_usage_full(const Pred& pred) -> size_type
     return m_grid.mem_usage_full(pred);
 }
 
+/// Call \p c with the value of each uniform box of cells, as
+/// c(value, first_x, first_y, first_z, last_x, last_y, last_z), where value is
+/// a bool and the box is the half-open range of cells it covers. Packed cells
+/// that are neither entirely set nor entirely unset are reported one cell at a
+/// time.
 template <class Allocator>
 template <typename Callable>
 void SparseBinaryGrid<Allocator>::accept_coords(Callable c)
 {
-    return m_grid.accept_coords(c);
+    region_type all;
+    for (int i = 0; i < 3; ++i) {
+        all.first[i] = 0;
+        all.last[i] = std::numeric_limits<size_type>::max();
+    }
+
+    m_grid.accept_coords([&](
+        std::uint8_t value,
+        size_type first_x, size_type first_y, size_type first_z,
+        size_type last_x, size_type last_y, size_type last_z)
+    {
+        accept_packed(
+                c, value,
+                first_x, first_y, first_z, last_x, last_y, last_z,
+                all);
+    });
+}
+
+/// Call \p c as accept_coords(), but only for boxes that intersect the box
+/// [first_x, last_x) x [first_y, last_y) x [first_z, last_z), clipped to it.
+template <class Allocator>
+template <typename Callable>
+void SparseBinaryGrid<Allocator>::accept_coords(
+    Callable c,
+    index_type first_x, index_type first_y, index_type first_z,
+    index_type last_x, index_type last_y, index_type last_z) const
+{
+    region_type region;
+    if (!make_region(
+            first_x, first_y, first_z, last_x, last_y, last_z, region))
+    {
+        return;
+    }
+
+    m_grid.accept_coords([&](
+            std::uint8_t value,
+            size_type x0, size_type y0, size_type z0,
+            size_type x1, size_type y1, size_type z1)
+        {
+            accept_packed(c, value, x0, y0, z0, x1, y1, z1, region);
+        },
+        (index_type)(region.first[0] >> 1),
+        (index_type)(region.first[1] >> 1),
+        (index_type)(region.first[2] >> 1),
+        (index_type)((region.last[0] + 1) >> 1),
+        (index_type)((region.last[1] + 1) >> 1),
+        (index_type)((region.last[2] + 1) >> 1));
+}
+
+/// Call \p c as accept_coords(), visiting the subtrees of the root's children
+/// concurrently using up to \p thread_count threads. \p c must be safe to
+/// call concurrently.
+template <class Allocator>
+template <typename Callable>
+void SparseBinaryGrid<Allocator>::accept_coords_parallel(
+    Callable c,
+    int thread_count)
+{
+    region_type all;
+    for (int i = 0; i < 3; ++i) {
+        all.first[i] = 0;
+        all.last[i] = std::numeric_limits<size_type>::max();
+    }
+
+    m_grid.accept_coords_parallel([&](
+            std::uint8_t value,
+            size_type first_x, size_type first_y, size_type first_z,
+            size_type last_x, size_type last_y, size_type last_z)
+        {
+            accept_packed(
+                    c, value,
+                    first_x, first_y, first_z, last_x, last_y, last_z,
+                    all);
+        },
+        thread_count);
 }
 
 template <class Allocator>
@@ -293,6 +437,120 @@ std::uint8_t SparseBinaryGrid<Allocator>::get_mask(int x, int y, int z) const
     return 1 << ((cx << 2) | (cy << 1) | (cz));
 }
 
+/// Convert a box of cells into a non-empty region, clamped to the extent of
+/// the grid. Return false if the clamped box is empty.
+template <class Allocator>
+bool SparseBinaryGrid<Allocator>::make_region(
+    index_type first_x, index_type first_y, index_type first_z,
+    index_type last_x, index_type last_y, index_type last_z,
+    region_type& region) const
+{
+    const index_type first[3] = { first_x, first_y, first_z };
+    const index_type last[3] = { last_x, last_y, last_z };
+    for (int i = 0; i < 3; ++i) {
+        if (last[i] <= std::max(first[i], 0)) {
+            return false;
+        }
+        region.first[i] = (size_type)std::max(first[i], 0);
+        region.last[i] = std::min((size_type)last[i], m_osize[i]);
+        if (region.last[i] <= region.first[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Set the cells of the packed cell (x, y, z) that lie within \p region to
+/// \p value.
+template <class Allocator>
+void SparseBinaryGrid<Allocator>::fill_packed(
+    index_type x, index_type y, index_type z,
+    const region_type& region,
+    bool value)
+{
+    const index_type packed[3] = { x, y, z };
+
+    // which of the two cells along each axis lie within the region
+    bool inside[3][2];
+    for (int i = 0; i < 3; ++i) {
+        for (int c = 0; c < 2; ++c) {
+            const size_type cell = 2 * (size_type)packed[i] + c;
+            inside[i][c] = cell >= region.first[i] && cell < region.last[i];
+        }
+    }
+
+    std::uint8_t mask = 0;
+    for (int i = 0; i < 8; ++i) {
+        if (inside[0][(i >> 2) & 1] & inside[1][(i >> 1) & 1] & inside[2][i & 1]) {
+            mask |= 1 << i;
+        }
+    }
+
+    std::uint8_t curr = m_grid.get(x, y, z);
+    std::uint8_t next = value ? (curr | mask) : (curr & ~mask);
+    if (curr != next) {
+        m_grid.set(x, y, z, next);
+    }
+}
+
+/// Report a leaf of the packed grid, holding \p value over the packed cells
+/// [first_x, last_x) x [first_y, last_y) x [first_z, last_z), as boxes of
+/// cells clipped to \p region.
+template <class Allocator>
+template <typename Callable>
+void SparseBinaryGrid<Allocator>::accept_packed(
+    Callable& c,
+    std::uint8_t value,
+    size_type first_x, size_type first_y, size_type first_z,
+    size_type last_x, size_type last_y, size_type last_z,
+    const region_type& region)
+{
+    if (value == 0x00 || value == 0xFF) {
+        accept_box(
+                c, value != 0x00,
+                2 * first_x, 2 * first_y, 2 * first_z,
+                2 * last_x, 2 * last_y, 2 * last_z,
+                region);
+        return;
+    }
+
+    for (size_type x = first_x; x != last_x; ++x) {
+    for (size_type y = first_y; y != last_y; ++y) {
+    for (size_type z = first_z; z != last_z; ++z) {
+        for (int i = 0; i < 8; ++i) {
+            const size_type cx = 2 * x + ((i >> 2) & 1);
+            const size_type cy = 2 * y + ((i >> 1) & 1);
+            const size_type cz = 2 * z + (i & 1);
+            accept_box(
+                    c, (bool)(value & (1 << i)),
+                    cx, cy, cz, cx + 1, cy + 1, cz + 1,
+                    region);
+        }
+    }
+    }
+    }
+}
+
+template <class Allocator>
+template <typename Callable>
+void SparseBinaryGrid<Allocator>::accept_box(
+    Callable& c,
+    bool value,
+    size_type first_x, size_type first_y, size_type first_z,
+    size_type last_x, size_type last_y, size_type last_z,
+    const region_type& region)
+{
+    first_x = std::max(first_x, region.first[0]);
+    first_y = std::max(first_y, region.first[1]);
+    first_z = std::max(first_z, region.first[2]);
+    last_x = std::min(last_x, region.last[0]);
+    last_y = std::min(last_y, region.last[1]);
+    last_z = std::min(last_z, region.last[2]);
+    if (first_x < last_x && first_y < last_y && first_z < last_z) {
+        c(value, first_x, first_y, first_z, last_x, last_y, last_z);
+    }
+}
+
 } // namespace sbpl
 
 #endif
@@ -38,6 +38,9 @@
 #include <assert.h>
 #include <limits>
 
+// project includes
+#include <smpl/parallel_for.h>
+
 namespace sbpl {
 
 template <class T, class Allocator>
@@ -269,6 +272,27 @@ SparseGrid<T, Allocator>::resize(
     m_tree.root()->value = value;
 }
 
+/// Set all cells in the box [first_x, last_x) x [first_y, last_y) x
+/// [first_z, last_z) to \p value. Nodes entirely within the box are collapsed
+/// without visiting their descendants, so the cost is proportional to the
+/// number of nodes along the boundary of the box rather than the number of
+/// cells within it. As with set(), nodes are pruned where possible.
+template <class T, class Allocator>
+void SparseGrid<T, Allocator>::fill_region(
+    index_type first_x, index_type first_y, index_type first_z,
+    index_type last_x, index_type last_y, index_type last_z,
+    const T& value)
+{
+    region_type region;
+    if (!make_region(
+            first_x, first_y, first_z, last_x, last_y, last_z, region))
+    {
+        return;
+    }
+
+    fill_node(m_tree.root(), 0, 0, 0, (size_type)1 << m_max_depth, region, value);
+}
+
 template <class T, class Allocator>
 typename SparseGrid<T, Allocator>::const_reference
 SparseGrid<T, Allocator>::get(index_type x, index_type y, index_type z) const
@@ -322,6 +346,56 @@ void SparseGrid<T, Allocator>::accept_coords(Callable c)
     accept_coords(c, m_tree.root(), 0, 0, 0, max_coord, max_coord, max_coord);
 }
 
+/// Call \p c with the value of each leaf that intersects the box [first_x,
+/// last_x) x [first_y, last_y) x [first_z, last_z), along with the extents of
+/// the leaf clipped to the box. Subtrees outside the box are not visited.
+template <class T, class Allocator>
+template <typename Callable>
+void SparseGrid<T, Allocator>::accept_coords(
+    Callable c,
+    index_type first_x, index_type first_y, index_type first_z,
+    index_type last_x, index_type last_y, index_type last_z) const
+{
+    region_type region;
+    if (!make_region(
+            first_x, first_y, first_z, last_x, last_y, last_z, region))
+    {
+        return;
+    }
+
+    accept_coords_in_region(
+            c, m_tree.root(), 0, 0, 0, (size_type)1 << m_max_depth, region);
+}
+
+/// Call \p c with the value and extents of each leaf, as accept_coords(), but
+/// visit the subtrees of the root's children concurrently, using up to
+/// \p thread_count threads. \p c must be safe to call concurrently; leaves
+/// within a subtree are visited in the same order as accept_coords().
+template <class T, class Allocator>
+template <typename Callable>
+void SparseGrid<T, Allocator>::accept_coords_parallel(
+    Callable c,
+    int thread_count)
+{
+    const size_type max_coord = (size_type)1 << m_max_depth;
+    node_type* root = m_tree.root();
+    if (!root->children) {
+        c(root->value, 0, 0, 0, max_coord, max_coord, max_coord);
+        return;
+    }
+
+    const size_type half = max_coord >> 1;
+    ParallelFor(0, 8, thread_count, [&](std::size_t i)
+    {
+        const size_type x = ((i >> 2) & 1) * half;
+        const size_type y = ((i >> 1) & 1) * half;
+        const size_type z = (i & 1) * half;
+        accept_coords(
+                c, &root->children[i],
+                x, y, z, x + half, y + half, z + half);
+    });
+}
+
 template <class T, class Allocator>
 int SparseGrid<T, Allocator>::compute_max_depth(
     size_type size_x,
@@ -540,8 +614,11 @@ template <class T, class Allocator>
 bool SparseGrid<T, Allocator>::collapsible(node_type* n) const
 {
     assert(n->children);
+    if (n->children[0].children) {
+        return false;
+    }
     for (node_type* c = n->children + 1; c != n->children + 8; ++c) {
-        if (!std::equal_to<T>()(c->value, n->children[0].value)) {
+        if (c->children || !std::equal_to<T>()(c->value, n->children[0].value)) {
             return false;
         }
     }
@@ -616,6 +693,116 @@ void SparseGrid<T, Allocator>::accept_coords(
     }
 }
 
+/// Convert a box of cells into a non-empty region, clamped to the extent of
+/// the grid. Return false if the clamped box is empty.
+template <class T, class Allocator>
+bool SparseGrid<T, Allocator>::make_region(
+    index_type first_x, index_type first_y, index_type first_z,
+    index_type last_x, index_type last_y, index_type last_z,
+    region_type& region) const
+{
+    const index_type first[3] = { first_x, first_y, first_z };
+    const index_type last[3] = { last_x, last_y, last_z };
+    for (int i = 0; i < 3; ++i) {
+        if (last[i] <= std::max(first[i], 0)) {
+            return false;
+        }
+        region.first[i] = (size_type)std::max(first[i], 0);
+        region.last[i] = std::min((size_type)last[i], m_size[i]);
+        if (region.last[i] <= region.first[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <class T, class Allocator>
+void SparseGrid<T, Allocator>::fill_node(
+    node_type* n,
+    size_type x, size_type y, size_type z, size_type size,
+    const region_type& region,
+    const T& value)
+{
+    const size_type first[3] = { x, y, z };
+    bool contained = true;
+    for (int i = 0; i < 3; ++i) {
+        if (first[i] >= region.last[i] || first[i] + size <= region.first[i]) {
+            return; // disjoint
+        }
+        contained &= first[i] >= region.first[i] &&
+                first[i] + size <= region.last[i];
+    }
+
+    if (contained) {
+        if (n->children) {
+            m_tree.collapse_subtree(n, value);
+        } else {
+            n->value = value;
+        }
+        return;
+    }
+
+    if (!n->children) {
+        if (std::equal_to<T>()(n->value, value)) {
+            return;
+        }
+        m_tree.expand_node(n);
+    }
+
+    const size_type half = size >> 1;
+    for (int i = 0; i < 8; ++i) {
+        fill_node(
+                &n->children[i],
+                x + ((i >> 2) & 1) * half,
+                y + ((i >> 1) & 1) * half,
+                z + (i & 1) * half,
+                half,
+                region,
+                value);
+    }
+
+    if (collapsible(n)) {
+        m_tree.collapse_node(n, n->children[0].value);
+    }
+}
+
+template <class T, class Allocator>
+template <typename Callable>
+void SparseGrid<T, Allocator>::accept_coords_in_region(
+    Callable& c, const node_type* n,
+    size_type x, size_type y, size_type z, size_type size,
+    const region_type& region) const
+{
+    const size_type first[3] = { x, y, z };
+    size_type clipped_first[3];
+    size_type clipped_last[3];
+    for (int i = 0; i < 3; ++i) {
+        if (first[i] >= region.last[i] || first[i] + size <= region.first[i]) {
+            return; // disjoint
+        }
+        clipped_first[i] = std::max(first[i], region.first[i]);
+        clipped_last[i] = std::min(first[i] + size, region.last[i]);
+    }
+
+    if (!n->children) {
+        c(n->value,
+                clipped_first[0], clipped_first[1], clipped_first[2],
+                clipped_last[0], clipped_last[1], clipped_last[2]);
+        return;
+    }
+
+    const size_type half = size >> 1;
+    for (int i = 0; i < 8; ++i) {
+        accept_coords_in_region(
+                c, &n->children[i],
+                x + ((i >> 2) & 1) * half,
+                y + ((i >> 1) & 1) * half,
+                z + (i & 1) * half,
+                half,
+                region);
+    }
+}
+
 } // namespace sbpl
 
 #endif
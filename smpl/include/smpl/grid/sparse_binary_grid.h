@@ -38,10 +38,11 @@
 
 // project includes
 #include <smpl/grid/sparse_grid.h>
+#include <smpl/octree/pool_allocator.h>
 
 namespace sbpl {
 
-template <class Allocator = std::allocator<std::uint8_t>>
+template <class Allocator = PoolAllocator<std::uint8_t>>
 class SparseBinaryGrid
 {
     struct packed_bool_ref;
@@ -110,6 +111,11 @@ public:
 
     void resize(size_type size_x, size_type size_y, size_type size_z);
     void resize(size_type size_x, size_type size_y, size_type size_z, bool value);
+
+    void fill_region(
+        index_type first_x, index_type first_y, index_type first_z,
+        index_type last_x, index_type last_y, index_type last_z,
+        bool value);
     ///@}
 
     template <class Pred>
@@ -118,6 +124,15 @@ public:
     template <typename Callable>
     void accept_coords(Callable c);
 
+    template <typename Callable>
+    void accept_coords(
+        Callable c,
+        index_type first_x, index_type first_y, index_type first_z,
+        index_type last_x, index_type last_y, index_type last_z) const;
+
+    template <typename Callable>
+    void accept_coords_parallel(Callable c, int thread_count);
+
     const TreeType& tree() const { return m_grid.tree(); }
 
 private:
@@ -139,12 +154,44 @@ private:
         }
     };
 
+    struct region_type
+    {
+        size_type first[3];
+        size_type last[3];
+    };
+
     SparseGrid<std::uint8_t, Allocator> m_grid;
     size_type m_osize[3];
 
     std::uint8_t initval(bool value) const;
     size_type reduced(size_type s) const;
     std::uint8_t get_mask(int x, int y, int z) const;
+
+    bool make_region(
+        index_type first_x, index_type first_y, index_type first_z,
+        index_type last_x, index_type last_y, index_type last_z,
+        region_type& region) const;
+
+    void fill_packed(
+        index_type x, index_type y, index_type z,
+        const region_type& region,
+        bool value);
+
+    template <typename Callable>
+    static void accept_packed(
+        Callable& c,
+        std::uint8_t value,
+        size_type first_x, size_type first_y, size_type first_z,
+        size_type last_x, size_type last_y, size_type last_z,
+        const region_type& region);
+
+    template <typename Callable>
+    static void accept_box(
+        Callable& c,
+        bool value,
+        size_type first_x, size_type first_y, size_type first_z,
+        size_type last_x, size_type last_y, size_type last_z,
+        const region_type& region);
 };
 
 } // namespace sbpl
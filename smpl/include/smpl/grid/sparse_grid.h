@@ -37,6 +37,7 @@
 
 // project includes
 #include <smpl/octree/octree.h>
+#include <smpl/octree/pool_allocator.h>
 
 namespace sbpl {
 
@@ -68,7 +69,7 @@ namespace sbpl {
 /// set() to skip automatic pruning of nodes. The underlying octree may then be
 /// explicitly pruned by calling the prune() function, which will prune all
 /// nodes where applicable for maximum compression.
-template <class T, class Allocator = std::allocator<T>>
+template <class T, class Allocator = PoolAllocator<T>>
 class SparseGrid
 {
 public:
@@ -135,6 +136,11 @@ public:
 
     void resize(size_type size_x, size_type size_y, size_type size_z);
     void resize(size_type size_x, size_type size_y, size_type size_z, const T& value);
+
+    void fill_region(
+        index_type first_x, index_type first_y, index_type first_z,
+        index_type last_x, index_type last_y, index_type last_z,
+        const T& value);
     ///@}
 
     template <class Pred>
@@ -146,10 +152,25 @@ public:
     template <typename Callable>
     void accept_coords(Callable c);
 
+    template <typename Callable>
+    void accept_coords(
+        Callable c,
+        index_type first_x, index_type first_y, index_type first_z,
+        index_type last_x, index_type last_y, index_type last_z) const;
+
+    template <typename Callable>
+    void accept_coords_parallel(Callable c, int thread_count);
+
     const TreeType &tree() const { return m_tree; }
 
 private:
 
+    struct region_type
+    {
+        size_type first[3];
+        size_type last[3];
+    };
+
     OcTree<T, Allocator> m_tree;
 
     int m_max_depth;
@@ -209,6 +230,23 @@ private:
         Callable c, node_type* n,
         size_type first_x, size_type first_y, size_type first_z,
         size_type last_x, size_type last_y, size_type last_z);
+
+    bool make_region(
+        index_type first_x, index_type first_y, index_type first_z,
+        index_type last_x, index_type last_y, index_type last_z,
+        region_type& region) const;
+
+    void fill_node(
+        node_type* n,
+        size_type x, size_type y, size_type z, size_type size,
+        const region_type& region,
+        const T& value);
+
+    template <typename Callable>
+    void accept_coords_in_region(
+        Callable& c, const node_type* n,
+        size_type x, size_type y, size_type z, size_type size,
+        const region_type& region) const;
 };
 
 } // namespace sbpl
@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_HASH_INDEX_H
+#define SMPL_HASH_INDEX_H
+
+// standard includes
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+namespace sbpl {
+
+/// An open-addressing hash index mapping externally-stored keys to integer
+/// ids. The index stores pointers to keys, which must remain valid and
+/// unmodified for as long as they are present in the index, together with
+/// their hash values so that collisions are resolved without dereferencing
+/// unrelated keys.
+///
+/// Entries are kept in a single flat array probed linearly and the table is
+/// doubled whenever it becomes half full. Entries may not be removed
+/// individually; the index is intended to map discrete states to state ids
+/// for the duration of a graph's lifetime.
+template <class Key, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+class HashIndex
+{
+public:
+
+    typedef Key         key_type;
+    typedef Hash        hasher;
+    typedef KeyEqual    key_equal;
+    typedef std::size_t size_type;
+
+    HashIndex(const hasher& hash = hasher(), const key_equal& equal = key_equal());
+
+    /// Return the id associated with a key equal to \p key or -1 if no such
+    /// key exists in the index.
+    int find(const Key& key) const;
+
+    /// Associate \p id with the key pointed to by \p key. If an equal key
+    /// already exists in the index, the index is left unmodified and the id
+    /// of the existing key is returned; otherwise \p id is returned.
+    int insert(const Key* key, int id);
+
+    bool empty() const;
+    size_type size() const;
+    size_type bucket_count() const;
+
+    void reserve(size_type count);
+    void clear();
+
+private:
+
+    struct Entry
+    {
+        std::size_t hash;
+        const Key* key;
+        int id;
+    };
+
+    std::vector<Entry> m_entries;
+    size_type m_size;
+    hasher m_hash;
+    key_equal m_equal;
+
+    static std::size_t mix(std::size_t h);
+
+    size_type probe(const Key& key, std::size_t hash) const;
+    void rehash(size_type bucket_count);
+};
+
+} // namespace sbpl
+
+#include "detail/hash_index.hpp"
+
+#endif
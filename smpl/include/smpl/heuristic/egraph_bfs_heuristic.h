@@ -33,11 +33,13 @@
 #define SMPL_EGRAPH_BFS_HEURISTIC_H
 
 // standard includes
+#include <cstdint>
+#include <limits>
 #include <vector>
 
 // project includes
 #include <smpl/grid.h>
-#include <smpl/intrusive_heap.h>
+#include <smpl/radix_heap.h>
 #include <smpl/graph/experience_graph_extension.h>
 #include <smpl/heuristic/egraph_heuristic.h>
 #include <smpl/heuristic/robot_heuristic.h>
@@ -67,6 +69,12 @@ public:
     void getShortcutSuccs(
         int state_id,
         std::vector<int>& ids) override;
+
+    void updateExperienceGraph(
+        ExperienceGraph::node_id first_node,
+        const std::vector<ExperienceGraph::edge_id>& edges) override;
+
+    void rebuildExperienceGraph() override;
     ///@}
 
     /// \name Required Public Functions from RobotHeuristic
@@ -98,56 +106,59 @@ private:
     static const int Wall = std::numeric_limits<int>::max();
     static const int Infinity = Unknown;
 
-    struct Cell : public heap_element
+    struct Cell
     {
         int dist;
 
         Cell() = default;
-        explicit Cell(int d) : heap_element(), dist(d) { }
+        explicit Cell(int d) : dist(d) { }
     };
 
     Grid3<Cell> m_dist_grid;
 
-    struct CellCompare
-    {
-        bool operator()(const Cell& a, const Cell& b) const {
-            return a.dist < b.dist;
-        }
-    };
-
     double m_eg_eps;
 
-    intrusive_heap<Cell, CellCompare> m_open;
+    // open list of cell indices, keyed by distance; cells may appear more than
+    // once and stale entries are skipped when removed
+    RadixHeap<int> m_open;
+
+    // index offsets and costs of the 26-connected neighbors of a cell
+    int m_neighbor_offsets[26];
+    int m_neighbor_costs[26];
 
     PointProjectionExtension* m_pp;
     ExperienceGraphExtension* m_eg;
 
-    // map down-projected state cells to adjacent down-projected state cells
-    struct Vector3iHash
-    {
-        typedef Eigen::Vector3i argument_type;
-        typedef std::size_t result_type;
-
-        result_type operator()(const argument_type& s) const;
-    };
-
-    // map from experience graph nodes to their heuristic cell coordinates
+    // map from experience graph nodes to their projections and heuristic cell
+    // coordinates, valid for the planning frame offset they were computed with
+    std::vector<Eigen::Vector3d> m_projected_points;
     std::vector<Eigen::Vector3i> m_projected_nodes;
+    double m_projection_offset[3];
 
     // map from experience graph nodes to their component ids
     std::vector<int> m_component_ids;
+    int m_component_count;
     std::vector<std::vector<ExperienceGraph::node_id>> m_shortcut_nodes;
 
-    struct HeuristicNode
-    {
-        std::vector<ExperienceGraph::node_id> up_nodes;
+    // version of the experience graph that the projections and components
+    // were computed for
+    std::uint64_t m_graph_version;
 
-        std::vector<Eigen::Vector3i> edges;
-    };
+    // adjacency between down-projected experience graph cells, stored in
+    // compressed rows indexed by cell index; the edges of cell i are in
+    // [m_edge_offsets[i], m_edge_offsets[i + 1])
+    std::vector<int> m_edge_offsets;
+    std::vector<int> m_edge_targets;
+    std::vector<int> m_edge_costs;
 
-    hash_map<Eigen::Vector3i, HeuristicNode, Vector3iHash> m_heur_nodes;
+    // experience graph nodes whose projections lie in each cell, stored in
+    // the same layout as the adjacency
+    std::vector<int> m_node_offsets;
+    std::vector<ExperienceGraph::node_id> m_cell_nodes;
 
     void projectExperienceGraph();
+    void projectExperienceGraphNodes(ExperienceGraph::node_id first_node);
+    void buildProjectedAdjacency();
     int getGoalHeuristic(const Eigen::Vector3i& dp);
 
     void syncGridAndDijkstra();
@@ -34,6 +34,8 @@
 
 #include <vector>
 
+#include <smpl/graph/experience_graph.h>
+
 namespace sbpl {
 namespace motion {
 
@@ -53,6 +55,18 @@ public:
         int state_id,
         std::vector<int>& ids) = 0;
 
+    /// Notify the heuristic that nodes and edges have been inserted into the
+    /// experience graph. Nodes with ids at or after \p first_node are new,
+    /// \p edges lists the new edges, and the ids of existing nodes and edges
+    /// are unchanged.
+    virtual void updateExperienceGraph(
+        ExperienceGraph::node_id first_node,
+        const std::vector<ExperienceGraph::edge_id>& edges) { }
+
+    /// Notify the heuristic that nodes or edges have been removed from the
+    /// experience graph, invalidating node and edge ids
+    virtual void rebuildExperienceGraph() { }
+
 private:
 };
 
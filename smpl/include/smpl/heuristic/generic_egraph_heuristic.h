@@ -32,8 +32,12 @@
 #ifndef SMPL_GENERIC_EGRAPH_HEURISTIC_H
 #define SMPL_GENERIC_EGRAPH_HEURISTIC_H
 
+// standard includes
+#include <cstdint>
+
 // project includes
 #include <smpl/intrusive_heap.h>
+#include <smpl/vantage_point_tree.h>
 #include <smpl/graph/experience_graph_extension.h>
 #include <smpl/heuristic/robot_heuristic.h>
 #include <smpl/heuristic/egraph_heuristic.h>
@@ -57,6 +61,12 @@ public:
     void getEquivalentStates(int state_id, std::vector<int>& ids) override;
 
     void getShortcutSuccs(int state_id, std::vector<int>& ids) override;
+
+    void updateExperienceGraph(
+        ExperienceGraph::node_id first_node,
+        const std::vector<ExperienceGraph::edge_id>& edges) override;
+
+    void rebuildExperienceGraph() override;
     ///@}
 
     /// \name Required Functions from RobotHeuristic
@@ -95,6 +105,11 @@ private:
     double m_eg_eps;
 
     std::vector<int> m_component_ids;
+    int m_component_count;
+
+    // version of the experience graph that the components were computed for
+    std::uint64_t m_graph_version;
+
     std::vector<std::vector<ExperienceGraph::node_id>> m_shortcut_nodes;
 
     struct HeuristicNode : public heap_element
@@ -115,6 +130,15 @@ private:
 
     std::vector<HeuristicNode> m_h_nodes;
     intrusive_heap<HeuristicNode, NodeCompare> m_open;
+
+    // experience graph state ids indexed by the original heuristic, assumed to
+    // be a metric, to find equivalent states without visiting every node
+    bool m_use_equiv_index;
+    VantagePointTree<int> m_equiv_index;
+    ExperienceGraph::nodes_size_type m_indexed_node_count;
+
+    void rebuildEquivalenceIndex();
+    void updateEquivalenceIndex();
 };
 
 } // namespace motion
@@ -0,0 +1,119 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_OBJECT_POOL_H
+#define SMPL_OBJECT_POOL_H
+
+// standard includes
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sbpl {
+
+/// An append-only arena of objects of type T. Objects are constructed in place
+/// inside fixed-size blocks, so creating an object costs at most one block
+/// allocation per \p BlockSize objects and pointers to objects remain valid
+/// until the pool is cleared or destroyed. Objects are stored contiguously in
+/// creation order, which keeps records created close together in time close
+/// together in memory.
+template <class T, std::size_t BlockSize = 1024>
+class ObjectPool
+{
+public:
+
+    typedef T           value_type;
+    typedef std::size_t size_type;
+
+    ObjectPool() : m_blocks(), m_size(0) { }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    ~ObjectPool()
+    {
+        clear();
+        for (Storage* block : m_blocks) {
+            delete[] block;
+        }
+    }
+
+    /// Construct a new object from the given arguments and return a pointer
+    /// to it.
+    template <class... Args>
+    T* create(Args&&... args)
+    {
+        const size_type bidx = m_size / BlockSize;
+        if (bidx == m_blocks.size()) {
+            m_blocks.push_back(new Storage[BlockSize]);
+        }
+        void* p = &m_blocks[bidx][m_size % BlockSize];
+        T* o = new (p) T(std::forward<Args>(args)...);
+        ++m_size;
+        return o;
+    }
+
+    T& operator[](size_type pos)
+    {
+        return *reinterpret_cast<T*>(&m_blocks[pos / BlockSize][pos % BlockSize]);
+    }
+
+    const T& operator[](size_type pos) const
+    {
+        return *reinterpret_cast<const T*>(&m_blocks[pos / BlockSize][pos % BlockSize]);
+    }
+
+    bool empty() const { return m_size == 0; }
+    size_type size() const { return m_size; }
+
+    /// Destroy all objects in the pool. Allocated blocks are retained and
+    /// reused by subsequent calls to create().
+    void clear()
+    {
+        for (size_type i = 0; i < m_size; ++i) {
+            (*this)[i].~T();
+        }
+        m_size = 0;
+    }
+
+private:
+
+    typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+
+    std::vector<Storage*> m_blocks;
+    size_type m_size;
+};
+
+} // namespace sbpl
+
+#endif
@@ -35,6 +35,7 @@
 
 // standard includes
 #include <algorithm>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -78,6 +79,8 @@ public:
         const std::vector<Eigen::Vector3d>& new_points);
 
     void reset();
+
+    std::uint32_t version() const { return m_version; }
     ///@}
 
     /// \name Properties
@@ -164,6 +167,8 @@ private:
     int m_y_stride;
     std::vector<int> m_counts;
 
+    std::uint32_t m_version;
+
     void initRefCounts();
 
     int coordToIndex(int x, int y, int z) const;
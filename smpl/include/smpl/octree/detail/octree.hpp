@@ -220,12 +220,14 @@ OcTree<T, Allocator>::num_leaves() const
 
 /// Return the approximate number of bytes used by the octree. Note the size is
 /// obtained from sizeof which will not account for dynamic memory allocated by
-/// an element
+/// an element. If the tree's allocator is a PoolAllocator, this is the number
+/// of bytes reserved by its pool, including blocks that are currently unused.
 template <class T, class Allocator>
 typename OcTree<T, Allocator>::size_type
 OcTree<T, Allocator>::mem_usage() const
 {
-    return mem_usage(root());
+    auto used = [this]() { return (num_nodes() - 1) * sizeof(node_type); };
+    return sizeof(*this) + detail::ReservedBytes(get_node_allocator(), used);
 }
 
 /// Return a pointer to the root node. This is never null.
@@ -258,6 +260,18 @@ void OcTree<T, Allocator>::collapse_node(node_type* n, const T& value)
     n->children = nullptr;
 }
 
+/// Collapse a node by recursively destroying and deallocating all of its
+/// descendants.
+template <class T, class Allocator>
+void OcTree<T, Allocator>::collapse_subtree(node_type* n, const T& value)
+{
+    // set value for node, before obliterating descendants in case value comes
+    // from them
+    n->value = value;
+    Base::clear_node(n);
+    n->children = nullptr;
+}
+
 /// Expand a node by allocating and constructing its children with the value of
 /// the element stored in the node. This function does not check for the
 /// existence of previous children and assumes no prior children exist have been
@@ -330,23 +344,6 @@ OcTree<T, Allocator>::count_leaves(const node_type* n) const
     }
 }
 
-template <class T, class Allocator>
-typename OcTree<T, Allocator>::size_type
-OcTree<T, Allocator>::mem_usage(const node_type* n) const
-{
-    if (!n->children) {
-        return sizeof(T);
-    }
-    else {
-        int sum = 0;
-        for (const node_type* c = n->children; c != n->children + 8; ++c) {
-            sum += mem_usage(c);
-        }
-
-        return sum;
-    }
-}
-
 template <class T, class Allocator>
 void
 OcTree<T, Allocator>::clone_children(node_type *nout, const node_type *nin)
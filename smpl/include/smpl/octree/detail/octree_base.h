@@ -35,8 +35,12 @@
 // standard includes
 #include <assert.h>
 #include <memory>
+#include <type_traits>
 #include <utility>
 
+// project includes
+#include <smpl/octree/pool_allocator.h>
+
 namespace sbpl {
 namespace detail {
 
@@ -111,7 +115,7 @@ public:
     allocator_type get_allocator() const noexcept
     { return allocator_type(get_node_allocator()); }
 
-    void clear() { clear_node(&m_impl.m_node); m_impl.m_node.children = nullptr; }
+    void clear();
 
 protected:
 
@@ -37,6 +37,25 @@
 namespace sbpl {
 namespace detail {
 
+/// Destroy and deallocate all nodes except the root. If the node allocator
+/// can release all of its memory at once, nodes are not deallocated
+/// individually, and trivially destructible nodes are not visited at all.
+template <class T, class Allocator>
+void
+OcTreeBase<T, Allocator>::clear()
+{
+    if (std::is_trivially_destructible<node_type>::value &&
+        ReleaseAll(get_node_allocator()))
+    {
+        m_impl.m_node.children = nullptr;
+        return;
+    }
+
+    clear_node(&m_impl.m_node);
+    m_impl.m_node.children = nullptr;
+    ReleaseAll(get_node_allocator());
+}
+
 template <class T, class Allocator>
 const typename OcTreeBase<T, Allocator>::node_allocator_type&
 OcTreeBase<T, Allocator>::get_node_allocator() const noexcept
@@ -0,0 +1,239 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_POOL_ALLOCATOR_HPP
+#define SMPL_POOL_ALLOCATOR_HPP
+
+#include "../pool_allocator.h"
+
+// standard includes
+#include <algorithm>
+#include <new>
+
+namespace sbpl {
+namespace detail {
+
+inline PoolResource::PoolResource() :
+    m_classes(),
+    m_slabs(),
+    m_reserved(0)
+{
+}
+
+inline PoolResource::~PoolResource()
+{
+    release();
+}
+
+/// Return a block of at least \p size bytes, aligned for any fundamental type.
+inline void* PoolResource::allocate(std::size_t size)
+{
+    size_class& c = get_size_class(size);
+
+    if (c.free) {
+        free_block* b = c.free;
+        c.free = b->next;
+        return b;
+    }
+
+    if (c.next == c.end) {
+        const std::size_t slab_size = c.size * BLOCKS_PER_SLAB;
+        m_slabs.reserve(m_slabs.size() + 1);
+        char* slab = static_cast<char*>(::operator new(slab_size));
+        m_slabs.push_back(slab);
+        m_reserved += slab_size;
+        c.next = slab;
+        c.end = slab + slab_size;
+    }
+
+    void* p = c.next;
+    c.next += c.size;
+    return p;
+}
+
+/// Return a block of \p size bytes, obtained from allocate(), to its free list.
+inline void PoolResource::deallocate(void* p, std::size_t size)
+{
+    size_class& c = get_size_class(size);
+    c.free = ::new (p) free_block{ c.free };
+}
+
+/// Return all slabs to the system at once, invalidating all blocks allocated
+/// from the resource.
+inline void PoolResource::release()
+{
+    for (void* slab : m_slabs) {
+        ::operator delete(slab);
+    }
+    m_slabs.clear();
+    for (size_class& c : m_classes) {
+        c.free = nullptr;
+        c.next = c.end = nullptr;
+    }
+    m_reserved = 0;
+}
+
+/// Return the number of bytes reserved by slabs, including blocks that are
+/// currently free.
+inline std::size_t PoolResource::mem_usage() const
+{
+    return m_reserved + m_slabs.capacity() * sizeof(void*) +
+            m_classes.capacity() * sizeof(size_class);
+}
+
+inline auto PoolResource::get_size_class(std::size_t size) -> size_class&
+{
+    // round up so that consecutive blocks within a slab remain aligned
+    const std::size_t align = alignof(std::max_align_t);
+    size = std::max(size, sizeof(free_block));
+    size = (size + align - 1) / align * align;
+
+    // expect very few distinct sizes; usually only one
+    for (size_class& c : m_classes) {
+        if (c.size == size) {
+            return c;
+        }
+    }
+
+    m_classes.push_back(size_class{ size, nullptr, nullptr, nullptr });
+    return m_classes.back();
+}
+
+template <class Allocator>
+bool ReleaseAll(Allocator&)
+{
+    return false;
+}
+
+/// Release all memory held by the pool of \p alloc, if no other allocator
+/// refers to the pool.
+template <class T>
+bool ReleaseAll(PoolAllocator<T>& alloc)
+{
+    return alloc.release();
+}
+
+/// Return the number of bytes reserved by \p alloc on behalf of a container.
+/// For allocators without statistics, this is the number of bytes in use by the
+/// container, as returned by \p used.
+template <class Allocator, class UsedBytes>
+std::size_t ReservedBytes(const Allocator&, UsedBytes used)
+{
+    return used();
+}
+
+template <class T, class UsedBytes>
+std::size_t ReservedBytes(const PoolAllocator<T>& alloc, UsedBytes)
+{
+    return alloc.mem_usage();
+}
+
+} // namespace detail
+
+template <class T>
+PoolAllocator<T>::PoolAllocator() :
+    m_pool(std::make_shared<detail::PoolResource>())
+{
+}
+
+template <class T>
+template <class U>
+PoolAllocator<T>::PoolAllocator(const PoolAllocator<U>& o) :
+    m_pool(o.m_pool)
+{
+}
+
+template <class T>
+T* PoolAllocator<T>::allocate(std::size_t n)
+{
+    if (!pooled(n)) {
+        return std::allocator<T>().allocate(n);
+    }
+    return static_cast<T*>(m_pool->allocate(n * sizeof(T)));
+}
+
+template <class T>
+void PoolAllocator<T>::deallocate(T* p, std::size_t n)
+{
+    if (!pooled(n)) {
+        return std::allocator<T>().deallocate(p, n);
+    }
+    m_pool->deallocate(p, n * sizeof(T));
+}
+
+template <class T>
+PoolAllocator<T> PoolAllocator<T>::select_on_container_copy_construction() const
+{
+    return PoolAllocator();
+}
+
+/// Return all memory held by the pool to the system, if this allocator is the
+/// only one referring to it. Return whether the memory was released.
+template <class T>
+bool PoolAllocator<T>::release()
+{
+    if (m_pool.use_count() != 1) {
+        return false;
+    }
+    m_pool->release();
+    return true;
+}
+
+/// Return the number of bytes reserved by the pool, including blocks that are
+/// not currently allocated.
+template <class T>
+std::size_t PoolAllocator<T>::mem_usage() const
+{
+    return m_pool->mem_usage();
+}
+
+template <class T>
+bool PoolAllocator<T>::pooled(std::size_t n)
+{
+    return alignof(T) <= alignof(std::max_align_t) &&
+            n * sizeof(T) <= detail::PoolResource::MAX_BLOCK_SIZE;
+}
+
+template <class T, class U>
+bool operator==(const PoolAllocator<T>& a, const PoolAllocator<U>& b)
+{
+    return a.m_pool == b.m_pool;
+}
+
+template <class T, class U>
+bool operator!=(const PoolAllocator<T>& a, const PoolAllocator<U>& b)
+{
+    return !(a == b);
+}
+
+} // namespace sbpl
+
+#endif
@@ -106,6 +106,7 @@ public:
     const node_type* root() const;
 
     void collapse_node(node_type* n, const T& value);
+    void collapse_subtree(node_type* n, const T& value);
 
     void expand_node(node_type* n);
 
@@ -165,7 +166,6 @@ protected:
     size_type count_nodes(const node_type* n) const;
     size_type count_leaves(const node_type* n) const;
 
-    size_type mem_usage(const node_type* n) const;
 
     void clone_children(node_type *nout, const node_type *nin);
     void move_children(node_type *nout, node_type *nin);
@@ -0,0 +1,173 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_POOL_ALLOCATOR_H
+#define SMPL_POOL_ALLOCATOR_H
+
+// standard includes
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace sbpl {
+namespace detail {
+
+/// Storage for fixed-size blocks of memory, carved out of larger slabs. Each
+/// distinct block size is served from its own free list. Released blocks are
+/// kept on their free list for reuse and slabs are only returned to the system
+/// when the resource is released or destroyed.
+///
+/// The resource performs no synchronization; it must only be used by one
+/// thread at a time.
+class PoolResource
+{
+public:
+
+    static const std::size_t BLOCKS_PER_SLAB = 64;
+    static const std::size_t MAX_BLOCK_SIZE = 1024;
+
+    PoolResource();
+    ~PoolResource();
+
+    PoolResource(const PoolResource&) = delete;
+    PoolResource& operator=(const PoolResource&) = delete;
+
+    void* allocate(std::size_t size);
+    void deallocate(void* p, std::size_t size);
+
+    void release();
+
+    std::size_t mem_usage() const;
+
+private:
+
+    struct free_block
+    {
+        free_block* next;
+    };
+
+    struct size_class
+    {
+        std::size_t size;
+        free_block* free;
+        char* next;
+        char* end;
+    };
+
+    std::vector<size_class> m_classes;
+    std::vector<void*> m_slabs;
+    std::size_t m_reserved;
+
+    size_class& get_size_class(std::size_t size);
+};
+
+} // namespace detail
+
+/// An allocator that serves allocations from a pool of fixed-size blocks. It
+/// is tailored to containers, such as OcTree, that repeatedly allocate and
+/// free arrays of the same size, and avoids a trip to the system allocator for
+/// each expansion and collapse of a node. Allocations larger than
+/// detail::PoolResource::MAX_BLOCK_SIZE bytes, and allocations of over-aligned
+/// types, bypass the pool.
+///
+/// Copies of an allocator, including rebound copies, share the same pool. A
+/// default-constructed allocator, and the allocator selected for a copy of a
+/// container, create a new pool, so that each container owns its storage and
+/// may be used from a separate thread without locking.
+template <class T>
+class PoolAllocator
+{
+public:
+
+    using value_type = T;
+
+    using propagate_on_container_copy_assignment    = std::false_type;
+    using propagate_on_container_move_assignment    = std::true_type;
+    using propagate_on_container_swap               = std::true_type;
+
+    PoolAllocator();
+
+    PoolAllocator(const PoolAllocator& o) = default;
+
+    template <class U>
+    PoolAllocator(const PoolAllocator<U>& o);
+
+    PoolAllocator& operator=(const PoolAllocator& rhs) = default;
+
+    T* allocate(std::size_t n);
+    void deallocate(T* p, std::size_t n);
+
+    PoolAllocator select_on_container_copy_construction() const;
+
+    bool release();
+
+    std::size_t mem_usage() const;
+
+private:
+
+    template <class U> friend class PoolAllocator;
+
+    template <class U, class V>
+    friend bool operator==(const PoolAllocator<U>&, const PoolAllocator<V>&);
+
+    std::shared_ptr<detail::PoolResource> m_pool;
+
+    static bool pooled(std::size_t n);
+};
+
+template <class T, class U>
+bool operator==(const PoolAllocator<T>& a, const PoolAllocator<U>& b);
+
+template <class T, class U>
+bool operator!=(const PoolAllocator<T>& a, const PoolAllocator<U>& b);
+
+namespace detail {
+
+template <class Allocator>
+bool ReleaseAll(Allocator& alloc);
+
+template <class T>
+bool ReleaseAll(PoolAllocator<T>& alloc);
+
+template <class Allocator, class UsedBytes>
+std::size_t ReservedBytes(const Allocator& alloc, UsedBytes used);
+
+template <class T, class UsedBytes>
+std::size_t ReservedBytes(const PoolAllocator<T>& alloc, UsedBytes used);
+
+} // namespace detail
+
+} // namespace sbpl
+
+#include "detail/pool_allocator.hpp"
+
+#endif
@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_RADIX_HEAP_H
+#define SMPL_RADIX_HEAP_H
+
+// standard includes
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+namespace sbpl {
+
+/// A monotone priority queue over unsigned 32-bit integer keys, suitable for
+/// Dijkstra's algorithm with integer edge costs. The key of every inserted
+/// element must be no less than the key of the most recently removed element.
+///
+/// Elements are stored in buckets by the position of the highest bit in which
+/// their key differs from the last removed key. Removing the minimum element
+/// redistributes at most one bucket into lower buckets, so each element moves
+/// at most 32 times over its lifetime.
+///
+/// The heap does not support decreasing the key of an element. Instead, an
+/// element may be inserted again with a smaller key, and the caller should
+/// ignore removed elements whose key is stale.
+template <class T>
+class RadixHeap
+{
+public:
+
+    typedef std::uint32_t   key_type;
+    typedef T               value_type;
+    typedef std::size_t     size_type;
+
+    RadixHeap();
+
+    bool empty() const;
+    size_type size() const;
+
+    void push(key_type key, const T& value);
+
+    /// Remove the element with the minimum key, storing its key and value in
+    /// \p key and \p value
+    void pop(key_type& key, T& value);
+
+    void clear();
+
+private:
+
+    static const int BucketCount = 33;
+
+    std::vector<std::pair<key_type, T>> m_buckets[BucketCount];
+    key_type m_last;
+    size_type m_size;
+
+    static int bucketIndex(key_type key, key_type last);
+};
+
+} // namespace sbpl
+
+#include "detail/radix_heap.hpp"
+
+#endif
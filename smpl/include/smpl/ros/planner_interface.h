@@ -34,6 +34,7 @@
 #define SMPL_PLANNER_INTERFACE_H
 
 // standard includes
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -56,6 +57,7 @@
 #include <smpl/occupancy_grid.h>
 #include <smpl/planning_params.h>
 #include <smpl/robot_model.h>
+#include <smpl/types.h>
 #include <smpl/ros/heuristic_allocator.h>
 #include <smpl/ros/planner_allocator.h>
 #include <smpl/ros/planning_space_allocator.h>
@@ -160,6 +162,14 @@ protected:
     moveit_msgs::MotionPlanRequest m_req;
     moveit_msgs::MotionPlanResponse m_res;
 
+    // goal of the current request, and the goal and scene versions of the
+    // last search, for deciding whether its effort may be reused
+    GoalConstraint m_goal;
+    GoalConstraint m_last_goal;
+    bool m_last_search_valid;
+    std::uint32_t m_last_grid_version;
+    std::uint64_t m_last_collision_version;
+
     bool checkConstructionArgs() const;
 
     // Initialize the SBPL planner and the smpl environment
@@ -188,6 +198,8 @@ protected:
 
     // Retrieve plan from sbpl
     bool plan(double allowed_time, std::vector<RobotState>& path);
+    bool canReuseSearch() const;
+    void recordSearch();
 
     bool extractGoalPoseFromGoalConstraints(
         const moveit_msgs::Constraints& goal_constraints,
@@ -214,6 +226,7 @@ protected:
 
     bool isPathValid(const std::vector<RobotState>& path) const;
     void postProcessPath(std::vector<RobotState>& path) const;
+    void learnExperienceGraphPath(const std::vector<RobotState>& path);
     void convertJointVariablePathToJointTrajectory(
         const std::vector<RobotState>& path,
         trajectory_msgs::JointTrajectory& traj) const;
@@ -72,6 +72,21 @@ namespace sbpl {
 ///
 /// * The heuristics for any encountered states remain constant, unless the goal
 ///   state ID has changed.
+///
+/// When the goal state ID changes but the start state does not, the search
+/// tree is retained: heuristics are recomputed, the open list is reordered,
+/// and a new series of iterations begins from the initial suboptimality bound,
+/// so that only states whose priorities changed need to be re-expanded.
+///
+/// Incremental search may additionally be enabled via
+/// allowIncrementalSearch(). After each successful call to replan(), every
+/// state reached by the search stores the lower bound g(goal) / eps - g(s) on
+/// its cost-to-goal. Subsequent searches toward the same goal state ID, from a
+/// different start state, use the maximum of this learned value and the
+/// heuristic, which focuses the new search around the previously explored
+/// corridor. Learned values are discarded when the goal state ID changes or
+/// on force_planning_from_scratch(), which must be called whenever edge costs
+/// or the goal conditions represented by the goal state ID change.
 class ARAStar : public SBPLPlanner
 {
 public:
@@ -94,6 +109,9 @@ public:
     void allowPartialSolutions(bool enabled) { m_allow_partial_solutions = enabled; }
     bool allowPartialSolutions() const { return m_allow_partial_solutions; }
 
+    void allowIncrementalSearch(bool enabled) { m_incremental = enabled; }
+    bool allowIncrementalSearch() const { return m_incremental; }
+
     void setAllowedRepairTime(double allowed_time_secs)
     { m_time_params.max_allowed_time = to_duration(allowed_time_secs); }
 
@@ -141,8 +159,10 @@ private:
         unsigned int h;     // estimated cost-to-go
         unsigned int f;     // (g + eps * h) at time of insertion into OPEN
         unsigned int eg;    // g-value at time of expansion
+        unsigned int hl;    // learned lower bound on cost-to-go
         unsigned short iteration_closed;
         unsigned short call_number;
+        unsigned int learn_number; // learning episode that computed hl
         SearchState* bp;
         bool incons;
     };
@@ -164,6 +184,7 @@ private:
     double m_delta_eps;
 
     bool m_allow_partial_solutions;
+    bool m_incremental;
 
     std::vector<SearchState*> m_states;
 
@@ -185,6 +206,7 @@ private:
     int m_last_start_state_id;  // for lazy reinitialization of the search tree
     int m_last_goal_state_id;   // for updating the search tree when the goal changes
     double m_last_eps;          // for updating the search tree when heuristics change
+    unsigned int m_learn_number;    // for invalidating learned heuristics
 
     int m_expand_count_init;
     clock::duration m_search_time_init;
@@ -213,6 +235,7 @@ private:
     void expand(SearchState* s);
 
     void recomputeHeuristics();
+    void updateLearnedHeuristics(SearchState* goal_state);
     void reorderOpen();
     int computeKey(SearchState* s) const;
 
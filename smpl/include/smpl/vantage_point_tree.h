@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_VANTAGE_POINT_TREE_H
+#define SMPL_VANTAGE_POINT_TREE_H
+
+// standard includes
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+namespace sbpl {
+
+/// A vantage-point tree for range queries over elements of an arbitrary metric
+/// space. Each internal node stores a vantage element and the median distance
+/// of the elements below it from the vantage element; elements closer than the
+/// median are stored in the inside subtree and the rest in the outside
+/// subtree. Leaves store small buckets of elements.
+///
+/// The distance function must be symmetric and satisfy the triangle inequality
+/// to within \p tolerance, i.e. d(a, c) >= d(a, b) - d(b, c) - tolerance. A
+/// nonzero tolerance accommodates distances that have been rounded, at the
+/// expense of visiting more of the tree during queries.
+///
+/// Elements may be inserted incrementally after the tree is built. Inserted
+/// elements descend to a leaf by the existing partitions, so a tree built from
+/// a representative sample remains balanced. Elements may not be removed
+/// individually.
+template <class T, class Distance = std::function<double(const T&, const T&)>>
+class VantagePointTree
+{
+public:
+
+    typedef T           value_type;
+    typedef Distance    distance_function;
+    typedef std::size_t size_type;
+
+    VantagePointTree(
+        const distance_function& dist = distance_function(),
+        double tolerance = 0.0,
+        size_type leaf_size = 8);
+
+    /// Replace the contents of the tree with the elements in [first, last)
+    template <class InputIt>
+    void build(InputIt first, InputIt last);
+
+    void insert(const T& value);
+
+    /// Write all elements e with dist(query, e) <= radius to \p out
+    template <class OutputIt>
+    OutputIt within(const T& query, double radius, OutputIt out) const;
+
+    bool empty() const;
+    size_type size() const;
+
+    void clear();
+
+private:
+
+    struct Node
+    {
+        // internal nodes
+        T vantage;
+        double mu;
+        int inside;
+        int outside;
+
+        // leaf nodes
+        std::vector<T> bucket;
+        size_type split_size;
+
+        bool leaf() const { return inside < 0; }
+    };
+
+    distance_function m_dist;
+    double m_tolerance;
+    size_type m_leaf_size;
+
+    std::vector<Node> m_nodes;
+    size_type m_size;
+
+    int createNode();
+    void makeNode(int nidx, std::vector<T>&& values);
+};
+
+} // namespace sbpl
+
+#include "detail/vantage_point_tree.hpp"
+
+#endif
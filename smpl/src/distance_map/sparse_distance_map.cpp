@@ -400,6 +400,7 @@ int SparseDistanceMap::distance(int nx, int ny, int nz, const Cell& s)
 
 void SparseDistanceMap::lower(Cell* s, int sx, int sy, int sz)
 {
+    auto cells = m_cells.accessor();
     int nfirst, nlast;
     std::tie(nfirst, nlast) = m_neighbor_ranges[s->dir];
     for (int i = nfirst; i != nlast; ++i) {
@@ -409,7 +410,7 @@ void SparseDistanceMap::lower(Cell* s, int sx, int sy, int sz)
             continue;
         }
 
-        Cell* n = &m_cells(nx.x(), nx.y(), nx.z()); // force stable
+        Cell* n = &cells(nx.x(), nx.y(), nx.z()); // force stable
 //        if (n->dist_new > s->dist_new)
         {
             int dp = distance(nx.x(), nx.y(), nx.z(), *s);
@@ -428,6 +429,7 @@ void SparseDistanceMap::lower(Cell* s, int sx, int sy, int sz)
 
 void SparseDistanceMap::raise(Cell* s, int sx, int sy, int sz)
 {
+    auto cells = m_cells.accessor();
     int nfirst, nlast;
     std::tie(nfirst, nlast) = m_neighbor_ranges[m_no_update_dir];
     for (int i = nfirst; i != nlast; ++i) {
@@ -436,7 +438,7 @@ void SparseDistanceMap::raise(Cell* s, int sx, int sy, int sz)
         if (!isCellValid(nx)) {
             continue;
         }
-        Cell* n = &m_cells(nx.x(), nx.y(), nx.z()); // force stable
+        Cell* n = &cells(nx.x(), nx.y(), nx.z()); // force stable
         waveout(n, nx.x(), nx.y(), nx.z());
     }
     waveout(s, sx, sy, sz);
@@ -453,6 +455,7 @@ void SparseDistanceMap::waveout(Cell* n, int nx, int ny, int nz)
     n->obs = nullptr;
     n->ox = n->oy = n->oz = -1; // TODO(Andrew: required?)
 
+    auto cells = m_cells.accessor();
     int nfirst, nlast;
     std::tie(nfirst, nlast) = m_neighbor_ranges[m_no_update_dir];
     for (int i = nfirst; i != nlast; ++i) {
@@ -461,7 +464,7 @@ void SparseDistanceMap::waveout(Cell* n, int nx, int ny, int nz)
         if (!isCellValid(ax)) {
             continue;
         }
-        Cell* a = &m_cells(ax.x(), ax.y(), ax.z()); // force stable
+        Cell* a = &cells(ax.x(), ax.y(), ax.z()); // force stable
         auto valid = [](Cell* c) { return c && c->obs == c; };
         if (valid(a->obs)) {
             int dp = distance(nx, ny, nz, *a);
@@ -525,6 +528,7 @@ void SparseDistanceMap::lowerBounded(Cell* s, int sx, int sy, int sz)
 
 void SparseDistanceMap::propagateRemovals()
 {
+    auto cells = m_cells.accessor();
     while (!m_rem_stack.empty()) {
         bucket_element e = m_rem_stack.back();
         Cell* s = e.c;
@@ -538,7 +542,7 @@ void SparseDistanceMap::propagateRemovals()
             if (!isCellValid(nx)) {
                 continue;
             }
-            Cell* n = &m_cells(nx.x(), nx.y(), nx.z()); // force stable
+            Cell* n = &cells(nx.x(), nx.y(), nx.z()); // force stable
             auto valid = [](Cell* c) { return c && c->obs == c; };
             if (!valid(n->obs)) {
                 if (n->dist_new != m_dmax_sqrd_int) {
@@ -659,6 +663,8 @@ double SparseDistanceMap::getTrueMetricSquaredDistance(
             gpy == m_cell_count_y - 1 |
             gpz == m_cell_count_z - 1;
 
+    auto cells = m_cells.accessor();
+
     double min_d2 = res * res * m_dmax_sqrd_int;
     int nx_last = -1, ny_last = -1, nz_last = -1;
 
@@ -671,7 +677,7 @@ double SparseDistanceMap::getTrueMetricSquaredDistance(
         for (int gppy = gpy - 1; gppy != gpy + 2; ++gppy) {
         for (int gppz = gpz - 1; gppz != gpz + 2; ++gppz) {
             if (SparseDistanceMap::isCellValid(gppx, gppy, gppz)) {
-                const Cell& c = m_cells.get(gppx, gppy, gppz);
+                const Cell& c = cells.get(gppx, gppy, gppz);
 
                 if (c.obs) { // known nearest obstacle -> nearest distance to it
                     const double d2 = nearestEdgeDist(c.ox, c.oy, c.oz);
@@ -687,7 +693,7 @@ double SparseDistanceMap::getTrueMetricSquaredDistance(
         for (int gppx = gpx - 1; gppx != gpx + 2; ++gppx) {
         for (int gppy = gpy - 1; gppy != gpy + 2; ++gppy) {
         for (int gppz = gpz - 1; gppz != gpz + 2; ++gppz) {
-            const Cell& c = m_cells.get(gppx, gppy, gppz);
+            const Cell& c = cells.get(gppx, gppy, gppz);
 
             if (c.obs) { // known nearest obstacle -> nearest distance to it
                 const double d2 = nearestEdgeDist(c.ox, c.oy, c.oz);
@@ -769,54 +775,55 @@ double SparseDistanceMap::getInterpMetricSquaredDistance(
 
     // interpolate distance values of 8 nearest cells
     // interpolation distances based off of distance to current cell boundaries
+    auto cells = m_cells.accessor();
     double sum = 0.0;
     if (dx_oob) {
         if (dy_oob) {
             if (dz_oob) { // dx_oob, dy_oob, dz_oob
-                sum += m_sqrt_table[m_cells.get(gx     , gy     , gz     ).dist];
+                sum += m_sqrt_table[cells.get(gx     , gy     , gz     ).dist];
             } else { // dx_oob, dy_oob
-                sum += gamma         * m_sqrt_table[m_cells.get(gx     , gy     , gz     ).dist];
-                sum += (1.0 - gamma) * m_sqrt_table[m_cells.get(gx     , gy     , gz + dz).dist];
+                sum += gamma         * m_sqrt_table[cells.get(gx     , gy     , gz     ).dist];
+                sum += (1.0 - gamma) * m_sqrt_table[cells.get(gx     , gy     , gz + dz).dist];
             }
         }
         else {
             if (dz_oob) { // dx_oob, dz_oob
-                sum += beta         * m_sqrt_table[m_cells.get(gx     , gy     , gz     ).dist];
-                sum += (1.0 - beta) * m_sqrt_table[m_cells.get(gx     , gy + dy, gz     ).dist];
+                sum += beta         * m_sqrt_table[cells.get(gx     , gy     , gz     ).dist];
+                sum += (1.0 - beta) * m_sqrt_table[cells.get(gx     , gy + dy, gz     ).dist];
             } else { // dx_oob
-                sum += beta         * gamma         * m_sqrt_table[m_cells.get(gx     , gy     , gz     ).dist];
-                sum += beta         * (1.0 - gamma) * m_sqrt_table[m_cells.get(gx     , gy     , gz + dz).dist];
-                sum += (1.0 - beta) * gamma         * m_sqrt_table[m_cells.get(gx     , gy + dy, gz     ).dist];
-                sum += (1.0 - beta) * (1.0 - gamma) * m_sqrt_table[m_cells.get(gx     , gy + dy, gz + dz).dist];
+                sum += beta         * gamma         * m_sqrt_table[cells.get(gx     , gy     , gz     ).dist];
+                sum += beta         * (1.0 - gamma) * m_sqrt_table[cells.get(gx     , gy     , gz + dz).dist];
+                sum += (1.0 - beta) * gamma         * m_sqrt_table[cells.get(gx     , gy + dy, gz     ).dist];
+                sum += (1.0 - beta) * (1.0 - gamma) * m_sqrt_table[cells.get(gx     , gy + dy, gz + dz).dist];
             }
         }
     } else {
         if (dy_oob) {
             if (dz_oob) { // dy_oob, dz_oob
-                sum += alpha         * m_sqrt_table[m_cells.get(gx     , gy     , gz     ).dist];
-                sum += (1.0 - alpha) * m_sqrt_table[m_cells.get(gx + dx, gy     , gz     ).dist];
+                sum += alpha         * m_sqrt_table[cells.get(gx     , gy     , gz     ).dist];
+                sum += (1.0 - alpha) * m_sqrt_table[cells.get(gx + dx, gy     , gz     ).dist];
             } else { // dy_oob
-                sum += alpha         * gamma         * m_sqrt_table[m_cells.get(gx     , gy     , gz     ).dist];
-                sum += alpha         * (1.0 - gamma) * m_sqrt_table[m_cells.get(gx     , gy     , gz + dz).dist];
-                sum += (1.0 - alpha) * gamma         * m_sqrt_table[m_cells.get(gx + dx, gy     , gz     ).dist];
-                sum += (1.0 - alpha) * (1.0 - gamma) * m_sqrt_table[m_cells.get(gx + dx, gy     , gz + dz).dist];
+                sum += alpha         * gamma         * m_sqrt_table[cells.get(gx     , gy     , gz     ).dist];
+                sum += alpha         * (1.0 - gamma) * m_sqrt_table[cells.get(gx     , gy     , gz + dz).dist];
+                sum += (1.0 - alpha) * gamma         * m_sqrt_table[cells.get(gx + dx, gy     , gz     ).dist];
+                sum += (1.0 - alpha) * (1.0 - gamma) * m_sqrt_table[cells.get(gx + dx, gy     , gz + dz).dist];
             }
         }
         else {
             if (dz_oob) { // dz_oob
-                sum += alpha         * beta         * m_sqrt_table[m_cells.get(gx     , gy     , gz     ).dist];
-                sum += alpha         * (1.0 - beta) * m_sqrt_table[m_cells.get(gx     , gy + dy, gz     ).dist];
-                sum += (1.0 - alpha) * beta         * m_sqrt_table[m_cells.get(gx + dx, gy     , gz     ).dist];
-                sum += (1.0 - alpha) * (1.0 - beta) * m_sqrt_table[m_cells.get(gx + dx, gy + dy, gz     ).dist];
+                sum += alpha         * beta         * m_sqrt_table[cells.get(gx     , gy     , gz     ).dist];
+                sum += alpha         * (1.0 - beta) * m_sqrt_table[cells.get(gx     , gy + dy, gz     ).dist];
+                sum += (1.0 - alpha) * beta         * m_sqrt_table[cells.get(gx + dx, gy     , gz     ).dist];
+                sum += (1.0 - alpha) * (1.0 - beta) * m_sqrt_table[cells.get(gx + dx, gy + dy, gz     ).dist];
             } else { // no oob
-                sum += alpha         * beta         * gamma         * m_sqrt_table[m_cells.get(gx     , gy     , gz     ).dist];
-                sum += alpha         * beta         * (1.0 - gamma) * m_sqrt_table[m_cells.get(gx     , gy     , gz + dz).dist];
-                sum += alpha         * (1.0 - beta) * gamma         * m_sqrt_table[m_cells.get(gx     , gy + dy, gz     ).dist];
-                sum += alpha         * (1.0 - beta) * (1.0 - gamma) * m_sqrt_table[m_cells.get(gx     , gy + dy, gz + dz).dist];
-                sum += (1.0 - alpha) * beta         * gamma         * m_sqrt_table[m_cells.get(gx + dx, gy     , gz     ).dist];
-                sum += (1.0 - alpha) * beta         * (1.0 - gamma) * m_sqrt_table[m_cells.get(gx + dx, gy     , gz + dz).dist];
-                sum += (1.0 - alpha) * (1.0 - beta) * gamma         * m_sqrt_table[m_cells.get(gx + dx, gy + dy, gz     ).dist];
-                sum += (1.0 - alpha) * (1.0 - beta) * (1.0 - gamma) * m_sqrt_table[m_cells.get(gx + dx, gy + dy, gz + dz).dist];
+                sum += alpha         * beta         * gamma         * m_sqrt_table[cells.get(gx     , gy     , gz     ).dist];
+                sum += alpha         * beta         * (1.0 - gamma) * m_sqrt_table[cells.get(gx     , gy     , gz + dz).dist];
+                sum += alpha         * (1.0 - beta) * gamma         * m_sqrt_table[cells.get(gx     , gy + dy, gz     ).dist];
+                sum += alpha         * (1.0 - beta) * (1.0 - gamma) * m_sqrt_table[cells.get(gx     , gy + dy, gz + dz).dist];
+                sum += (1.0 - alpha) * beta         * gamma         * m_sqrt_table[cells.get(gx + dx, gy     , gz     ).dist];
+                sum += (1.0 - alpha) * beta         * (1.0 - gamma) * m_sqrt_table[cells.get(gx + dx, gy     , gz + dz).dist];
+                sum += (1.0 - alpha) * (1.0 - beta) * gamma         * m_sqrt_table[cells.get(gx + dx, gy + dy, gz     ).dist];
+                sum += (1.0 - alpha) * (1.0 - beta) * (1.0 - gamma) * m_sqrt_table[cells.get(gx + dx, gy + dy, gz + dz).dist];
             }
         }
     }
@@ -34,11 +34,13 @@
 #include <cstdlib>
 #include <algorithm>
 #include <iostream>
+#include <limits>
+#include <thread>
 #include <utility>
 
 // project includes
 #include <smpl/geometry/mesh_utils.h>
-#include "triangle.h"
+#include <smpl/parallel_for.h>
 
 namespace sbpl {
 namespace geometry {
@@ -47,49 +49,88 @@ namespace geometry {
 // Static Function Declarations //
 //////////////////////////////////
 
-template <typename Discretizer>
-static void VoxelizeMesh(
-    const std::vector<Eigen::Vector3d>& vertices,
-    const std::vector<int>& indices,
-    VoxelGrid<Discretizer>& vg,
-    bool fill = false);
+/// \brief A run of voxels [z0, z1] along the z axis of column (x, y)
+struct VoxelSpan
+{
+    int x;
+    int y;
+    int z0;
+    int z1;
+};
 
-template <typename Discretizer>
-static void VoxelizeMeshAwesome(
-    const std::vector<Eigen::Vector3d>& vertices,
-    const std::vector<int>& indices,
-    VoxelGrid<Discretizer>& vg);
+static bool CompareSpans(const VoxelSpan& a, const VoxelSpan& b);
 
-template <typename Discretizer>
-void VoxelizeMeshNaive(
-    const std::vector<Eigen::Vector3d>& vertices,
-    const std::vector<int>& triangles,
-    VoxelGrid<Discretizer>& vg);
+static bool ClipLinear(double a, double b, double& lo, double& hi);
 
-template <typename Discretizer>
-void ExtractVoxels(
-    const VoxelGrid<Discretizer>& vg,
-    std::vector<Eigen::Vector3d>& voxels);
+static bool ClipSphere(
+    const Eigen::Vector3d& c,
+    double radius_sqrd,
+    double x, double y,
+    double& lo, double& hi);
 
-static bool IsInDiscreteBoundingBox(
-    const MemoryCoord& mc,
-    const MemoryCoord& minmc,
-    const MemoryCoord& maxmc);
+static bool ClipCapsule(
+    const Eigen::Vector3d& p,
+    const Eigen::Vector3d& q,
+    double radius_sqrd,
+    double x, double y,
+    double& lo, double& hi);
+
+static bool ClipFace(
+    const detail::ThickTriangle& tri,
+    double x, double y,
+    double& lo, double& hi);
+
+template <typename Discretizer, typename Region>
+static void PushSpan(
+    const Discretizer& z_disc,
+    int gx, int gy,
+    double wx, double wy,
+    double lo, double hi,
+    int min_gz, int max_gz,
+    const Region& region,
+    std::vector<VoxelSpan>& spans);
+
+/// \brief A thick triangle and the bounds of the voxels it may fill
+struct SpanTriangle
+{
+    detail::ThickTriangle tri;
+    int min_gx;
+    int min_gy;
+    int min_gz;
+    int max_gx;
+    int max_gy;
+    int max_gz;
+};
 
-static bool Intersects(
-    const Triangle& tr1,
-    const Triangle& tr2,
-    double eps = 1.0e-4);
+template <typename Discretizer>
+static void CollectSpans(
+    const SpanTriangle& st,
+    double res,
+    int min_gx, int max_gx,
+    const Discretizer& x_disc,
+    const Discretizer& y_disc,
+    const Discretizer& z_disc,
+    std::vector<VoxelSpan>& spans);
 
-bool PointOnTriangle(
-    const Eigen::Vector3d& p,
-    const Eigen::Vector3d& a,
-    const Eigen::Vector3d& b,
-    const Eigen::Vector3d& c);
+template <typename Discretizer>
+static void ExtractSpans(
+    std::vector<VoxelSpan>& spans,
+    const Discretizer& x_disc,
+    const Discretizer& y_disc,
+    const Discretizer& z_disc,
+    bool fill,
+    std::vector<Eigen::Vector3d>& voxels);
 
-/// \brief Fill the interior of a voxel grid via scanning
 template <typename Discretizer>
-static void ScanFill(VoxelGrid<Discretizer>& vg);
+static void VoxelizeMeshSpans(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    double res,
+    const Discretizer& x_disc,
+    const Discretizer& y_disc,
+    const Discretizer& z_disc,
+    std::vector<Eigen::Vector3d>& voxels,
+    bool fill);
 
 static void TransformVertices(
     const Eigen::Affine3d& transform,
@@ -111,116 +152,6 @@ static bool CompareZ(const Eigen::Vector3d& u, const Eigen::Vector3d& v);
 // Static Function Definitions //
 /////////////////////////////////
 
-template <typename Discretizer>
-static void VoxelizeMesh(
-    const std::vector<Eigen::Vector3d>& vertices,
-    const std::vector<int>& indices,
-    VoxelGrid<Discretizer>& vg,
-    bool fill)
-{
-    const bool awesome = true;
-    if (awesome) {
-        VoxelizeMeshAwesome(vertices, indices, vg);
-    }
-    else {
-        VoxelizeMeshNaive(vertices, indices, vg);
-    }
-
-    if (fill) {
-        ScanFill(vg);
-    }
-}
-
-template <typename Discretizer>
-void VoxelizeMeshAwesome(
-    const std::vector<Eigen::Vector3d>& vertices,
-    const std::vector<int>& indices,
-    VoxelGrid<Discretizer>& vg)
-{
-    for (int i = 0; i < (int)indices.size() / 3; i++) {
-        const Eigen::Vector3d& a = vertices[indices[3 * i + 0]];
-        const Eigen::Vector3d& b = vertices[indices[3 * i + 1]];
-        const Eigen::Vector3d& c = vertices[indices[3 * i + 2]];
-        VoxelizeTriangle(a, b, c, vg);
-    }
-}
-
-template <typename Discretizer>
-void VoxelizeMeshNaive(
-    const std::vector<Eigen::Vector3d>& vertices,
-    const std::vector<int>& triangles,
-    VoxelGrid<Discretizer>& vg)
-{
-    // create a triangle mesh for the voxel grid surrounding the mesh
-    // TODO: use indexed mesh
-    std::vector<Eigen::Vector3d> voxel_mesh;
-    CreateGridMesh(vg, voxel_mesh);
-
-    for (std::size_t tidx = 0; tidx < triangles.size(); tidx += 3) {
-        // get the vertices of the triangle as Point
-        const Eigen::Vector3d& pt1 = vertices[triangles[tidx + 0]];
-        const Eigen::Vector3d& pt2 = vertices[triangles[tidx + 1]];
-        const Eigen::Vector3d& pt3 = vertices[triangles[tidx + 2]];
-
-        // pack those vertices into my Triangle struct
-        Triangle triangle(pt1, pt2, pt3);
-
-        // get the bounding box of the triangle
-        std::vector<Eigen::Vector3d> triPointV = { pt1, pt2, pt3 };
-        Eigen::Vector3d tri_min;
-        Eigen::Vector3d tri_max;
-        if (!ComputeAxisAlignedBoundingBox(triPointV, tri_min, tri_max)) {
-            std::cerr << "Failed to compute AABB of triangle" << std::endl;
-            continue; // just skip this triangle; it's bogus
-        }
-
-        // compute the bounding voxel grid
-        const WorldCoord minwc(tri_min.x(), tri_min.y(), tri_min.z());
-        const WorldCoord maxwc(tri_max.x(), tri_max.y(), tri_max.z());
-        const MemoryCoord minmc = vg.worldToMemory(minwc);
-        const MemoryCoord maxmc = vg.worldToMemory(maxwc);
-
-        // voxels in the voxel mesh are ordered by the memory index
-        for (std::size_t a = 0; a < voxel_mesh.size() / 3; ++a) {
-            int voxelNum = a / 12; // there are 12 mesh triangles per voxel
-
-            const MemoryIndex mi(voxelNum);
-            const MemoryCoord mc = vg.indexToMemory(mi);
-
-            // if not already filled, is in the bounding voxel grid of the
-            // triangle, and this voxel mesh triangle Intersects the current
-            // triangle, fill in the voxel
-
-            Triangle t(voxel_mesh[3 * a], voxel_mesh[3 * a + 1], voxel_mesh[3 * a + 2]);
-
-            if (!vg[mi] &&
-                IsInDiscreteBoundingBox(mc, minmc, maxmc) &&
-                Intersects(triangle, t))
-            {
-                vg[mi] = true;
-            }
-        }
-    }
-}
-
-template <typename Discretizer>
-void ExtractVoxels(
-    const VoxelGrid<Discretizer>& vg,
-    std::vector<Eigen::Vector3d>& voxels)
-{
-    for (int x = 0; x < vg.sizeX(); x++) {
-        for (int y = 0; y < vg.sizeY(); y++) {
-            for (int z = 0; z < vg.sizeZ(); z++) {
-                MemoryCoord mc(x, y, z);
-                if (vg[mc]) {
-                    WorldCoord wc = vg.memoryToWorld(mc);
-                    voxels.push_back(Eigen::Vector3d(wc.x, wc.y, wc.z));
-                }
-            }
-        }
-    }
-}
-
 bool ComputeAxisAlignedBoundingBox(
     const std::vector<Eigen::Vector3d>& vertices,
     Eigen::Vector3d& min,
@@ -258,350 +189,379 @@ bool ComputeAxisAlignedBoundingBox(
     return true;
 }
 
-bool IsInDiscreteBoundingBox(
-    const MemoryCoord& mc,
-    const MemoryCoord& minmc,
-    const MemoryCoord& maxmc)
+bool CompareSpans(const VoxelSpan& a, const VoxelSpan& b)
 {
-    bool inside = true;
-    inside &= mc.x >= minmc.x && mc.x <= maxmc.x;
-    inside &= mc.y >= minmc.y && mc.y <= maxmc.y;
-    inside &= mc.z >= minmc.z && mc.z <= maxmc.z;
-    return inside;
+    if (a.x != b.x) {
+        return a.x < b.x;
+    }
+    if (a.y != b.y) {
+        return a.y < b.y;
+    }
+    return a.z0 < b.z0;
 }
 
-bool Intersects(const Triangle& tr1, const Triangle& tr2, double eps)
+/// \brief Restrict [lo, hi] to the values of z for which a * z + b >= 0
+///
+/// Near-zero slopes are treated as constant so that the bounds remain
+/// conservative.
+bool ClipLinear(double a, double b, double& lo, double& hi)
 {
-    // Vertices 0, 1, and 2 on triangle 1
-    Eigen::Vector3d v10(tr1.a.x(), tr1.a.y(), tr1.a.z());
-    Eigen::Vector3d v11(tr1.b.x(), tr1.b.y(), tr1.b.z());
-    Eigen::Vector3d v12(tr1.c.x(), tr1.c.y(), tr1.c.z());
-
-    // Vertices 0, 1, and 2 on triangle 2
-    Eigen::Vector3d v20(tr2.a.x(), tr2.a.y(), tr2.a.z());
-    Eigen::Vector3d v21(tr2.b.x(), tr2.b.y(), tr2.b.z());
-    Eigen::Vector3d v22(tr2.c.x(), tr2.c.y(), tr2.c.z());
-
-    ////////////////////////////////////////////////////////////////////////////////
-    /// Reject if Triangle 1's vertices are all on the same side of Triangle 2
-    ////////////////////////////////////////////////////////////////////////////////
-
-    // Calculate parameters for the plane in which triangle 2 lies
-    Eigen::Vector3d n2 = (v21 - v20).cross(v22 - v20);
-    n2.normalize();
-    double d2 = (-n2).dot(v20);
-
-    // The distances from the vertices of triangle 1 to the plane of triangle 2
-    double dv10 = n2.dot(v10) + d2;
-    double dv11 = n2.dot(v11) + d2;
-    double dv12 = n2.dot(v12) + d2;
-
-    // approx. dv10 != 0.0, dv11 != 0.0, dv12 != 0.0
-    if (std::fabs(dv10) > eps && std::fabs(dv11) > eps && std::fabs(dv12) > eps) {
-        // all points lie to one side of the triangle
-        if ((dv10 > 0 && dv11 > 0 && dv12 > 0) || (dv10 < 0 && dv11 < 0 && dv12 < 0)) {
-            return false;
-        }
+    const double eps = 1.0e-9;
+    if (a > eps) {
+        lo = std::max(lo, -b / a);
     }
-    else if (std::fabs(dv10) < eps && std::fabs(dv11) < eps && std::fabs(dv12) < eps) {
-        ////////////////////////////////////////////////////////////////////////////////
-        /// Perform tests to see if coplanar triangles are in collision
-        ////////////////////////////////////////////////////////////////////////////////
-
-        // Project the coplanar triangles into the X-Y plane
-        std::vector<Eigen::Vector2d> firstTri2DVertices;
-        Eigen::Vector2d u1;
-        u1[0] = v10[0]; u1[1] = v10[1];
-        firstTri2DVertices.push_back(u1);
-        u1[0] = v11[0]; u1[1] = v11[1];
-        firstTri2DVertices.push_back(u1);
-        u1[0] = v12[0]; u1[1] = v12[1];
-        firstTri2DVertices.push_back(u1);
-
-        std::vector<Eigen::Vector2d> secondTri2DVertices;
-        Eigen::Vector2d u2;
-        u2[0] = v20[0]; u2[1] = v20[1];
-        secondTri2DVertices.push_back(u2);
-        u2[0] = v21[0]; u2[1] = v21[1];
-        secondTri2DVertices.push_back(u2);
-        u2[0] = v22[0]; u2[1] = v22[1];
-        secondTri2DVertices.push_back(u2);
-
-        ////////////////////////////////////////////////////////////////////////////////
-        /// Perform collision tests between two-dimensional line segments
-        ////////////////////////////////////////////////////////////////////////////////
-
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 3; j++) {
-                // the points defining the first segment
-                const Eigen::Vector2d& pt1 = firstTri2DVertices[i];
-                const Eigen::Vector2d& pt2 = firstTri2DVertices[(i + 1) % 3];
-                // the points defining the second segment
-                const Eigen::Vector2d& pt3 = secondTri2DVertices[j];
-                const Eigen::Vector2d& pt4 = secondTri2DVertices[(j + 1) % 3];
-
-                double denom = (pt1[0] - pt2[0]) * (pt3[1] - pt4[1]) - (pt1[1] - pt2[1]) * (pt3[0] - pt4[0]);
-                double tmp1 = pt1[0] * pt2[1] - pt1[1] * pt2[0];
-                double tmp2 = pt3[0] * pt4[1] - pt3[1] * pt4[0];
-
-                // if lines arent parallel
-                if (std::fabs(denom) > eps) {
-                    // the point of intersection between the two lines (from the segments)
-                    Eigen::Vector2d intersection;
-                    intersection[0] = tmp1 * (pt3[0] - pt4[0]) - (pt1[0] - pt2[0]) * tmp2;
-                    intersection[0] /= denom;
-                    intersection[1] = tmp1 * (pt3[1] - pt4[1]) - (pt1[1] - pt2[1]) * tmp2;
-                    intersection[1] /= denom;
-
-                    // check if the point of between the lines intersection lies on the line segments
-                    double vx1 = pt2[0] - pt1[0];
-                    double vx2 = pt4[0] - pt3[0];
-                    if ((intersection[0] - pt1[0]) / vx1 >= 0 && (intersection[0] - pt1[0]) / vx1 <= 1.0 &&
-                       (intersection[0] - pt3[0]) / vx2 >= 0 && (intersection[0] - pt3[0]) / vx2 <= 1.0)
-                    {
-                        return true;
-                    }
-                }
-                else
-                {
-                    // ANDREW: bad assumption, they could be the same line
-                    //std::printf("Line segments are parallel and won't intersect\n");
-                }
-            }
-        }
-
-        ////////////////////////////////////////////////////////////////////////////////
-        /// Check for containment of one triangle within another
-        ////////////////////////////////////////////////////////////////////////////////
-
-        // compute center point of first triangle
-        Eigen::Vector2d firstTriangleCenter(0.0, 0.0);
-        for (int i = 0; i < 3; i++) {
-            firstTriangleCenter[0] += firstTri2DVertices[i][0];
-            firstTriangleCenter[1] += firstTri2DVertices[i][1];
-        }
-        firstTriangleCenter[0] /= 3;
-        firstTriangleCenter[1] /= 3;
-
-        // compute center point of second triangle
-        Eigen::Vector2d secondTriangleCenter(0.0, 0.0);
-        for (int i = 0; i < 3; i++) {
-            secondTriangleCenter[0] += secondTri2DVertices[i][0];
-            secondTriangleCenter[1] += secondTri2DVertices[i][1];
-        }
-        secondTriangleCenter[0] /= 3;
-        secondTriangleCenter[1] /= 3;
-
-        Eigen::Vector3d firstTriangleCenterTo3D(firstTriangleCenter[0], firstTriangleCenter[1], 0.0);
-        Eigen::Vector3d secondTriangleCenterTo3D(secondTriangleCenter[0], secondTriangleCenter[1], 0.0);
-        Eigen::Vector3d u10To3D(firstTri2DVertices[0][0], firstTri2DVertices[0][1], 0.0);
-        Eigen::Vector3d u11To3D(firstTri2DVertices[1][0], firstTri2DVertices[1][1], 0.0);
-        Eigen::Vector3d u12To3D(firstTri2DVertices[2][0], firstTri2DVertices[2][1], 0.0);
-        Eigen::Vector3d u20To3D(secondTri2DVertices[0][0], secondTri2DVertices[0][1], 0.0);
-        Eigen::Vector3d u21To3D(secondTri2DVertices[1][0], secondTri2DVertices[1][1], 0.0);
-        Eigen::Vector3d u22To3D(secondTri2DVertices[2][0], secondTri2DVertices[2][1], 0.0);
-
-        // Awesome code re-use
-        if (PointOnTriangle(firstTriangleCenterTo3D, u20To3D, u21To3D, u22To3D) ||
-            PointOnTriangle(secondTriangleCenterTo3D, u10To3D, u11To3D, u12To3D))
-        {
-            return true;
-        }
+    else if (a < -eps) {
+        hi = std::min(hi, -b / a);
+    }
+    else if (b < -eps) {
+        return false;
+    }
+    return lo <= hi;
+}
 
+/// \brief Restrict [lo, hi] to the values of z for which (x, y, z) lies within
+///     the sphere defined by c and radius_sqrd
+bool ClipSphere(
+    const Eigen::Vector3d& c,
+    double radius_sqrd,
+    double x, double y,
+    double& lo, double& hi)
+{
+    const double dx = x - c.x();
+    const double dy = y - c.y();
+    const double h = radius_sqrd - dx * dx - dy * dy;
+    if (h < -1.0e-9) {
         return false;
     }
-    else {
+    const double r = std::sqrt(std::max(h, 0.0));
+    lo = std::max(lo, c.z() - r);
+    hi = std::min(hi, c.z() + r);
+    return lo <= hi;
+}
+
+/// \brief Restrict [lo, hi] to the values of z for which (x, y, z) lies within
+///     the region tested by Distance(p, q, radius_sqrd, x)
+bool ClipCapsule(
+    const Eigen::Vector3d& p,
+    const Eigen::Vector3d& q,
+    double radius_sqrd,
+    double x, double y,
+    double& lo, double& hi)
+{
+    const Eigen::Vector3d pq = q - p;
+    const Eigen::Vector3d px(x - p.x(), y - p.y(), -p.z());
+    const double len_sqrd = pq.squaredNorm();
+
+    // the projection onto the segment, px.dot(pq) + z * pq.z(), must be
+    // within [0, len_sqrd]
+    const double proj = px.dot(pq);
+    if (!ClipLinear(pq.z(), proj, lo, hi) ||
+        !ClipLinear(-pq.z(), len_sqrd - proj, lo, hi))
+    {
         return false;
     }
 
-    ////////////////////////////////////////////////////////////////////////////////
-    /// Reject if Triangle 2's vertices are all on the same side of Triangle 1
-    ////////////////////////////////////////////////////////////////////////////////
+    // the squared distance to the line is quadratic in z; for segments nearly
+    // parallel to the z axis, the projection bounds above suffice
+    const double a = 1.0 - pq.z() * pq.z() / len_sqrd;
+    if (a < 1.0e-6) {
+        return true;
+    }
 
-    // Calculate parameters for the plane in which triangle 1 lies
-    Eigen::Vector3d n1 = (v11 - v10).cross(v12 - v10);
-    n1.normalize();
-    double d1 = (-n1).dot(v10);
+    const double b = 2.0 * (px.z() - proj * pq.z() / len_sqrd);
+    const double c = px.squaredNorm() - proj * proj / len_sqrd - radius_sqrd;
+    const double disc = b * b - 4.0 * a * c;
+    if (disc < -1.0e-9) {
+        return false;
+    }
+    const double sq = std::sqrt(std::max(disc, 0.0));
+    lo = std::max(lo, (-b - sq) / (2.0 * a));
+    hi = std::min(hi, (-b + sq) / (2.0 * a));
+    return lo <= hi;
+}
 
-    // The distances from the vertices of triangle 2 to the plane of triangle 1
-    double dv20 = n1.dot(v20) + d1;
-    double dv21 = n1.dot(v21) + d1;
-    double dv22 = n1.dot(v22) + d1;
+/// \brief Restrict [lo, hi] to the values of z for which (x, y, z) lies within
+///     the face region of a thick triangle
+bool ClipFace(
+    const detail::ThickTriangle& tri,
+    double x, double y,
+    double& lo, double& hi)
+{
+    // within the thickness of the triangle plane
+    const double s = tri.n.x() * x + tri.n.y() * y + tri.d;
+    if (!ClipLinear(tri.n.z(), s + tri.t, lo, hi) ||
+        !ClipLinear(-tri.n.z(), tri.t - s, lo, hi))
+    {
+        return false;
+    }
 
-    // approx. dv20 != 0.0, dv21 != 0.0, dv22 != 0.0
-    if (std::fabs(dv20) > eps && std::fabs(dv21) > eps && std::fabs(dv22) > eps) {
-        // all points lie to one side of the triangle
-        if ((dv20 > 0 && dv21 > 0 && dv22 > 0) || (dv20 < 0 && dv21 < 0 && dv22 < 0)) {
+    // within the edge-guard planes
+    for (int i = 0; i < 3; ++i) {
+        const Eigen::Vector3d& e = tri.e[i];
+        if (!ClipLinear(e.z(), e.x() * x + e.y() * y + tri.ed[i], lo, hi)) {
             return false;
         }
     }
-    else {
-        // ANDREW: should be covered by coplanar case above
-        return false;
-    }
-
-    // The direction of the line of intersection between the two planes
-    Eigen::Vector3d D = n1.cross(n2);
-
-    ////////////////////////////////////////////////////////////////////////////////////////
-    /// Get the interval on the line where Triangle 1 Intersects
-    ////////////////////////////////////////////////////////////////////////////////////////
-
-    double t1;
-    double t2;
-
-    double pv10 = D.dot(v10);
-    double pv11 = D.dot(v11);
-    double pv12 = D.dot(v12);
+    return true;
+}
 
-    // Vertex 0 of Triangle 1 is on the opposite side
-    if ((dv10 > 0 && dv11 < 0 && dv12 < 0) || (dv10 < 0 && dv11 > 0 && dv12 > 0)) {
-        t1 = pv11 + (pv10 - pv11) * (dv11 / (dv11 - dv10));
-        t2 = pv12 + (pv10 - pv12) * (dv12 / (dv12 - dv10));
+/// \brief Append the span of voxels in column (gx, gy) whose centers lie in a
+///     convex region
+///
+/// [lo, hi] is a conservative bound on the region along the column. Since the
+/// region is convex, the exact span is found by testing only its endpoints.
+template <typename Discretizer, typename Region>
+void PushSpan(
+    const Discretizer& z_disc,
+    int gx, int gy,
+    double wx, double wy,
+    double lo, double hi,
+    int min_gz, int max_gz,
+    const Region& region,
+    std::vector<VoxelSpan>& spans)
+{
+    int z0 = std::max(min_gz, z_disc.discretize(lo) - 1);
+    int z1 = std::min(max_gz, z_disc.discretize(hi) + 1);
+    while (z0 <= z1 && !region(Eigen::Vector3d(wx, wy, z_disc.continuize(z0)))) {
+        ++z0;
     }
-    // Vertex 1 of Triangle 1 is on the opposite side
-    else if ((dv11 > 0 && dv10 < 0 && dv12 < 0) || (dv11 < 0 && dv10 > 0 && dv12 > 0)) {
-        t1 = pv10 + (pv11 - pv10) * (dv10 / (dv10 - dv11));
-        t2 = pv12 + (pv11 - pv12) * (dv12 / (dv12 - dv11));
+    while (z1 >= z0 && !region(Eigen::Vector3d(wx, wy, z_disc.continuize(z1)))) {
+        --z1;
     }
-    // Vertex 2 of triangle 1 is on the opposite side
-    else //if((dv12 > 0 && dv10 < 0 && dv11 < 0) || (dv12 < 0 && dv10 > 0 && dv11 > 0))
-    {
-        t1 = pv10 + (pv12 - pv10) * (dv10 / (dv10 - dv12));
-        t2 = pv11 + (pv12 - pv11) * (dv11 / (dv11 - dv12));
+    if (z0 <= z1) {
+        VoxelSpan span;
+        span.x = gx;
+        span.y = gy;
+        span.z0 = z0;
+        span.z1 = z1;
+        spans.push_back(span);
     }
+}
 
-    ////////////////////////////////////////////////////////////////////////////////////////
-    /// Get the interval on the line where Triangle 2 Intersects
-    ////////////////////////////////////////////////////////////////////////////////////////
-
-    double t3;
-    double t4;
+/// \brief Append the spans of voxels filled by a thick triangle within the
+///     columns [min_gx, max_gx] x [st.min_gy, st.max_gy]
+///
+/// The convex vertex, edge, and face regions of the triangle are intersected
+/// with each grid column in closed form rather than testing every voxel in the
+/// bounding box of the triangle.
+template <typename Discretizer>
+void CollectSpans(
+    const SpanTriangle& st,
+    double res,
+    int min_gx, int max_gx,
+    const Discretizer& x_disc,
+    const Discretizer& y_disc,
+    const Discretizer& z_disc,
+    std::vector<VoxelSpan>& spans)
+{
+    const detail::ThickTriangle& tri = st.tri;
+
+    // bounds on every region along a column
+    const double zmin = z_disc.continuize(st.min_gz) - res;
+    const double zmax = z_disc.continuize(st.max_gz) + res;
+
+    for (int gx = min_gx; gx <= max_gx; ++gx) {
+        const double wx = x_disc.continuize(gx);
+        for (int gy = st.min_gy; gy <= st.max_gy; ++gy) {
+            const double wy = y_disc.continuize(gy);
+
+            for (int v = 0; v < 3; ++v) {
+                double lo = zmin, hi = zmax;
+                if (ClipSphere(tri.p[v], tri.rc2, wx, wy, lo, hi)) {
+                    PushSpan(
+                            z_disc, gx, gy, wx, wy, lo, hi, st.min_gz, st.max_gz,
+                            [&](const Eigen::Vector3d& x)
+                            {
+                                return tri.inVertexRegion(v, x);
+                            },
+                            spans);
+                }
+            }
 
-    double pv20 = D.dot(v20);
-    double pv21 = D.dot(v21);
-    double pv22 = D.dot(v22);
+            for (int e = 0; e < 3; ++e) {
+                double lo = zmin, hi = zmax;
+                if (ClipCapsule(
+                        tri.edgeStart(e), tri.edgeEnd(e), tri.rc2,
+                        wx, wy, lo, hi))
+                {
+                    PushSpan(
+                            z_disc, gx, gy, wx, wy, lo, hi, st.min_gz, st.max_gz,
+                            [&](const Eigen::Vector3d& x)
+                            {
+                                return tri.inEdgeRegion(e, x);
+                            },
+                            spans);
+                }
+            }
 
-    // Vertex 0 of Triangle 2 is on the opposite side
-    if((dv20 > 0 && dv21 < 0 && dv22 < 0) || (dv20 < 0 && dv21 > 0 && dv22 > 0))
-    {
-        t3 = pv21 + (pv20 - pv21) * (dv21 / (dv21 - dv20));
-        t4 = pv22 + (pv20 - pv22) * (dv22 / (dv22 - dv20));
-    }
-    // Vertex 1 of Triangle 2 is on the opposite side
-    else if((dv21 > 0 && dv20 < 0 && dv22 < 0) || (dv21 < 0 && dv20 > 0 && dv22 > 0))
-    {
-        t3 = pv20 + (pv21 - pv20) * (dv20 / (dv20 - dv21));
-        t4 = pv22 + (pv21 - pv22) * (dv22 / (dv22 - dv21));
-    }
-    // Vertex 2 of triangle 2 is on the opposite side
-    else //if((dv22 > 0 && dv20 < 0 && dv21 < 0) || (dv22 < 0 && dv20 > 0 && dv21 > 0))
-    {
-        t3 = pv20 + (pv22 - pv20) * (dv20 / (dv20 - dv22));
-        t4 = pv21 + (pv22 - pv21) * (dv21 / (dv21 - dv22));
+            double lo = zmin, hi = zmax;
+            if (ClipFace(tri, wx, wy, lo, hi)) {
+                PushSpan(
+                        z_disc, gx, gy, wx, wy, lo, hi, st.min_gz, st.max_gz,
+                        [&](const Eigen::Vector3d& x)
+                        {
+                            return tri.inFaceRegion(x);
+                        },
+                        spans);
+            }
+        }
     }
+}
 
-    ////////////////////////////////////////////////////////////////////////////////
-    /// Test for intersection of the above intervals
-    ////////////////////////////////////////////////////////////////////////////////
-
-    double temp = t1;
-    t1 = std::min(t1, t2);
-    t2 = std::max(temp, t2);
+/// \brief Merge spans into runs, fill the interior of each column, and append
+///     the voxel centers ordered by x, then y, then z
+///
+/// Within a column, the gaps between the first and second runs, the third and
+/// fourth runs, and so on, are interior to the mesh.
+template <typename Discretizer>
+void ExtractSpans(
+    std::vector<VoxelSpan>& spans,
+    const Discretizer& x_disc,
+    const Discretizer& y_disc,
+    const Discretizer& z_disc,
+    bool fill,
+    std::vector<Eigen::Vector3d>& voxels)
+{
+    std::sort(spans.begin(), spans.end(), CompareSpans);
+
+    std::vector<VoxelSpan> runs;
+    size_t i = 0;
+    while (i < spans.size()) {
+        runs.clear();
+        runs.push_back(spans[i]);
+        size_t j = i + 1;
+        for (; j < spans.size() && spans[j].x == spans[i].x && spans[j].y == spans[i].y; ++j) {
+            if (spans[j].z0 <= runs.back().z1 + 1) {
+                runs.back().z1 = std::max(runs.back().z1, spans[j].z1);
+            }
+            else {
+                runs.push_back(spans[j]);
+            }
+        }
 
-    temp = t3;
-    t3 = std::min(t3, t4);
-    t4 = std::max(temp, t4);
+        if (fill) {
+            size_t filled = 0;
+            for (size_t r = 0; r < runs.size(); r += 2) {
+                runs[filled] = runs[r];
+                if (r + 1 < runs.size()) {
+                    runs[filled].z1 = runs[r + 1].z1;
+                }
+                ++filled;
+            }
+            runs.resize(filled);
+        }
 
-    // if intervals overlap, triangles intersect
-    bool overlap = false;
-    overlap |= (t3 <= t2 && t2 <= t4);
-    overlap |= (t3 <= t1 && t1 <= t4);
-    overlap |= (t1 <= t3 && t3 <= t2);
-    overlap |= (t1 <= t4 && t4 <= t2);
+        const double wx = x_disc.continuize(spans[i].x);
+        const double wy = y_disc.continuize(spans[i].y);
+        for (const VoxelSpan& run : runs) {
+            for (int gz = run.z0; gz <= run.z1; ++gz) {
+                voxels.push_back(Eigen::Vector3d(wx, wy, z_disc.continuize(gz)));
+            }
+        }
 
-    if (overlap) {
-        return true;
+        i = j;
     }
-
-    return false;
 }
 
-bool PointOnTriangle(
-    const Eigen::Vector3d& p,
-    const Eigen::Vector3d& a,
-    const Eigen::Vector3d& b,
-    const Eigen::Vector3d& c)
+/// \brief Voxelize a mesh as spans of voxels along the z axis
+///
+/// The grid columns covered by the mesh are partitioned into tiles of
+/// consecutive x coordinates. Each triangle is assigned to the tiles it
+/// overlaps, and tiles are voxelized and filled independently, in parallel for
+/// large meshes. Memory use is proportional to the number of surface voxels
+/// rather than the volume of the bounding box of the mesh.
+template <typename Discretizer>
+void VoxelizeMeshSpans(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    double res,
+    const Discretizer& x_disc,
+    const Discretizer& y_disc,
+    const Discretizer& z_disc,
+    std::vector<Eigen::Vector3d>& voxels,
+    bool fill)
 {
-    Eigen::Vector3d ab = b - a;
-    Eigen::Vector3d bc = c - b;
-    Eigen::Vector3d ca = a - c;
-
-    Eigen::Vector3d n = ab.cross(bc);
-
-    Eigen::Vector3d abn = n.cross(ab);
-    Eigen::Vector3d bcn = n.cross(bc);
-    Eigen::Vector3d can = n.cross(ca);
+    // number of consecutive x coordinates per tile
+    const int tile_width = 32;
+
+    std::vector<SpanTriangle> triangles;
+    triangles.reserve(indices.size() / 3);
+    int min_gx = std::numeric_limits<int>::max();
+    int max_gx = std::numeric_limits<int>::min();
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const Eigen::Vector3d& a = vertices[indices[i + 0]];
+        const Eigen::Vector3d& b = vertices[indices[i + 1]];
+        const Eigen::Vector3d& c = vertices[indices[i + 2]];
+
+        SpanTriangle st;
+        if (!st.tri.init(a, b, c, res)) {
+            continue;
+        }
 
-    Eigen::Vector3d p1 = a - p;
-    Eigen::Vector3d p2 = b - p;
-    Eigen::Vector3d p3 = c - p;
+        const Eigen::Vector3d mintri = a.cwiseMin(b).cwiseMin(c);
+        const Eigen::Vector3d maxtri = a.cwiseMax(b).cwiseMax(c);
+        st.min_gx = x_disc.discretize(mintri.x());
+        st.min_gy = y_disc.discretize(mintri.y());
+        st.min_gz = z_disc.discretize(mintri.z());
+        st.max_gx = x_disc.discretize(maxtri.x());
+        st.max_gy = y_disc.discretize(maxtri.y());
+        st.max_gz = z_disc.discretize(maxtri.z());
+        min_gx = std::min(min_gx, st.min_gx);
+        max_gx = std::max(max_gx, st.max_gx);
+        triangles.push_back(st);
+    }
 
-    if (p1.dot(abn) < 0 && p2.dot(bcn) < 0 && p3.dot(can) < 0) {
-        return true;
+    if (triangles.empty()) {
+        return;
     }
 
-    if (p1.dot(abn) > 0 && p2.dot(bcn) > 0 && p3.dot(can) > 0) {
-        return true;
+    const int tile_count = (max_gx - min_gx) / tile_width + 1;
+    if (tile_count == 1) {
+        std::vector<VoxelSpan> spans;
+        for (const SpanTriangle& st : triangles) {
+            CollectSpans(st, res, st.min_gx, st.max_gx, x_disc, y_disc, z_disc, spans);
+        }
+        ExtractSpans(spans, x_disc, y_disc, z_disc, fill, voxels);
+        return;
     }
 
-    return false;
-}
+    std::vector<std::vector<int>> tile_triangles(tile_count);
+    for (size_t i = 0; i < triangles.size(); ++i) {
+        const int first = (triangles[i].min_gx - min_gx) / tile_width;
+        const int last = (triangles[i].max_gx - min_gx) / tile_width;
+        for (int t = first; t <= last; ++t) {
+            tile_triangles[t].push_back((int)i);
+        }
+    }
 
-template <typename Discretizer>
-void ScanFill(VoxelGrid<Discretizer>& vg)
-{
-    for (int x = 0; x < vg.sizeX(); x++) {
-        for (int y = 0; y < vg.sizeY(); y++) {
-            const int OUTSIDE = 0;
-            const int ON_BOUNDARY_FROM_OUTSIDE = 1;
-            const int INSIDE = 2;
-            const int ON_BOUNDARY_FROM_INSIDE = 4;
-
-            int scan_state = OUTSIDE;
-
-            for (int z = 0; z < vg.sizeZ(); z++) {
-                if (scan_state == OUTSIDE && vg[MemoryCoord(x, y, z)]) {
-                    scan_state = ON_BOUNDARY_FROM_OUTSIDE;
-                }
-                else if (scan_state == ON_BOUNDARY_FROM_OUTSIDE &&
-                    !vg[MemoryCoord(x, y, z)])
-                {
-                    bool allEmpty = true;
-                    for (int l = z; l < vg.sizeZ(); l++) {
-                        allEmpty &= !vg[MemoryCoord(x, y, l)];
-                    }
-                    if (allEmpty) {
-                        scan_state = OUTSIDE;
-                    }
-                    else {
-                        scan_state = INSIDE;
-                        vg[MemoryCoord(x, y, z)] = true;
-                    }
-                }
-                else if (scan_state == INSIDE && !vg[MemoryCoord(x, y, z)]) {
-                    vg[MemoryCoord(x, y, z)] = true;
-                }
-                else if (scan_state == INSIDE && vg[MemoryCoord(x, y, z)]) {
-                    scan_state = ON_BOUNDARY_FROM_INSIDE;
-                }
-                else if (scan_state == ON_BOUNDARY_FROM_INSIDE &&
-                    !vg[MemoryCoord(x, y, z)])
-                {
-                    scan_state = OUTSIDE;
-                }
-            }
+    // columns are never shared between tiles, so each tile is filled on its
+    // own and the voxels of consecutive tiles are already in order
+    std::vector<std::vector<Eigen::Vector3d>> tile_voxels(tile_count);
+    const int thread_count = std::max(1, std::min(
+            (int)std::thread::hardware_concurrency(), tile_count));
+    ParallelFor(0, tile_count, thread_count, [&](size_t t)
+    {
+        const int tile_min_gx = min_gx + (int)t * tile_width;
+        const int tile_max_gx = tile_min_gx + tile_width - 1;
+        std::vector<VoxelSpan> spans;
+        for (int i : tile_triangles[t]) {
+            const SpanTriangle& st = triangles[i];
+            CollectSpans(
+                    st, res,
+                    std::max(st.min_gx, tile_min_gx),
+                    std::min(st.max_gx, tile_max_gx),
+                    x_disc, y_disc, z_disc, spans);
         }
+        ExtractSpans(spans, x_disc, y_disc, z_disc, fill, tile_voxels[t]);
+    });
+
+    size_t voxel_count = voxels.size();
+    for (const std::vector<Eigen::Vector3d>& tv : tile_voxels) {
+        voxel_count += tv.size();
+    }
+    voxels.reserve(voxel_count);
+    for (const std::vector<Eigen::Vector3d>& tv : tile_voxels) {
+        voxels.insert(voxels.end(), tv.begin(), tv.end());
     }
 }
 
@@ -948,7 +908,6 @@ void VoxelizeCone(
     std::vector<Eigen::Vector3d>& voxels,
     bool fill)
 {
-    // TODO: implement
     std::vector<Eigen::Vector3d> vertices;
     std::vector<int> triangles;
     CreateIndexedConeMesh(radius, height, vertices, triangles);
@@ -971,18 +930,8 @@ void VoxelizeMesh(
         return;
     }
 
-    Eigen::Vector3d min;
-    Eigen::Vector3d max;
-    if (!ComputeAxisAlignedBoundingBox(vertices, min, max)) {
-        std::cerr << "Failed to compute AABB of mesh vertices" << std::endl;
-        return;
-    }
-
-    const Eigen::Vector3d size = max - min;
-    HalfResVoxelGrid vg(min, size, Eigen::Vector3d(res, res, res));
-
-    VoxelizeMesh(vertices, indices, vg, fill);
-    ExtractVoxels(vg, voxels);
+    const HalfResDiscretizer disc(res);
+    VoxelizeMeshSpans(vertices, indices, res, disc, disc, disc, voxels, fill);
 }
 
 /// \brief Voxelize a mesh at a given pose
@@ -1018,20 +967,12 @@ void VoxelizeMesh(
         return;
     }
 
-    Eigen::Vector3d min;
-    Eigen::Vector3d max;
-    if (!ComputeAxisAlignedBoundingBox(vertices, min, max)) {
-        std::cerr << "Failed to compute AABB of mesh vertices" << std::endl;
-        return;
-    }
-
-    const Eigen::Vector3d size = max - min;
-    PivotVoxelGrid vg(
-            min, size, Eigen::Vector3d(res, res, res),
-            Eigen::Vector3d(voxel_origin.x(), voxel_origin.y(), voxel_origin.z()));
-
-    VoxelizeMesh(vertices, triangles, vg, fill);
-    ExtractVoxels(vg, voxels);
+    VoxelizeMeshSpans(
+            vertices, triangles, res,
+            PivotDiscretizer(res, voxel_origin.x()),
+            PivotDiscretizer(res, voxel_origin.y()),
+            PivotDiscretizer(res, voxel_origin.z()),
+            voxels, fill);
 }
 
 /// \brief Voxelize a mesh at a given pose using a specified origin for the
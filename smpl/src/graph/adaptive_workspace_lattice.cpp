@@ -88,6 +88,8 @@ AdaptiveWorkspaceLattice::AdaptiveWorkspaceLattice(
     m_goal_state_id(-1),
     m_start_state(nullptr),
     m_start_state_id(-1),
+    m_hi_pool(),
+    m_lo_pool(),
     m_hi_to_id(),
     m_lo_to_id(),
     m_states(),
@@ -95,13 +97,16 @@ AdaptiveWorkspaceLattice::AdaptiveWorkspaceLattice(
     m_near_goal(false),
     m_region_radius(1),
     m_tunnel_radius(3),
-    m_dim_grid()
+    m_grow_grid(),
+    m_plan_grid(),
+    m_trak_grid()
 {
-    m_dim_grid.assign(
-            m_grid->numCellsX(),
-            m_grid->numCellsY(),
-            m_grid->numCellsZ(),
-            AdaptiveGridCell());
+    m_grow_grid.resize(
+            m_grid->numCellsX(), m_grid->numCellsY(), m_grid->numCellsZ(), 0);
+    m_plan_grid.resize(
+            m_grid->numCellsX(), m_grid->numCellsY(), m_grid->numCellsZ(), false);
+    m_trak_grid.resize(
+            m_grid->numCellsX(), m_grid->numCellsY(), m_grid->numCellsZ(), false);
 
     m_goal_state_id = reserveHashEntry(true);
     m_goal_state = getHashEntry(m_goal_state_id);
@@ -113,15 +118,11 @@ AdaptiveWorkspaceLattice::AdaptiveWorkspaceLattice(
 
 AdaptiveWorkspaceLattice::~AdaptiveWorkspaceLattice()
 {
-    for (AdaptiveState* state : m_states) {
-        if (state->hid) {
-            AdaptiveWorkspaceState* hi_state = (AdaptiveWorkspaceState*)state;
-            delete hi_state;
-        } else {
-            AdaptiveGridState* lo_state = (AdaptiveGridState*)state;
-            delete lo_state;
-        }
-    }
+    m_hi_to_id.clear();
+    m_lo_to_id.clear();
+    m_states.clear();
+    m_hi_pool.clear();
+    m_lo_pool.clear();
 
     // NOTE: StateID2IndexMapping cleared by DiscreteSpaceInformation
 }
@@ -166,6 +167,45 @@ bool AdaptiveWorkspaceLattice::projectToPoint(
     return true;
 }
 
+/// Set all cells within \p radius cells of \p center, clipped to the bounds of
+/// the grid. Cells are set lazily, scanline by scanline, and the grid is left
+/// unpruned so that several regions may be rasterized before a single prune.
+/// Return the number of cells within the sphere.
+static
+int RasterizeSphere(
+    SparseBinaryGrid<>& grid,
+    const Eigen::Vector3i& center,
+    int radius)
+{
+    const int max_x = (int)grid.size_x() - 1;
+    const int max_y = (int)grid.size_y() - 1;
+    const int max_z = (int)grid.size_z() - 1;
+
+    int marked = 0;
+    const int r2 = radius * radius;
+    for (int dx = -radius; dx <= radius; ++dx) {
+        const int x = center.x() + dx;
+        if (x < 0 || x > max_x) {
+            continue;
+        }
+        for (int dy = -radius; dy <= radius; ++dy) {
+            const int y = center.y() + dy;
+            const int rem = r2 - dx * dx - dy * dy;
+            if (y < 0 || y > max_y || rem < 0) {
+                continue;
+            }
+            const int dz = (int)std::sqrt((double)rem);
+            const int z_lo = std::max(center.z() - dz, 0);
+            const int z_hi = std::min(center.z() + dz, max_z);
+            for (int z = z_lo; z <= z_hi; ++z) {
+                grid.set_lazy(x, y, z, true);
+            }
+            marked += std::max(z_hi - z_lo + 1, 0);
+        }
+    }
+    return marked;
+}
+
 bool AdaptiveWorkspaceLattice::addHighDimRegion(int state_id)
 {
     AdaptiveState* state = m_states[state_id];
@@ -199,23 +239,13 @@ bool AdaptiveWorkspaceLattice::addHighDimRegion(int state_id)
         return false;
     }
 
-    ++m_dim_grid(gp.x(), gp.y(), gp.z()).grow_count;
-    const int radius = m_region_radius * m_dim_grid(gp.x(), gp.y(), gp.z()).grow_count;
+    const int grow_count = m_grow_grid.get(gp.x(), gp.y(), gp.z()) + 1;
+    m_grow_grid.set(gp.x(), gp.y(), gp.z(), grow_count);
+    const int radius = m_region_radius * grow_count;
     ROS_INFO_NAMED(params()->graph_log, "  radius: %d", radius);
 
-    // TODO: mark cells as in high-dimensional region
-    int marked = 0;
-    for (int dx = -radius; dx <= radius; ++dx) {
-    for (int dy = -radius; dy <= radius; ++dy) {
-    for (int dz = -radius; dz <= radius; ++dz) {
-        Eigen::Vector3i p = gp + Eigen::Vector3i(dx, dy, dz);
-        if (m_grid->isInBounds(p.x(), p.y(), p.z())) {
-            m_dim_grid(p.x(), p.y(), p.z()).plan_hd = true;
-            ++marked;
-        }
-    }
-    }
-    }
+    const int marked = RasterizeSphere(m_plan_grid, gp, radius);
+    m_plan_grid.prune();
 
     ROS_INFO_NAMED(params()->graph_log, "Marked %d cells as high-dimensional", marked);
 
@@ -224,11 +254,9 @@ bool AdaptiveWorkspaceLattice::addHighDimRegion(int state_id)
 
 bool AdaptiveWorkspaceLattice::setTunnel(const std::vector<int>& states)
 {
-    // clear the tunnel grid
-    // TODO: retain the list of points in the tunnel and clear only those points
-    for (auto it = m_dim_grid.begin(); it != m_dim_grid.end(); ++it) {
-        it->trak_hd = false;
-    }
+    // clear the tunnel grid; this releases only the octree nodes created by
+    // the previous tunnel
+    m_trak_grid.reset(false);
 
     std::vector<Eigen::Vector3i> tunnel;
     for (int state_id : states) {
@@ -270,20 +298,9 @@ bool AdaptiveWorkspaceLattice::setTunnel(const std::vector<int>& states)
     // tunnel-width away
     int marked = 0;
     for (const Eigen::Vector3i& gp : tunnel) {
-        const int radius = m_tunnel_radius;
-
-        for (int dx = -radius; dx <= radius; ++dx) {
-        for (int dy = -radius; dy <= radius; ++dy) {
-        for (int dz = -radius; dz <= radius; ++dz) {
-            Eigen::Vector3i p = gp + Eigen::Vector3i(dx, dy, dz);
-            if (m_grid->isInBounds(p.x(), p.y(), p.z())) {
-                m_dim_grid(p.x(), p.y(), p.z()).trak_hd = true;
-                ++marked;
-            }
-        }
-        }
-        }
+        marked += RasterizeSphere(m_trak_grid, gp, m_tunnel_radius);
     }
+    m_trak_grid.prune();
     ROS_INFO_NAMED(params()->graph_log, "Marked %d cells as tunnel cells", marked);
 
     return true;
@@ -833,9 +850,9 @@ int AdaptiveWorkspaceLattice::reserveHashEntry(bool hid)
 {
     AdaptiveState* entry;
     if (hid) {
-        entry = new AdaptiveWorkspaceState;
+        entry = m_hi_pool.create();
     } else {
-        entry = new AdaptiveGridState;
+        entry = m_lo_pool.create();
     }
     entry->hid = hid;
 
@@ -855,9 +872,9 @@ int AdaptiveWorkspaceLattice::reserveHashEntry(bool hid)
 bool AdaptiveWorkspaceLattice::isHighDimensional(int gx, int gy, int gz) const
 {
     if (m_plan_mode) {
-        return m_dim_grid(gx, gy, gz).plan_hd;
+        return m_plan_grid.get(gx, gy, gz);
     } else {
-        return m_dim_grid(gx, gy, gz).trak_hd;
+        return m_trak_grid.get(gx, gy, gz);
     }
 }
 
@@ -892,11 +909,7 @@ int AdaptiveWorkspaceLattice::getHiHashEntry(
 {
     AdaptiveWorkspaceState state;
     state.coord = coord;
-    auto sit = m_hi_to_id.find(&state);
-    if (sit == m_hi_to_id.end()) {
-        return -1;
-    }
-    return sit->second;
+    return m_hi_to_id.find(state);
 }
 
 int AdaptiveWorkspaceLattice::getLoHashEntry(
@@ -908,11 +921,7 @@ int AdaptiveWorkspaceLattice::getLoHashEntry(
     state.gx = x;
     state.gy = y;
     state.gz = z;
-    auto sit = m_lo_to_id.find(&state);
-    if (sit == m_lo_to_id.end()) {
-        return -1;
-    }
-    return sit->second;
+    return m_lo_to_id.find(state);
 }
 
 int AdaptiveWorkspaceLattice::createHiState(
@@ -923,7 +932,7 @@ int AdaptiveWorkspaceLattice::createHiState(
     AdaptiveWorkspaceState* hi_state = getHiHashEntry(state_id);
     hi_state->coord = coord;
     hi_state->state = state;
-    m_hi_to_id[hi_state] = state_id;
+    m_hi_to_id.insert(hi_state, state_id);
     return state_id;
 }
 
@@ -939,6 +948,7 @@ int AdaptiveWorkspaceLattice::createLoState(
     lo_state->x = wx;
     lo_state->y = wy;
     lo_state->z = wz;
+    m_lo_to_id.insert(lo_state, state_id);
     return state_id;
 }
 
@@ -1009,7 +1019,7 @@ bool AdaptiveWorkspaceLattice::checkAction(
         ROS_DEBUG_NAMED(params()->successors_log, "        %zu: %s", widx, to_string(istate).c_str());
 
         RobotState irstate;
-        if (!stateWorkspaceToRobot(istate, state, irstate)) {
+        if (!stateWorkspaceToRobot(istate, waypointSeed(state, wptraj), irstate)) {
             ROS_DEBUG_NAMED(params()->successors_log, "         -> failed to find ik solution");
             violation_mask |= 0x00000001;
             break;
@@ -1106,24 +1116,35 @@ AdaptiveWorkspaceLattice::getAdaptiveGridVisualization(bool plan_mode) const
     m.action = visualization_msgs::Marker::ADD;
     m.pose.orientation.w = 1.0;
     m.scale.x = m.scale.y = m.scale.z = 0.5 * m_grid->resolution();
-    if (m_plan_mode) {
+    if (plan_mode) {
         m.color.r = m.color.a = 1.0;
     } else {
         m.color.b = m.color.a = 1.0;
     }
     m.lifetime = ros::Duration(0);
-    for (int x = 0; x < m_grid->numCellsX(); ++x) {
-    for (int y = 0; y < m_grid->numCellsY(); ++y) {
-    for (int z = 0; z < m_grid->numCellsZ(); ++z) {
-        if (isHighDimensional(x, y, z)) {
-            geometry_msgs::Point p;
-            m_grid->gridToWorld(x, y, z, p.x, p.y, p.z);
-            m.points.push_back(p);
-        }
-    }
-    }
-    }
-    ROS_INFO("Visualize %zu/%zu adaptive cells", m.points.size(), m_dim_grid.size());
+
+    // visit only the set boxes of the binary grid, clipped to the grid
+    const SparseBinaryGrid<>& grid = plan_mode ? m_plan_grid : m_trak_grid;
+    grid.accept_coords([&](
+            bool value,
+            std::size_t fx, std::size_t fy, std::size_t fz,
+            std::size_t lx, std::size_t ly, std::size_t lz)
+        {
+            if (!value) {
+                return;
+            }
+            for (int x = (int)fx; x < (int)lx; ++x) {
+            for (int y = (int)fy; y < (int)ly; ++y) {
+            for (int z = (int)fz; z < (int)lz; ++z) {
+                geometry_msgs::Point p;
+                m_grid->gridToWorld(x, y, z, p.x, p.y, p.z);
+                m.points.push_back(p);
+            }
+            }
+            }
+        },
+        0, 0, 0, m_grid->numCellsX(), m_grid->numCellsY(), m_grid->numCellsZ());
+    ROS_INFO("Visualize %zu/%zu adaptive cells", m.points.size(), grid.size());
     ma.markers.push_back(m);
     return ma;
 }
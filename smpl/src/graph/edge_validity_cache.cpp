@@ -0,0 +1,267 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#include <smpl/graph/edge_validity_cache.h>
+
+// standard includes
+#include <cstring>
+
+namespace sbpl {
+namespace motion {
+
+const std::uint64_t EdgeValidityCache::EmptyKey;
+const std::uint32_t EdgeValidityCache::VersionMask;
+const std::uint64_t EdgeValidityCache::ValidBit;
+
+EdgeValidityCache::EdgeValidityCache(std::size_t capacity) :
+    m_slots(),
+    m_size(0),
+    m_mask(0),
+    m_hits(0),
+    m_misses(0)
+{
+    resize(capacity);
+}
+
+/// Resize the cache to hold at least \p capacity entries. The capacity is
+/// rounded up to the next power of two and all existing entries are discarded.
+/// Must not be called concurrently with lookups or insertions.
+void EdgeValidityCache::resize(std::size_t capacity)
+{
+    if (capacity == 0) {
+        m_slots.reset();
+        m_size = 0;
+        m_mask = 0;
+        return;
+    }
+
+    std::size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    m_slots.reset(new Slot[size]);
+    m_size = size;
+    m_mask = size - 1;
+    clear();
+}
+
+/// Remove all entries from the cache and reset the hit and miss counters. Must
+/// not be called concurrently with lookups or insertions.
+void EdgeValidityCache::clear()
+{
+    for (std::size_t i = 0; i < m_size; ++i) {
+        m_slots[i].seq.store(0, std::memory_order_relaxed);
+        m_slots[i].key.store(EmptyKey, std::memory_order_relaxed);
+        m_slots[i].action.store(0, std::memory_order_relaxed);
+        m_slots[i].value.store(0, std::memory_order_relaxed);
+    }
+    m_hits.store(0, std::memory_order_relaxed);
+    m_misses.store(0, std::memory_order_relaxed);
+}
+
+/// Look up the validity of the action with index \p action_index out of the
+/// state \p parent_id.
+///
+/// \param action_id A fingerprint of the action, compared against the
+///     fingerprint of the action the entry was computed for
+/// \param version The current version of the world
+/// \param valid Whether the edge is valid, if the lookup succeeds
+/// \param dist The clearance along the edge, if the lookup succeeds
+/// \return Whether an entry for the edge, computed against the same world
+///     version, was found
+bool EdgeValidityCache::find(
+    int parent_id,
+    int action_index,
+    std::uint64_t action_id,
+    std::uint32_t version,
+    bool& valid,
+    double& dist) const
+{
+    if (!m_slots) {
+        return false;
+    }
+
+    const std::uint64_t key = MakeKey(parent_id, action_index);
+    const std::size_t home = homeSlot(key);
+    for (int i = 0; i < ProbeCount; ++i) {
+        const Slot& slot = m_slots[(home + i) & m_mask];
+
+        const std::uint32_t seq_before = slot.seq.load(std::memory_order_acquire);
+        const std::uint64_t k = slot.key.load(std::memory_order_relaxed);
+        const std::uint64_t a = slot.action.load(std::memory_order_relaxed);
+        const std::uint64_t v = slot.value.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const std::uint32_t seq_after = slot.seq.load(std::memory_order_relaxed);
+
+        // slot is being written or was rewritten while we read it
+        if ((seq_before & 1) || seq_before != seq_after) {
+            break;
+        }
+
+        // slots are never emptied once filled, so the key can't appear further
+        // along the probe sequence
+        if (k == EmptyKey) {
+            break;
+        }
+
+        if (k != key) {
+            continue;
+        }
+
+        // the entry is stale if the action at this index or the world has
+        // changed since it was computed
+        if (a != action_id || ValueVersion(v) != (version & VersionMask)) {
+            break;
+        }
+
+        const std::uint32_t dist_bits = (std::uint32_t)(v >> 32);
+        float fdist;
+        std::memcpy(&fdist, &dist_bits, sizeof(fdist));
+
+        valid = (v & ValidBit) != 0;
+        dist = fdist;
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+/// Store the validity of the action with index \p action_index, and
+/// fingerprint \p action_id, out of the state \p parent_id, as computed against
+/// the world with version \p version.
+///
+/// The entry replaces an existing entry for the same edge, an empty entry, or
+/// an entry computed against a different world version, in that order of
+/// preference, along the edge's probe sequence. If no such entry exists, the
+/// entry in the edge's home slot is evicted.
+void EdgeValidityCache::insert(
+    int parent_id,
+    int action_index,
+    std::uint64_t action_id,
+    std::uint32_t version,
+    bool valid,
+    double dist)
+{
+    if (!m_slots) {
+        return;
+    }
+
+    const std::uint64_t key = MakeKey(parent_id, action_index);
+    const std::size_t home = homeSlot(key);
+
+    std::size_t target = m_size;
+    for (int i = 0; i < ProbeCount; ++i) {
+        const std::size_t sidx = (home + i) & m_mask;
+        if (m_slots[sidx].key.load(std::memory_order_relaxed) == key) {
+            target = sidx;
+            break;
+        }
+    }
+
+    if (target == m_size) {
+        for (int i = 0; i < ProbeCount; ++i) {
+            const std::size_t sidx = (home + i) & m_mask;
+            const Slot& slot = m_slots[sidx];
+            if (slot.key.load(std::memory_order_relaxed) == EmptyKey ||
+                ValueVersion(slot.value.load(std::memory_order_relaxed)) !=
+                        (version & VersionMask))
+            {
+                target = sidx;
+                break;
+            }
+        }
+    }
+
+    if (target == m_size) {
+        target = home;
+    }
+
+    Slot& slot = m_slots[target];
+
+    // claim the slot; give up if another writer holds it
+    std::uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    if ((seq & 1) ||
+        !slot.seq.compare_exchange_strong(
+                seq, seq + 1,
+                std::memory_order_acquire,
+                std::memory_order_relaxed))
+    {
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.key.store(key, std::memory_order_relaxed);
+    slot.action.store(action_id, std::memory_order_relaxed);
+    slot.value.store(MakeValue(version, valid, dist), std::memory_order_relaxed);
+    slot.seq.store(seq + 2, std::memory_order_release);
+}
+
+std::uint64_t EdgeValidityCache::MakeKey(int parent_id, int action_index)
+{
+    // offset the state id so that no valid key is equal to the empty key
+    return ((std::uint64_t)(std::uint32_t)(parent_id + 1) << 32) |
+            (std::uint64_t)(std::uint32_t)action_index;
+}
+
+std::uint64_t EdgeValidityCache::MakeValue(
+    std::uint32_t version,
+    bool valid,
+    double dist)
+{
+    const float fdist = (float)dist;
+    std::uint32_t dist_bits;
+    std::memcpy(&dist_bits, &fdist, sizeof(dist_bits));
+    return ((std::uint64_t)dist_bits << 32) |
+            (valid ? ValidBit : 0) |
+            (version & VersionMask);
+}
+
+std::uint32_t EdgeValidityCache::ValueVersion(std::uint64_t value)
+{
+    return (std::uint32_t)value & VersionMask;
+}
+
+std::size_t EdgeValidityCache::homeSlot(std::uint64_t key) const
+{
+    // 64-bit finalizer from MurmurHash3
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return (std::size_t)key & m_mask;
+}
+
+} // namespace motion
+} // namespace sbpl
@@ -2,6 +2,7 @@
 
 #include <assert.h>
 #include <algorithm>
+#include <atomic>
 #include <stdexcept>
 
 namespace sbpl {
@@ -9,6 +10,7 @@ namespace motion {
 
 ExperienceGraph::ExperienceGraph()
 {
+    touch();
 }
 
 /// Return a pair of iterators to the range of nodes in the graph.
@@ -99,6 +101,7 @@ bool ExperienceGraph::edge(node_id uid, node_id vid) const
 /// Insert a node.
 ExperienceGraph::node_id ExperienceGraph::insert_node(const RobotState& state)
 {
+    touch();
     m_nodes.emplace_back(state);
     return m_nodes.size() - 1;
 }
@@ -112,6 +115,8 @@ void ExperienceGraph::erase_node(node_id id)
         throw std::out_of_range("ExperienceGraph::erase_node called with invalid node id");
     }
 
+    touch();
+
     const Node& rem_node = m_nodes[id];
 
     // the number of edges to be removed and the smallest id, for updating
@@ -169,6 +174,15 @@ void ExperienceGraph::erase_node(node_id id)
                 }
             }
         }
+    } else {
+        // no edges are removed, but adjacent node ids still shift down
+        for (auto& node : m_nodes) {
+            for (Node::adjacency& a : node.edges) {
+                if (a.second > id) {
+                    --a.second;
+                }
+            }
+        }
     }
 
     // update the node ids stored in edges
@@ -193,6 +207,7 @@ ExperienceGraph::edge_id ExperienceGraph::insert_edge(node_id uid, node_id vid)
         throw std::out_of_range("ExperienceGraph::insert_edge called with invalid node ids");
     }
 
+    touch();
     m_edges.emplace_back(uid, vid);
     ExperienceGraph::edge_id eid = m_edges.size() - 1;
     insert_incident_edge(eid, uid, vid);
@@ -210,6 +225,7 @@ ExperienceGraph::edge_id ExperienceGraph::insert_edge(
         throw std::out_of_range("ExperienceGraph::insert_edge called with invalid node ids");
     }
 
+    touch();
     m_edges.emplace_back(path, uid, vid);
     ExperienceGraph::edge_id eid = m_edges.size() - 1;
     insert_incident_edge(eid, uid, vid);
@@ -262,6 +278,8 @@ void ExperienceGraph::erase_edge(edge_id id)
         throw std::out_of_range("ExperienceGraph::erase_edge called with invalid edge id");
     }
 
+    touch();
+
     const Edge& e = m_edges[id];
 
     // remove incident edge from source node and update edge ids
@@ -299,6 +317,13 @@ void ExperienceGraph::erase_edge(edge_id id)
     m_edges.erase(std::next(m_edges.begin(), id));
 }
 
+/// Assign the next version, shared by all experience graphs
+void ExperienceGraph::touch()
+{
+    static std::atomic<std::uint64_t> next_version(0);
+    m_version = ++next_version;
+}
+
 inline
 void ExperienceGraph::insert_incident_edge(edge_id eid, node_id uid, node_id vid)
 {
@@ -310,5 +335,63 @@ void ExperienceGraph::insert_incident_edge(edge_id eid, node_id uid, node_id vid
     }
 }
 
+int ComputeComponents(
+    const ExperienceGraph& eg,
+    std::vector<int>& component_ids)
+{
+    component_ids.clear();
+    return UpdateComponents(
+            eg, 0, std::vector<ExperienceGraph::edge_id>(), component_ids, 0);
+}
+
+int UpdateComponents(
+    const ExperienceGraph& eg,
+    ExperienceGraph::node_id first_node,
+    const std::vector<ExperienceGraph::edge_id>& edges,
+    std::vector<int>& component_ids,
+    int component_count)
+{
+    component_ids.resize(eg.num_nodes(), -1);
+
+    // relabel the component containing n, and any component reachable from
+    // it, with comp_id
+    std::vector<ExperienceGraph::node_id> frontier;
+    auto flood = [&](ExperienceGraph::node_id n, int comp_id) {
+        frontier.push_back(n);
+        while (!frontier.empty()) {
+            ExperienceGraph::node_id m = frontier.back();
+            frontier.pop_back();
+
+            component_ids[m] = comp_id;
+
+            auto adj = eg.adjacent_nodes(m);
+            for (auto ait = adj.first; ait != adj.second; ++ait) {
+                if (component_ids[*ait] != comp_id) {
+                    frontier.push_back(*ait);
+                }
+            }
+        }
+    };
+
+    // label components of new nodes, which also absorbs any existing
+    // components they connect to
+    for (auto n = first_node; n < eg.num_nodes(); ++n) {
+        if (component_ids[n] == -1) {
+            flood(n, component_count++);
+        }
+    }
+
+    // merge existing components joined by new edges between existing nodes
+    for (ExperienceGraph::edge_id e : edges) {
+        const ExperienceGraph::node_id u = eg.source(e);
+        const ExperienceGraph::node_id v = eg.target(e);
+        if (component_ids[u] != component_ids[v]) {
+            flood(v, component_ids[u]);
+        }
+    }
+
+    return component_count;
+}
+
 } // namespace motion
 } // namespace sbpl
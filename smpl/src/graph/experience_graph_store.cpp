@@ -0,0 +1,592 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#include <smpl/graph/experience_graph_store.h>
+
+// standard includes
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+
+// system includes
+#include <boost/filesystem.hpp>
+#include <fcntl.h>
+#include <ros/console.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sbpl {
+namespace motion {
+
+static const char* LOG = "egraph_store";
+
+static const char StoreMagic[4] = { 'E', 'G', 'B', 'S' };
+static const std::uint32_t StoreVersion = 1;
+
+struct StoreHeader
+{
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t variable_count;
+    std::uint32_t reserved;
+};
+
+struct SegmentHeader
+{
+    std::uint64_t size;
+    std::uint32_t node_count;
+    std::uint32_t edge_count;
+    std::uint32_t waypoint_count;
+    std::uint32_t component_count;
+    std::uint32_t flags;
+    std::uint32_t reserved;
+};
+
+enum SegmentFlags : std::uint32_t
+{
+    HasProjections = 1
+};
+
+struct ExperienceGraphStore::EdgeRecord
+{
+    std::uint32_t source;
+    std::uint32_t target;
+    std::uint32_t waypoint_begin;
+    std::uint32_t waypoint_count;
+};
+
+static_assert(sizeof(StoreHeader) == 16, "unexpected store header size");
+static_assert(sizeof(SegmentHeader) == 32, "unexpected segment header size");
+
+// Every array in a segment is padded to a multiple of 8 bytes so that the
+// arrays of doubles that follow remain aligned within the mapping.
+static size_t Align8(size_t n)
+{
+    return (n + 7) & ~size_t(7);
+}
+
+static size_t SegmentSize(const SegmentHeader& h, size_t var_count)
+{
+    size_t size = sizeof(SegmentHeader);
+    size += sizeof(double) * h.node_count * var_count;
+    if (h.flags & HasProjections) {
+        size += sizeof(double) * h.node_count * 3;
+    }
+    size += Align8(sizeof(std::uint32_t) * h.node_count);
+    size += 4 * sizeof(std::uint32_t) * h.edge_count;
+    size += sizeof(double) * h.waypoint_count * var_count;
+    return size;
+}
+
+static bool ValidStoreHeader(const StoreHeader& h)
+{
+    return std::memcmp(h.magic, StoreMagic, sizeof(StoreMagic)) == 0 &&
+            h.version == StoreVersion;
+}
+
+ExperienceGraphStore::ExperienceGraphStore() :
+    m_data(nullptr),
+    m_size(0),
+    m_var_count(0),
+    m_node_count(0),
+    m_edge_count(0),
+    m_component_count(0),
+    m_segments()
+{
+}
+
+ExperienceGraphStore::~ExperienceGraphStore()
+{
+    close();
+}
+
+bool ExperienceGraphStore::open(const std::string& path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        ROS_ERROR_NAMED(LOG, "Failed to open experience graph store '%s'", path.c_str());
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(StoreHeader)) {
+        ROS_ERROR_NAMED(LOG, "Experience graph store '%s' is too small", path.c_str());
+        ::close(fd);
+        return false;
+    }
+
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        ROS_ERROR_NAMED(LOG, "Failed to map experience graph store '%s'", path.c_str());
+        return false;
+    }
+
+    m_data = data;
+    m_size = st.st_size;
+
+    const char* bytes = (const char*)m_data;
+
+    StoreHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    if (!ValidStoreHeader(header)) {
+        ROS_ERROR_NAMED(LOG, "'%s' is not an experience graph store", path.c_str());
+        close();
+        return false;
+    }
+
+    m_var_count = header.variable_count;
+
+    size_t offset = sizeof(StoreHeader);
+    while (offset + sizeof(SegmentHeader) <= m_size) {
+        SegmentHeader sh;
+        std::memcpy(&sh, bytes + offset, sizeof(sh));
+
+        if (sh.size != SegmentSize(sh, m_var_count) ||
+            offset + sh.size > m_size)
+        {
+            // a partially written segment, left by an interrupted append
+            ROS_WARN_NAMED(LOG, "Ignoring truncated segment at offset %zu in '%s'", offset, path.c_str());
+            break;
+        }
+
+        const char* p = bytes + offset + sizeof(SegmentHeader);
+
+        Segment s;
+        s.node_begin = m_node_count;
+        s.edge_begin = m_edge_count;
+        s.component_begin = m_component_count;
+
+        s.states = (const double*)p;
+        p += sizeof(double) * sh.node_count * m_var_count;
+        if (sh.flags & HasProjections) {
+            s.projections = (const double*)p;
+            p += sizeof(double) * sh.node_count * 3;
+        } else {
+            s.projections = nullptr;
+        }
+        s.components = (const std::uint32_t*)p;
+        p += Align8(sizeof(std::uint32_t) * sh.node_count);
+        s.edges = (const EdgeRecord*)p;
+        p += sizeof(EdgeRecord) * sh.edge_count;
+        s.waypoints = (const double*)p;
+
+        // waypoint ranges must lie within the waypoints of their segment
+        for (size_t e = 0; e < sh.edge_count; ++e) {
+            const EdgeRecord& r = s.edges[e];
+            if ((std::uint64_t)r.waypoint_begin + r.waypoint_count >
+                sh.waypoint_count)
+            {
+                ROS_ERROR_NAMED(LOG, "Edge %zu in '%s' references invalid waypoints", m_edge_count + e, path.c_str());
+                close();
+                return false;
+            }
+        }
+
+        m_segments.push_back(s);
+
+        m_node_count += sh.node_count;
+        m_edge_count += sh.edge_count;
+        m_component_count += sh.component_count;
+
+        offset += sh.size;
+    }
+
+    ROS_DEBUG_NAMED(LOG, "Mapped experience graph store with %zu segments, %zu nodes, and %zu edges", m_segments.size(), m_node_count, m_edge_count);
+    return true;
+}
+
+void ExperienceGraphStore::close()
+{
+    if (m_data) {
+        munmap(m_data, m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_var_count = 0;
+    m_node_count = 0;
+    m_edge_count = 0;
+    m_component_count = 0;
+    m_segments.clear();
+}
+
+auto ExperienceGraphStore::nodeSegment(size_t n) const -> const Segment&
+{
+    auto it = std::upper_bound(
+            m_segments.begin(), m_segments.end(), n,
+            [](size_t n, const Segment& s) { return n < s.node_begin; });
+    return *(it - 1);
+}
+
+auto ExperienceGraphStore::edgeSegment(size_t e) const -> const Segment&
+{
+    auto it = std::upper_bound(
+            m_segments.begin(), m_segments.end(), e,
+            [](size_t e, const Segment& s) { return e < s.edge_begin; });
+    return *(it - 1);
+}
+
+auto ExperienceGraphStore::edgeRecord(size_t e) const -> const EdgeRecord&
+{
+    const Segment& s = edgeSegment(e);
+    return s.edges[e - s.edge_begin];
+}
+
+const double* ExperienceGraphStore::state(size_t n) const
+{
+    const Segment& s = nodeSegment(n);
+    return s.states + (n - s.node_begin) * m_var_count;
+}
+
+const double* ExperienceGraphStore::projection(size_t n) const
+{
+    const Segment& s = nodeSegment(n);
+    if (!s.projections) {
+        return nullptr;
+    }
+    return s.projections + (n - s.node_begin) * 3;
+}
+
+size_t ExperienceGraphStore::component(size_t n) const
+{
+    const Segment& s = nodeSegment(n);
+    return s.component_begin + s.components[n - s.node_begin];
+}
+
+size_t ExperienceGraphStore::source(size_t e) const
+{
+    return edgeRecord(e).source;
+}
+
+size_t ExperienceGraphStore::target(size_t e) const
+{
+    return edgeRecord(e).target;
+}
+
+size_t ExperienceGraphStore::waypointCount(size_t e) const
+{
+    return edgeRecord(e).waypoint_count;
+}
+
+const double* ExperienceGraphStore::waypoint(size_t e, size_t i) const
+{
+    const Segment& s = edgeSegment(e);
+    const EdgeRecord& r = s.edges[e - s.edge_begin];
+    return s.waypoints + (r.waypoint_begin + i) * m_var_count;
+}
+
+bool ExperienceGraphStore::load(ExperienceGraph& graph) const
+{
+    if (!isOpen()) {
+        return false;
+    }
+
+    // validate all edges before modifying the graph
+    for (size_t e = 0; e < m_edge_count; ++e) {
+        const EdgeRecord& r = edgeRecord(e);
+        if (r.source >= m_node_count || r.target >= m_node_count) {
+            ROS_ERROR_NAMED(LOG, "Experience graph store edge %zu references invalid node", e);
+            return false;
+        }
+    }
+
+    const size_t node_offset = graph.num_nodes();
+
+    for (size_t n = 0; n < m_node_count; ++n) {
+        const double* s = state(n);
+        graph.insert_node(RobotState(s, s + m_var_count));
+    }
+
+    std::vector<RobotState> waypoints;
+    for (size_t e = 0; e < m_edge_count; ++e) {
+        const EdgeRecord& r = edgeRecord(e);
+        waypoints.clear();
+        for (size_t i = 0; i < r.waypoint_count; ++i) {
+            const double* w = waypoint(e, i);
+            waypoints.emplace_back(w, w + m_var_count);
+        }
+        graph.insert_edge(
+                node_offset + r.source, node_offset + r.target, waypoints);
+    }
+
+    return true;
+}
+
+template <class T>
+static void WriteArray(std::ostream& o, const T* data, size_t count)
+{
+    o.write((const char*)data, sizeof(T) * count);
+}
+
+// Write the nodes of a graph with ids at or after first_node, and the edges
+// between them, as a segment whose first node has id node_offset.
+static bool WriteSegment(
+    std::ostream& o,
+    const ExperienceGraph& graph,
+    ExperienceGraph::node_id first_node,
+    size_t node_offset,
+    size_t var_count,
+    const std::vector<Eigen::Vector3d>* projections)
+{
+    typedef ExperienceGraph::node_id node_id;
+
+    const size_t node_count = graph.num_nodes() - first_node;
+
+    if (projections && projections->size() != node_count) {
+        ROS_ERROR_NAMED(LOG, "Expected %zu projections but received %zu", node_count, projections->size());
+        return false;
+    }
+
+    std::vector<double> states;
+    states.reserve(node_count * var_count);
+    for (node_id n = first_node; n < graph.num_nodes(); ++n) {
+        const RobotState& s = graph.state(n);
+        if (s.size() != var_count) {
+            ROS_ERROR_NAMED(LOG, "Experience graph state has %zu variables, expected %zu", s.size(), var_count);
+            return false;
+        }
+        states.insert(states.end(), s.begin(), s.end());
+    }
+
+    // gather edges within the segment and label connected components
+    std::vector<std::uint32_t> edges;
+    std::vector<double> waypoints;
+    std::vector<size_t> parent(node_count);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find_root = [&](size_t i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    };
+
+    size_t waypoint_count = 0;
+    auto all_edges = graph.edges();
+    for (auto eit = all_edges.first; eit != all_edges.second; ++eit) {
+        const node_id u = graph.source(*eit);
+        const node_id v = graph.target(*eit);
+        if (u < first_node || v < first_node) {
+            continue;
+        }
+
+        const std::vector<RobotState>& path = graph.waypoints(*eit);
+        edges.push_back((std::uint32_t)(node_offset + u - first_node));
+        edges.push_back((std::uint32_t)(node_offset + v - first_node));
+        edges.push_back((std::uint32_t)waypoint_count);
+        edges.push_back((std::uint32_t)path.size());
+        for (const RobotState& w : path) {
+            if (w.size() != var_count) {
+                ROS_ERROR_NAMED(LOG, "Experience graph waypoint has %zu variables, expected %zu", w.size(), var_count);
+                return false;
+            }
+            waypoints.insert(waypoints.end(), w.begin(), w.end());
+        }
+        waypoint_count += path.size();
+
+        parent[find_root(u - first_node)] = find_root(v - first_node);
+    }
+
+    std::vector<std::uint32_t> components(node_count);
+    std::vector<std::uint32_t> root_labels(node_count, (std::uint32_t)-1);
+    std::uint32_t component_count = 0;
+    for (size_t i = 0; i < node_count; ++i) {
+        const size_t root = find_root(i);
+        if (root_labels[root] == (std::uint32_t)-1) {
+            root_labels[root] = component_count++;
+        }
+        components[i] = root_labels[root];
+    }
+
+    SegmentHeader header;
+    header.node_count = (std::uint32_t)node_count;
+    header.edge_count = (std::uint32_t)(edges.size() / 4);
+    header.waypoint_count = (std::uint32_t)waypoint_count;
+    header.component_count = component_count;
+    header.flags = projections ? HasProjections : 0;
+    header.reserved = 0;
+    header.size = SegmentSize(header, var_count);
+
+    WriteArray(o, &header, 1);
+    WriteArray(o, states.data(), states.size());
+    if (projections) {
+        for (const Eigen::Vector3d& p : *projections) {
+            WriteArray(o, p.data(), 3);
+        }
+    }
+    WriteArray(o, components.data(), components.size());
+    const char padding[8] = { 0 };
+    o.write(padding, Align8(sizeof(std::uint32_t) * node_count) - sizeof(std::uint32_t) * node_count);
+    WriteArray(o, edges.data(), edges.size());
+    WriteArray(o, waypoints.data(), waypoints.size());
+
+    return o.good();
+}
+
+static size_t GraphVariableCount(const ExperienceGraph& graph)
+{
+    return graph.num_nodes() == 0 ? 0 : graph.state(0).size();
+}
+
+// Write a new store holding a single segment with the nodes of a graph with ids
+// at or after first_node, and the edges between them
+static bool WriteStore(
+    const std::string& path,
+    const ExperienceGraph& graph,
+    ExperienceGraph::node_id first_node,
+    const std::vector<Eigen::Vector3d>* projections)
+{
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open()) {
+        ROS_ERROR_NAMED(LOG, "Failed to open '%s' for writing", path.c_str());
+        return false;
+    }
+
+    StoreHeader header;
+    std::memcpy(header.magic, StoreMagic, sizeof(StoreMagic));
+    header.version = StoreVersion;
+    header.variable_count = (std::uint32_t)GraphVariableCount(graph);
+    header.reserved = 0;
+    WriteArray(ofs, &header, 1);
+
+    if (!WriteSegment(ofs, graph, first_node, 0, header.variable_count, projections)) {
+        ROS_ERROR_NAMED(LOG, "Failed to write experience graph store '%s'", path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool WriteExperienceGraphStore(
+    const std::string& path,
+    const ExperienceGraph& graph,
+    const std::vector<Eigen::Vector3d>* projections)
+{
+    return WriteStore(path, graph, 0, projections);
+}
+
+bool AppendExperienceGraphStore(
+    const std::string& path,
+    const ExperienceGraph& graph,
+    ExperienceGraph::node_id first_node,
+    const std::vector<Eigen::Vector3d>* projections)
+{
+    if (first_node > graph.num_nodes()) {
+        return false;
+    }
+
+    boost::system::error_code ec;
+    if (!boost::filesystem::exists(path, ec)) {
+        if (first_node != 0) {
+            // node ids in the new store are offset from those in the graph
+            ROS_WARN_NAMED(LOG, "Creating experience graph store '%s' from the nodes after node %zu of an experience graph", path.c_str(), (size_t)first_node);
+        }
+        return WriteStore(path, graph, first_node, projections);
+    }
+
+    // find the end of the last complete segment and the number of nodes
+    // already stored
+    size_t var_count = 0;
+    size_t node_count = 0;
+    size_t valid_size = 0;
+    {
+        std::ifstream ifs(path, std::ios::binary);
+        StoreHeader header;
+        if (!ifs.read((char*)&header, sizeof(header)) ||
+            !ValidStoreHeader(header))
+        {
+            ROS_ERROR_NAMED(LOG, "'%s' is not an experience graph store", path.c_str());
+            return false;
+        }
+        var_count = header.variable_count;
+
+        const size_t file_size = boost::filesystem::file_size(path, ec);
+        valid_size = sizeof(StoreHeader);
+        SegmentHeader sh;
+        while (ifs.read((char*)&sh, sizeof(sh))) {
+            if (sh.size != SegmentSize(sh, var_count) ||
+                valid_size + sh.size > file_size)
+            {
+                break;
+            }
+            node_count += sh.node_count;
+            valid_size += sh.size;
+            ifs.seekg(valid_size);
+        }
+    }
+
+    if (node_count == 0 && graph.num_nodes() > first_node) {
+        // an empty store takes the variable count of the first append
+        var_count = GraphVariableCount(graph);
+        std::fstream fs(path, std::ios::binary | std::ios::in | std::ios::out);
+        fs.seekp(offsetof(StoreHeader, variable_count));
+        const std::uint32_t vc = (std::uint32_t)var_count;
+        if (!fs.write((const char*)&vc, sizeof(vc))) {
+            ROS_ERROR_NAMED(LOG, "Failed to update experience graph store '%s'", path.c_str());
+            return false;
+        }
+    }
+
+    if (graph.num_nodes() > first_node &&
+        GraphVariableCount(graph) != var_count)
+    {
+        ROS_ERROR_NAMED(LOG, "Experience graph store '%s' holds states with %zu variables", path.c_str(), var_count);
+        return false;
+    }
+
+    // discard any partially written segment
+    boost::filesystem::resize_file(path, valid_size, ec);
+    if (ec) {
+        ROS_ERROR_NAMED(LOG, "Failed to truncate experience graph store '%s'", path.c_str());
+        return false;
+    }
+
+    std::ofstream ofs(path, std::ios::binary | std::ios::app);
+    if (!ofs.is_open()) {
+        ROS_ERROR_NAMED(LOG, "Failed to open '%s' for writing", path.c_str());
+        return false;
+    }
+
+    if (!WriteSegment(ofs, graph, first_node, node_count, var_count, projections)) {
+        ROS_ERROR_NAMED(LOG, "Failed to append to experience graph store '%s'", path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace motion
+} // namespace sbpl
@@ -76,7 +76,13 @@ ManipLattice::ManipLattice(
     m_expanded_states(),
     m_near_goal(false),
     m_t_start(),
-    m_viz_frame_id()
+    m_viz_frame_id(),
+    m_edge_cache(),
+    m_edge_cache_grid(nullptr),
+    m_edge_cache_checker(nullptr),
+    m_edge_cache_grid_version(0),
+    m_edge_cache_checker_version(0),
+    m_edge_cache_version(0)
 {
     m_fk_iface = robot()->getExtension<ForwardKinematicsInterface>();
 
@@ -237,7 +243,7 @@ void ManipLattice::GetSuccs(
         ROS_DEBUG_NAMED(params()->expands_log, "      waypoints: %zu", action.size());
 
         double dist;
-        if (!checkAction(parent_entry->state, action, dist)) {
+        if (!checkAction(state_id, (int)i, parent_entry->state, action, dist)) {
             continue;
         }
 
@@ -454,7 +460,7 @@ int ManipLattice::GetTrueCost(int parentID, int childID)
         ROS_DEBUG_NAMED(params()->expands_log, "      waypoints %zu:", action.size());
 
         double dist;
-        if (!checkAction(parent_angles, action, dist)) {
+        if (!checkAction(parentID, (int)aidx, parent_angles, action, dist)) {
             continue;
         }
 
@@ -734,6 +740,68 @@ bool ManipLattice::checkAction(
     return true;
 }
 
+/// Hash the waypoints of an action. Used to verify that a cached result for
+/// an action index out of a state was computed for the same action, since the
+/// set of actions returned by the action space is not stable across queries;
+/// adaptive motions depend on the start and goal.
+static
+std::uint64_t HashAction(const Action& action)
+{
+    size_t seed = 0;
+    for (const RobotState& waypoint : action) {
+        boost::hash_combine(
+                seed, boost::hash_range(waypoint.begin(), waypoint.end()));
+    }
+    return (std::uint64_t)seed;
+}
+
+/// Check the action with index \p action_index applied to the state
+/// \p state_id for validity, consulting the edge validity cache, if enabled,
+/// before checking for collisions.
+bool ManipLattice::checkAction(
+    int state_id,
+    int action_index,
+    const RobotState& state,
+    const Action& action,
+    double& dist)
+{
+    if (!edgeCacheEnabled()) {
+        return checkAction(state, action, dist);
+    }
+
+    const std::uint32_t version = edgeCacheVersion();
+    const std::uint64_t action_id = HashAction(action);
+
+    bool valid;
+    if (m_edge_cache.find(state_id, action_index, action_id, version, valid, dist)) {
+        ROS_DEBUG_NAMED(params()->expands_log, "        -> cached (valid: %d, dist: %0.3f)", (int)valid, dist);
+        return valid;
+    }
+
+    valid = checkAction(state, action, dist);
+    m_edge_cache.insert(state_id, action_index, action_id, version, valid, dist);
+    return valid;
+}
+
+/// Return the version against which edge validity results are cached. The
+/// version is advanced whenever the occupancy grid or the collision checker
+/// report a change since the last query.
+std::uint32_t ManipLattice::edgeCacheVersion()
+{
+    const std::uint32_t grid_version =
+            m_edge_cache_grid ? m_edge_cache_grid->version() : 0;
+    const std::uint64_t checker_version =
+            m_edge_cache_checker ? m_edge_cache_checker->collisionVersion() : 0;
+    if (grid_version != m_edge_cache_grid_version ||
+        checker_version != m_edge_cache_checker_version)
+    {
+        m_edge_cache_grid_version = grid_version;
+        m_edge_cache_checker_version = checker_version;
+        ++m_edge_cache_version;
+    }
+    return m_edge_cache_version;
+}
+
 bool ManipLattice::isGoal(
     const RobotState& state,
     const std::vector<double>& pose)
@@ -901,6 +969,41 @@ const std::string& ManipLattice::visualizationFrameId() const
     return m_viz_frame_id;
 }
 
+/// Enable caching of edge validity checks.
+///
+/// Results are keyed by the parent state and the action applied to it, so
+/// that edges re-expanded during later iterations of an anytime search, or by
+/// later queries, are not collision checked again. Cached results are ignored
+/// once \p grid changes or, if the collision checker provides the
+/// CollisionVersionExtension, once the collision checker reports a change to
+/// its scene or configuration. Collision checkers without the extension must
+/// be followed by a call to clearEdgeCache() after changes that do not modify
+/// \p grid, such as attaching objects or modifying the allowed collisions.
+///
+/// \param grid The occupancy grid used by the collision checker, or null if
+///     the cache should only be invalidated by the collision checker or
+///     manually
+/// \param capacity The maximum number of cached edges
+void ManipLattice::enableEdgeCache(const OccupancyGrid* grid, size_t capacity)
+{
+    m_edge_cache_grid = grid;
+    m_edge_cache_checker =
+            collisionChecker()->getExtension<CollisionVersionExtension>();
+    m_edge_cache.resize(capacity);
+}
+
+void ManipLattice::disableEdgeCache()
+{
+    m_edge_cache_grid = nullptr;
+    m_edge_cache_checker = nullptr;
+    m_edge_cache.resize(0);
+}
+
+void ManipLattice::clearEdgeCache()
+{
+    m_edge_cache.clear();
+}
+
 void ManipLattice::computeCostPerCell()
 {
     ROS_WARN("yeah...");
@@ -1005,7 +1108,7 @@ bool ManipLattice::extractPath(
 
                 // check the validity of this transition
                 double dist;
-                if (!checkAction(prev_state, action, dist)) {
+                if (!checkAction(prev_id, (int)aidx, prev_state, action, dist)) {
                     continue;
                 }
 
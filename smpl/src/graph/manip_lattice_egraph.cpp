@@ -30,13 +30,18 @@
 #include <smpl/graph/manip_lattice_egraph.h>
 
 #include <fstream>
+#include <functional>
+#include <numeric>
 
 #include <boost/filesystem.hpp>
 #include <leatherman/print.h>
 #include <smpl/csv_parser.h>
+#include <smpl/graph/experience_graph_store.h>
 #include <smpl/intrusive_heap.h>
 #include <smpl/debug/visualize.h>
 #include <smpl/graph/manip_lattice_action_space.h>
+#include <smpl/heuristic/egraph_heuristic.h>
+#include <smpl/heuristic/robot_heuristic.h>
 
 namespace sbpl {
 namespace motion {
@@ -57,8 +62,11 @@ ManipLatticeEgraph::ManipLatticeEgraph(
     ManipLattice(robot, checker, params),
     m_coord_to_nodes(),
     m_egraph(),
-    m_egraph_state_ids()
+    m_egraph_state_ids(),
+    m_edge_usage(),
+    m_max_egraph_edges(0)
 {
+    params->param("egraph_max_edges", m_max_egraph_edges, 0);
 }
 
 bool ManipLatticeEgraph::extractPath(
@@ -145,10 +153,12 @@ bool ManipLatticeEgraph::extractPath(
         ManipLatticeState* best_state = nullptr;
         RobotCoord succ_coord(robot()->jointVariableCount());
         int best_cost = std::numeric_limits<int>::max();
-        for (const Action& action : actions) {
+        for (size_t aidx = 0; aidx < actions.size(); ++aidx) {
+            const Action& action = actions[aidx];
+
             // check the validity of this transition
             double dist;
-            if (!checkAction(prev_state, action, dist)) {
+            if (!checkAction(prev_id, (int)aidx, prev_state, action, dist)) {
                 continue;
             }
 
@@ -215,6 +225,12 @@ bool ManipLatticeEgraph::extractPath(
             std::vector<ExperienceGraph::node_id> node_path;
             found = findShortestExperienceGraphPath(pn, cn, node_path);
             if (found) {
+                for (size_t j = 1; j < node_path.size(); ++j) {
+                    ExperienceGraph::edge_id eid;
+                    if (findExperienceGraphEdge(node_path[j - 1], node_path[j], eid)) {
+                        ++m_edge_usage[eid];
+                    }
+                }
                 for (ExperienceGraph::node_id n : node_path) {
                     int state_id = m_egraph_state_ids[n];
                     ManipLatticeState* entry = getHashEntry(state_id);
@@ -253,6 +269,10 @@ bool ManipLatticeEgraph::loadExperienceGraph(const std::string& path)
     ROS_INFO("Load Experience Graph at %s", path.c_str());
 
     boost::filesystem::path p(path);
+    if (boost::filesystem::is_regular_file(p)) {
+        return loadExperienceGraphStore(path);
+    }
+
     if (!boost::filesystem::is_directory(p)) {
         ROS_ERROR("'%s' is not a directory", path.c_str());
         return false;
@@ -272,59 +292,99 @@ bool ManipLatticeEgraph::loadExperienceGraph(const std::string& path)
         }
 
         ROS_INFO("Create hash entries for experience graph states");
+        addExperienceGraphStates(egraph_states, false, nullptr);
+    }
 
-        const RobotState& pp = egraph_states.front();  // previous robot state
-        RobotCoord pdp(robot()->jointVariableCount()); // previous robot coord
-        stateToCoord(egraph_states.front(), pdp);
-
-        ExperienceGraph::node_id pid = m_egraph.insert_node(pp);
-        m_coord_to_nodes[pdp].push_back(pid);
-
-        int entry_id = reserveHashEntry();
-        ManipLatticeState* entry = getHashEntry(entry_id);
-        entry->coord = pdp;
-        entry->state = pp;
-
-        // map state id <-> experience graph state
-        m_egraph_state_ids.resize(pid + 1, -1);
-        m_egraph_state_ids[pid] = entry_id;
-        m_state_to_node[entry_id] = pid;
-
-        std::vector<RobotState> edge_data;
-        for (size_t i = 1; i < egraph_states.size(); ++i) {
-            const RobotState& p = egraph_states[i];
-            RobotCoord dp(robot()->jointVariableCount());
-            stateToCoord(p, dp);
-            if (dp != pdp) {
-                // found a new discrete state along the path
-
-                ExperienceGraph::node_id id = m_egraph.insert_node(p);
-                m_coord_to_nodes[dp].push_back(id);
-
-                int entry_id = reserveHashEntry();
-                ManipLatticeState* entry = getHashEntry(entry_id);
-                entry->coord = dp;
-                entry->state = p;
-
-                m_egraph_state_ids.resize(id + 1, -1);
-                m_egraph_state_ids[id] = entry_id;
-                m_state_to_node[entry_id] = id;
-                m_egraph.insert_edge(pid, id, edge_data);
-
-                pdp = dp;
-                pid = id;
-                edge_data.clear();
-            } else {
-                // gather intermediate robot states
-                edge_data.push_back(p);
-            }
+    ROS_INFO("Experience graph contains %zu nodes and %zu edges", m_egraph.num_nodes(), m_egraph.num_edges());
+    return true;
+}
+
+/// Write the experience graph to a binary experience graph store, which may be
+/// loaded later with loadExperienceGraph(). Loading a directory of CSV
+/// demonstrations and saving the result converts them to the binary format.
+bool ManipLatticeEgraph::saveExperienceGraph(const std::string& path) const
+{
+    ROS_INFO("Save Experience Graph to %s", path.c_str());
+    return WriteExperienceGraphStore(path, m_egraph);
+}
+
+/// Insert a demonstration into the experience graph and append its nodes and
+/// edges to the binary experience graph store at \p path, without rewriting
+/// the existing contents of the store. Experience graph heuristics of this
+/// planning space are notified of the change.
+bool ManipLatticeEgraph::appendExperienceGraph(
+    const std::string& path,
+    const std::vector<RobotState>& egraph_states)
+{
+    if (egraph_states.empty()) {
+        return true;
+    }
+
+    const ExperienceGraph::node_id first_node = m_egraph.num_nodes();
+    std::vector<ExperienceGraph::edge_id> new_edges;
+    addExperienceGraphStates(egraph_states, false, &new_edges);
+    const bool appended = AppendExperienceGraphStore(path, m_egraph, first_node);
+
+    notifyExperienceGraphHeuristics(first_node, new_edges, false);
+    return appended;
+}
+
+/// Insert a solution path into the experience graph. States are merged into
+/// existing nodes at the same discrete state and transitions between existing
+/// nodes reuse existing edges, counting their use. If the experience graph
+/// contains more than egraph_max_edges edges afterwards, the least used edges
+/// are evicted. Experience graph heuristics of this planning space are
+/// notified of the change.
+bool ManipLatticeEgraph::insertExperienceGraphPath(
+    const std::vector<RobotState>& path)
+{
+    if (path.empty()) {
+        return true;
+    }
+
+    for (const RobotState& state : path) {
+        if (state.size() != robot()->jointVariableCount()) {
+            ROS_ERROR_NAMED(params()->graph_log, "Experience graph path state has %zu variables, expected %zu", state.size(), robot()->jointVariableCount());
+            return false;
         }
     }
 
-    ROS_INFO("Experience graph contains %zu nodes and %zu edges", m_egraph.num_nodes(), m_egraph.num_edges());
+    const ExperienceGraph::node_id first_node = m_egraph.num_nodes();
+    const ExperienceGraph::edges_size_type prev_edge_count = m_egraph.num_edges();
+
+    std::vector<ExperienceGraph::edge_id> new_edges;
+    addExperienceGraphStates(path, true, &new_edges);
+
+    ROS_INFO_NAMED(params()->graph_log, "Inserted path with %zu nodes and %zu edges into experience graph", m_egraph.num_nodes() - first_node, m_egraph.num_edges() - prev_edge_count);
+
+    const bool pruned = pruneExperienceGraph();
+
+    notifyExperienceGraphHeuristics(first_node, new_edges, pruned);
     return true;
 }
 
+/// Notify the experience graph heuristics of this planning space that nodes
+/// with ids at or after \p first_node and the edges \p edges were inserted
+/// into the experience graph, or, if nodes or edges were also removed, that
+/// the experience graph must be rebuilt.
+void ManipLatticeEgraph::notifyExperienceGraphHeuristics(
+    ExperienceGraph::node_id first_node,
+    const std::vector<ExperienceGraph::edge_id>& edges,
+    bool rebuild)
+{
+    for (size_t i = 0; i < numHeuristics(); ++i) {
+        auto* egh = heuristic(i)->getExtension<ExperienceGraphHeuristicExtension>();
+        if (!egh) {
+            continue;
+        }
+        if (rebuild) {
+            egh->rebuildExperienceGraph();
+        } else {
+            egh->updateExperienceGraph(first_node, edges);
+        }
+    }
+}
+
 void ManipLatticeEgraph::getExperienceGraphNodes(
     int state_id,
     std::vector<ExperienceGraph::node_id>& nodes)
@@ -497,6 +557,194 @@ bool ManipLatticeEgraph::findShortestExperienceGraphPath(
     return false;
 }
 
+bool ManipLatticeEgraph::loadExperienceGraphStore(const std::string& path)
+{
+    ExperienceGraphStore store;
+    if (!store.open(path)) {
+        return false;
+    }
+
+    if (store.numNodes() != 0 &&
+        store.variableCount() != robot()->jointVariableCount())
+    {
+        ROS_ERROR("Experience graph store contains %zu joint variables, expected %zu", store.variableCount(), robot()->jointVariableCount());
+        return false;
+    }
+
+    const ExperienceGraph::node_id first_node = m_egraph.num_nodes();
+    if (!store.load(m_egraph)) {
+        ROS_ERROR("Failed to load experience graph store '%s'", path.c_str());
+        return false;
+    }
+
+    for (ExperienceGraph::node_id n = first_node; n < m_egraph.num_nodes(); ++n) {
+        RobotCoord coord(robot()->jointVariableCount());
+        stateToCoord(m_egraph.state(n), coord);
+        mapExperienceGraphNode(n, coord);
+    }
+    m_edge_usage.resize(m_egraph.num_edges(), 0);
+
+    ROS_INFO("Experience graph contains %zu nodes and %zu edges", m_egraph.num_nodes(), m_egraph.num_edges());
+    return true;
+}
+
+// Insert a sequence of robot states into the experience graph. Consecutive
+// states that discretize to the same lattice coordinate are collapsed into
+// a single node, and the states between nodes are stored as edge waypoints.
+// If merge is true, states are collapsed into existing nodes at the same
+// lattice coordinate and transitions along existing edges reuse those edges.
+// The ids of inserted edges are appended to new_edges, if given.
+void ManipLatticeEgraph::addExperienceGraphStates(
+    const std::vector<RobotState>& egraph_states,
+    bool merge,
+    std::vector<ExperienceGraph::edge_id>* new_edges)
+{
+    auto get_node = [&](const RobotState& state, const RobotCoord& coord) {
+        if (merge) {
+            auto it = m_coord_to_nodes.find(coord);
+            if (it != m_coord_to_nodes.end() && !it->second.empty()) {
+                return it->second.front();
+            }
+        }
+        ExperienceGraph::node_id id = m_egraph.insert_node(state);
+        mapExperienceGraphNode(id, coord);
+        return id;
+    };
+
+    const RobotState& pp = egraph_states.front();  // previous robot state
+    RobotCoord pdp(robot()->jointVariableCount()); // previous robot coord
+    stateToCoord(egraph_states.front(), pdp);
+
+    ExperienceGraph::node_id pid = get_node(pp, pdp);
+
+    std::vector<RobotState> edge_data;
+    for (size_t i = 1; i < egraph_states.size(); ++i) {
+        const RobotState& p = egraph_states[i];
+        RobotCoord dp(robot()->jointVariableCount());
+        stateToCoord(p, dp);
+        if (dp != pdp) {
+            // found a new discrete state along the path
+
+            ExperienceGraph::node_id id = get_node(p, dp);
+
+            ExperienceGraph::edge_id eid;
+            if (merge && findExperienceGraphEdge(pid, id, eid)) {
+                ++m_edge_usage[eid];
+            } else {
+                eid = m_egraph.insert_edge(pid, id, edge_data);
+                m_edge_usage.resize(m_egraph.num_edges(), 0);
+                m_edge_usage[eid] = 1;
+                if (new_edges) {
+                    new_edges->push_back(eid);
+                }
+            }
+
+            pdp = dp;
+            pid = id;
+            edge_data.clear();
+        } else {
+            // gather intermediate robot states
+            edge_data.push_back(p);
+        }
+    }
+}
+
+// Create a hash entry for an experience graph node and map state id <->
+// experience graph node
+void ManipLatticeEgraph::mapExperienceGraphNode(
+    ExperienceGraph::node_id n,
+    const RobotCoord& coord)
+{
+    m_coord_to_nodes[coord].push_back(n);
+
+    int entry_id = reserveHashEntry();
+    ManipLatticeState* entry = getHashEntry(entry_id);
+    entry->coord = coord;
+    entry->state = m_egraph.state(n);
+
+    m_egraph_state_ids.resize(n + 1, -1);
+    m_egraph_state_ids[n] = entry_id;
+    m_state_to_node[entry_id] = n;
+}
+
+// Find an edge between two experience graph nodes
+bool ManipLatticeEgraph::findExperienceGraphEdge(
+    ExperienceGraph::node_id u,
+    ExperienceGraph::node_id v,
+    ExperienceGraph::edge_id& e)
+{
+    m_edge_usage.resize(m_egraph.num_edges(), 0);
+    auto edges = m_egraph.edges(u);
+    for (auto eit = edges.first; eit != edges.second; ++eit) {
+        if ((m_egraph.source(*eit) == u && m_egraph.target(*eit) == v) ||
+            (m_egraph.source(*eit) == v && m_egraph.target(*eit) == u))
+        {
+            e = *eit;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Evict the least used experience graph edges, oldest first, until the graph
+// contains no more than egraph_max_edges edges. Nodes left without any edges
+// by the eviction are removed. Return whether anything was removed.
+bool ManipLatticeEgraph::pruneExperienceGraph()
+{
+    if (m_max_egraph_edges <= 0 ||
+        m_egraph.num_edges() <= (size_t)m_max_egraph_edges)
+    {
+        return false;
+    }
+
+    m_edge_usage.resize(m_egraph.num_edges(), 0);
+
+    std::vector<ExperienceGraph::edge_id> evicted(m_egraph.num_edges());
+    std::iota(evicted.begin(), evicted.end(), 0);
+    std::stable_sort(evicted.begin(), evicted.end(),
+            [&](ExperienceGraph::edge_id a, ExperienceGraph::edge_id b) {
+                return m_edge_usage[a] < m_edge_usage[b];
+            });
+    evicted.resize(m_egraph.num_edges() - m_max_egraph_edges);
+
+    std::vector<ExperienceGraph::node_id> endpoints;
+    for (ExperienceGraph::edge_id e : evicted) {
+        endpoints.push_back(m_egraph.source(e));
+        endpoints.push_back(m_egraph.target(e));
+    }
+
+    // erase from the highest id so lower ids remain valid
+    std::sort(evicted.begin(), evicted.end(), std::greater<ExperienceGraph::edge_id>());
+    for (ExperienceGraph::edge_id e : evicted) {
+        m_egraph.erase_edge(e);
+        m_edge_usage.erase(m_edge_usage.begin() + e);
+    }
+
+    std::sort(endpoints.begin(), endpoints.end(), std::greater<ExperienceGraph::node_id>());
+    endpoints.erase(std::unique(endpoints.begin(), endpoints.end()), endpoints.end());
+    size_t removed_node_count = 0;
+    for (ExperienceGraph::node_id n : endpoints) {
+        if (m_egraph.degree(n) == 0) {
+            m_egraph.erase_node(n);
+            m_egraph_state_ids.erase(m_egraph_state_ids.begin() + n);
+            ++removed_node_count;
+        }
+    }
+
+    // rebuild the mappings to experience graph nodes, whose ids have shifted;
+    // hash entries of removed nodes remain in the lattice
+    m_state_to_node.clear();
+    m_coord_to_nodes.clear();
+    for (ExperienceGraph::node_id n = 0; n < m_egraph.num_nodes(); ++n) {
+        const int state_id = m_egraph_state_ids[n];
+        m_state_to_node[state_id] = n;
+        m_coord_to_nodes[getHashEntry(state_id)->coord].push_back(n);
+    }
+
+    ROS_INFO_NAMED(params()->graph_log, "Evicted %zu edges and %zu nodes from experience graph", evicted.size(), removed_node_count);
+    return true;
+}
+
 bool ManipLatticeEgraph::parseExperienceGraphFile(
     const std::string& filepath,
     std::vector<RobotState>& egraph_states) const
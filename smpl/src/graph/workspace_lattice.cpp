@@ -80,6 +80,7 @@ WorkspaceLattice::WorkspaceLattice(
     m_goal_state_id(-1),
     m_start_entry(nullptr),
     m_start_state_id(-1),
+    m_state_pool(),
     m_state_to_id(),
     m_states(),
     m_t_start(),
@@ -98,11 +99,9 @@ WorkspaceLattice::WorkspaceLattice(
 
 WorkspaceLattice::~WorkspaceLattice()
 {
-    for (size_t i = 0; i < m_states.size(); i++) {
-        delete m_states[i];
-        m_states[i] = nullptr;
-    }
+    m_state_to_id.clear();
     m_states.clear();
+    m_state_pool.clear();
 
     // NOTE: StateID2IndexMapping cleared by DiscreteSpaceInformation
 }
@@ -360,7 +359,7 @@ void WorkspaceLattice::GetSuccs(
     WorkspaceLatticeState* parent_entry = getState(state_id);
 
     assert(parent_entry);
-    assert(parent_entry->coord.size() == m_dof_count);
+    assert(parent_entry->coord.size() == (size_t)m_dof_count);
 
     ROS_DEBUG_NAMED(params()->expands_log, "  coord: %s", to_string(parent_entry->coord).c_str());
     ROS_DEBUG_NAMED(params()->expands_log, "  state: %s", to_string(parent_entry->state).c_str());
@@ -463,7 +462,7 @@ void WorkspaceLattice::GetLazySuccs(
     WorkspaceLatticeState* state_entry = getState(state_id);
 
     assert(state_entry);
-    assert(state_entry->coord.size() == m_dof_count);
+    assert(state_entry->coord.size() == (size_t)m_dof_count);
 
     ROS_DEBUG_NAMED(params()->expands_log, "  coord: %s", to_string(state_entry->coord).c_str());
     ROS_DEBUG_NAMED(params()->expands_log, "  state: %s", to_string(state_entry->state).c_str());
@@ -527,8 +526,8 @@ int WorkspaceLattice::GetTrueCost(int parent_id, int child_id)
 
     WorkspaceLatticeState* parent_entry = getState(parent_id);
     WorkspaceLatticeState* child_entry = getState(child_id);
-    assert(parent_entry && parent_entry->coord.size() == m_dof_count);
-    assert(child_entry && child_entry->coord.size() == m_dof_count);
+    assert(parent_entry && parent_entry->coord.size() == (size_t)m_dof_count);
+    assert(child_entry && child_entry->coord.size() == (size_t)m_dof_count);
 
     std::vector<Action> actions;
     getActions(*parent_entry, actions);
@@ -670,19 +669,19 @@ int WorkspaceLattice::createState(const WorkspaceCoord& coord)
 {
     WorkspaceLatticeState state;
     state.coord = coord;
-    auto sit = m_state_to_id.find(&state);
-    if (sit != m_state_to_id.end()) {
-        return sit->second;
+    int state_id = m_state_to_id.find(state);
+    if (state_id >= 0) {
+        return state_id;
     }
 
     int new_id = (int)m_states.size();
 
     // create a new entry
-    WorkspaceLatticeState* state_entry = new WorkspaceLatticeState(state);
+    WorkspaceLatticeState* state_entry = m_state_pool.create(state);
 
     // map id <-> state
     m_states.push_back(state_entry);
-    m_state_to_id[state_entry] = new_id;
+    m_state_to_id.insert(state_entry, new_id);
 
     int* indices = new int[NUMOFINDICES_STATEID2IND];
     std::fill(indices, indices + NUMOFINDICES_STATEID2IND, -1);
@@ -835,7 +834,7 @@ bool WorkspaceLattice::checkAction(
         ROS_DEBUG_NAMED(params()->expands_log, "        %zu: %s", widx, to_string(istate).c_str());
 
         RobotState irstate;
-        if (!stateWorkspaceToRobot(istate, state, irstate)) {
+        if (!stateWorkspaceToRobot(istate, waypointSeed(state, wptraj), irstate)) {
             ROS_DEBUG_NAMED(params()->expands_log, "         -> failed to find ik solution");
             violation_mask |= 0x00000001;
             break;
@@ -906,7 +905,7 @@ bool WorkspaceLattice::checkLazyAction(
         ROS_DEBUG_NAMED(params()->expands_log, "        %zu: %s", widx, to_string(istate).c_str());
 
         RobotState irstate;
-        if (!stateWorkspaceToRobot(istate, state, irstate)) {
+        if (!stateWorkspaceToRobot(istate, waypointSeed(state, wptraj), irstate)) {
             ROS_DEBUG_NAMED(params()->expands_log, "         -> failed to find ik solution");
             violation_mask |= 0x00000001;
             break;
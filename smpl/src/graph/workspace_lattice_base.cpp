@@ -31,6 +31,10 @@
 
 #include <smpl/graph/workspace_lattice_base.h>
 
+// standard includes
+#include <algorithm>
+#include <cmath>
+
 // system includes
 #include <Eigen/Dense>
 #include <leatherman/print.h>
@@ -53,7 +57,16 @@ WorkspaceLatticeBase::WorkspaceLatticeBase(
     m_res(),
     m_val_count(),
     m_dof_count(0),
-    m_fangle_indices()
+    m_fangle_indices(),
+    m_approx_ik_vars(),
+    m_approx_ik(false),
+    m_approx_ik_max_iterations(0),
+    m_approx_ik_pos_tolerance(0.0),
+    m_approx_ik_rot_tolerance(0.0),
+    m_ik_seed_cache_size(0),
+    m_ik_seed_cache_max_dist(0.0),
+    m_ik_seed_cache(),
+    m_ik_seed_cache_order()
 {
 }
 
@@ -77,6 +90,11 @@ bool WorkspaceLatticeBase::init(const Params& _params)
         return false;
     }
 
+    if (6 + (size_t)m_rm_iface->redundantVariableCount() > MaxWorkspaceDofCount) {
+        ROS_WARN("Workspace Lattice supports at most %zu redundant variables", MaxWorkspaceDofCount - 6);
+        return false;
+    }
+
     m_fangle_indices.resize(m_rm_iface->redundantVariableCount());
     for (size_t i = 0; i < m_fangle_indices.size(); ++i) {
         m_fangle_indices[i] = m_rm_iface->redundantVariableIndex(i);
@@ -119,6 +137,26 @@ bool WorkspaceLatticeBase::init(const Params& _params)
         ROS_INFO("  J%d: { res: %0.3f, count: %d }", i, m_res[6 + i], m_val_count[6 + i]);
     }
 
+    // the approximate solver, like computeFastIK, holds redundant variables
+    // fixed to their values in the seed state
+    m_approx_ik_vars.clear();
+    for (int vidx = 0; vidx < (int)robot()->jointVariableCount(); ++vidx) {
+        if (std::find(m_fangle_indices.begin(), m_fangle_indices.end(), vidx) ==
+            m_fangle_indices.end())
+        {
+            m_approx_ik_vars.push_back(vidx);
+        }
+    }
+    m_approx_ik = _params.approx_ik;
+    m_approx_ik_max_iterations = _params.approx_ik_max_iterations;
+    m_approx_ik_pos_tolerance = _params.approx_ik_pos_tolerance;
+    m_approx_ik_rot_tolerance = _params.approx_ik_rot_tolerance;
+    m_ik_seed_cache_size = std::max(_params.ik_seed_cache_size, 0);
+    m_ik_seed_cache_max_dist = _params.ik_seed_cache_max_dist;
+    clearIKSeedCache();
+
+    ROS_INFO("ik acceleration: { approx ik: %s, seed cache size: %zu, seed cache max dist: %0.3f }", m_approx_ik ? "true" : "false", m_ik_seed_cache_size, m_ik_seed_cache_max_dist);
+
     return true;
 }
 
@@ -155,14 +193,12 @@ bool WorkspaceLatticeBase::stateWorkspaceToRobot(
     const WorkspaceState& state,
     RobotState& ostate) const
 {
-    SixPose pose(state.begin(), state.begin() + 6);
-
     RobotState seed(robot()->jointVariableCount(), 0);
     for (size_t fai = 0; fai < freeAngleCount(); ++fai) {
         seed[m_fangle_indices[fai]] = state[6 + fai];
     }
 
-    return m_rm_iface->computeFastIK(pose, seed, ostate);
+    return stateWorkspaceToRobot(state, seed, ostate);
 }
 
 void WorkspaceLatticeBase::stateWorkspaceToCoord(
@@ -199,8 +235,189 @@ bool WorkspaceLatticeBase::stateWorkspaceToRobot(
 {
     SixPose pose(state.begin(), state.begin() + 6);
 
+    // prefer a recent solution near the target pose as the seed, restricted
+    // to the redundant variables of the given seed, unless it lies on another
+    // ik branch than the given seed
+    const RobotState* iseed = &seed;
+    RobotState cached_seed;
+    WorkspaceCoord coord;
+    if (m_ik_seed_cache_size > 0) {
+        stateWorkspaceToCoord(state, coord);
+        auto it = m_ik_seed_cache.find(coord);
+        if (it != m_ik_seed_cache.end() &&
+            seedDistance(it->second, seed) <= m_ik_seed_cache_max_dist)
+        {
+            cached_seed = it->second;
+            for (size_t fai = 0; fai < freeAngleCount(); ++fai) {
+                cached_seed[m_fangle_indices[fai]] = seed[m_fangle_indices[fai]];
+            }
+            iseed = &cached_seed;
+        }
+    }
+
     // TODO: unrestricted variant?
-    return m_rm_iface->computeFastIK(pose, seed, ostate);
+    if (!(m_approx_ik && computeApproxIK(pose, *iseed, ostate)) &&
+        !m_rm_iface->computeFastIK(pose, *iseed, ostate))
+    {
+        return false;
+    }
+
+    if (m_ik_seed_cache_size > 0) {
+        auto ent = m_ik_seed_cache.insert(std::make_pair(coord, ostate));
+        if (ent.second) {
+            // evict the least recently inserted solutions
+            m_ik_seed_cache_order.push_back(coord);
+            while (m_ik_seed_cache_order.size() > m_ik_seed_cache_size) {
+                m_ik_seed_cache.erase(m_ik_seed_cache_order.front());
+                m_ik_seed_cache_order.pop_front();
+            }
+        } else {
+            ent.first->second = ostate;
+        }
+    }
+
+    return true;
+}
+
+static
+Eigen::Affine3d PoseToTransform(const double* pose)
+{
+    Eigen::Matrix3d rot;
+    angles::from_euler_zyx(pose[5], pose[4], pose[3], rot);
+    return Eigen::Translation3d(pose[0], pose[1], pose[2]) * rot;
+}
+
+/// Return the twist, as ( linear, angular ) velocity, that carries frame \p a
+/// to frame \p b in unit time
+static
+Eigen::Matrix<double, 6, 1> TransformDiff(
+    const Eigen::Affine3d& a,
+    const Eigen::Affine3d& b)
+{
+    Eigen::AngleAxisd aa(b.rotation() * a.rotation().transpose());
+    Eigen::Matrix<double, 6, 1> twist;
+    twist.head<3>() = b.translation() - a.translation();
+    twist.tail<3>() = aa.angle() * aa.axis();
+    return twist;
+}
+
+/// Solve for a joint configuration achieving \p pose via damped least-squares
+/// iterations on a finite-difference Jacobian of the planning link, starting
+/// from \p seed. Intended for the small workspace displacements between
+/// successive waypoints, where it typically converges in one or two iterations
+/// and is much cheaper than a full numerical IK solve. Redundant variables are
+/// held fixed. Returns false if the solver does not converge within the
+/// configured tolerances and iteration limit or the solution violates joint
+/// limits.
+bool WorkspaceLatticeBase::computeApproxIK(
+    const SixPose& pose,
+    const RobotState& seed,
+    RobotState& ostate) const
+{
+    const double fd_eps = 1e-6;
+    const double damping = 1e-4;
+
+    const Eigen::Affine3d target = PoseToTransform(pose.data());
+
+    RobotState q = seed;
+    SixPose curr_pose;
+    if (!m_fk_iface->computePlanningLinkFK(q, curr_pose)) {
+        return false;
+    }
+
+    const int n = (int)m_approx_ik_vars.size();
+    Eigen::MatrixXd J(6, n);
+    RobotState qd;
+    SixPose pd;
+    for (int iter = 0; iter <= m_approx_ik_max_iterations; ++iter) {
+        const Eigen::Affine3d curr = PoseToTransform(curr_pose.data());
+        const Eigen::Matrix<double, 6, 1> err = TransformDiff(curr, target);
+        if (err.head<3>().norm() <= m_approx_ik_pos_tolerance &&
+            err.tail<3>().norm() <= m_approx_ik_rot_tolerance)
+        {
+            for (int vidx : m_approx_ik_vars) {
+                if (robot()->isContinuous(vidx)) {
+                    q[vidx] = angles::normalize_angle(q[vidx]);
+                } else if (robot()->hasPosLimit(vidx) &&
+                    (q[vidx] < robot()->minPosLimit(vidx) ||
+                    q[vidx] > robot()->maxPosLimit(vidx)))
+                {
+                    return false;
+                }
+            }
+            ostate = std::move(q);
+            return true;
+        }
+
+        if (iter == m_approx_ik_max_iterations) {
+            break;
+        }
+
+        for (int j = 0; j < n; ++j) {
+            qd = q;
+            qd[m_approx_ik_vars[j]] += fd_eps;
+            if (!m_fk_iface->computePlanningLinkFK(qd, pd)) {
+                return false;
+            }
+            J.col(j) = TransformDiff(curr, PoseToTransform(pd.data())) / fd_eps;
+        }
+
+        // dq = J^T (J J^T + lambda I)^-1 err
+        Eigen::Matrix<double, 6, 6> JJt = J * J.transpose();
+        JJt.diagonal().array() += damping;
+        const Eigen::VectorXd dq = J.transpose() * JJt.ldlt().solve(err);
+        for (int j = 0; j < n; ++j) {
+            q[m_approx_ik_vars[j]] += dq[j];
+        }
+
+        if (!m_fk_iface->computePlanningLinkFK(q, curr_pose)) {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+void WorkspaceLatticeBase::clearIKSeedCache()
+{
+    m_ik_seed_cache.clear();
+    m_ik_seed_cache_order.clear();
+}
+
+bool WorkspaceLatticeBase::ikAccelerationEnabled() const
+{
+    return m_approx_ik || m_ik_seed_cache_size > 0;
+}
+
+/// Return the seed for the inverse kinematics of the next waypoint of an
+/// action applied to \p state, given the solutions \p wptraj for the previous
+/// waypoints. With ik acceleration enabled, the previous waypoint, which is
+/// nearest in workspace, is used; otherwise, every waypoint is seeded with
+/// \p state.
+const RobotState& WorkspaceLatticeBase::waypointSeed(
+    const RobotState& state,
+    const std::vector<RobotState>& wptraj) const
+{
+    if (ikAccelerationEnabled() && !wptraj.empty()) {
+        return wptraj.back();
+    }
+    return state;
+}
+
+/// Return the largest difference between the non-redundant variables of two
+/// states
+double WorkspaceLatticeBase::seedDistance(
+    const RobotState& a,
+    const RobotState& b) const
+{
+    double dist = 0.0;
+    for (int vidx : m_approx_ik_vars) {
+        const double d = robot()->isContinuous(vidx) ?
+                angles::shortest_angle_dist(a[vidx], b[vidx]) :
+                std::fabs(a[vidx] - b[vidx]);
+        dist = std::max(dist, d);
+    }
+    return dist;
 }
 
 void WorkspaceLatticeBase::posWorkspaceToCoord(const double* wp, int* gp) const
@@ -31,7 +31,10 @@
 
 #include <smpl/heuristic/egraph_bfs_heuristic.h>
 
-#include <boost/functional/hash.hpp>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
 #include <leatherman/print.h>
 #include <leatherman/viz.h>
 #include <smpl/debug/visualize.h>
@@ -39,16 +42,6 @@
 namespace sbpl {
 namespace motion {
 
-auto DijkstraEgraphHeuristic3D::Vector3iHash::operator()(const argument_type& s) const
-    -> result_type
-{
-    std::size_t seed = 0;
-    boost::hash_combine(seed, std::hash<int>()(s.x()));
-    boost::hash_combine(seed, std::hash<int>()(s.y()));
-    boost::hash_combine(seed, std::hash<int>()(s.z()));
-    return seed;
-}
-
 DijkstraEgraphHeuristic3D::DijkstraEgraphHeuristic3D(
     const RobotPlanningSpacePtr& ps,
     const OccupancyGrid* _grid)
@@ -56,11 +49,15 @@ DijkstraEgraphHeuristic3D::DijkstraEgraphHeuristic3D(
     Extension(),
     RobotHeuristic(ps, _grid),
     ExperienceGraphHeuristicExtension(),
-    m_pp(nullptr)
+    m_pp(nullptr),
+    m_component_count(0),
+    m_graph_version(0)
 {
     params()->param("egraph_epsilon", m_eg_eps, 1.0);
     ROS_INFO_NAMED(params()->heuristic_log, "egraph_epsilon: %0.3f", m_eg_eps);
 
+    std::fill(m_projection_offset, m_projection_offset + 3, 0.0);
+
     m_pp = ps->getExtension<PointProjectionExtension>();
     m_eg = ps->getExtension<ExperienceGraphExtension>();
 
@@ -104,6 +101,24 @@ DijkstraEgraphHeuristic3D::DijkstraEgraphHeuristic3D(
             add_wall(x, y, num_cells_z - 1);
         }
     }
+
+    // precompute neighbor index offsets; cells adjacent to the border walls
+    // are never expanded, so the offsets never leave the grid
+    const int base = (int)m_dist_grid.coord_to_index(1, 1, 1);
+    int n = 0;
+    for (int dx = -1; dx <= 1; ++dx) {
+    for (int dy = -1; dy <= 1; ++dy) {
+    for (int dz = -1; dz <= 1; ++dz) {
+        if (dx == 0 & dy == 0 & dz == 0) {
+            continue;
+        }
+        m_neighbor_offsets[n] =
+                (int)m_dist_grid.coord_to_index(1 + dx, 1 + dy, 1 + dz) - base;
+        m_neighbor_costs[n] = (int)(m_eg_eps * 1000.0 * std::sqrt((double)(dx * dx + dy * dy + dz * dz)));
+        ++n;
+    }
+    }
+    }
 }
 
 void DijkstraEgraphHeuristic3D::getEquivalentStates(
@@ -119,13 +134,13 @@ void DijkstraEgraphHeuristic3D::getEquivalentStates(
     }
     dp += Eigen::Vector3i::Ones();
 
-    auto hit = m_heur_nodes.find(dp);
-    if (hit == m_heur_nodes.end()) {
+    if (m_node_offsets.empty()) {
         return;
     }
 
-    for (ExperienceGraph::node_id n : hit->second.up_nodes) {
-        int id = m_eg->getStateID(n);
+    const int cidx = (int)m_dist_grid.coord_to_index(dp.x(), dp.y(), dp.z());
+    for (int i = m_node_offsets[cidx]; i != m_node_offsets[cidx + 1]; ++i) {
+        int id = m_eg->getStateID(m_cell_nodes[i]);
         if (id != state_id) {
             ids.push_back(id);
         }
@@ -150,6 +165,68 @@ void DijkstraEgraphHeuristic3D::getShortcutSuccs(
     }
 }
 
+/// Project new experience graph nodes and merge the components joined by new
+/// edges, without reprojecting existing nodes. Distances computed for the
+/// current goal are not updated until the next goal update.
+void DijkstraEgraphHeuristic3D::updateExperienceGraph(
+    ExperienceGraph::node_id first_node,
+    const std::vector<ExperienceGraph::edge_id>& edges)
+{
+    if (!m_eg || !m_eg->getExperienceGraph()) {
+        return;
+    }
+
+    if (m_projected_points.size() != first_node ||
+        m_component_ids.size() != first_node)
+    {
+        rebuildExperienceGraph();
+        return;
+    }
+
+    ExperienceGraph* eg = m_eg->getExperienceGraph();
+
+    projectExperienceGraphNodes(first_node);
+    buildProjectedAdjacency();
+
+    m_component_count = UpdateComponents(
+            *eg, first_node, edges, m_component_ids, m_component_count);
+    m_shortcut_nodes.resize(m_component_count);
+
+    // seed components of new nodes with an arbitrary shortcut node until the
+    // next goal update selects the nodes nearest the goal
+    for (auto n = first_node; n < eg->num_nodes(); ++n) {
+        auto& shortcuts = m_shortcut_nodes[m_component_ids[n]];
+        if (shortcuts.empty()) {
+            shortcuts.push_back(n);
+        }
+    }
+
+    m_graph_version = eg->version();
+}
+
+void DijkstraEgraphHeuristic3D::rebuildExperienceGraph()
+{
+    if (!m_eg || !m_eg->getExperienceGraph()) {
+        return;
+    }
+
+    ExperienceGraph* eg = m_eg->getExperienceGraph();
+
+    projectExperienceGraph();
+
+    m_component_count = ComputeComponents(*eg, m_component_ids);
+    m_shortcut_nodes.assign(m_component_count, std::vector<ExperienceGraph::node_id>());
+    auto nodes = eg->nodes();
+    for (auto nit = nodes.first; nit != nodes.second; ++nit) {
+        auto& shortcuts = m_shortcut_nodes[m_component_ids[*nit]];
+        if (shortcuts.empty()) {
+            shortcuts.push_back(*nit);
+        }
+    }
+
+    m_graph_version = eg->version();
+}
+
 visualization_msgs::MarkerArray
 DijkstraEgraphHeuristic3D::getWallsVisualization()
 {
@@ -335,7 +412,25 @@ void DijkstraEgraphHeuristic3D::updateGoal(const GoalConstraint& goal)
         }
     } } }
 
-    projectExperienceGraph();
+    ExperienceGraph* eg = m_eg->getExperienceGraph();
+
+    // the projections of experience graph states and the components of the
+    // experience graph do not depend on the goal, other than through the
+    // offset of the planning frame, so they are only recomputed when the
+    // offset or the experience graph changes
+    const bool graph_changed = m_graph_version != eg->version();
+    if (graph_changed ||
+        !std::equal(goal.xyz_offset, goal.xyz_offset + 3, m_projection_offset))
+    {
+        std::copy(goal.xyz_offset, goal.xyz_offset + 3, m_projection_offset);
+        projectExperienceGraph();
+    }
+
+    if (graph_changed) {
+        m_component_count = ComputeComponents(*eg, m_component_ids);
+        ROS_INFO("Experience graph contains %d components", m_component_count);
+        m_graph_version = eg->version();
+    }
 
     Eigen::Vector3d gp(
             goal.tgt_off_pose[0], goal.tgt_off_pose[1], goal.tgt_off_pose[2]);
@@ -344,8 +439,7 @@ void DijkstraEgraphHeuristic3D::updateGoal(const GoalConstraint& goal)
     grid()->worldToGrid(gp.x(), gp.y(), gp.z(), dgp.x(), dgp.y(), dgp.z());
 
     // precompute shortcuts
-    assert(m_component_ids.size() == m_eg->getExperienceGraph()->num_nodes());
-    ExperienceGraph* eg = m_eg->getExperienceGraph();
+    m_shortcut_nodes.assign(m_component_count, std::vector<ExperienceGraph::node_id>());
     auto nodes = eg->nodes();
     for (auto nit = nodes.first; nit != nodes.second; ++nit) {
         int comp_id = m_component_ids[*nit];
@@ -355,13 +449,11 @@ void DijkstraEgraphHeuristic3D::updateGoal(const GoalConstraint& goal)
         }
 
         // get the distance of this node to the goal
-        Eigen::Vector3d p;
-        m_pp->projectToPoint(m_eg->getStateID(*nit), p);
+        const Eigen::Vector3d& p = m_projected_points[*nit];
 
         const double dist = (gp - p).squaredNorm();
 
-        Eigen::Vector3d lp;
-        m_pp->projectToPoint(m_eg->getStateID(m_shortcut_nodes[comp_id].front()), lp);
+        const Eigen::Vector3d& lp = m_projected_points[m_shortcut_nodes[comp_id].front()];
 
         const double curr_dist = (gp - lp).squaredNorm();
 
@@ -381,9 +473,8 @@ void DijkstraEgraphHeuristic3D::updateGoal(const GoalConstraint& goal)
     dgp += Eigen::Vector3i::Ones();
 
     m_open.clear();
-    Cell* c = &m_dist_grid(dgp.x(), dgp.y(), dgp.z());
-    c->dist = 0;
-    m_open.push(c);
+    m_dist_grid(dgp.x(), dgp.y(), dgp.z()).dist = 0;
+    m_open.push(0, (int)m_dist_grid.coord_to_index(dgp.x(), dgp.y(), dgp.z()));
 
     ROS_INFO_NAMED(params()->heuristic_log, "Updated EGraphBfsHeuristic goal");
 }
@@ -420,10 +511,6 @@ int DijkstraEgraphHeuristic3D::GetFromToHeuristic(int from_id, int to_id)
 // frame is determined according to the planning link and a fixed offset)
 void DijkstraEgraphHeuristic3D::projectExperienceGraph()
 {
-    m_heur_nodes.clear();
-
-    std::vector<geometry_msgs::Point> viz_points;
-
     // project experience graph into 3d space (projections of adjacent nodes in
     // the experience graph impose additional edges in 3d, cost equal to the
     // cheapest transition):
@@ -436,7 +523,10 @@ void DijkstraEgraphHeuristic3D::projectExperienceGraph()
     // precomputation
     //
     // (3) maintain an external adjacency list mapping cells with projections
-    // from experience graph states to adjacent cells (method used here)
+    // from experience graph states to adjacent cells
+    //
+    // Here, (3) is stored as flat arrays indexed by cell, so that looking up
+    // the egraph edges of an expanded cell requires no hashing
     ROS_INFO("Project experience graph into three-dimensional grid");
     ExperienceGraph* eg = m_eg->getExperienceGraph();
     if (!eg) {
@@ -444,112 +534,137 @@ void DijkstraEgraphHeuristic3D::projectExperienceGraph()
         return;
     }
 
+    projectExperienceGraphNodes(0);
+    buildProjectedAdjacency();
+
+    std::vector<geometry_msgs::Point> viz_points;
+    viz_points.reserve(m_projected_nodes.size());
+    for (const Eigen::Vector3i& dp : m_projected_nodes) {
+        geometry_msgs::Point viz_pt;
+        grid()->gridToWorld(dp.x() - 1, dp.y() - 1, dp.z() - 1, viz_pt.x, viz_pt.y, viz_pt.z);
+        viz_points.push_back(viz_pt);
+    }
+
+    std_msgs::ColorRGBA color;
+    color.r = (float)0xFF / (float)0xFF;
+    color.g = (float)0x8C / (float)0xFF;
+    color.b = (float)0x00 / (float)0xFF;
+    color.a = 1.0f;
+
+    visualization_msgs::MarkerArray ma;
+    ma.markers.push_back(::viz::getCubesMarker(viz_points, grid()->resolution(), color, grid()->getReferenceFrame(), "egraph_projection", 0));
+    SV_SHOW_INFO(ma);
+}
+
+// Project experience graph nodes with ids at or after first_node into the
+// (padded) heuristic grid
+void DijkstraEgraphHeuristic3D::projectExperienceGraphNodes(
+    ExperienceGraph::node_id first_node)
+{
+    ExperienceGraph* eg = m_eg->getExperienceGraph();
+    m_projected_points.resize(eg->num_nodes());
     m_projected_nodes.resize(eg->num_nodes());
 
-    size_t proj_node_count = 0;
-    size_t proj_edge_count = 0;
-    auto nodes = eg->nodes();
-    for (auto nit = nodes.first; nit != nodes.second; ++nit) {
+    for (auto n = first_node; n < eg->num_nodes(); ++n) {
         // project experience graph state to point and discretize
-        int first_id = m_eg->getStateID(*nit);
-        ROS_DEBUG_NAMED(params()->heuristic_log, "Project experience graph state %d %s into 3D", first_id, to_string(eg->state(*nit)).c_str());
+        int first_id = m_eg->getStateID(n);
         Eigen::Vector3d p;
         m_pp->projectToPoint(first_id, p);
-        ROS_DEBUG_NAMED(params()->heuristic_log, "Discretize point (%0.3f, %0.3f, %0.3f)", p.x(), p.y(), p.z());
         Eigen::Vector3i dp;
         grid()->worldToGrid(p.x(), p.y(), p.z(), dp.x(), dp.y(), dp.z());
 
-        geometry_msgs::Point viz_pt;
-        grid()->gridToWorld(dp.x(), dp.y(), dp.z(), viz_pt.x, viz_pt.y, viz_pt.z);
-        viz_points.push_back(viz_pt);
-
         dp += Eigen::Vector3i::Ones();
 
-        m_projected_nodes[*nit] = dp;
+        m_projected_points[n] = p;
+        m_projected_nodes[n] = dp;
+    }
+}
 
-        // insert node into down-projected experience graph
-        HeuristicNode empty;
-        auto ent = m_heur_nodes.insert(std::make_pair(dp, std::move(empty)));
-        auto eit = ent.first;
-        if (ent.second) {
-            ROS_DEBUG_NAMED(params()->heuristic_log, "Inserted down-projected cell (%d, %d, %d) into experience graph heuristic", dp.x(), dp.y(), dp.z());
-            ++proj_node_count;
-        } else {
-            ROS_DEBUG_NAMED(params()->heuristic_log, "Duplicate down-projected cell (%d, %d, %d)", dp.x(), dp.y(), dp.z());
-        }
+// Rebuild the cell adjacency and cell -> node arrays from the projections of
+// all experience graph nodes
+void DijkstraEgraphHeuristic3D::buildProjectedAdjacency()
+{
+    ExperienceGraph* eg = m_eg->getExperienceGraph();
+
+    m_edge_offsets.clear();
+    m_edge_targets.clear();
+    m_edge_costs.clear();
+    m_node_offsets.clear();
+    m_cell_nodes.clear();
+
+    // (cell index, node) and (cell index, adjacent cell index) pairs
+    std::vector<std::pair<int, ExperienceGraph::node_id>> cell_nodes;
+    std::vector<std::pair<int, int>> cell_edges;
 
-        HeuristicNode& hnode = eit->second;
+    auto in_bounds = [&](ExperienceGraph::node_id n) {
+        const Eigen::Vector3i& dp = m_projected_nodes[n];
+        return grid()->isInBounds(dp.x() - 1, dp.y() - 1, dp.z() - 1);
+    };
+
+    auto nodes = eg->nodes();
+    for (auto nit = nodes.first; nit != nodes.second; ++nit) {
+        if (!in_bounds(*nit)) {
+            continue;
+        }
 
-        hnode.up_nodes.push_back(*nit);
+        const Eigen::Vector3i& dp = m_projected_nodes[*nit];
+        const int cidx = (int)m_dist_grid.coord_to_index(dp.x(), dp.y(), dp.z());
+        cell_nodes.emplace_back(cidx, *nit);
 
         auto adj = eg->adjacent_nodes(*nit);
         for (auto ait = adj.first; ait != adj.second; ++ait) {
-            // project adjacent experience graph state and discretize
-            int second_id = m_eg->getStateID(*ait);
-            ROS_DEBUG_NAMED(params()->heuristic_log, "  Project experience graph edge to state %d", second_id);
-            Eigen::Vector3d q;
-            m_pp->projectToPoint(second_id, q);
-            Eigen::Vector3i dq;
-            grid()->worldToGrid(q.x(), q.y(), q.z(), dq.x(), dq.y(), dq.z());
-            if (!grid()->isInBounds(dq.x(), dq.y(), dq.z())) {
+            if (!in_bounds(*ait)) {
                 continue;
             }
-            dq += Eigen::Vector3i::Ones();
-
-            // insert adjacent edge
-            if (std::find(hnode.edges.begin(), hnode.edges.end(), dq) ==
-                hnode.edges.end())
-            {
-                ++proj_edge_count;
-                ROS_DEBUG_NAMED(params()->heuristic_log, "  Insert edge to state %d", second_id);
-                hnode.edges.push_back(dq);
-            } else {
-                ROS_DEBUG_NAMED(params()->heuristic_log, "  Duplicate edge to state %d", second_id);
-            }
+            const Eigen::Vector3i& dq = m_projected_nodes[*ait];
+            const int aidx = (int)m_dist_grid.coord_to_index(dq.x(), dq.y(), dq.z());
+            cell_edges.emplace_back(cidx, aidx);
         }
     }
 
-    ROS_INFO("Projected experience graph contains %zu nodes and %zu edges", proj_node_count, proj_edge_count);
-
-    int comp_count = 0;
-    m_component_ids.assign(eg->num_nodes(), -1);
-    for (auto nit = nodes.first; nit != nodes.second; ++nit) {
-        if (m_component_ids[*nit] != -1) {
-            continue;
-        }
+    std::sort(cell_nodes.begin(), cell_nodes.end());
+    std::sort(cell_edges.begin(), cell_edges.end());
+    cell_edges.erase(
+            std::unique(cell_edges.begin(), cell_edges.end()),
+            cell_edges.end());
 
-        std::vector<ExperienceGraph::node_id> frontier;
-        frontier.push_back(*nit);
-        while (!frontier.empty()) {
-            ExperienceGraph::node_id n = frontier.back();
-            frontier.pop_back();
+    const int cell_count = (int)m_dist_grid.size();
 
-            m_component_ids[n] = comp_count;
+    m_node_offsets.assign(cell_count + 1, 0);
+    m_cell_nodes.reserve(cell_nodes.size());
+    for (const auto& cn : cell_nodes) {
+        ++m_node_offsets[cn.first + 1];
+        m_cell_nodes.push_back(cn.second);
+    }
 
-            auto adj = eg->adjacent_nodes(n);
-            for (auto ait = adj.first; ait != adj.second; ++ait) {
-                if (m_component_ids[*ait] == -1) {
-                    frontier.push_back(*ait);
-                }
-            }
-        }
+    m_edge_offsets.assign(cell_count + 1, 0);
+    m_edge_targets.reserve(cell_edges.size());
+    m_edge_costs.reserve(cell_edges.size());
+    for (const auto& ce : cell_edges) {
+        ++m_edge_offsets[ce.first + 1];
 
-        ++comp_count;
+        size_t cx, cy, cz;
+        m_dist_grid.index_to_coord(ce.first, cx, cy, cz);
+        size_t ax, ay, az;
+        m_dist_grid.index_to_coord(ce.second, ax, ay, az);
+        const int dx = (int)ax - (int)cx;
+        const int dy = (int)ay - (int)cy;
+        const int dz = (int)az - (int)cz;
+
+        m_edge_targets.push_back(ce.second);
+        m_edge_costs.push_back((int)(1000.0 * std::sqrt((double)(dx * dx + dy * dy + dz * dz))));
     }
 
-    // pre-allocate shortcuts array here, fill in updateGoal()
-    m_shortcut_nodes.assign(comp_count, std::vector<ExperienceGraph::node_id>());
-    ROS_INFO("Experience graph contains %d components", comp_count);
-
-    std_msgs::ColorRGBA color;
-    color.r = (float)0xFF / (float)0xFF;
-    color.g = (float)0x8C / (float)0xFF;
-    color.b = (float)0x00 / (float)0xFF;
-    color.a = 1.0f;
+    size_t proj_node_count = 0;
+    for (int i = 0; i < cell_count; ++i) {
+        if (m_node_offsets[i + 1] != 0) {
+            ++proj_node_count;
+        }
+        m_node_offsets[i + 1] += m_node_offsets[i];
+        m_edge_offsets[i + 1] += m_edge_offsets[i];
+    }
 
-    visualization_msgs::MarkerArray ma;
-    ma.markers.push_back(::viz::getCubesMarker(viz_points, grid()->resolution(), color, grid()->getReferenceFrame(), "egraph_projection", 0));
-    SV_SHOW_INFO(ma);
+    ROS_INFO("Projected experience graph contains %zu nodes and %zu edges", proj_node_count, m_edge_targets.size());
 }
 
 int DijkstraEgraphHeuristic3D::getGoalHeuristic(const Eigen::Vector3i& dp)
@@ -563,77 +678,56 @@ int DijkstraEgraphHeuristic3D::getGoalHeuristic(const Eigen::Vector3i& dp)
     static int last_expand_count = 0;
     int expand_count = 0;
     static int repeat_count = 1;
+    Cell* cells = m_dist_grid.data();
     while (cell->dist == Unknown && !m_open.empty()) {
-        ++expand_count;
-        Cell* curr_cell = m_open.min();
-        m_open.pop();
+        RadixHeap<int>::key_type key;
+        int cidx;
+        m_open.pop(key, cidx);
 
-        int cidx = std::distance(m_dist_grid.data(), curr_cell);
-        size_t cx, cy, cz;
-        m_dist_grid.index_to_coord(cidx, cx, cy, cz);
-        ROS_DEBUG_NAMED(params()->heuristic_log, "Expand cell (%zu, %zu, %zu)", cx, cy, cz);
+        Cell* curr_cell = &cells[cidx];
+
+        // skip stale entries left behind by later improvements
+        if ((int)key != curr_cell->dist) {
+            continue;
+        }
+
+        ++expand_count;
+        ROS_DEBUG_NAMED(params()->heuristic_log, "Expand cell %d", cidx);
 
         // relax experience graph adjacency edges
-        auto it = m_heur_nodes.find(Eigen::Vector3i(cx, cy, cz));
-        if (it != m_heur_nodes.end()) {
-            const HeuristicNode& hnode = it->second;
-            ROS_DEBUG_NAMED(params()->heuristic_log, "  %zu adjacent egraph cells", hnode.edges.size());
-            for (const Eigen::Vector3i& adj : hnode.edges) {
-                const int dx = adj.x() - cx;
-                const int dy = adj.y() - cy;
-                const int dz = adj.z() - cz;
-                Cell* ncell = &m_dist_grid(adj.x(), adj.y(), adj.z());
-
-                const int cost = (int)(1000.0 * std::sqrt((double)(dx * dx + dy * dy + dz * dz)));
-                const int new_cost = curr_cell->dist + cost;
+        if (!m_edge_offsets.empty()) {
+            const int ebegin = m_edge_offsets[cidx];
+            const int eend = m_edge_offsets[cidx + 1];
+            ROS_DEBUG_NAMED(params()->heuristic_log, "  %d adjacent egraph cells", eend - ebegin);
+            for (int e = ebegin; e != eend; ++e) {
+                const int nidx = m_edge_targets[e];
+                Cell* ncell = &cells[nidx];
+                const int new_cost = curr_cell->dist + m_edge_costs[e];
                 if (new_cost < ncell->dist) {
+                    ROS_DEBUG_NAMED(params()->heuristic_log, "  Update cell %d with egraph edge (-> %d)", nidx, new_cost);
                     ncell->dist = new_cost;
-                    if (m_open.contains(ncell)) {
-                        ROS_DEBUG_NAMED(params()->heuristic_log, "  Update cell (%d, %d, %d) with egraph edge (-> %d)", adj.x(), adj.y(), adj.z(), new_cost);
-                        m_open.decrease(ncell);
-                    } else {
-                        ROS_DEBUG_NAMED(params()->heuristic_log, "  Insert cell (%d, %d, %d) with egraph edge (-> %d)", adj.x(), adj.y(), adj.z(), new_cost);
-                        m_open.push(ncell);
-                    }
+                    m_open.push(new_cost, nidx);
                 }
             }
         }
 
         // relax neighboring edges
-        for (int dx = -1; dx <= 1; ++dx) {
-        for (int dy = -1; dy <= 1; ++dy) {
-        for (int dz = -1; dz <= 1; ++dz) {
-            if (dx == 0 & dy == 0 & dz == 0) {
-                continue;
-            }
-
-            const int sx = cx + dx;
-            const int sy = cy + dy;
-            const int sz = cz + dz;
-
-            Cell* ncell = &m_dist_grid(sx, sy, sz);
+        for (int n = 0; n < 26; ++n) {
+            const int nidx = cidx + m_neighbor_offsets[n];
+            Cell* ncell = &cells[nidx];
 
             // bounds and obstacle check
             if (ncell->dist == Wall) {
                 continue;
             }
 
-            const int cost = (int)(m_eg_eps * 1000.0 * std::sqrt((double)(dx * dx + dy * dy + dz * dz)));
-            const int new_cost = curr_cell->dist + cost;
-
+            const int new_cost = curr_cell->dist + m_neighbor_costs[n];
             if (new_cost < ncell->dist) {
+                ROS_DEBUG_NAMED(params()->heuristic_log, "  Update cell %d with normal edge (-> %d)", nidx, new_cost);
                 ncell->dist = new_cost;
-                if (m_open.contains(ncell)) {
-                    ROS_DEBUG_NAMED(params()->heuristic_log, "  Update cell (%d, %d, %d) with normal edge (-> %d)", sx, sy, sz, new_cost);
-                    m_open.decrease(ncell);
-                } else {
-                    ROS_DEBUG_NAMED(params()->heuristic_log, "  Insert cell (%d, %d, %d) with normal edge (-> %d)", sx, sy, sz, new_cost);
-                    m_open.push(ncell);
-                }
+                m_open.push(new_cost, nidx);
             }
         }
-        }
-        }
     }
 
     if (last_expand_count != expand_count) {
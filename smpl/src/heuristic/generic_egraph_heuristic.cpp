@@ -29,6 +29,9 @@
 
 /// \author Andrew Dornbush
 
+// standard includes
+#include <iterator>
+
 // system includes
 #include <leatherman/print.h>
 
@@ -50,13 +53,24 @@ GenericEgraphHeuristic::GenericEgraphHeuristic(
     m_eg(nullptr),
     m_eg_eps(1.0),
     m_component_ids(),
+    m_component_count(0),
+    m_graph_version(0),
     m_shortcut_nodes(),
     m_h_nodes(),
-    m_open()
+    m_open(),
+    m_use_equiv_index(true),
+    // heuristic values are rounded to integers, which may violate the
+    // triangle inequality by up to 1
+    m_equiv_index(
+            [this](int a, int b) { return m_orig_h->GetFromToHeuristic(a, b); },
+            1.0),
+    m_indexed_node_count(0)
 {
     params()->param("egraph_epsilon", m_eg_eps, 1.0);
+    params()->param("egraph_equivalence_index", m_use_equiv_index, true);
 
     ROS_INFO_NAMED(params()->heuristic_log, "egraph_epsilon: %0.3f", m_eg_eps);
+    ROS_INFO_NAMED(params()->heuristic_log, "egraph_equivalence_index: %s", m_use_equiv_index ? "true" : "false");
 
     m_eg = pspace->getExtension<ExperienceGraphExtension>();
     if (!m_eg) {
@@ -68,10 +82,17 @@ void GenericEgraphHeuristic::getEquivalentStates(
     int state_id,
     std::vector<int>& ids)
 {
+    const int equiv_thresh = 100;
+
+    if (m_use_equiv_index) {
+        updateEquivalenceIndex();
+        m_equiv_index.within(state_id, equiv_thresh, std::back_inserter(ids));
+        return;
+    }
+
     ExperienceGraph* eg = m_eg->getExperienceGraph();
     auto nodes = eg->nodes();
     int best_h = std::numeric_limits<int>::max();
-    const int equiv_thresh = 100;
     for (auto nit = nodes.first; nit != nodes.second; ++nit) {
         int egraph_state_id = m_eg->getStateID(*nit);
         int h = m_orig_h->GetFromToHeuristic(state_id, egraph_state_id);
@@ -102,6 +123,75 @@ void GenericEgraphHeuristic::getShortcutSuccs(
     }
 }
 
+/// Extend per-node data for new experience graph nodes and merge the components
+/// joined by new edges. Heuristic distances of new nodes are unknown until the
+/// next goal update.
+void GenericEgraphHeuristic::updateExperienceGraph(
+    ExperienceGraph::node_id first_node,
+    const std::vector<ExperienceGraph::edge_id>& edges)
+{
+    if (!m_eg || !m_eg->getExperienceGraph()) {
+        return;
+    }
+
+    if (m_component_ids.size() != first_node) {
+        rebuildExperienceGraph();
+        return;
+    }
+
+    ExperienceGraph* eg = m_eg->getExperienceGraph();
+
+    m_component_count = UpdateComponents(
+            *eg, first_node, edges, m_component_ids, m_component_count);
+    m_shortcut_nodes.resize(m_component_count);
+    for (auto n = first_node; n < eg->num_nodes(); ++n) {
+        auto& shortcuts = m_shortcut_nodes[m_component_ids[n]];
+        if (shortcuts.empty()) {
+            shortcuts.push_back(n);
+        }
+    }
+
+    m_graph_version = eg->version();
+
+    m_open.clear();
+    m_h_nodes.resize(eg->num_nodes() + 1, HeuristicNode(Unknown));
+
+    if (m_use_equiv_index) {
+        updateEquivalenceIndex();
+    }
+}
+
+/// Recompute per-node data after nodes or edges have been removed from the
+/// experience graph. Shortcuts and heuristic distances are reset until the next
+/// goal update.
+void GenericEgraphHeuristic::rebuildExperienceGraph()
+{
+    if (!m_eg || !m_eg->getExperienceGraph()) {
+        return;
+    }
+
+    ExperienceGraph* eg = m_eg->getExperienceGraph();
+
+    m_component_count = ComputeComponents(*eg, m_component_ids);
+    m_shortcut_nodes.assign(m_component_count, std::vector<ExperienceGraph::node_id>());
+    auto nodes = eg->nodes();
+    for (auto nit = nodes.first; nit != nodes.second; ++nit) {
+        auto& shortcuts = m_shortcut_nodes[m_component_ids[*nit]];
+        if (shortcuts.empty()) {
+            shortcuts.push_back(*nit);
+        }
+    }
+
+    m_graph_version = eg->version();
+
+    m_open.clear();
+    m_h_nodes.assign(eg->num_nodes() + 1, HeuristicNode(Unknown));
+
+    if (m_use_equiv_index) {
+        rebuildEquivalenceIndex();
+    }
+}
+
 double GenericEgraphHeuristic::getMetricStartDistance(
     double x, double y, double z)
 {
@@ -136,39 +226,35 @@ void GenericEgraphHeuristic::updateGoal(const GoalConstraint& goal)
         return;
     }
 
+    // the equivalence index and the components of the experience graph do
+    // not depend on the goal, and are maintained as the experience graph
+    // changes
+    if (m_use_equiv_index) {
+        updateEquivalenceIndex();
+    }
+
     //////////////////////////////////////////////////////////
     // Compute Connected Components of the Experience Graph //
     //////////////////////////////////////////////////////////
 
-    int comp_count = 0;
-    m_component_ids.assign(eg->num_nodes(), -1);
+    if (m_graph_version != eg->version()) {
+        m_component_count = ComputeComponents(*eg, m_component_ids);
+        m_graph_version = eg->version();
+    }
+    const int comp_count = m_component_count;
     auto nodes = eg->nodes();
-    for (auto nit = nodes.first; nit != nodes.second; ++nit) {
-        if (m_component_ids[*nit] != -1) {
-            continue;
-        }
 
-        std::vector<ExperienceGraph::node_id> frontier;
-        frontier.push_back(*nit);
-        while (!frontier.empty()) {
-            ExperienceGraph::node_id n = frontier.back();
-            frontier.pop_back();
+    ROS_INFO_NAMED(params()->heuristic_log, "Experience graph contains %d connected components", comp_count);
 
-            m_component_ids[n] = comp_count;
+    ///////////////////////////////////////////////////////
+    // Compute Heuristic Values of Experience Graph Nodes //
+    ///////////////////////////////////////////////////////
 
-            auto adj = eg->adjacent_nodes(n);
-            for (auto ait = adj.first; ait != adj.second; ++ait) {
-                if (m_component_ids[*ait] == -1) {
-                    frontier.push_back(*ait);
-                }
-            }
-        }
-
-        ++comp_count;
+    std::vector<int> goal_heuristics(eg->num_nodes());
+    for (auto nit = nodes.first; nit != nodes.second; ++nit) {
+        goal_heuristics[*nit] = m_orig_h->GetGoalHeuristic(m_eg->getStateID(*nit));
     }
 
-    ROS_INFO_NAMED(params()->heuristic_log, "Experience graph contains %d connected components", comp_count);
-
     ////////////////////////////
     // Compute Shortcut Nodes //
     ////////////////////////////
@@ -178,9 +264,8 @@ void GenericEgraphHeuristic::updateGoal(const GoalConstraint& goal)
     for (auto nit = nodes.first; nit != nodes.second; ++nit) {
         const ExperienceGraph::node_id n = *nit;
         const int comp_id = m_component_ids[n];
-        const int state_id = m_eg->getStateID(n);
 
-        int h = m_orig_h->GetGoalHeuristic(state_id);
+        int h = goal_heuristics[n];
 
         if (m_shortcut_nodes[comp_id].empty()) {
             m_shortcut_nodes[comp_id].push_back(n);
@@ -216,8 +301,7 @@ void GenericEgraphHeuristic::updateGoal(const GoalConstraint& goal)
             for (auto nit = nodes.first; nit != nodes.second; ++nit) {
                 const ExperienceGraph::node_id nid = *nit;
                 HeuristicNode* n = &m_h_nodes[nid + 1];
-                const int state_id = m_eg->getStateID(nid);
-                const int h = m_orig_h->GetGoalHeuristic(state_id);
+                const int h = goal_heuristics[nid];
                 n->dist = (int)(m_eg_eps * h);
                 m_open.push(n);
             }
@@ -295,5 +379,35 @@ int GenericEgraphHeuristic::GetFromToHeuristic(int from_id, int to_id)
     return 0;
 }
 
+void GenericEgraphHeuristic::rebuildEquivalenceIndex()
+{
+    ExperienceGraph* eg = m_eg->getExperienceGraph();
+    std::vector<int> state_ids;
+    state_ids.reserve(eg->num_nodes());
+    auto nodes = eg->nodes();
+    for (auto nit = nodes.first; nit != nodes.second; ++nit) {
+        state_ids.push_back(m_eg->getStateID(*nit));
+    }
+    m_equiv_index.build(state_ids.begin(), state_ids.end());
+    m_indexed_node_count = eg->num_nodes();
+}
+
+/// Index nodes added to the experience graph since the index was last updated.
+/// Node ids are assigned sequentially, so new nodes follow the indexed nodes;
+/// if nodes have been removed, the index is rebuilt.
+void GenericEgraphHeuristic::updateEquivalenceIndex()
+{
+    ExperienceGraph* eg = m_eg->getExperienceGraph();
+    if (eg->num_nodes() < m_indexed_node_count) {
+        rebuildEquivalenceIndex();
+        return;
+    }
+
+    for (auto n = m_indexed_node_count; n < eg->num_nodes(); ++n) {
+        m_equiv_index.insert(m_eg->getStateID(n));
+    }
+    m_indexed_node_count = eg->num_nodes();
+}
+
 } // namespace motion
 } // namespace sbpl
@@ -69,6 +69,12 @@ namespace sbpl {
 /// An arbitrary distance map implementation may be used with this class. If
 /// none is specified, by calling the verbose constructor, an instance of
 /// sbpl::PropagationDistanceField is constructed.
+///
+/// The occupancy grid maintains a version number that is incremented every
+/// time obstacles are added, removed, or reset through its interface. Clients
+/// that cache the results of queries against the grid may compare versions to
+/// detect when their results have become stale. Modifications made directly to
+/// the underlying distance map are not tracked.
 
 /// Construct an Occupancy Grid.
 ///
@@ -100,7 +106,8 @@ OccupancyGrid::OccupancyGrid(
     m_ref_counted(ref_counted),
     m_x_stride(m_grid->numCellsY() * m_grid->numCellsZ()),
     m_y_stride(m_grid->numCellsZ()),
-    m_counts()
+    m_counts(),
+    m_version(0)
 {
     // distance field guaranteed to be empty -> faster initialization
     if (m_ref_counted) {
@@ -121,7 +128,8 @@ OccupancyGrid::OccupancyGrid(
     m_ref_counted(ref_counted),
     m_x_stride(m_grid->numCellsY() * m_grid->numCellsZ()),
     m_y_stride(m_grid->numCellsZ()),
-    m_counts()
+    m_counts(),
+    m_version(0)
 {
     initRefCounts();
 }
@@ -136,6 +144,7 @@ OccupancyGrid::OccupancyGrid(const OccupancyGrid& o)
     m_x_stride = o.m_x_stride;
     m_y_stride = o.m_y_stride;
     m_counts = o.m_counts;
+    m_version = o.m_version;
 }
 
 /// Reset the grid, removing all obstacles setting distances to their
@@ -146,6 +155,7 @@ void OccupancyGrid::reset()
     if (m_ref_counted) {
         m_counts.assign(getCellCount(), 0);
     }
+    ++m_version;
 }
 
 /// Count the number of obstacles in the occupancy grid.
@@ -444,7 +454,7 @@ void OccupancyGrid::addPointsToField(
     else {
         m_grid->addPointsToMap(points);
     }
-
+    ++m_version;
 }
 
 /// Remove a set of obstacle cells from the occupancy grid.
@@ -474,6 +484,7 @@ void OccupancyGrid::removePointsFromField(
     else {
         m_grid->removePointsFromMap(points);
     }
+    ++m_version;
 }
 
 /// Update the occupancy grid, removing obstacles that exist in the old obstacle
@@ -485,6 +496,7 @@ void OccupancyGrid::updatePointsInField(
 {
     // TODO: ref counting
     m_grid->updatePointsInMap(old_points, new_points);
+    ++m_version;
 }
 
 void OccupancyGrid::initRefCounts()
@@ -64,6 +64,9 @@ RobotPlanningSpacePtr AdaptiveWorkspaceLatticeAllocator::allocate(
         return RobotPlanningSpacePtr();
     }
     wsp.free_angle_res.resize(rmi->redundantVariableCount(), angles::to_radians(1.0));
+    params->param("ik_seed_cache_size", wsp.ik_seed_cache_size, 0);
+    params->param("ik_seed_cache_max_dist", wsp.ik_seed_cache_max_dist, 0.5);
+    params->param("use_approx_ik", wsp.approx_ik, false);
     if (!pspace->init(wsp)) {
         ROS_ERROR("Failed to initialize Workspace Lattice");
         return RobotPlanningSpacePtr();
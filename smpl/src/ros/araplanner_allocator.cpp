@@ -58,6 +58,10 @@ SBPLPlannerPtr ARAPlannerAllocator::allocate(
         search->setAllowedRepairTime(repair_time);
     }
 
+    bool incremental_search;
+    pspace->params()->param("incremental_search", incremental_search, false);
+    search->allowIncrementalSearch(incremental_search);
+
     return search;
 }
 
@@ -66,6 +66,8 @@ RobotPlanningSpacePtr ManipLatticeAllocator::allocate(
     double rpy_snap_thresh;
     double xyzrpy_snap_thresh;
     double short_dist_mprims_thresh;
+    bool use_edge_cache;
+    int edge_cache_size;
 
     std::string disc_string;
     if (!params->getParam("discretization", disc_string)) {
@@ -124,6 +126,9 @@ RobotPlanningSpacePtr ManipLatticeAllocator::allocate(
     params->param("xyzrpy_snap_dist_thresh", xyzrpy_snap_thresh, 0.0);
     params->param("short_dist_mprims_thresh", short_dist_mprims_thresh, 0.0);
 
+    params->param("use_edge_cache", use_edge_cache, false);
+    params->param("edge_cache_size", edge_cache_size, 1 << 18);
+
     ////////////////////
     // Initialization //
     ////////////////////
@@ -138,6 +143,10 @@ RobotPlanningSpacePtr ManipLatticeAllocator::allocate(
         pspace->setVisualizationFrameId(m_grid->getReferenceFrame());
     }
 
+    if (use_edge_cache && edge_cache_size > 0) {
+        pspace->enableEdgeCache(m_grid, edge_cache_size);
+    }
+
     auto aspace = std::make_shared<ManipLatticeActionSpace>(pspace.get());
     aspace->useMultipleIkSolutions(use_multiple_ik_solutions);
     aspace->useAmp(MotionPrimitive::SNAP_TO_XYZ, use_xyz_snap_mprim);
@@ -138,6 +138,15 @@ RobotPlanningSpacePtr ManipLatticeEgraphAllocator::allocate(
     if (params->getParam("egraph_path", egraph_path)) {
         // warning printed within, allow to fail silently
         (void)pspace->loadExperienceGraph(egraph_path);
+
+        // optionally convert the loaded experience graph to the binary
+        // experience graph store format
+        std::string egraph_save_path;
+        if (params->getParam("egraph_save_path", egraph_save_path) &&
+            !pspace->saveExperienceGraph(egraph_save_path))
+        {
+            ROS_WARN("Failed to save experience graph to '%s'", egraph_save_path.c_str());
+        }
     } else {
         ROS_WARN("No experience graph file parameter");
     }
@@ -57,6 +57,8 @@
 
 #include <smpl/debug/visualize.h>
 
+#include <smpl/graph/experience_graph_extension.h>
+
 #include <smpl/heuristic/bfs_heuristic.h>
 #include <smpl/heuristic/egraph_bfs_heuristic.h>
 #include <smpl/heuristic/multi_frame_bfs_heuristic.h>
@@ -77,6 +79,8 @@
 #include <smpl/ros/multi_frame_bfs_heuristic_allocator.h>
 #include <smpl/ros/workspace_lattice_allocator.h>
 
+#include <smpl/search/arastar.h>
+
 namespace sbpl {
 namespace motion {
 
@@ -99,7 +103,12 @@ PlannerInterface::PlannerInterface(
     m_sol_cost(INFINITECOST),
     m_planner_id(),
     m_req(),
-    m_res()
+    m_res(),
+    m_goal(),
+    m_last_goal(),
+    m_last_search_valid(false),
+    m_last_grid_version(0),
+    m_last_collision_version(0)
 {
     if (m_robot) {
         m_fk_iface = m_robot->getExtension<ForwardKinematicsInterface>();
@@ -270,6 +279,12 @@ bool PlannerInterface::solve(
     postProcessPath(path);
     visualizePath(path);
 
+    bool egraph_online_learning = false;
+    m_params.getParam("egraph_online_learning", egraph_online_learning);
+    if (egraph_online_learning) {
+        learnExperienceGraphPath(path);
+    }
+
     ROS_DEBUG_NAMED(PI_LOGGER, "smoothed path:");
     for (size_t pidx = 0; pidx < path.size(); ++pidx) {
         const auto& point = path[pidx];
@@ -427,6 +442,7 @@ bool PlannerInterface::setGoalConfiguration(
         return false;
     }
 
+    m_goal = goal;
     return true;
 }
 
@@ -504,6 +520,7 @@ bool PlannerInterface::setGoalPosition(
         return false;
     }
 
+    m_goal = goal;
     return true;
 }
 
@@ -519,11 +536,16 @@ bool PlannerInterface::plan(double allowed_time, std::vector<RobotState>& path)
     bool b_ret = false;
     std::vector<int> solution_state_ids;
 
-    // reinitialize the search space
-    m_planner->force_planning_from_scratch();
+    // reinitialize the search space, unless the last search may be continued
+    if (canReuseSearch()) {
+        ROS_INFO_NAMED(PI_LOGGER, "Reuse previous search effort");
+    } else {
+        m_planner->force_planning_from_scratch();
+    }
 
     // plan
     b_ret = m_planner->replan(allowed_time, &solution_state_ids, &m_sol_cost);
+    recordSearch();
 
     // check if an empty plan was received.
     if (b_ret && solution_state_ids.size() <= 0) {
@@ -552,6 +574,54 @@ bool PlannerInterface::plan(double allowed_time, std::vector<RobotState>& path)
     return b_ret;
 }
 
+static
+bool SameGoal(const GoalConstraint& a, const GoalConstraint& b)
+{
+    return a.type == b.type &&
+            a.angles == b.angles &&
+            a.angle_tolerances == b.angle_tolerances &&
+            a.pose == b.pose &&
+            a.tgt_off_pose == b.tgt_off_pose &&
+            std::equal(a.xyz_offset, a.xyz_offset + 3, b.xyz_offset) &&
+            std::equal(a.xyz_tolerance, a.xyz_tolerance + 3, b.xyz_tolerance) &&
+            std::equal(a.rpy_tolerance, a.rpy_tolerance + 3, b.rpy_tolerance);
+}
+
+/// Return whether the search may continue from the effort of the last search,
+/// rather than planning from scratch. This requires a search that supports
+/// incremental search, with it enabled, and that neither the goal nor the
+/// scene have changed since the last search. The planning spaces represent
+/// every goal with a single goal state id, so the search can not detect a
+/// changed goal itself. The scene is compared via the versions of the
+/// occupancy grid and the collision checker; collision checkers that do not
+/// report a version always cause the search to start from scratch.
+bool PlannerInterface::canReuseSearch() const
+{
+    auto* search = dynamic_cast<ARAStar*>(m_planner.get());
+    if (!search || !search->allowIncrementalSearch() || !m_last_search_valid) {
+        return false;
+    }
+
+    auto* versioned = m_checker->getExtension<CollisionVersionExtension>();
+    if (!versioned) {
+        return false;
+    }
+
+    return SameGoal(m_goal, m_last_goal) &&
+            (!m_grid || m_grid->version() == m_last_grid_version) &&
+            versioned->collisionVersion() == m_last_collision_version;
+}
+
+/// Record the goal and scene versions of the search just run
+void PlannerInterface::recordSearch()
+{
+    m_last_goal = m_goal;
+    m_last_grid_version = m_grid ? m_grid->version() : 0;
+    auto* versioned = m_checker->getExtension<CollisionVersionExtension>();
+    m_last_collision_version = versioned ? versioned->collisionVersion() : 0;
+    m_last_search_valid = true;
+}
+
 bool PlannerInterface::planToPose(
     const moveit_msgs::MotionPlanRequest& req,
     std::vector<RobotState>& path,
@@ -1065,6 +1135,7 @@ bool PlannerInterface::reinitPlanner(const std::string& planner_id)
         return false;
     }
     m_planner_id = planner_id;
+    m_last_search_valid = false;
     return true;
 }
 
@@ -1175,6 +1246,29 @@ void PlannerInterface::postProcessPath(std::vector<RobotState>& path) const
     }
 }
 
+/// Insert a post-processed solution path into the experience graph of the
+/// planning space, if it has one, so that later requests may reuse it
+void PlannerInterface::learnExperienceGraphPath(
+    const std::vector<RobotState>& path)
+{
+    auto* egraph = m_pspace->getExtension<ExperienceGraphExtension>();
+    if (!egraph) {
+        return;
+    }
+
+    if (!isPathValid(path)) {
+        ROS_WARN_NAMED(PI_LOGGER, "Skip inserting invalid path into the experience graph");
+        return;
+    }
+
+    if (!egraph->insertExperienceGraphPath(path)) {
+        ROS_WARN_NAMED(PI_LOGGER, "Failed to insert path into the experience graph");
+    }
+
+    // new experience edges invalidate costs learned by the last search
+    m_last_search_valid = false;
+}
+
 void PlannerInterface::convertJointVariablePathToJointTrajectory(
     const std::vector<RobotState>& path,
     trajectory_msgs::JointTrajectory& traj) const
@@ -31,6 +31,9 @@
 
 #include <smpl/search/arastar.h>
 
+// standard includes
+#include <algorithm>
+
 // system includes
 #include <ros/console.h>
 #include <sbpl/utils/key.h>
@@ -55,6 +58,7 @@ ARAStar::ARAStar(
     m_final_eps(1.0),
     m_delta_eps(1.0),
     m_allow_partial_solutions(false),
+    m_incremental(false),
     m_states(),
     m_start_state_id(-1),
     m_goal_state_id(-1),
@@ -67,6 +71,7 @@ ARAStar::ARAStar(
     m_last_start_state_id(-1),
     m_last_goal_state_id(-1),
     m_last_eps(1.0),
+    m_learn_number(1),
     m_expand_count_init(0),
     m_expand_count(0),
     m_search_time_init(clock::duration::zero()),
@@ -122,6 +127,12 @@ int ARAStar::replan(
     SearchState* start_state = getSearchState(m_start_state_id);
     SearchState* goal_state = getSearchState(m_goal_state_id);
 
+    const bool goal_changed = m_goal_state_id != m_last_goal_state_id;
+    if (goal_changed) {
+        // values learned toward the previous goal are no longer bounds
+        ++m_learn_number;
+    }
+
     if (m_start_state_id != m_last_start_state_id) {
         ROS_DEBUG_NAMED(SLOG, "Reinitialize search");
         m_open.clear();
@@ -148,12 +159,39 @@ int ARAStar::replan(
         m_satisfied_eps = std::numeric_limits<double>::infinity();
 
         m_last_start_state_id = m_start_state_id;
+    } else if (goal_changed) {
+        ROS_DEBUG_NAMED(SLOG, "Reuse search tree for new goal");
+
+        // g-values and back pointers remain valid for the same start state;
+        // begin a new series of iterations so that every locally
+        // inconsistent state may be expanded toward the new goal
+        reinitSearchState(goal_state);
+        for (SearchState* s : m_incons) {
+            s->incons = false;
+            m_open.push(s);
+        }
+        m_incons.clear();
+
+        ++m_iteration;
+
+        m_expand_count_init = 0;
+        m_search_time_init = clock::duration::zero();
+
+        m_expand_count = 0;
+        m_search_time = clock::duration::zero();
+
+        m_curr_eps = m_initial_eps;
+
+        m_satisfied_eps = std::numeric_limits<double>::infinity();
     }
 
-    if (m_goal_state_id != m_last_goal_state_id) {
+    if (goal_changed) {
         ROS_DEBUG_NAMED(SLOG, "Refresh heuristics, keys, and reorder open list");
         recomputeHeuristics();
         reorderOpen();
+        if (goal_state->g != INFINITECOST && !m_open.contains(goal_state)) {
+            goal_state->f = computeKey(goal_state);
+        }
 
         m_last_goal_state_id = m_goal_state_id;
     }
@@ -195,6 +233,12 @@ int ARAStar::replan(
     m_search_time += elapsed_time;
     m_expand_count += num_expansions;
 
+    if (m_incremental &&
+        m_satisfied_eps != std::numeric_limits<double>::infinity())
+    {
+        updateLearnedHeuristics(goal_state);
+    }
+
     if (m_satisfied_eps == std::numeric_limits<double>::infinity()) {
         if (m_allow_partial_solutions && !m_open.empty()) {
             SearchState* next_state = m_open.min();
@@ -374,6 +418,7 @@ int ARAStar::force_planning_from_scratch()
 {
     m_last_start_state_id = -1;
     m_last_goal_state_id = -1;
+    ++m_learn_number;
     return 0;
 }
 
@@ -399,6 +444,33 @@ void ARAStar::recomputeHeuristics()
     }
 }
 
+// Store, for every state reached by the current search, a lower bound on its
+// cost-to-go. Since the solution satisfies g(goal) <= eps * g*(goal) and g(s)
+// is the cost of some path to s, any path from s to the goal costs at least
+// g(goal) / eps - g(s) by the triangle inequality. The bound is independent of
+// the start state and remains valid while the goal and edge costs are fixed.
+void ARAStar::updateLearnedHeuristics(SearchState* goal_state)
+{
+    const unsigned int goal_cost =
+            (unsigned int)((double)goal_state->g / m_satisfied_eps);
+    const unsigned int learn_number = m_learn_number;
+    int count = 0;
+    for (SearchState* s : m_states) {
+        if (s->call_number != m_call_number || s->g >= goal_cost) {
+            continue;
+        }
+        const unsigned int hl = goal_cost - s->g;
+        if (s->learn_number != learn_number) {
+            s->hl = hl;
+            s->learn_number = learn_number;
+        } else {
+            s->hl = std::max(s->hl, hl);
+        }
+        ++count;
+    }
+    ROS_DEBUG_NAMED(SLOG, "Learned heuristic values for %d states", count);
+}
+
 // Convert TimeParameters to ReplanParams. Uses the current epsilon values
 // to fill in the epsilon fields.
 void ARAStar::convertTimeParamsToReplanParams(
@@ -591,6 +663,8 @@ ARAStar::SearchState* ARAStar::createState(int state_id)
     SearchState* ss = new SearchState;
     ss->state_id = state_id;
     ss->call_number = 0;
+    ss->hl = 0;
+    ss->learn_number = 0;
     m_states.push_back(ss);
 
     return ss;
@@ -603,6 +677,9 @@ void ARAStar::reinitSearchState(SearchState* state)
         ROS_DEBUG_NAMED(SELOG, "Reinitialize state %d", state->state_id);
         state->g = INFINITECOST;
         state->h = m_heur->GetGoalHeuristic(state->state_id);
+        if (m_incremental && state->learn_number == m_learn_number) {
+            state->h = std::max(state->h, state->hl);
+        }
         state->f = INFINITECOST;
         state->eg = INFINITECOST;
         state->iteration_closed = 0;
@@ -0,0 +1,278 @@
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+#define BOOST_TEST_MODULE ARAStarTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <sbpl/headers.h>
+
+#include <smpl/search/arastar.h>
+
+// 4-connected grid with unit edge costs
+class GridSpace : public DiscreteSpaceInformation
+{
+public:
+
+    GridSpace(int width, int height) :
+        m_width(width),
+        m_height(height),
+        m_blocked(width * height, false),
+        m_expansions(0)
+    { }
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+    int id(int x, int y) const { return y * m_width + x; }
+    int x(int id) const { return id % m_width; }
+    int y(int id) const { return id / m_width; }
+
+    void setBlocked(int x, int y, bool blocked) { m_blocked[id(x, y)] = blocked; }
+    bool blocked(int x, int y) const { return m_blocked[id(x, y)]; }
+
+    int expansions() const { return m_expansions; }
+
+    // cost of the optimal path between two cells, by breadth-first search
+    int optimalCost(int from, int to) const
+    {
+        std::vector<int> dist(m_width * m_height, -1);
+        std::deque<int> q;
+        dist[from] = 0;
+        q.push_back(from);
+        while (!q.empty()) {
+            int s = q.front();
+            q.pop_front();
+            std::vector<int> succs;
+            neighbors(s, succs);
+            for (int n : succs) {
+                if (dist[n] < 0) {
+                    dist[n] = dist[s] + 1;
+                    q.push_back(n);
+                }
+            }
+        }
+        return dist[to];
+    }
+
+    void GetSuccs(int state_id, std::vector<int>* succs, std::vector<int>* costs) override
+    {
+        ++m_expansions;
+        succs->clear();
+        costs->clear();
+        neighbors(state_id, *succs);
+        costs->assign(succs->size(), 1);
+    }
+
+    void GetPreds(int state_id, std::vector<int>* preds, std::vector<int>* costs) override
+    {
+        GetSuccs(state_id, preds, costs);
+    }
+
+    bool InitializeEnv(const char*) override { return true; }
+    bool InitializeMDPCfg(MDPConfig*) override { return true; }
+    int GetFromToHeuristic(int, int) override { return 0; }
+    int GetGoalHeuristic(int) override { return 0; }
+    int GetStartHeuristic(int) override { return 0; }
+    void SetAllActionsandAllOutcomes(CMDPSTATE*) override { }
+    void SetAllPreds(CMDPSTATE*) override { }
+    int SizeofCreatedEnv() override { return m_width * m_height; }
+    void PrintState(int, bool, FILE*) override { }
+    void PrintEnv_Config(FILE*) override { }
+
+private:
+
+    int m_width;
+    int m_height;
+    std::vector<bool> m_blocked;
+    int m_expansions;
+
+    void neighbors(int state_id, std::vector<int>& succs) const
+    {
+        const int dx[] = { 1, -1, 0, 0 };
+        const int dy[] = { 0, 0, 1, -1 };
+        for (int i = 0; i < 4; ++i) {
+            int nx = x(state_id) + dx[i];
+            int ny = y(state_id) + dy[i];
+            if (nx < 0 || nx >= m_width || ny < 0 || ny >= m_height) {
+                continue;
+            }
+            if (blocked(nx, ny)) {
+                continue;
+            }
+            succs.push_back(id(nx, ny));
+        }
+    }
+};
+
+// Manhattan distance to the goal cell
+class ManhattanHeuristic : public Heuristic
+{
+public:
+
+    ManhattanHeuristic(GridSpace* space) : Heuristic(space), m_space(space) { }
+
+    void setGoal(int goal_id) { m_goal_id = goal_id; }
+
+    int GetGoalHeuristic(int state_id) override
+    {
+        return std::abs(m_space->x(state_id) - m_space->x(m_goal_id)) +
+                std::abs(m_space->y(state_id) - m_space->y(m_goal_id));
+    }
+
+    int GetStartHeuristic(int state_id) override { return 0; }
+    int GetFromToHeuristic(int from_id, int to_id) override { return 0; }
+
+private:
+
+    GridSpace* m_space;
+    int m_goal_id = 0;
+};
+
+// 20x20 grid with a wall along x = 10, open only at the top row, so the
+// Manhattan distance badly underestimates the cost to cross it
+static void BuildWall(GridSpace& space)
+{
+    for (int y = 0; y < space.height() - 1; ++y) {
+        space.setBlocked(10, y, true);
+    }
+}
+
+static ReplanParams MakeParams()
+{
+    ReplanParams params(10.0);
+    params.initial_eps = 1.0;
+    params.final_eps = 1.0;
+    params.dec_eps = 0.1;
+    params.return_first_solution = false;
+    return params;
+}
+
+// Plan from scratch with a new search, returning the solution cost and the
+// number of expansions
+static int PlanFresh(GridSpace& space, int start_id, int goal_id, int& expansions)
+{
+    ManhattanHeuristic h(&space);
+    h.setGoal(goal_id);
+    sbpl::ARAStar search(&space, &h);
+    search.set_start(start_id);
+    search.set_goal(goal_id);
+    std::vector<int> solution;
+    int cost = -1;
+    BOOST_REQUIRE(search.replan(&solution, MakeParams(), &cost));
+    expansions = search.get_n_expands();
+    return cost;
+}
+
+BOOST_AUTO_TEST_CASE(IncrementalStartChangeTest)
+{
+    GridSpace space(20, 20);
+    BuildWall(space);
+
+    const int goal_id = space.id(19, 0);
+
+    ManhattanHeuristic h(&space);
+    h.setGoal(goal_id);
+    sbpl::ARAStar search(&space, &h);
+    search.allowIncrementalSearch(true);
+
+    search.set_start(space.id(0, 0));
+    search.set_goal(goal_id);
+    std::vector<int> solution;
+    int cost = -1;
+    BOOST_REQUIRE(search.replan(&solution, MakeParams(), &cost));
+    BOOST_CHECK_EQUAL(cost, space.optimalCost(space.id(0, 0), goal_id));
+
+    // re-plan from a later state along the previous solution; the learned
+    // cost-to-goal values confine the search to the previous corridor
+    const int start_id = solution[solution.size() / 4];
+    search.set_start(start_id);
+    solution.clear();
+    BOOST_REQUIRE(search.replan(&solution, MakeParams(), &cost));
+    BOOST_CHECK_EQUAL(cost, space.optimalCost(start_id, goal_id));
+    BOOST_CHECK_EQUAL(solution.front(), start_id);
+    BOOST_CHECK_EQUAL(solution.back(), goal_id);
+
+    int fresh_expansions;
+    int fresh_cost = PlanFresh(space, start_id, goal_id, fresh_expansions);
+    BOOST_CHECK_EQUAL(cost, fresh_cost);
+    BOOST_CHECK_LT(search.get_n_expands(), fresh_expansions);
+}
+
+BOOST_AUTO_TEST_CASE(IncrementalCostChangeTest)
+{
+    GridSpace space(20, 20);
+    BuildWall(space);
+
+    const int goal_id = space.id(19, 0);
+
+    ManhattanHeuristic h(&space);
+    h.setGoal(goal_id);
+    sbpl::ARAStar search(&space, &h);
+    search.allowIncrementalSearch(true);
+
+    search.set_start(space.id(0, 0));
+    search.set_goal(goal_id);
+    std::vector<int> solution;
+    int cost = -1;
+    BOOST_REQUIRE(search.replan(&solution, MakeParams(), &cost));
+
+    const int start_id = solution[solution.size() / 4];
+
+    // open a shortcut through the bottom of the wall; the values learned
+    // before the change overestimate the new cost-to-goal
+    space.setBlocked(10, 0, false);
+    const int optimal_cost = space.optimalCost(start_id, goal_id);
+    BOOST_REQUIRE_LT(optimal_cost, cost);
+
+    StateChangeQuery changes;
+    search.costs_changed(changes);
+
+    search.set_start(start_id);
+    solution.clear();
+    BOOST_REQUIRE(search.replan(&solution, MakeParams(), &cost));
+    BOOST_CHECK_EQUAL(cost, optimal_cost);
+
+    // no learned values survive the cost change, so the search must match
+    // a search from scratch exactly
+    int fresh_expansions;
+    int fresh_cost = PlanFresh(space, start_id, goal_id, fresh_expansions);
+    BOOST_CHECK_EQUAL(cost, fresh_cost);
+    BOOST_CHECK_EQUAL(search.get_n_expands(), fresh_expansions);
+
+    // learning resumes after the change
+    const int next_start_id = solution[solution.size() / 2];
+    search.set_start(next_start_id);
+    solution.clear();
+    BOOST_REQUIRE(search.replan(&solution, MakeParams(), &cost));
+    BOOST_CHECK_EQUAL(cost, space.optimalCost(next_start_id, goal_id));
+}
+
+BOOST_AUTO_TEST_CASE(IncrementalGoalChangeTest)
+{
+    GridSpace space(20, 20);
+    BuildWall(space);
+
+    ManhattanHeuristic h(&space);
+    sbpl::ARAStar search(&space, &h);
+    search.allowIncrementalSearch(true);
+
+    const int start_id = space.id(0, 0);
+    search.set_start(start_id);
+
+    h.setGoal(space.id(19, 0));
+    search.set_goal(space.id(19, 0));
+    std::vector<int> solution;
+    int cost = -1;
+    BOOST_REQUIRE(search.replan(&solution, MakeParams(), &cost));
+
+    // values learned toward the previous goal must not bias the new search
+    const int goal_id = space.id(5, 10);
+    h.setGoal(goal_id);
+    search.set_goal(goal_id);
+    search.set_start(space.id(19, 0));
+    solution.clear();
+    BOOST_REQUIRE(search.replan(&solution, MakeParams(), &cost));
+    BOOST_CHECK_EQUAL(cost, space.optimalCost(space.id(19, 0), goal_id));
+}
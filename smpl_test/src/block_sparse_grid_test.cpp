@@ -0,0 +1,456 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+#define BOOST_TEST_MODULE BlockSparseGridTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <smpl/grid/block_sparse_grid.h>
+#include <smpl/grid/sparse_grid.h>
+
+BOOST_AUTO_TEST_CASE(DefaultConstructorTest)
+{
+    sbpl::BlockSparseGrid<int> g;
+    BOOST_CHECK_EQUAL(g.max_depth(), 16);
+
+    std::uint64_t max_coord = 1u << 16;
+    BOOST_CHECK_EQUAL(g.size(), max_coord * max_coord * max_coord);
+
+    BOOST_CHECK_EQUAL(g.num_blocks(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ValueConstructorTest)
+{
+    sbpl::BlockSparseGrid<int> g(8);
+    BOOST_CHECK_EQUAL(g.get(0, 0, 0), 8);
+}
+
+BOOST_AUTO_TEST_CASE(SetSingleNodeTest)
+{
+    sbpl::BlockSparseGrid<int> g(0);
+
+    g.set(0, 0, 0, 8);
+
+    BOOST_CHECK_EQUAL(g.get(0, 0, 0), 8);
+    BOOST_CHECK_EQUAL(g.get(0, 0, 1), 0);
+    BOOST_CHECK_EQUAL(g.get(0, 1, 0), 0);
+    BOOST_CHECK_EQUAL(g.get(1, 0, 0), 0);
+    BOOST_CHECK_EQUAL(g.get(1, 1, 1), 0);
+    BOOST_CHECK_EQUAL(g.get(8, 0, 0), 0);
+
+    BOOST_CHECK_EQUAL(g.num_blocks(), 1);
+    BOOST_CHECK_EQUAL(g.num_dense_blocks(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(SetBackgroundValueTest)
+{
+    sbpl::BlockSparseGrid<int> g(0);
+    g.set(0, 0, 0, 0);
+    g.set_lazy(0, 0, 0, 0);
+    BOOST_CHECK_EQUAL(g.num_blocks(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(CopyConstructorTest)
+{
+    sbpl::BlockSparseGrid<int> g(0);
+    g.set(0, 0, 0, 8);
+
+    sbpl::BlockSparseGrid<int> cg(g);
+    BOOST_CHECK_EQUAL(cg.get(0, 0, 0), 8);
+
+    // the copy owns its own cells
+    g.set(0, 0, 0, 4);
+    BOOST_CHECK_EQUAL(cg.get(0, 0, 0), 8);
+
+    BOOST_CHECK_EQUAL(cg.size_x(), g.size_x());
+    BOOST_CHECK_EQUAL(cg.size_y(), g.size_y());
+    BOOST_CHECK_EQUAL(cg.size_z(), g.size_z());
+    BOOST_CHECK_EQUAL(cg.size(), g.size());
+    BOOST_CHECK_EQUAL(cg.max_depth(), g.max_depth());
+}
+
+BOOST_AUTO_TEST_CASE(MoveConstructorTest)
+{
+    sbpl::BlockSparseGrid<int> g(10);
+    g.set(0, 0, 0, 8);
+
+    sbpl::BlockSparseGrid<int> g2(std::move(g));
+
+    BOOST_CHECK_EQUAL(g2.get(0, 0, 0), 8);
+}
+
+BOOST_AUTO_TEST_CASE(CopyAssignmentTest)
+{
+    sbpl::BlockSparseGrid<int> g1(10);
+    g1.set(100, 0, 0, 3);
+
+    sbpl::BlockSparseGrid<int> g2(8);
+    g2.set(0, 0, 0, 8);
+
+    g1 = g2;
+
+    BOOST_CHECK_EQUAL(g1.get(0, 0, 0), g2.get(0, 0, 0));
+    BOOST_CHECK_EQUAL(g1.get(100, 0, 0), 8);
+
+    BOOST_CHECK_EQUAL(g1.num_blocks(), g2.num_blocks());
+    BOOST_CHECK_EQUAL(g1.num_dense_blocks(), g2.num_dense_blocks());
+
+    BOOST_CHECK_EQUAL(g1.size(), g2.size());
+    BOOST_CHECK_EQUAL(g1.max_depth(), g2.max_depth());
+}
+
+BOOST_AUTO_TEST_CASE(MoveAssignmentTest)
+{
+    sbpl::BlockSparseGrid<int> t1(10);
+    t1.set(100, 0, 0, 3);
+
+    sbpl::BlockSparseGrid<int> t2(8);
+    t2.set(0, 0, 0, 6);
+
+    t1 = std::move(t2);
+
+    BOOST_CHECK_EQUAL(t1.get(0, 0, 0), 6);
+    BOOST_CHECK_EQUAL(t1.get(100, 0, 0), 8);
+}
+
+BOOST_AUTO_TEST_CASE(SetAndUnsetNodeTest)
+{
+    sbpl::BlockSparseGrid<int> g(0);
+
+    g.set(0, 0, 0, 8);
+    g.set(0, 0, 0, 0);
+
+    // the block collapses back to a uniform block immediately...
+    BOOST_CHECK_EQUAL(g.num_dense_blocks(), 0);
+
+    // ...and is removed when pruned
+    g.prune();
+    BOOST_CHECK_EQUAL(g.num_blocks(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ExtentsTest)
+{
+    auto max_coord = std::numeric_limits<std::uint16_t>::max();
+    sbpl::BlockSparseGrid<int> g(0);
+
+    g.set(0,         0,         0,         8);
+    g.set(0,         0,         max_coord, 8);
+    g.set(0,         max_coord, 0,         8);
+    g.set(0,         max_coord, max_coord, 8);
+    g.set(max_coord, 0,         0,         8);
+    g.set(max_coord, 0,         max_coord, 8);
+    g.set(max_coord, max_coord, 0,         8);
+    g.set(max_coord, max_coord, max_coord, 8);
+
+    BOOST_CHECK_EQUAL(g.num_blocks(), 8);
+    BOOST_CHECK_EQUAL(g.get(max_coord, max_coord, max_coord), 8);
+    BOOST_CHECK_EQUAL(g.get(max_coord - 1, max_coord, max_coord), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ResetTest)
+{
+    sbpl::BlockSparseGrid<int> g(8);
+    g.set(0, 0, 0, 6);
+
+    g.reset(4);
+    BOOST_CHECK_EQUAL(g.num_blocks(), 0);
+    BOOST_CHECK_EQUAL(g.get(0, 0, 0), 4);
+}
+
+/// Test automatic compression of a block whose cells become equal
+BOOST_AUTO_TEST_CASE(AutoCompressionTest)
+{
+    sbpl::BlockSparseGrid<int> g(8, 8, 8, 0);
+
+    BOOST_CHECK_EQUAL(g.max_depth(), 3);
+    BOOST_CHECK_EQUAL(g.size(), 8 * 8 * 8);
+
+    for (int x = 0; x < 8; ++x) {
+    for (int y = 0; y < 8; ++y) {
+    for (int z = 0; z < 8; ++z) {
+        g.set(x, y, z, 10);
+    }
+    }
+    }
+
+    // the block is not collapsed automatically since its cells no longer hold
+    // the value it was expanded from
+    BOOST_CHECK_EQUAL(g.num_dense_blocks(), 1);
+
+    g.prune();
+    BOOST_CHECK_EQUAL(g.num_blocks(), 1);
+    BOOST_CHECK_EQUAL(g.num_dense_blocks(), 0);
+    BOOST_CHECK_EQUAL(g.get(3, 4, 5), 10);
+}
+
+/// Test bounded depth for a smallish sparse grid
+BOOST_AUTO_TEST_CASE(BoundedGridDepthTest)
+{
+    sbpl::BlockSparseGrid<int> g(1024, 1024, 1024);
+    BOOST_CHECK_EQUAL(g.max_depth(), 10);
+}
+
+BOOST_AUTO_TEST_CASE(StringTreeTest)
+{
+    using StringGrid = sbpl::BlockSparseGrid<std::string>;
+    StringGrid t;
+    t.reset("test");
+    BOOST_CHECK_EQUAL(t.get(0, 0, 0), "test");
+    t.set(1, 2, 3, "other");
+    BOOST_CHECK_EQUAL(t.get(1, 2, 3), "other");
+    BOOST_CHECK_EQUAL(t.get(1, 2, 4), "test");
+}
+
+BOOST_AUTO_TEST_CASE(LazySetNodeTest)
+{
+    sbpl::BlockSparseGrid<int> g(10);
+
+    // enforce block creation
+    int i = 0;
+    for (int x = 0; x < 16; ++x) {
+    for (int y = 0; y < 16; ++y) {
+    for (int z = 0; z < 16; ++z) {
+        g.set_lazy(x, y, z, i++);
+    }
+    }
+    }
+
+    for (int x = 0; x < 16; ++x) {
+    for (int y = 0; y < 16; ++y) {
+    for (int z = 0; z < 16; ++z) {
+        g.set_lazy(x, y, z, 10);
+    }
+    }
+    }
+
+    BOOST_CHECK_EQUAL(g.num_dense_blocks(), 8);
+
+    g.prune();
+
+    BOOST_CHECK_EQUAL(g.num_blocks(), 0);
+
+    g.set(0, 0, 0, 8); // add a block back in
+    g.prune();
+
+    BOOST_CHECK_EQUAL(g.num_blocks(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(ConditionalPruneTest)
+{
+    sbpl::BlockSparseGrid<int> g(0);
+    g.set_lazy(0, 0, 0, 1);
+    g.set_lazy(0, 0, 0, 0);
+    for (int x = 8; x < 16; ++x) {
+    for (int y = 0; y < 8; ++y) {
+    for (int z = 0; z < 8; ++z) {
+        g.set_lazy(x, y, z, 2);
+    }
+    }
+    }
+
+    // only collapse blocks whose cells do not hold the value 2
+    BOOST_CHECK_EQUAL(g.num_dense_blocks(), 2);
+    g.prune([](int v) { return v != 2; });
+    BOOST_CHECK_EQUAL(g.num_blocks(), 1);
+    BOOST_CHECK_EQUAL(g.num_dense_blocks(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(StableReferenceTest)
+{
+    sbpl::BlockSparseGrid<int> g(0);
+
+    int& c = g(3, 3, 3);
+    c = 5;
+
+    // insert enough blocks to force the block table to rehash
+    for (int x = 0; x < 1024; x += 8) {
+        g.set(x, 16, 0, 1);
+    }
+
+    BOOST_CHECK_EQUAL(&g(3, 3, 3), &c);
+    BOOST_CHECK_EQUAL(g.get(3, 3, 3), 5);
+}
+
+BOOST_AUTO_TEST_CASE(AccessorTest)
+{
+    sbpl::BlockSparseGrid<int> g(0);
+
+    auto a = g.accessor();
+    BOOST_CHECK_EQUAL(a.get(0, 0, 0), 0);
+    BOOST_CHECK_EQUAL(g.num_blocks(), 0);
+
+    a.set(0, 0, 0, 1);
+    a.set(1, 0, 0, 2);
+    a.set(9, 0, 0, 3);
+    a(10, 0, 0) = 4;
+
+    BOOST_CHECK_EQUAL(g.get(0, 0, 0), 1);
+    BOOST_CHECK_EQUAL(g.get(1, 0, 0), 2);
+    BOOST_CHECK_EQUAL(g.get(9, 0, 0), 3);
+    BOOST_CHECK_EQUAL(g.get(10, 0, 0), 4);
+
+    // the block is collapsed through the accessor when restored
+    a.set(9, 0, 0, 0);
+    a.set(10, 0, 0, 0);
+    BOOST_CHECK_EQUAL(g.num_dense_blocks(), 1);
+    BOOST_CHECK_EQUAL(a.get(9, 0, 0), 0);
+
+    const sbpl::BlockSparseGrid<int>& cg = g;
+    auto ca = cg.accessor();
+    BOOST_CHECK_EQUAL(ca.get(0, 0, 0), 1);
+    BOOST_CHECK_EQUAL(ca.get(1, 0, 0), 2);
+    BOOST_CHECK_EQUAL(ca.get(100, 0, 0), 0);
+    BOOST_CHECK_EQUAL(ca.get(0, 0, 0), 1);
+}
+
+/// Compare against SparseGrid and a dense grid for a random sequence of
+/// modifications
+BOOST_AUTO_TEST_CASE(MatchesSparseGridTest)
+{
+    std::vector<int> dense(64 * 64 * 64, 0);
+    sbpl::SparseGrid<int> expected(64, 64, 64, 0);
+    sbpl::BlockSparseGrid<int> actual(64, 64, 64, 0);
+    auto a = actual.accessor();
+
+    std::default_random_engine rng;
+    std::uniform_int_distribution<int> coord(0, 63);
+    std::uniform_int_distribution<int> value(0, 3);
+    std::uniform_int_distribution<int> op(0, 3);
+    for (int i = 0; i < 20000; ++i) {
+        const int x = coord(rng), y = coord(rng), z = coord(rng);
+        const int v = value(rng);
+        dense[(x * 64 + y) * 64 + z] = v;
+        switch (op(rng)) {
+        case 0: expected.set(x, y, z, v); actual.set(x, y, z, v); break;
+        case 1: expected.set_lazy(x, y, z, v); actual.set_lazy(x, y, z, v); break;
+        case 2: expected.set(x, y, z, v); a.set(x, y, z, v); break;
+        case 3: expected(x, y, z) = v; a(x, y, z) = v; break;
+        }
+    }
+
+    auto check = [&]()
+    {
+        for (int x = 0; x < 64; ++x) {
+        for (int y = 0; y < 64; ++y) {
+        for (int z = 0; z < 64; ++z) {
+            const int v = dense[(x * 64 + y) * 64 + z];
+            BOOST_REQUIRE_EQUAL(expected.get(x, y, z), v);
+            BOOST_REQUIRE_EQUAL(actual.get(x, y, z), v);
+        }
+        }
+        }
+    };
+
+    check();
+    expected.prune();
+    actual.prune();
+    check();
+}
+
+BOOST_AUTO_TEST_CASE(VisitorTest)
+{
+    auto dispatcher = [](int& v) { v = 8; };
+
+    sbpl::BlockSparseGrid<int> g(8);
+    g.set(0, 0, 0, 4);
+
+    g.accept(dispatcher);
+    g.prune();
+
+    BOOST_CHECK_EQUAL(g.num_blocks(), 0);
+    BOOST_CHECK_EQUAL(g.get(0, 0, 0), 8);
+}
+
+BOOST_AUTO_TEST_CASE(AlignmentTest)
+{
+    sbpl::BlockSparseGrid<Eigen::Vector4d> g(Eigen::Vector4d::Zero());
+
+    g.set(0, 0, 0, Eigen::Vector4d::Ones());
+    g.set(0, 0, 1, Eigen::Vector4d::Ones());
+
+    BOOST_CHECK(g.get(0, 0, 0) == Eigen::Vector4d::Ones());
+    BOOST_CHECK_EQUAL((std::uintptr_t)&g(0, 0, 0) % alignof(Eigen::Vector4d), 0);
+}
+
+BOOST_AUTO_TEST_CASE(LeafCoordsVisitorTest)
+{
+    sbpl::BlockSparseGrid<int> g(16, 16, 16, 0);
+    g.set(0, 0, 0, 1);
+    for (int x = 8; x < 16; ++x) {
+    for (int y = 8; y < 16; ++y) {
+    for (int z = 8; z < 16; ++z) {
+        g.set_lazy(x, y, z, 2);
+    }
+    }
+    }
+    g.prune();
+
+    // count the cells holding each value; every visit after the first
+    // overrides the background value
+    bool background = true;
+    int count[3] = { 0, 0, 0 };
+    auto count_coords = [&](
+        int value,
+        size_t first_x, size_t first_y, size_t first_z,
+        size_t last_x, size_t last_y, size_t last_z)
+    {
+        const int n = (int)((last_x - first_x) * (last_y - first_y) * (last_z - first_z));
+        if (!background) {
+            count[0] -= n;
+        }
+        background = false;
+        count[value] += n;
+    };
+
+    g.accept_coords(count_coords);
+    BOOST_CHECK_EQUAL(count[0], 16 * 16 * 16 - 1 - 8 * 8 * 8);
+    BOOST_CHECK_EQUAL(count[1], 1);
+    BOOST_CHECK_EQUAL(count[2], 8 * 8 * 8);
+}
+
+BOOST_AUTO_TEST_CASE(CompareMemUsageTest)
+{
+    int scale = 2;
+    const int xmax = scale * 512;
+    const int ymax = scale * 512;
+    const int zmax = scale * 80;
+    sbpl::BlockSparseGrid<int> g(0);
+    auto a = g.accessor();
+    for (int x = 0; x < xmax; ++x) {
+    for (int y = 0; y < ymax; ++y) {
+    for (int z = 0; z < zmax; ++z) {
+        if ((x == 0       ) | (y == 0       ) | (z == 0       )|
+            (x == xmax - 1) | (y == ymax - 1) | (z == zmax - 1))
+        {
+            a.set(x, y, z, 1);
+        }
+    }
+    }
+    }
+
+    auto comp_size = g.mem_usage();
+    std::cout << "memory usage: " << std::endl;
+    std::cout << comp_size << " B" << std::endl;
+    std::cout << (double)comp_size / (1024.0) << " KB" << std::endl;
+    std::cout << (double)comp_size / (1024.0 * 1024.0) << " MB" << std::endl;
+    std::cout << (double)comp_size / (1024.0 * 1024.0 * 1024.0) << " GB" << std::endl;
+
+    auto pred = [](int val) { return val == 1; };
+    auto full_size = g.mem_usage_full(pred);
+
+    std::cout << "memory usage full: " << std::endl;
+    std::cout << full_size << " B" << std::endl;
+    std::cout << (double)full_size / (1024.0) << " KB" << std::endl;
+    std::cout << (double)full_size / (1024.0 * 1024.0) << " MB" << std::endl;
+    std::cout << (double)full_size / (1024.0 * 1024.0 * 1024.0) << " GB" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(ResizeTest)
+{
+    sbpl::BlockSparseGrid<int> g;
+    g.resize(8, 8, 8);
+    BOOST_CHECK_EQUAL(g.max_depth(), 3);
+}
@@ -0,0 +1,115 @@
+#include <cstdint>
+
+#define BOOST_TEST_MODULE EdgeValidityCacheTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <smpl/graph/edge_validity_cache.h>
+
+using sbpl::motion::EdgeValidityCache;
+
+BOOST_AUTO_TEST_CASE(CapacityTest)
+{
+    EdgeValidityCache c0;
+    BOOST_CHECK_EQUAL(c0.capacity(), 0);
+
+    EdgeValidityCache c1(1000);
+    BOOST_CHECK_EQUAL(c1.capacity(), 1024);
+
+    c1.resize(0);
+    BOOST_CHECK_EQUAL(c1.capacity(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(DisabledCacheTest)
+{
+    EdgeValidityCache c;
+    c.insert(0, 1, 42, 0, true, 1.0);
+
+    bool valid;
+    double dist;
+    BOOST_CHECK(!c.find(0, 1, 42, 0, valid, dist));
+}
+
+BOOST_AUTO_TEST_CASE(InsertFindTest)
+{
+    EdgeValidityCache c(64);
+
+    c.insert(5, 17, 42, 3, true, 0.25);
+    c.insert(5, 18, 42, 3, false, 0.0);
+
+    bool valid = false;
+    double dist = 0.0;
+    BOOST_CHECK(c.find(5, 17, 42, 3, valid, dist));
+    BOOST_CHECK(valid);
+    BOOST_CHECK_CLOSE(dist, 0.25, 1e-4);
+
+    BOOST_CHECK(c.find(5, 18, 42, 3, valid, dist));
+    BOOST_CHECK(!valid);
+
+    BOOST_CHECK(!c.find(6, 17, 42, 3, valid, dist));
+    BOOST_CHECK(!c.find(5, 19, 42, 3, valid, dist));
+
+    BOOST_CHECK_EQUAL(c.hits(), 2);
+    BOOST_CHECK_EQUAL(c.misses(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(VersionInvalidationTest)
+{
+    EdgeValidityCache c(64);
+    c.insert(0, 0, 42, 1, true, 1.0);
+
+    bool valid;
+    double dist;
+    BOOST_CHECK(c.find(0, 0, 42, 1, valid, dist));
+    BOOST_CHECK(!c.find(0, 0, 42, 2, valid, dist));
+
+    c.insert(0, 0, 42, 2, false, 0.0);
+    BOOST_CHECK(c.find(0, 0, 42, 2, valid, dist));
+    BOOST_CHECK(!valid);
+    BOOST_CHECK(!c.find(0, 0, 42, 1, valid, dist));
+}
+
+BOOST_AUTO_TEST_CASE(ActionMismatchTest)
+{
+    EdgeValidityCache c(64);
+    c.insert(3, 7, 1001, 0, true, 1.0);
+
+    // a different action at the same index is a miss
+    bool valid;
+    double dist;
+    BOOST_CHECK(!c.find(3, 7, 1002, 0, valid, dist));
+    BOOST_CHECK(c.find(3, 7, 1001, 0, valid, dist));
+    BOOST_CHECK(valid);
+
+    c.insert(3, 7, 1002, 0, false, 0.0);
+    BOOST_CHECK(c.find(3, 7, 1002, 0, valid, dist));
+    BOOST_CHECK(!valid);
+    BOOST_CHECK(!c.find(3, 7, 1001, 0, valid, dist));
+}
+
+BOOST_AUTO_TEST_CASE(BoundedTest)
+{
+    EdgeValidityCache c(16);
+    for (int i = 0; i < 1000; ++i) {
+        c.insert(i, i, 42, 0, (i % 2) == 0, (double)i);
+    }
+
+    // every entry that survived eviction must be reported correctly
+    int found = 0;
+    for (int i = 0; i < 1000; ++i) {
+        bool valid;
+        double dist;
+        if (c.find(i, i, 42, 0, valid, dist)) {
+            BOOST_CHECK_EQUAL(valid, (i % 2) == 0);
+            BOOST_CHECK_EQUAL(dist, (double)i);
+            ++found;
+        }
+    }
+    BOOST_CHECK(found > 0);
+    BOOST_CHECK(found <= 16);
+
+    c.clear();
+    bool valid;
+    double dist;
+    BOOST_CHECK(!c.find(999, 999, 42, 0, valid, dist));
+}
@@ -31,6 +31,9 @@
 
 // standard includes
 #include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
 
 #define BOOST_TEST_MODULE ExperienceGraphTest
 #define BOOST_TEST_DYN_LINK
@@ -38,6 +41,7 @@
 
 // system includes
 #include <smpl/graph/experience_graph.h>
+#include <smpl/graph/experience_graph_store.h>
 
 namespace smpl = sbpl::motion;
 
@@ -373,3 +377,214 @@ BOOST_AUTO_TEST_CASE(ParallelEdgeTest)
 //
 //    BOOST_CHECK_EQUAL(eg.degree(n1), 1);
 }
+
+BOOST_AUTO_TEST_CASE(RemoveIsolatedInteriorNodeTest)
+{
+    smpl::ExperienceGraph eg;
+    smpl::RobotState zero_state;
+    smpl::ExperienceGraph::node_id n1 = eg.insert_node(zero_state);
+    smpl::ExperienceGraph::node_id n2 = eg.insert_node(zero_state);
+    smpl::ExperienceGraph::node_id n3 = eg.insert_node(zero_state);
+    eg.insert_edge(n1, n3);
+
+    eg.erase_node(n2);
+
+    // the node formerly known as n3 is now n2
+    BOOST_CHECK_EQUAL(eg.num_nodes(), 2);
+    BOOST_CHECK_EQUAL(*eg.adjacent_nodes(n1).first, n2);
+    BOOST_CHECK_EQUAL(*eg.adjacent_nodes(n2).first, n1);
+    BOOST_CHECK(eg.edge(n1, n2));
+}
+
+BOOST_AUTO_TEST_CASE(ComponentsTest)
+{
+    smpl::ExperienceGraph eg;
+    smpl::RobotState zero_state;
+    smpl::ExperienceGraph::node_id n1 = eg.insert_node(zero_state);
+    smpl::ExperienceGraph::node_id n2 = eg.insert_node(zero_state);
+    smpl::ExperienceGraph::node_id n3 = eg.insert_node(zero_state);
+    eg.insert_edge(n1, n2);
+
+    std::vector<int> comps;
+    int comp_count = smpl::ComputeComponents(eg, comps);
+    BOOST_CHECK_EQUAL(comp_count, 2);
+    BOOST_CHECK_EQUAL(comps[n1], comps[n2]);
+    BOOST_CHECK_NE(comps[n1], comps[n3]);
+
+    // a new node joined to an existing component
+    smpl::ExperienceGraph::node_id n4 = eg.insert_node(zero_state);
+    std::vector<smpl::ExperienceGraph::edge_id> edges;
+    edges.push_back(eg.insert_edge(n3, n4));
+    comp_count = smpl::UpdateComponents(eg, n4, edges, comps, comp_count);
+    BOOST_CHECK_EQUAL(comps[n3], comps[n4]);
+    BOOST_CHECK_NE(comps[n1], comps[n4]);
+
+    // a new edge joining two existing components
+    edges.clear();
+    edges.push_back(eg.insert_edge(n2, n3));
+    comp_count = smpl::UpdateComponents(eg, eg.num_nodes(), edges, comps, comp_count);
+    BOOST_CHECK_EQUAL(comps[n1], comps[n4]);
+    BOOST_CHECK_EQUAL(comps[n2], comps[n3]);
+}
+
+BOOST_AUTO_TEST_CASE(VersionTest)
+{
+    smpl::ExperienceGraph eg;
+    smpl::RobotState zero_state;
+    smpl::ExperienceGraph::node_id n1 = eg.insert_node(zero_state);
+    smpl::ExperienceGraph::node_id n2 = eg.insert_node(zero_state);
+
+    auto version = eg.version();
+    const smpl::ExperienceGraph& ceg = eg;
+    ceg.state(n1);
+    BOOST_CHECK_EQUAL(eg.version(), version);
+
+    eg.state(n1) = { 1.0 };
+    BOOST_CHECK_NE(eg.version(), version);
+
+    version = eg.version();
+    eg.insert_edge(n1, n2);
+    BOOST_CHECK_NE(eg.version(), version);
+
+    // erasing and inserting a node leaves the node count unchanged
+    version = eg.version();
+    eg.erase_node(n2);
+    eg.insert_node(zero_state);
+    BOOST_CHECK_EQUAL(eg.num_nodes(), 2);
+    BOOST_CHECK_NE(eg.version(), version);
+
+    // a replacement graph with the same node count has a different version
+    version = eg.version();
+    eg = smpl::ExperienceGraph();
+    eg.insert_node(zero_state);
+    eg.insert_node(zero_state);
+    BOOST_CHECK_NE(eg.version(), version);
+}
+
+BOOST_AUTO_TEST_CASE(StoreAppendTest)
+{
+    const char* path = "egraph_store_test.egbs";
+    std::remove(path);
+
+    smpl::ExperienceGraph eg;
+    smpl::ExperienceGraph::node_id n1 = eg.insert_node({ 0.0, 0.0 });
+    smpl::ExperienceGraph::node_id n2 = eg.insert_node({ 1.0, 0.0 });
+    smpl::ExperienceGraph::node_id n3 = eg.insert_node({ 5.0, 5.0 });
+    eg.insert_edge(n1, n2, { { 0.5, 0.0 } });
+
+    BOOST_REQUIRE(smpl::AppendExperienceGraphStore(path, eg));
+
+    // append a second demonstration without rewriting the first
+    smpl::ExperienceGraph::node_id first = eg.num_nodes();
+    smpl::ExperienceGraph::node_id n4 = eg.insert_node({ 2.0, 2.0 });
+    smpl::ExperienceGraph::node_id n5 = eg.insert_node({ 3.0, 3.0 });
+    eg.insert_edge(n4, n5, { { 2.25, 2.25 }, { 2.75, 2.75 } });
+
+    BOOST_REQUIRE(smpl::AppendExperienceGraphStore(path, eg, first));
+
+    smpl::ExperienceGraphStore store;
+    BOOST_REQUIRE(store.open(path));
+    BOOST_CHECK_EQUAL(store.variableCount(), 2);
+    BOOST_CHECK_EQUAL(store.numNodes(), 5);
+    BOOST_CHECK_EQUAL(store.numEdges(), 2);
+    BOOST_CHECK_EQUAL(store.numComponents(), 3);
+
+    BOOST_CHECK_EQUAL(store.component(n1), store.component(n2));
+    BOOST_CHECK_NE(store.component(n1), store.component(n3));
+    BOOST_CHECK_EQUAL(store.component(n4), store.component(n5));
+    BOOST_CHECK(store.projection(n1) == nullptr);
+
+    BOOST_CHECK_EQUAL(store.source(1), n4);
+    BOOST_CHECK_EQUAL(store.target(1), n5);
+    BOOST_CHECK_EQUAL(store.waypointCount(1), 2);
+    BOOST_CHECK_EQUAL(store.waypoint(1, 1)[0], 2.75);
+
+    smpl::ExperienceGraph loaded;
+    BOOST_REQUIRE(store.load(loaded));
+    BOOST_CHECK_EQUAL(loaded.num_nodes(), eg.num_nodes());
+    BOOST_CHECK_EQUAL(loaded.num_edges(), eg.num_edges());
+    for (auto nit = eg.nodes(); nit.first != nit.second; ++nit.first) {
+        BOOST_CHECK(loaded.state(*nit.first) == eg.state(*nit.first));
+    }
+    BOOST_CHECK(loaded.edge(n1, n2));
+    BOOST_CHECK(loaded.edge(n4, n5));
+
+    store.close();
+    std::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(StoreAppendNewPartialTest)
+{
+    const char* path = "egraph_store_partial_test.egbs";
+    std::remove(path);
+
+    smpl::ExperienceGraph eg;
+    smpl::ExperienceGraph::node_id n1 = eg.insert_node({ 0.0, 0.0 });
+    smpl::ExperienceGraph::node_id n2 = eg.insert_node({ 1.0, 0.0 });
+    eg.insert_edge(n1, n2);
+
+    smpl::ExperienceGraph::node_id first = eg.num_nodes();
+    smpl::ExperienceGraph::node_id n3 = eg.insert_node({ 2.0, 2.0 });
+    smpl::ExperienceGraph::node_id n4 = eg.insert_node({ 3.0, 3.0 });
+    eg.insert_edge(n3, n4, { { 2.5, 2.5 } });
+    eg.insert_edge(n2, n3);
+
+    // only the nodes from the first appended node on are written when the
+    // store does not yet exist, along with the edges between them
+    std::vector<Eigen::Vector3d> projections(2, Eigen::Vector3d::Zero());
+    BOOST_REQUIRE(smpl::AppendExperienceGraphStore(path, eg, first, &projections));
+
+    smpl::ExperienceGraphStore store;
+    BOOST_REQUIRE(store.open(path));
+    BOOST_CHECK_EQUAL(store.numNodes(), 2);
+    BOOST_CHECK_EQUAL(store.numEdges(), 1);
+    BOOST_CHECK_EQUAL(store.numComponents(), 1);
+    BOOST_CHECK_EQUAL(store.state(0)[0], eg.state(n3)[0]);
+    BOOST_CHECK_EQUAL(store.state(1)[0], eg.state(n4)[0]);
+    BOOST_CHECK_EQUAL(store.source(0), 0);
+    BOOST_CHECK_EQUAL(store.target(0), 1);
+    BOOST_CHECK_EQUAL(store.waypointCount(0), 1);
+    BOOST_CHECK(store.projection(0) != nullptr);
+
+    store.close();
+    std::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(StoreInvalidWaypointsTest)
+{
+    const char* path = "egraph_store_invalid_test.egbs";
+    std::remove(path);
+
+    smpl::ExperienceGraph eg;
+    smpl::ExperienceGraph::node_id n1 = eg.insert_node({ 0.0, 0.0 });
+    smpl::ExperienceGraph::node_id n2 = eg.insert_node({ 1.0, 1.0 });
+    eg.insert_edge(n1, n2, { { 0.5, 0.5 } });
+    BOOST_REQUIRE(smpl::WriteExperienceGraphStore(path, eg));
+
+    {
+        smpl::ExperienceGraphStore store;
+        BOOST_REQUIRE(store.open(path));
+        BOOST_CHECK_EQUAL(store.waypointCount(0), 1);
+    }
+
+    // point the waypoints of the only edge past the end of the waypoints of
+    // its segment; the edge record precedes the single two-variable waypoint
+    // at the end of the file
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(0, std::ios::end);
+        const std::streamoff size = f.tellp();
+        const std::uint32_t waypoint_begin = 1;
+        f.seekp(size - 2 * sizeof(double) - 2 * sizeof(std::uint32_t));
+        f.write((const char*)&waypoint_begin, sizeof(waypoint_begin));
+    }
+
+    smpl::ExperienceGraphStore store;
+    BOOST_CHECK(!store.open(path));
+
+    smpl::ExperienceGraph loaded;
+    BOOST_CHECK(!store.load(loaded));
+    BOOST_CHECK_EQUAL(loaded.num_nodes(), 0);
+
+    std::remove(path);
+}
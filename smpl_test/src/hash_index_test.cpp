@@ -0,0 +1,132 @@
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE HashIndexTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <smpl/fixed_vector.h>
+#include <smpl/hash_index.h>
+#include <smpl/object_pool.h>
+
+typedef sbpl::FixedVector<int, 4> Coord;
+
+struct CoordHash
+{
+    std::size_t operator()(const Coord& c) const
+    {
+        std::size_t seed = 0;
+        for (int v : c) {
+            seed = 31 * seed + (std::size_t)v;
+        }
+        return seed;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(FixedVectorTest)
+{
+    Coord c;
+    BOOST_CHECK(c.empty());
+    BOOST_CHECK_EQUAL(c.capacity(), 4);
+
+    c.resize(3, 7);
+    BOOST_CHECK_EQUAL(c.size(), 3);
+    BOOST_CHECK_EQUAL(c[2], 7);
+
+    c.push_back(1);
+    BOOST_CHECK_EQUAL(c.back(), 1);
+
+    Coord d = { 7, 7, 7, 1 };
+    BOOST_CHECK(c == d);
+    d.resize(3);
+    BOOST_CHECK(c != d);
+    BOOST_CHECK_EQUAL(sbpl::to_string(d), "[7, 7, 7]");
+
+    // integral arguments select the count constructor
+    Coord e(3, 0);
+    BOOST_CHECK_EQUAL(e.size(), 3);
+    BOOST_CHECK_EQUAL(e[2], 0);
+
+    std::vector<int> v = { 1, 2 };
+    Coord f(v.begin(), v.end());
+    BOOST_CHECK_EQUAL(sbpl::to_string(f), "[1, 2]");
+}
+
+BOOST_AUTO_TEST_CASE(ObjectPoolTest)
+{
+    sbpl::ObjectPool<std::string, 4> pool;
+    std::vector<std::string*> ptrs;
+    for (int i = 0; i < 10; ++i) {
+        ptrs.push_back(pool.create(std::to_string(i)));
+    }
+
+    BOOST_CHECK_EQUAL(pool.size(), 10);
+    for (int i = 0; i < 10; ++i) {
+        // pointers remain valid as the pool grows
+        BOOST_CHECK_EQUAL(*ptrs[i], std::to_string(i));
+        BOOST_CHECK_EQUAL(&pool[i], ptrs[i]);
+    }
+
+    pool.clear();
+    BOOST_CHECK(pool.empty());
+    BOOST_CHECK_EQUAL(*pool.create("a"), "a");
+}
+
+BOOST_AUTO_TEST_CASE(HashIndexTest)
+{
+    sbpl::ObjectPool<Coord> keys;
+    sbpl::HashIndex<Coord, CoordHash> index;
+
+    BOOST_CHECK_EQUAL(index.find(Coord{ 0, 0, 0 }), -1);
+
+    const int count = 1000;
+    for (int i = 0; i < count; ++i) {
+        Coord* key = keys.create(Coord{ i, -i, 2 * i });
+        BOOST_CHECK_EQUAL(index.insert(key, i), i);
+    }
+
+    BOOST_CHECK_EQUAL(index.size(), count);
+    BOOST_CHECK(index.bucket_count() >= 2 * count);
+
+    for (int i = 0; i < count; ++i) {
+        BOOST_CHECK_EQUAL(index.find(Coord{ i, -i, 2 * i }), i);
+    }
+    BOOST_CHECK_EQUAL(index.find(Coord{ 1, 1, 1 }), -1);
+
+    // inserting an equal key returns the existing id
+    Coord dup = { 5, -5, 10 };
+    BOOST_CHECK_EQUAL(index.insert(&dup, count), 5);
+    BOOST_CHECK_EQUAL(index.size(), count);
+
+    index.clear();
+    BOOST_CHECK(index.empty());
+    BOOST_CHECK_EQUAL(index.find(Coord{ 5, -5, 10 }), -1);
+}
+
+BOOST_AUTO_TEST_CASE(HashIndexInsertExistingTest)
+{
+    sbpl::ObjectPool<Coord> keys;
+    sbpl::HashIndex<Coord, CoordHash> index;
+
+    // fill the table to its growth threshold
+    int count = 0;
+    Coord* first = keys.create(Coord{ 0, 0, 0 });
+    index.insert(first, count++);
+    const std::size_t buckets = index.bucket_count();
+    while (2 * (index.size() + 1) <= buckets) {
+        index.insert(keys.create(Coord{ count, count, count }), count);
+        ++count;
+    }
+    BOOST_REQUIRE_EQUAL(index.bucket_count(), buckets);
+
+    // inserting an existing key does not grow the table
+    Coord dup = { 0, 0, 0 };
+    BOOST_CHECK_EQUAL(index.insert(&dup, count), 0);
+    BOOST_CHECK_EQUAL(index.bucket_count(), buckets);
+    BOOST_CHECK_EQUAL(index.size(), count);
+
+    // a new key does
+    index.insert(keys.create(Coord{ count, count, count }), count);
+    BOOST_CHECK_GT(index.bucket_count(), buckets);
+    BOOST_CHECK_EQUAL(index.find(Coord{ 0, 0, 0 }), 0);
+}
@@ -30,6 +30,8 @@
 /// \author Andrew Dornbush
 
 #include <stdio.h>
+#include <algorithm>
+#include <functional>
 #include <iostream>
 #include <random>
 #include <type_traits>
@@ -42,6 +44,7 @@
 #include <boost/container/stable_vector.hpp>
 
 #include <smpl/intrusive_heap.h>
+#include <smpl/radix_heap.h>
 
 #define LOGDEBUG 0
 #if LOGDEBUG
@@ -723,3 +726,71 @@ BOOST_AUTO_TEST_CASE(PushEraseTest)
         }
     }
 }
+
+BOOST_AUTO_TEST_CASE(RadixHeapMonotoneTest)
+{
+    std::default_random_engine rng(0);
+    std::uniform_int_distribution<int> cost_dist(0, 2000);
+
+    sbpl::RadixHeap<int> h;
+    BOOST_CHECK(h.empty());
+
+    // simulate the pushes of a dijkstra search, always inserting keys no less
+    // than the last removed key
+    std::vector<unsigned> expected;
+    unsigned last = 0;
+    for (int i = 0; i < 100; ++i) {
+        unsigned key = last + cost_dist(rng);
+        h.push(key, i);
+        expected.push_back(key);
+    }
+
+    std::sort(expected.begin(), expected.end(), std::greater<unsigned>());
+
+    std::vector<unsigned> popped;
+    while (!h.empty()) {
+        sbpl::RadixHeap<int>::key_type key;
+        int value;
+        h.pop(key, value);
+        BOOST_CHECK(key >= last);
+        last = key;
+        popped.push_back(key);
+
+        if (popped.size() < 500) {
+            for (int j = 0; j < 3; ++j) {
+                unsigned k = last + cost_dist(rng);
+                h.push(k, value);
+                expected.push_back(k);
+            }
+            std::sort(expected.begin(), expected.end(), std::greater<unsigned>());
+        }
+
+        BOOST_CHECK_EQUAL(key, expected.back());
+        expected.pop_back();
+    }
+
+    BOOST_CHECK(expected.empty());
+}
+
+BOOST_AUTO_TEST_CASE(RadixHeapClearTest)
+{
+    sbpl::RadixHeap<int> h;
+    h.push(5, 0);
+    h.push(10, 1);
+    BOOST_CHECK_EQUAL(h.size(), 2);
+
+    sbpl::RadixHeap<int>::key_type key;
+    int value;
+    h.pop(key, value);
+    BOOST_CHECK_EQUAL(key, 5);
+    BOOST_CHECK_EQUAL(value, 0);
+
+    h.clear();
+    BOOST_CHECK(h.empty());
+
+    // keys below the last removed key are allowed after clearing
+    h.push(1, 2);
+    h.pop(key, value);
+    BOOST_CHECK_EQUAL(key, 1);
+    BOOST_CHECK_EQUAL(value, 2);
+}
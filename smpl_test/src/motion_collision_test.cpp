@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE MotionCollisionTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <sbpl_collision_checking/collision_space.h>
+#include <smpl/occupancy_grid.h>
+
+namespace collision = sbpl::collision;
+
+// A single revolute arm whose tip sweeps a circle of radius 0.5 about the base,
+// past a thin post fixed to the base at (0.5, 0, 0). Both the tip and the post
+// are modeled by single small spheres, so the arm only collides with the post
+// within a narrow window of joint positions around 0.
+static const char* ARM_URDF = R"(
+<robot name="arm">
+  <link name="base_link"/>
+  <link name="arm_link"/>
+  <link name="post_link"/>
+  <joint name="arm_joint" type="revolute">
+    <parent link="base_link"/>
+    <child link="arm_link"/>
+    <origin xyz="0 0 0" rpy="0 0 0"/>
+    <axis xyz="0 0 1"/>
+    <limit lower="-3.14" upper="3.14" effort="1.0" velocity="1.0"/>
+  </joint>
+  <joint name="post_joint" type="fixed">
+    <parent link="base_link"/>
+    <child link="post_link"/>
+    <origin xyz="0.5 0 0" rpy="0 0 0"/>
+  </joint>
+</robot>
+)";
+
+static collision::CollisionSpheresModelConfig MakeSpheres(
+    const std::string& link_name,
+    double x)
+{
+    collision::CollisionSphereConfig sphere;
+    sphere.name = link_name + "_sphere";
+    sphere.x = x;
+    sphere.y = 0.0;
+    sphere.z = 0.0;
+    sphere.radius = 0.02;
+    sphere.priority = 1;
+
+    collision::CollisionSpheresModelConfig spheres;
+    spheres.link_name = link_name;
+    spheres.autogenerate = false;
+    spheres.radius = 0.0;
+    spheres.spheres.push_back(sphere);
+    return spheres;
+}
+
+static collision::CollisionModelConfig MakeArmConfig()
+{
+    collision::CollisionModelConfig config;
+    config.world_joint.name = "world_joint";
+    config.world_joint.type = "fixed";
+
+    config.spheres_models.push_back(MakeSpheres("arm_link", 0.5));
+    config.spheres_models.push_back(MakeSpheres("post_link", 0.0));
+
+    collision::CollisionGroupConfig group;
+    group.name = "arm";
+    group.links.push_back("arm_link");
+    config.groups.push_back(group);
+    return config;
+}
+
+struct ArmFixture
+{
+    sbpl::OccupancyGrid grid;
+    collision::CollisionSpacePtr cspace;
+
+    ArmFixture() :
+        grid(1.5, 1.5, 0.5, 0.02, -0.75, -0.75, -0.25, 1.0)
+    {
+        collision::CollisionSpaceBuilder builder;
+        cspace = builder.build(
+                &grid, ARM_URDF, MakeArmConfig(), "arm", { "arm_joint" });
+        BOOST_REQUIRE(cspace);
+    }
+
+    bool isStateValid(double position, double& dist)
+    {
+        return cspace->isStateValid({ position }, false, false, dist);
+    }
+
+    bool isMotionValid(
+        double start,
+        double finish,
+        int& num_checks,
+        double& dist)
+    {
+        int path_length;
+        return isMotionValid(start, finish, path_length, num_checks, dist);
+    }
+
+    bool isMotionValid(
+        double start,
+        double finish,
+        int& path_length,
+        int& num_checks,
+        double& dist)
+    {
+        path_length = 0;
+        num_checks = 0;
+        dist = std::numeric_limits<double>::infinity();
+        return cspace->isStateToStateValid(
+                { start }, { finish }, path_length, num_checks, dist);
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(MotionCollisionTests, ArmFixture)
+
+BOOST_AUTO_TEST_CASE(ThinSelfCollisionTest)
+{
+    double dist;
+    BOOST_REQUIRE(isStateValid(-0.5, dist));
+    BOOST_REQUIRE(isStateValid(0.5, dist));
+    BOOST_REQUIRE(!isStateValid(0.0, dist));
+
+    // both waypoints are clear, but the tip passes through the post between
+    // them; no waypoint may be skipped past the collision
+    int num_checks;
+    BOOST_CHECK(!isMotionValid(-0.5, 0.5, num_checks, dist));
+    BOOST_CHECK(!isMotionValid(0.5, -0.5, num_checks, dist));
+}
+
+BOOST_AUTO_TEST_CASE(ThinSelfCollisionCachedTest)
+{
+    // a single cell covers the whole motion; seed it with a clear endpoint
+    BOOST_REQUIRE(cspace->enableResultCache(1024, { 4.0 }));
+    double dist;
+    BOOST_REQUIRE(isStateValid(-0.5, dist));
+
+    // waypoints must not take the cached result of another state in the cell
+    const size_t lookups =
+            cspace->resultCache()->hits() + cspace->resultCache()->misses();
+    int num_checks;
+    BOOST_CHECK(!isMotionValid(-0.5, 0.5, num_checks, dist));
+    BOOST_CHECK(!isMotionValid(0.5, -0.5, num_checks, dist));
+    BOOST_CHECK_EQUAL(
+            cspace->resultCache()->hits() + cspace->resultCache()->misses(),
+            lookups);
+}
+
+BOOST_AUTO_TEST_CASE(ClearMotionDistanceTest)
+{
+    double start_dist;
+    double finish_dist;
+    BOOST_REQUIRE(isStateValid(1.0, start_dist));
+    BOOST_REQUIRE(isStateValid(2.0, finish_dist));
+
+    // the reported distance is the minimum over the checked waypoints, which
+    // include both endpoints
+    int num_checks;
+    double dist;
+    BOOST_CHECK(isMotionValid(1.0, 2.0, num_checks, dist));
+    BOOST_CHECK_GT(num_checks, 0);
+    BOOST_CHECK_LE(dist, std::min(start_dist, finish_dist));
+
+    // far from the post, the clearance covers waypoints without checks
+    int path_length;
+    BOOST_CHECK(isMotionValid(2.0, 3.0, path_length, num_checks, dist));
+    BOOST_CHECK_LT(num_checks, path_length);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
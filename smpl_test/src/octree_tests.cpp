@@ -266,3 +266,52 @@ BOOST_AUTO_TEST_CASE(SizeTest)
     BOOST_CHECK_EQUAL(
             sizeof(sbpl::OcTree<int>), sizeof(sbpl::detail::OcTreeNode<int>));
 }
+
+BOOST_AUTO_TEST_CASE(PoolAllocatorReuseTest)
+{
+    sbpl::OcTree<int, sbpl::PoolAllocator<int>> tree(10);
+
+    tree.expand_node(tree.root());
+    auto* orig_children = tree.root()->children;
+    auto orig_mem_usage = tree.mem_usage();
+
+    // collapsing and expanding a node should reuse the same storage
+    tree.collapse_node(tree.root(), 10);
+    tree.expand_node(tree.root());
+    BOOST_CHECK_EQUAL(tree.root()->children, orig_children);
+    BOOST_CHECK_EQUAL(tree.mem_usage(), orig_mem_usage);
+
+    // children of distinct nodes are stored contiguously within a slab
+    tree.expand_node(tree.root()->child(0));
+    tree.expand_node(tree.root()->child(1));
+    BOOST_CHECK_EQUAL(
+            tree.root()->child(1)->children,
+            tree.root()->child(0)->children + 8);
+    BOOST_CHECK_EQUAL(tree.mem_usage(), orig_mem_usage);
+
+    tree.clear();
+    BOOST_CHECK_LT(tree.mem_usage(), orig_mem_usage);
+    BOOST_CHECK_EQUAL(tree.num_nodes(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(PoolAllocatorCopyTest)
+{
+    sbpl::OcTree<TrackedInt, sbpl::PoolAllocator<TrackedInt>> tree(8);
+    tree.expand_node(tree.root());
+    tree.expand_node(tree.root()->child(0));
+
+    // copies own a separate pool
+    sbpl::OcTree<TrackedInt, sbpl::PoolAllocator<TrackedInt>> copy(tree);
+    BOOST_CHECK(copy.get_allocator() != tree.get_allocator());
+    BOOST_CHECK_EQUAL(copy.num_nodes(), tree.num_nodes());
+
+    tree.clear();
+    BOOST_CHECK_EQUAL(copy.root()->child(0)->child(7)->value, 8);
+
+    // moved-to trees keep the storage of their source
+    auto* orig_children = copy.root()->children;
+    sbpl::OcTree<TrackedInt, sbpl::PoolAllocator<TrackedInt>> moved(std::move(copy));
+    BOOST_CHECK_EQUAL(moved.root()->children, orig_children);
+    copy.clear();
+    BOOST_CHECK_EQUAL(moved.root()->child(0)->child(7)->value, 8);
+}
@@ -1,4 +1,7 @@
+#include <atomic>
 #include <iostream>
+#include <random>
+#include <vector>
 
 #define BOOST_TEST_MODULE BinaryGridTest
 #define BOOST_TEST_DYN_LINK
@@ -302,6 +305,113 @@ BOOST_AUTO_TEST_CASE(ResizeTest)
     sbpl::SparseBinaryGrid<> g;
     g.resize(8, 8, 8);
     BOOST_CHECK_EQUAL(g.max_depth(), 2);
+
+    g.resize(37, 20, 15, true);
+    BOOST_CHECK_EQUAL(g.size_x(), 37);
+    BOOST_CHECK_EQUAL(g.size_y(), 20);
+    BOOST_CHECK_EQUAL(g.size_z(), 15);
+    BOOST_CHECK_EQUAL(g.get(36, 19, 14), true);
 }
 
 // TODO: Test throwing constructor/destructor
+
+BOOST_AUTO_TEST_CASE(FillRegionTest)
+{
+    std::vector<bool> dense(33 * 33 * 33, false);
+    sbpl::SparseBinaryGrid<> g(33, 33, 33, false);
+
+    std::default_random_engine rng;
+    std::uniform_int_distribution<int> coord(-2, 35);
+    std::uniform_int_distribution<int> value(0, 1);
+    for (int i = 0; i < 200; ++i) {
+        int first[3], last[3];
+        for (int j = 0; j < 3; ++j) {
+            first[j] = coord(rng);
+            last[j] = coord(rng);
+        }
+        const bool v = value(rng);
+        g.fill_region(first[0], first[1], first[2], last[0], last[1], last[2], v);
+        for (int x = std::max(first[0], 0); x < std::min(last[0], 33); ++x) {
+        for (int y = std::max(first[1], 0); y < std::min(last[1], 33); ++y) {
+        for (int z = std::max(first[2], 0); z < std::min(last[2], 33); ++z) {
+            dense[(x * 33 + y) * 33 + z] = v;
+        }
+        }
+        }
+    }
+
+    for (int x = 0; x < 33; ++x) {
+    for (int y = 0; y < 33; ++y) {
+    for (int z = 0; z < 33; ++z) {
+        BOOST_REQUIRE_EQUAL(g.get(x, y, z), dense[(x * 33 + y) * 33 + z]);
+    }
+    }
+    }
+
+    // every box reported by the visitor holds the value of its cells
+    size_t volume = 0;
+    g.accept_coords([&](
+            bool value,
+            size_t first_x, size_t first_y, size_t first_z,
+            size_t last_x, size_t last_y, size_t last_z)
+        {
+            for (size_t x = first_x; x < last_x; ++x) {
+            for (size_t y = first_y; y < last_y; ++y) {
+            for (size_t z = first_z; z < last_z; ++z) {
+                BOOST_REQUIRE_EQUAL(value, dense[(x * 33 + y) * 33 + z]);
+            }
+            }
+            }
+            volume += (last_x - first_x) * (last_y - first_y) * (last_z - first_z);
+        },
+        0, 0, 0, 33, 33, 33);
+    BOOST_CHECK_EQUAL(volume, 33 * 33 * 33);
+
+    // filling an entire grid of packed cells collapses the tree
+    sbpl::SparseBinaryGrid<> h(32, 32, 32, false);
+    h.set(3, 17, 9, true);
+    h.fill_region(0, 0, 0, 32, 32, 32, true);
+    BOOST_CHECK_EQUAL(h.tree().num_nodes(), 1);
+    BOOST_CHECK(h.get(31, 0, 31));
+
+    // boxes beyond the extent of the grid are clamped to it, and must not
+    // wrap around into cells within it
+    sbpl::SparseBinaryGrid<> o(10, 10, 10, false);
+    o.fill_region(0, 0, 40, 2, 2, 41, true);
+    o.fill_region(12, 0, 0, 20, 10, 10, true);
+    o.fill_region(8, 8, 8, 40, 40, 40, true);
+    int count = 0;
+    for (int x = 0; x < 10; ++x) {
+    for (int y = 0; y < 10; ++y) {
+    for (int z = 0; z < 10; ++z) {
+        count += o.get(x, y, z);
+    }
+    }
+    }
+    BOOST_CHECK_EQUAL(count, 8);
+    BOOST_CHECK(o.get(9, 9, 9));
+    BOOST_CHECK(!o.get(0, 0, 0));
+}
+
+BOOST_AUTO_TEST_CASE(ParallelVisitorTest)
+{
+    sbpl::SparseBinaryGrid<> g(64, 64, 64, false);
+    g.fill_region(3, 10, 11, 50, 21, 40, true);
+
+    std::atomic<size_t> volume(0);
+    std::atomic<size_t> set_volume(0);
+    g.accept_coords_parallel([&](
+            bool value,
+            size_t first_x, size_t first_y, size_t first_z,
+            size_t last_x, size_t last_y, size_t last_z)
+        {
+            const size_t v = (last_x - first_x) * (last_y - first_y) * (last_z - first_z);
+            volume += v;
+            if (value) {
+                set_volume += v;
+            }
+        },
+        4);
+    BOOST_CHECK_EQUAL(volume.load(), 64 * 64 * 64);
+    BOOST_CHECK_EQUAL(set_volume.load(), 47 * 11 * 29);
+}
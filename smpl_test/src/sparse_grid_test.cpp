@@ -1,5 +1,8 @@
+#include <atomic>
 #include <iostream>
+#include <random>
 #include <unordered_map>
+#include <vector>
 
 #include <Eigen/Dense>
 #define BOOST_TEST_MODULE OcTreeTest
@@ -355,4 +358,113 @@ BOOST_AUTO_TEST_CASE(ResizeTest)
     BOOST_CHECK_EQUAL(g.max_depth(), 3);
 }
 
+BOOST_AUTO_TEST_CASE(FillRegionTest)
+{
+    std::vector<int> dense(32 * 32 * 32, 0);
+    sbpl::SparseGrid<int> g(32, 32, 32, 0);
+
+    std::default_random_engine rng;
+    std::uniform_int_distribution<int> coord(-2, 34);
+    std::uniform_int_distribution<int> value(0, 2);
+    for (int i = 0; i < 200; ++i) {
+        int first[3], last[3];
+        for (int j = 0; j < 3; ++j) {
+            first[j] = coord(rng);
+            last[j] = coord(rng);
+        }
+        const int v = value(rng);
+        g.fill_region(first[0], first[1], first[2], last[0], last[1], last[2], v);
+        for (int x = std::max(first[0], 0); x < std::min(last[0], 32); ++x) {
+        for (int y = std::max(first[1], 0); y < std::min(last[1], 32); ++y) {
+        for (int z = std::max(first[2], 0); z < std::min(last[2], 32); ++z) {
+            dense[(x * 32 + y) * 32 + z] = v;
+        }
+        }
+        }
+    }
+
+    for (int x = 0; x < 32; ++x) {
+    for (int y = 0; y < 32; ++y) {
+    for (int z = 0; z < 32; ++z) {
+        BOOST_REQUIRE_EQUAL(g.get(x, y, z), dense[(x * 32 + y) * 32 + z]);
+    }
+    }
+    }
+
+    // filling the entire grid collapses the tree
+    g.fill_region(0, 0, 0, 32, 32, 32, 4);
+    BOOST_CHECK_EQUAL(g.tree().num_nodes(), 1);
+
+    // filling an aligned octant only touches the nodes above it
+    g.fill_region(16, 0, 16, 32, 16, 32, 5);
+    BOOST_CHECK_EQUAL(g.tree().num_nodes(), 9);
+    BOOST_CHECK_EQUAL(g.get(20, 3, 31), 5);
+
+    // boxes beyond the extent of the grid are clamped to it
+    sbpl::SparseGrid<int> o(10, 10, 10, 0);
+    o.fill_region(0, 0, 40, 2, 2, 41, 1);
+    o.fill_region(12, 0, 0, 20, 10, 10, 1);
+    BOOST_CHECK_EQUAL(o.tree().num_nodes(), 1);
+    o.fill_region(8, 8, 8, 40, 40, 40, 2);
+    int count = 0;
+    for (int x = 0; x < 10; ++x) {
+    for (int y = 0; y < 10; ++y) {
+    for (int z = 0; z < 10; ++z) {
+        count += o.get(x, y, z) == 2;
+    }
+    }
+    }
+    BOOST_CHECK_EQUAL(count, 8);
+}
+
+BOOST_AUTO_TEST_CASE(RegionVisitorTest)
+{
+    sbpl::SparseGrid<int> g(64, 64, 64, 0);
+    g.fill_region(10, 10, 10, 30, 20, 40, 1);
+    g.set(5, 5, 5, 2);
+
+    size_t volume = 0;
+    g.accept_coords([&](
+            int value,
+            size_t first_x, size_t first_y, size_t first_z,
+            size_t last_x, size_t last_y, size_t last_z)
+        {
+            BOOST_REQUIRE_GE(first_x, 4);
+            BOOST_REQUIRE_LE(last_x, 25);
+            BOOST_REQUIRE_GE(first_y, 0);
+            BOOST_REQUIRE_LE(last_y, 12);
+            BOOST_REQUIRE_GE(first_z, 5);
+            BOOST_REQUIRE_LE(last_z, 6);
+            BOOST_REQUIRE_EQUAL(value, g.get(first_x, first_y, first_z));
+            BOOST_REQUIRE_EQUAL(value, g.get(last_x - 1, last_y - 1, last_z - 1));
+            volume += (last_x - first_x) * (last_y - first_y) * (last_z - first_z);
+        },
+        4, -3, 5, 25, 12, 6);
+    BOOST_CHECK_EQUAL(volume, 21 * 12 * 1);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelVisitorTest)
+{
+    sbpl::SparseGrid<int> g(64, 64, 64, 0);
+    g.fill_region(10, 10, 10, 50, 20, 40, 1);
+    g.set(63, 63, 63, 2);
+
+    std::atomic<size_t> volume(0);
+    std::atomic<size_t> set_volume(0);
+    g.accept_coords_parallel([&](
+            int value,
+            size_t first_x, size_t first_y, size_t first_z,
+            size_t last_x, size_t last_y, size_t last_z)
+        {
+            const size_t v = (last_x - first_x) * (last_y - first_y) * (last_z - first_z);
+            volume += v;
+            if (value == 1) {
+                set_volume += v;
+            }
+        },
+        4);
+    BOOST_CHECK_EQUAL(volume.load(), 64 * 64 * 64);
+    BOOST_CHECK_EQUAL(set_volume.load(), 40 * 10 * 30);
+}
+
 // TODO: Test throwing constructor/destructor
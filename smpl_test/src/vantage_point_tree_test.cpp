@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iterator>
+#include <vector>
+
+#define BOOST_TEST_MODULE VantagePointTreeTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <smpl/vantage_point_tree.h>
+
+struct Point
+{
+    double x;
+    double y;
+};
+
+static std::vector<Point> g_points;
+
+static double PointDistance(int a, int b)
+{
+    const double dx = g_points[a].x - g_points[b].x;
+    const double dy = g_points[a].y - g_points[b].y;
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+static std::vector<int> BruteForceWithin(int q, double radius, int count)
+{
+    std::vector<int> ids;
+    for (int i = 0; i < count; ++i) {
+        if (PointDistance(q, i) <= radius) {
+            ids.push_back(i);
+        }
+    }
+    return ids;
+}
+
+static void MakePoints(int count)
+{
+    std::srand(0);
+    g_points.clear();
+    for (int i = 0; i < count; ++i) {
+        Point p;
+        p.x = (double)std::rand() / RAND_MAX;
+        p.y = (double)std::rand() / RAND_MAX;
+        g_points.push_back(p);
+    }
+}
+
+static std::vector<int> Sorted(std::vector<int> v)
+{
+    std::sort(v.begin(), v.end());
+    return v;
+}
+
+BOOST_AUTO_TEST_CASE(BuildAndQueryTest)
+{
+    MakePoints(1000);
+    std::vector<int> ids(g_points.size());
+    for (size_t i = 0; i < ids.size(); ++i) {
+        ids[i] = (int)i;
+    }
+
+    sbpl::VantagePointTree<int> tree(PointDistance);
+    BOOST_CHECK(tree.empty());
+    tree.build(ids.begin(), ids.end());
+    BOOST_CHECK_EQUAL(tree.size(), ids.size());
+
+    for (int q = 0; q < 100; ++q) {
+        for (double r : { 0.0, 0.05, 0.2 }) {
+            std::vector<int> found;
+            tree.within(q, r, std::back_inserter(found));
+            BOOST_CHECK(Sorted(found) == BruteForceWithin(q, r, ids.size()));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(IncrementalInsertTest)
+{
+    MakePoints(1000);
+
+    sbpl::VantagePointTree<int> tree(PointDistance);
+    std::vector<int> first;
+    for (int i = 0; i < 100; ++i) {
+        first.push_back(i);
+    }
+    tree.build(first.begin(), first.end());
+    for (int i = 100; i < (int)g_points.size(); ++i) {
+        tree.insert(i);
+    }
+    BOOST_CHECK_EQUAL(tree.size(), g_points.size());
+
+    for (int q = 0; q < (int)g_points.size(); q += 10) {
+        std::vector<int> found;
+        tree.within(q, 0.1, std::back_inserter(found));
+        BOOST_CHECK(Sorted(found) == BruteForceWithin(q, 0.1, g_points.size()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(EquidistantInsertTest)
+{
+    // every element at distance zero from every other element
+    sbpl::VantagePointTree<int> tree([](int a, int b) { return 0.0; });
+    for (int i = 0; i < 100; ++i) {
+        tree.insert(i);
+    }
+
+    std::vector<int> found;
+    tree.within(0, 0.0, std::back_inserter(found));
+    BOOST_CHECK_EQUAL(found.size(), 100);
+}
@@ -0,0 +1,202 @@
+#include <vector>
+
+#include <Eigen/Dense>
+#define BOOST_TEST_MODULE VoxelizeTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <smpl/geometry/mesh_utils.h>
+#include <smpl/geometry/voxelize.h>
+
+namespace geometry = sbpl::geometry;
+
+static std::vector<Eigen::Affine3d> TestPoses()
+{
+    std::vector<Eigen::Affine3d> poses;
+    poses.push_back(Eigen::Affine3d::Identity());
+    poses.push_back(Eigen::Translation3d(0.013, -0.021, 0.37) * Eigen::Affine3d::Identity());
+    poses.push_back(
+            Eigen::Translation3d(0.5, 0.25, -0.1) *
+            Eigen::AngleAxisd(0.3, Eigen::Vector3d::UnitZ()) *
+            Eigen::AngleAxisd(-0.7, Eigen::Vector3d::UnitY()) *
+            Eigen::AngleAxisd(1.1, Eigen::Vector3d::UnitX()));
+    poses.push_back(
+            Eigen::Translation3d(-0.31, 0.07, 0.02) *
+            Eigen::AngleAxisd(M_PI / 4.0, Eigen::Vector3d(1.0, 1.0, 0.0).normalized()));
+    return poses;
+}
+
+static void CheckSameVoxels(
+    const std::vector<Eigen::Vector3d>& expected,
+    const std::vector<Eigen::Vector3d>& actual)
+{
+    BOOST_REQUIRE_EQUAL(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        BOOST_REQUIRE(expected[i] == actual[i]);
+    }
+}
+
+// Voxelize the surface of a mesh into a dense voxel grid, one triangle at a time
+static void VoxelizeMeshDense(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    double res,
+    std::vector<Eigen::Vector3d>& voxels)
+{
+    Eigen::Vector3d min = vertices[0];
+    Eigen::Vector3d max = vertices[0];
+    for (const Eigen::Vector3d& v : vertices) {
+        min = min.cwiseMin(v);
+        max = max.cwiseMax(v);
+    }
+
+    geometry::HalfResVoxelGrid vg(min, max - min, Eigen::Vector3d(res, res, res));
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        geometry::VoxelizeTriangle(
+                vertices[indices[i]], vertices[indices[i + 1]], vertices[indices[i + 2]], vg);
+    }
+
+    for (int x = 0; x < vg.sizeX(); ++x) {
+        for (int y = 0; y < vg.sizeY(); ++y) {
+            for (int z = 0; z < vg.sizeZ(); ++z) {
+                const geometry::MemoryCoord mc(x, y, z);
+                if (vg[mc]) {
+                    const geometry::WorldCoord wc = vg.memoryToWorld(mc);
+                    voxels.push_back(Eigen::Vector3d(wc.x, wc.y, wc.z));
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(LargeMeshMatchesDenseTest)
+{
+    // a set of shelves wide enough to be split into several tiles
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<int> indices;
+    for (int s = 0; s < 4; ++s) {
+        std::vector<Eigen::Vector3d> box_vertices;
+        std::vector<int> box_indices;
+        geometry::CreateIndexedBoxMesh(2.5, 0.6, 0.03, box_vertices, box_indices);
+        const int offset = (int)vertices.size();
+        for (const Eigen::Vector3d& v : box_vertices) {
+            vertices.push_back(v + Eigen::Vector3d(0.0, 0.0, 0.4 * s));
+        }
+        for (int i : box_indices) {
+            indices.push_back(offset + i);
+        }
+    }
+
+    const double res = 0.02;
+    for (const Eigen::Affine3d& pose : TestPoses()) {
+        std::vector<Eigen::Vector3d> transformed;
+        for (const Eigen::Vector3d& v : vertices) {
+            transformed.push_back(pose * v);
+        }
+
+        std::vector<Eigen::Vector3d> expected, actual;
+        VoxelizeMeshDense(transformed, indices, res, expected);
+        geometry::VoxelizeMesh(transformed, indices, res, actual, false);
+        CheckSameVoxels(expected, actual);
+
+        std::vector<Eigen::Vector3d> filled;
+        geometry::VoxelizeMesh(transformed, indices, res, filled, true);
+        BOOST_CHECK_GT(filled.size(), actual.size());
+    }
+}
+
+// The primitive voxelizers must produce exactly the voxels of the mesh
+// voxelizer applied to the corresponding primitive mesh
+
+BOOST_AUTO_TEST_CASE(BoxMatchesMeshTest)
+{
+    const double res = 0.02;
+    const Eigen::Vector3d origin(0.003, -0.011, 0.007);
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<int> indices;
+    geometry::CreateIndexedBoxMesh(0.3, 0.17, 0.45, vertices, indices);
+    for (const Eigen::Affine3d& pose : TestPoses()) {
+        for (bool fill : { false, true }) {
+            std::vector<Eigen::Vector3d> expected, actual;
+            geometry::VoxelizeMesh(vertices, indices, pose, res, expected, fill);
+            geometry::VoxelizeBox(0.3, 0.17, 0.45, pose, res, actual, fill);
+            BOOST_CHECK(!actual.empty());
+            CheckSameVoxels(expected, actual);
+
+            expected.clear();
+            actual.clear();
+            geometry::VoxelizeMesh(vertices, indices, pose, res, origin, expected, fill);
+            geometry::VoxelizeBox(0.3, 0.17, 0.45, pose, res, origin, actual, fill);
+            CheckSameVoxels(expected, actual);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(SphereMatchesMeshTest)
+{
+    const double res = 0.02;
+    const Eigen::Vector3d origin(0.003, -0.011, 0.007);
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<int> indices;
+    geometry::CreateIndexedSphereMesh(0.17, 7, 8, vertices, indices);
+    for (const Eigen::Affine3d& pose : TestPoses()) {
+        for (bool fill : { false, true }) {
+            std::vector<Eigen::Vector3d> expected, actual;
+            geometry::VoxelizeMesh(vertices, indices, pose, res, expected, fill);
+            geometry::VoxelizeSphere(0.17, pose, res, actual, fill);
+            CheckSameVoxels(expected, actual);
+
+            expected.clear();
+            actual.clear();
+            geometry::VoxelizeMesh(vertices, indices, pose, res, origin, expected, fill);
+            geometry::VoxelizeSphere(0.17, pose, res, origin, actual, fill);
+            CheckSameVoxels(expected, actual);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(CylinderMatchesMeshTest)
+{
+    const double res = 0.02;
+    const Eigen::Vector3d origin(0.003, -0.011, 0.007);
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<int> indices;
+    geometry::CreateIndexedCylinderMesh(0.08, 0.4, vertices, indices);
+    for (const Eigen::Affine3d& pose : TestPoses()) {
+        for (bool fill : { false, true }) {
+            std::vector<Eigen::Vector3d> expected, actual;
+            geometry::VoxelizeMesh(vertices, indices, pose, res, expected, fill);
+            geometry::VoxelizeCylinder(0.08, 0.4, pose, res, actual, fill);
+            CheckSameVoxels(expected, actual);
+
+            expected.clear();
+            actual.clear();
+            geometry::VoxelizeMesh(vertices, indices, pose, res, origin, expected, fill);
+            geometry::VoxelizeCylinder(0.08, 0.4, pose, res, origin, actual, fill);
+            CheckSameVoxels(expected, actual);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ConeMatchesMeshTest)
+{
+    const double res = 0.02;
+    const Eigen::Vector3d origin(0.003, -0.011, 0.007);
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<int> indices;
+    geometry::CreateIndexedConeMesh(0.12, 0.3, vertices, indices);
+    for (const Eigen::Affine3d& pose : TestPoses()) {
+        for (bool fill : { false, true }) {
+            std::vector<Eigen::Vector3d> expected, actual;
+            geometry::VoxelizeMesh(vertices, indices, pose, res, expected, fill);
+            geometry::VoxelizeCone(0.12, 0.3, pose, res, actual, fill);
+            CheckSameVoxels(expected, actual);
+
+            expected.clear();
+            actual.clear();
+            geometry::VoxelizeMesh(vertices, indices, pose, res, origin, expected, fill);
+            geometry::VoxelizeCone(0.12, 0.3, pose, res, origin, actual, fill);
+            CheckSameVoxels(expected, actual);
+        }
+    }
+}
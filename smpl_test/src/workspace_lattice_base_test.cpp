@@ -0,0 +1,222 @@
+#include <cmath>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE WorkspaceLatticeBaseTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <smpl/graph/workspace_lattice_base.h>
+#include <smpl/planning_params.h>
+#include <smpl/robot_model.h>
+
+namespace motion = sbpl::motion;
+
+// A free-flying body whose six joint variables are the ( x, y, z, R, P, Y )
+// pose of its planning link. The fast ik solver returns the target pose
+// exactly and records the seed it was given.
+class FreeBodyModel :
+    public motion::ForwardKinematicsInterface,
+    public motion::InverseKinematicsInterface,
+    public motion::RedundantManipulatorInterface
+{
+public:
+
+    int fast_ik_calls = 0;
+    bool fast_ik_succeeds = true;
+    motion::RobotState fast_ik_seed;
+
+    FreeBodyModel()
+    {
+        setPlanningJoints({ "x", "y", "z", "roll", "pitch", "yaw" });
+    }
+
+    double minPosLimit(int jidx) const override { return 0.0; }
+    double maxPosLimit(int jidx) const override { return 0.0; }
+    bool hasPosLimit(int jidx) const override { return false; }
+    bool isContinuous(int jidx) const override { return false; }
+    double velLimit(int jidx) const override { return 0.0; }
+    double accLimit(int jidx) const override { return 0.0; }
+    bool checkJointLimits(const motion::RobotState&, bool) override { return true; }
+
+    bool computeFK(
+        const motion::RobotState& state,
+        const std::string& name,
+        std::vector<double>& pose) override
+    {
+        return computePlanningLinkFK(state, pose);
+    }
+
+    bool computePlanningLinkFK(
+        const motion::RobotState& state,
+        std::vector<double>& pose) override
+    {
+        pose.assign(state.begin(), state.begin() + 6);
+        return true;
+    }
+
+    bool computeIK(
+        const std::vector<double>& pose,
+        const motion::RobotState& start,
+        motion::RobotState& solution,
+        motion::ik_option::IkOption option) override
+    {
+        return computeFastIK(pose, start, solution);
+    }
+
+    bool computeIK(
+        const std::vector<double>& pose,
+        const motion::RobotState& start,
+        std::vector<motion::RobotState>& solutions,
+        motion::ik_option::IkOption option) override
+    {
+        return false;
+    }
+
+    const int redundantVariableCount() const override { return 0; }
+    const int redundantVariableIndex(int rvidx) const override { return -1; }
+
+    bool computeFastIK(
+        const std::vector<double>& pose,
+        const motion::RobotState& start,
+        motion::RobotState& solution) override
+    {
+        ++fast_ik_calls;
+        fast_ik_seed = start;
+        if (!fast_ik_succeeds) {
+            return false;
+        }
+        solution = pose;
+        return true;
+    }
+
+    motion::Extension* getExtension(size_t class_code) override
+    {
+        if (class_code == motion::GetClassCode<motion::RobotModel>() ||
+            class_code == motion::GetClassCode<motion::ForwardKinematicsInterface>() ||
+            class_code == motion::GetClassCode<motion::InverseKinematicsInterface>() ||
+            class_code == motion::GetClassCode<motion::RedundantManipulatorInterface>())
+        {
+            return this;
+        }
+        return nullptr;
+    }
+};
+
+// Exposes the conversions of WorkspaceLatticeBase
+class TestLattice : public motion::WorkspaceLatticeBase
+{
+public:
+
+    TestLattice(motion::RobotModel* robot, const motion::PlanningParams* params) :
+        WorkspaceLatticeBase(robot, nullptr, params)
+    { }
+
+    using WorkspaceLatticeBase::stateWorkspaceToRobot;
+
+    int getStartStateID() const override { return -1; }
+    int getGoalStateID() const override { return -1; }
+
+    bool extractPath(
+        const std::vector<int>& ids,
+        std::vector<motion::RobotState>& path) override
+    {
+        return false;
+    }
+
+    void GetSuccs(int, std::vector<int>*, std::vector<int>*) override { }
+    void GetPreds(int, std::vector<int>*, std::vector<int>*) override { }
+    void PrintState(int, bool, FILE*) override { }
+
+    motion::Extension* getExtension(size_t class_code) override
+    {
+        return nullptr;
+    }
+};
+
+static motion::WorkspaceLatticeBase::Params MakeParams()
+{
+    motion::WorkspaceLatticeBase::Params params;
+    params.res_x = 0.02;
+    params.res_y = 0.02;
+    params.res_z = 0.02;
+    params.R_count = 360;
+    params.P_count = 180 + 1;
+    params.Y_count = 360;
+    return params;
+}
+
+static double PoseError(
+    FreeBodyModel& robot,
+    const motion::RobotState& state,
+    const motion::WorkspaceState& target)
+{
+    std::vector<double> pose;
+    robot.computePlanningLinkFK(state, pose);
+    double err = 0.0;
+    for (size_t i = 0; i < pose.size(); ++i) {
+        err = std::max(err, std::fabs(pose[i] - target[i]));
+    }
+    return err;
+}
+
+BOOST_AUTO_TEST_CASE(SeedCacheTest)
+{
+    FreeBodyModel robot;
+    motion::PlanningParams planning_params;
+    TestLattice lattice(&robot, &planning_params);
+
+    motion::WorkspaceLatticeBase::Params params = MakeParams();
+    params.ik_seed_cache_size = 16;
+    params.ik_seed_cache_max_dist = 0.1;
+    BOOST_REQUIRE(lattice.init(params));
+
+    const motion::WorkspaceState state = { 0.5, 0.0, 0.2, 0.1, 0.2, 0.3 };
+    const motion::RobotState seed = { 0.48, 0.0, 0.2, 0.1, 0.2, 0.3 };
+    motion::RobotState solution;
+    BOOST_REQUIRE(lattice.stateWorkspaceToRobot(state, seed, solution));
+    BOOST_CHECK(robot.fast_ik_seed == seed);
+
+    // a state in the same cell, with a seed on the same ik branch, is seeded
+    // with the cached solution
+    const motion::WorkspaceState near_state = { 0.501, 0.0, 0.2, 0.1, 0.2, 0.3 };
+    const motion::RobotState near_seed = { 0.46, 0.0, 0.2, 0.1, 0.2, 0.3 };
+    motion::RobotState near_solution;
+    BOOST_REQUIRE(lattice.stateWorkspaceToRobot(near_state, near_seed, near_solution));
+    BOOST_CHECK(robot.fast_ik_seed == solution);
+
+    // the cached solution is not used as the seed for a seed far from it
+    const motion::RobotState far_seed = { 0.0, 0.0, 0.2, 0.1, 0.2, 0.3 };
+    BOOST_REQUIRE(lattice.stateWorkspaceToRobot(near_state, far_seed, near_solution));
+    BOOST_CHECK(robot.fast_ik_seed == far_seed);
+}
+
+BOOST_AUTO_TEST_CASE(ApproxIKTest)
+{
+    FreeBodyModel robot;
+    motion::PlanningParams planning_params;
+    TestLattice lattice(&robot, &planning_params);
+
+    motion::WorkspaceLatticeBase::Params params = MakeParams();
+    params.approx_ik = true;
+    BOOST_REQUIRE(lattice.init(params));
+
+    // a small displacement from the seed is solved without the fast ik solver
+    const motion::RobotState seed = { 0.5, 0.0, 0.2, 0.1, 0.2, 0.3 };
+    const motion::WorkspaceState state = { 0.52, 0.01, 0.19, 0.12, 0.18, 0.33 };
+    motion::RobotState solution;
+    BOOST_REQUIRE(lattice.stateWorkspaceToRobot(state, seed, solution));
+    BOOST_CHECK_EQUAL(robot.fast_ik_calls, 0);
+    BOOST_CHECK_EQUAL(solution.size(), seed.size());
+    BOOST_CHECK_LT(PoseError(robot, solution, state), 1e-3);
+
+    // without convergence, the fast ik solver is used as the fallback
+    params.approx_ik_max_iterations = 0;
+    BOOST_REQUIRE(lattice.init(params));
+    BOOST_REQUIRE(lattice.stateWorkspaceToRobot(state, seed, solution));
+    BOOST_CHECK_EQUAL(robot.fast_ik_calls, 1);
+    BOOST_CHECK_LT(PoseError(robot, solution, state), 1e-9);
+
+    robot.fast_ik_succeeds = false;
+    BOOST_CHECK(!lattice.stateWorkspaceToRobot(state, seed, solution));
+}